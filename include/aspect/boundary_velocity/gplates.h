@@ -24,10 +24,11 @@
 
 #include <aspect/boundary_velocity/interface.h>
 #include <aspect/simulator_access.h>
+#include <aspect/utilities.h>
 #include <aspect/compat.h>
 
 #include <deal.II/base/std_cxx11/array.h>
-#include <deal.II/base/function_lib.h>
+#include <deal.II/base/table.h>
 
 
 namespace aspect
@@ -63,10 +64,18 @@ namespace aspect
 
           /**
            * Loads a gplates .gpml velocity file. Throws an exception if the
-           * file does not exist.
+           * file does not exist. If @p use_binary_cache is set, the velocities
+           * are read from a binary file with the name @p filename followed
+           * by '.cache' if it exists and was created from the current
+           * version of the gpml file. Otherwise, the gpml file is read and
+           * the binary file is (re)created. If @p prefetcher is not a null
+           * pointer, the content of the file that was read in the background
+           * by this object is used, if available.
            */
           void load_file(const std::string &filename,
-                         const MPI_Comm &comm);
+                         const MPI_Comm &comm,
+                         const bool use_binary_cache,
+                         Utilities::FilePrefetcher *prefetcher = NULL);
 
           /**
            * Returns the computed surface velocity in cartesian coordinates.
@@ -77,11 +86,31 @@ namespace aspect
            */
           Tensor<1,dim> surface_velocity(const Point<dim> &position) const;
 
+          /**
+           * Returns the computed surface velocity in cartesian coordinates
+           * like the function above, but takes as input the position in
+           * spherical coordinates as computed by
+           * spherical_surface_position(). This allows to reuse the
+           * coordinate transformation when evaluating several lookups with
+           * the same rotation at the same position.
+           */
+          Tensor<1,dim> surface_velocity(const std_cxx11::array<double,3> &spherical_point) const;
+
+          /**
+           * Returns the position in spherical coordinates of the point
+           * @p position, after rotating it into the plane of the model
+           * for 2D models.
+           */
+          std_cxx11::array<double,3>
+          spherical_surface_position(const Point<dim> &position) const;
+
         private:
           /**
-           * Interpolation functions to access the velocities.
+           * Two tables (one for the theta and one for the phi component)
+           * which contain the velocities at every point of the
+           * Lat/Long grid.
            */
-          std_cxx11::array<std_cxx11::unique_ptr<typename Functions::InterpolatedUniformGridData<2> >, 2> velocities;
+          std_cxx11::array<Table<2,double>,2> velocity_values;
 
           /**
            * Distances between adjacent point in the Lat/Long grid
@@ -96,6 +125,12 @@ namespace aspect
            */
           Tensor<2,3> rotation_matrix;
 
+          /**
+           * The transpose (and therefore inverse) of rotation_matrix, which
+           * is needed for every velocity evaluation in 2D models.
+           */
+          Tensor<2,3> inverse_rotation_matrix;
+
           /**
            * A function that returns the corresponding paraview angles for a
            * rotation described by a rotation matrix. These differ from the
@@ -157,6 +192,39 @@ namespace aspect
           Tensor<1,3> sphere_to_cart_velocity(const Tensor<1,2> &s_velocities,
                                               const std_cxx11::array<double,3> &s_position) const;
 
+          /**
+           * Interpolate the theta and phi components of the velocity at the
+           * position @p theta, @p phi of the Lat/Long grid. Both components
+           * are computed from the same interpolation weights.
+           */
+          Tensor<1,2>
+          interpolate_velocity(const double theta,
+                               const double phi) const;
+
+          /**
+           * Fill the velocity tables from the @p content of a gpml file.
+           */
+          void
+          parse_gpml_content(const std::string &content);
+
+          /**
+           * Fill the velocity tables from the @p content of a binary cache
+           * file that was written by write_binary_cache().
+           */
+          void
+          parse_binary_cache_content(const std::string &content);
+
+          /**
+           * Write the velocity tables into the binary cache file
+           * @p cache_filename. @p source_size and @p source_modification_time
+           * describe the gpml file the tables were created from, and are
+           * used to detect outdated cache files.
+           */
+          void
+          write_binary_cache(const std::string &cache_filename,
+                             const unsigned long long source_size,
+                             const long long source_modification_time) const;
+
           /**
            * Check whether the gpml file was created by GPlates1.4 or later.
            * We need to know this, because the mesh has changed its longitude
@@ -292,6 +360,12 @@ namespace aspect
          */
         double scale_factor;
 
+        /**
+         * Whether to convert the gpml files into binary files on first use,
+         * and read these binary files instead of the gpml files later.
+         */
+        bool use_binary_cache;
+
         /**
          * Two user defined points that prescribe the plane from which the 2D
          * model takes the velocity boundary condition. One can think of this,
@@ -350,6 +424,20 @@ namespace aspect
          */
         std::string
         create_filename (const int timestep) const;
+
+        /**
+         * Reads the velocity files that will be needed in the next time
+         * step in the background.
+         */
+        Utilities::FilePrefetcher file_prefetcher;
+
+        /**
+         * Predict which velocity files will be needed in the next time step,
+         * assuming the time step size does not change, and start reading
+         * them in the background if they are not loaded yet.
+         */
+        void
+        prefetch_data_files ();
     };
   }
 }
@@ -94,6 +94,20 @@ namespace aspect
       };
     };
 
+    /**
+     * A struct that describes the available methods to integrate the
+     * reactions of the temperature and compositional fields if operator
+     * splitting is used.
+     */
+    struct ReactionSolverType
+    {
+      enum Kind
+      {
+        forward_euler,
+        adaptive_runge_kutta
+      };
+    };
+
     /**
      * A struct that describes the available methods to solve
      * advected fields. This type is at the moment only used to determine how
@@ -315,6 +329,9 @@ namespace aspect
     double                         maximum_relative_increase_time_step;
     double                         reaction_time_step;
     unsigned int                   reaction_steps_per_advection_step;
+    typename ReactionSolverType::Kind reaction_solver_type;
+    double                         reaction_solver_relative_tolerance;
+    double                         reaction_solver_absolute_tolerance;
     bool                           use_artificial_viscosity_smoothing;
     bool                           use_conduction_timestep;
     bool                           convert_to_years;
@@ -0,0 +1,79 @@
+/*
+ Copyright (C) 2017 by the authors of the ASPECT code.
+
+ This file is part of ASPECT.
+
+ ASPECT is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2, or (at your option)
+ any later version.
+
+ ASPECT is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with ASPECT; see the file LICENSE.  If not see
+ <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _aspect_particle_generator_binary_file_h
+#define _aspect_particle_generator_binary_file_h
+
+#include <aspect/particle/generator/interface.h>
+
+namespace aspect
+{
+  namespace Particle
+  {
+    namespace Generator
+    {
+      /**
+       * Generate a distribution of particles that is determined by the
+       * coordinates given in a binary data file. The particles in the file
+       * are grouped into blocks with known bounding boxes, so that every
+       * process only reads the blocks that overlap with its part of the
+       * domain, directly from the file and without any communication.
+       *
+       * @ingroup ParticleGenerators
+       */
+      template <int dim>
+      class BinaryFile : public Interface<dim>
+      {
+        public:
+          /**
+           * Reads the parts of the file that overlap with the local domain
+           * and generates a set of particles at the prescribed positions.
+           *
+           * @param [in,out] particles A multimap between cells and their
+           * particles. This map will be filled in this function.
+           */
+          virtual
+          void
+          generate_particles(std::multimap<types::LevelInd, Particle<dim> > &particles);
+
+          /**
+           * Declare the parameters this class takes through input files.
+           */
+          static
+          void
+          declare_parameters (ParameterHandler &prm);
+
+          /**
+           * Read the parameters this class declares from the parameter file.
+           */
+          virtual
+          void
+          parse_parameters (ParameterHandler &prm);
+
+        private:
+          std::string data_directory;
+          std::string data_filename;
+      };
+
+    }
+  }
+}
+
+#endif
@@ -146,11 +146,68 @@ namespace aspect
           generate_particle(const Point<dim> &position,
                             const types::particle_index id) const;
 
+          /**
+           * Try to generate one particle with the given id in the given cell.
+           * The particle position is given by the @p dim numbers in
+           * @p random_numbers, which are taken from the interval [0,1] and
+           * scaled to the bounding box of the cell. If this position is
+           * inside the cell, store the particle in @p particle and return
+           * true, otherwise return false. generate_particle() repeats this
+           * with new random numbers until it succeeds. Since this function
+           * does not modify the object, it can be called concurrently.
+           */
+          bool
+          try_generate_particle (const typename parallel::distributed::Triangulation<dim>::active_cell_iterator &cell,
+                                 const types::particle_index id,
+                                 const double *random_numbers,
+                                 std::pair<types::LevelInd,Particle<dim> > &particle) const;
+
+          /**
+           * Generate particles at all of the given positions (with the
+           * given ids) that lie in the local domain and insert them into
+           * @p particles. Positions outside the local domain are silently
+           * ignored. The cells of the particles are searched for in parallel
+           * on all available threads.
+           */
+          void
+          generate_particles_at_positions (const std::vector<std::pair<Point<dim>,types::particle_index> > &positions,
+                                           std::multimap<types::LevelInd, Particle<dim> > &particles) const;
+
+          /**
+           * Return the lower and upper corner of a box that contains all
+           * locally owned cells. The box is slightly enlarged to also contain
+           * cells that are curved by the mapping. Positions outside of this
+           * box can be skipped before searching for their cell.
+           */
+          std::pair<Point<dim>,Point<dim> >
+          compute_local_bounding_box () const;
+
           /**
            * Random number generator. For reproducibility of tests it is
            * initialized in the constructor with a constant.
            */
           boost::mt19937            random_number_generator;
+
+        private:
+          /**
+           * Return the lower and upper corner of the bounding box of the
+           * vertices of @p cell.
+           */
+          static
+          std::pair<Point<dim>,Point<dim> >
+          get_cell_bounds (const typename parallel::distributed::Triangulation<dim>::active_cell_iterator &cell);
+
+          /**
+           * Generate particles at the entries of @p positions with indices
+           * in the range [@p begin, @p end) that lie in the local domain and
+           * append them to @p particles. This function is executed by the
+           * tasks of generate_particles_at_positions().
+           */
+          void
+          generate_particles_in_range (const std::vector<std::pair<Point<dim>,types::particle_index> > &positions,
+                                       const std::size_t begin,
+                                       const std::size_t end,
+                                       std::vector<std::pair<types::LevelInd,Particle<dim> > > *particles) const;
       };
 
       /**
@@ -49,16 +49,17 @@ namespace aspect
       /**
        * Generates a random distribution of particles over the simulation
        * domain. The particle density is determined by a user-defined
-       * probability density function in the parameter file. This is done using
-       * a "roulette wheel" style selection. Every cell is weighted by the value
-       * of the provided function at its center multiplied with the cell
-       * volume. Then a map between the accumulated cell weight
-       * and the cell index of the current cell is constructed. Consequently,
-       * a random number between zero and the global integral of the
-       * probability density function uniquely defines one particular cell.
-       * Afterwards, every process generates n_global_particles random numbers,
-       * but only generates a particle if it is the owner of the active cell
-       * that is associated with this random number.
+       * probability density function in the parameter file. Every cell is
+       * weighted by the value of the provided function at its center
+       * multiplied with the cell volume. Every process then generates as
+       * many particles as corresponds to the fraction of the global weight
+       * integral in its locally owned cells. The cells of these particles are
+       * either drawn randomly using a "roulette wheel" style selection, in
+       * which a random number between zero and the local weight integral
+       * uniquely defines one cell, or determined from the accumulated cell
+       * weights. The positions of the particles within their cells are
+       * tested in parallel on all available threads, but the result is
+       * identical to a sequential generation.
        *
        * @ingroup ParticleGenerators
        */
@@ -166,6 +167,27 @@ namespace aspect
            */
           std::vector<double>
           compute_local_accumulated_cell_weights () const;
+
+          /**
+           * Try to generate the local particles with indices in the range
+           * [@p begin, @p end) and store them in @p local_particles. The
+           * particle with index i is generated in the cell
+           * @p local_cells[@p particle_cells[i]], gets the id
+           * @p first_particle_id + i, and its position is given by the
+           * entries starting at dim*i of @p random_numbers. Entry i of
+           * @p accepted_candidates is set to one if this position is inside
+           * the cell, and to zero otherwise. This function is executed by the
+           * tasks of generate_particles_in_subdomain().
+           */
+          void
+          generate_particles_in_range (const std::vector<typename parallel::distributed::Triangulation<dim>::active_cell_iterator> &local_cells,
+                                       const std::vector<unsigned int> &particle_cells,
+                                       const types::particle_index begin,
+                                       const types::particle_index end,
+                                       const types::particle_index first_particle_id,
+                                       const std::vector<double> &random_numbers,
+                                       std::vector<std::pair<types::LevelInd, Particle<dim> > > *local_particles,
+                                       std::vector<unsigned char> *accepted_candidates) const;
       };
 
     }
@@ -0,0 +1,147 @@
+/*
+  Copyright (C) 2017 by the authors of the ASPECT code.
+
+ This file is part of ASPECT.
+
+ ASPECT is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2, or (at your option)
+ any later version.
+
+ ASPECT is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with ASPECT; see the file LICENSE.  If not see
+ <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _aspect_particle_integrator_adaptive_rk_h
+#define _aspect_particle_integrator_adaptive_rk_h
+
+#include <aspect/particle/integrator/interface.h>
+
+#include <aspect/simulator_access.h>
+
+
+namespace aspect
+{
+  namespace Particle
+  {
+    namespace Integrator
+    {
+      /**
+       * An adaptive embedded Runge-Kutta integrator that subdivides the
+       * time step of every particle individually. It uses the third order
+       * method of Bogacki and Shampine with its embedded second order
+       * method to estimate the local error of every substep, and adapts the
+       * substep length such that the estimated error stays below a given
+       * fraction of the cell diameter. Particles in regions with smooth
+       * velocity therefore take a single substep, while particles in regions
+       * with strong velocity gradients take as many substeps as necessary.
+       *
+       * The velocity at every stage is evaluated from the velocity field of
+       * the cell that contains the stage point, interpolated linearly in time
+       * between the old and the current solution. The integration therefore
+       * does not require additional integration steps of the particle world
+       * and no integrator data has to be stored. Particles can only be
+       * followed through the locally owned and ghost cells, which is
+       * sufficient as long as the time step satisfies the CFL condition
+       * with a CFL number of at most one.
+       *
+       * @ingroup ParticleIntegrators
+       */
+      template <int dim>
+      class AdaptiveRK : public Interface<dim>, public SimulatorAccess<dim>
+      {
+        public:
+          /**
+           * Constructor.
+           */
+          AdaptiveRK();
+
+          /**
+           * This integrator needs the velocity field of the whole cell.
+           */
+          virtual
+          bool
+          need_cell_velocity_field () const;
+
+          /**
+           * Move all particles of one cell by the time step @p dt, using as
+           * many substeps for every particle as necessary to keep the
+           * estimated error below the tolerance.
+           *
+           * @copydetails Interface::local_integrate_cell()
+           */
+          virtual
+          void
+          local_integrate_cell(const typename ParticleHandler<dim>::particle_iterator &begin_particle,
+                               const typename ParticleHandler<dim>::particle_iterator &end_particle,
+                               CellVelocityField<dim> &velocity_field,
+                               const double dt);
+
+          /**
+           * This integrator does not use the velocities at the particle
+           * positions, calling this function is an error.
+           */
+          virtual
+          void
+          local_integrate_step(const typename ParticleHandler<dim>::particle_iterator &begin_particle,
+                               const typename ParticleHandler<dim>::particle_iterator &end_particle,
+                               const std::vector<Tensor<1,dim> > &old_velocities,
+                               const std::vector<Tensor<1,dim> > &velocities,
+                               const double dt);
+
+          /**
+           * Declare the parameters this class takes through input files.
+           */
+          static
+          void
+          declare_parameters (ParameterHandler &prm);
+
+          /**
+           * Read the parameters this class declares from the parameter file.
+           */
+          virtual
+          void
+          parse_parameters (ParameterHandler &prm);
+
+        private:
+          /**
+           * Integrate the path of one particle that starts at @p location,
+           * which has the coordinates @p reference_location in the reference
+           * cell of the current cell of @p velocity_field, over the time step
+           * @p dt and return its final location. @p tolerance is the maximal
+           * estimated error of every substep. @p velocity_field is moved to
+           * the cells the particle passes through.
+           */
+          Point<dim>
+          integrate_particle (const Point<dim> &location,
+                              const Point<dim> &reference_location,
+                              CellVelocityField<dim> &velocity_field,
+                              const double dt,
+                              const double tolerance) const;
+
+          /**
+           * The maximal estimated error of a substep, relative to the
+           * diameter of the cell.
+           */
+          double relative_tolerance;
+
+          /**
+           * The maximal number of substeps per particle and time step,
+           * counting both accepted and rejected substeps. If a particle needs
+           * more substeps, the remaining part of the time step is integrated
+           * in a single substep without error control.
+           */
+          unsigned int max_substeps;
+      };
+
+    }
+  }
+}
+
+#endif
@@ -27,6 +27,9 @@
 #include <aspect/global.h>
 
 #include <deal.II/base/parameter_handler.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/fe/fe.h>
+#include <deal.II/fe/mapping.h>
 
 namespace aspect
 {
@@ -36,6 +39,106 @@ namespace aspect
     {
       using namespace dealii;
 
+      /**
+       * The velocity field inside of one cell at the beginning and the end of
+       * the current time step, described by the velocity values at the
+       * support points of the velocity finite element. Integrators that need
+       * to evaluate the velocity at arbitrary points and times during the
+       * time step (e.g. because they subdivide the time step) receive an
+       * object of this type, see Interface::need_cell_velocity_field().
+       * The object can move itself to other locally owned or ghost cells,
+       * so that integrators can follow a particle that leaves its cell
+       * during the time step.
+       *
+       * @ingroup ParticleIntegrators
+       */
+      template <int dim>
+      struct CellVelocityField
+      {
+        /**
+         * Constructor.
+         */
+        CellVelocityField ();
+
+        /**
+         * The finite element of the whole system and the component of the
+         * first velocity component in it, the velocity finite element, the
+         * mapping, and the current and old solution vectors the velocities
+         * are read from.
+         */
+        const FiniteElement<dim> *fe;
+        unsigned int first_velocity_component;
+        const FiniteElement<dim> *velocity_fe;
+        const Mapping<dim> *mapping;
+        const LinearAlgebra::BlockVector *solution;
+        const LinearAlgebra::BlockVector *old_solution;
+
+        /**
+         * The cell the velocity values below belong to.
+         */
+        typename DoFHandler<dim>::active_cell_iterator cell;
+
+        /**
+         * The velocities at the support points of @p velocity_fe at the
+         * beginning and at the end of the time step.
+         */
+        std::vector<Tensor<1,dim> > old_velocities;
+        std::vector<Tensor<1,dim> > velocities;
+
+        /**
+         * The degrees of freedom of @p cell.
+         */
+        std::vector<types::global_dof_index> cell_dof_indices;
+
+        /**
+         * Set @p cell to @p new_cell and read the velocities at its support
+         * points from the solution vectors. All pointers above have to be
+         * set before this function is called.
+         */
+        void
+        reinit (const typename DoFHandler<dim>::active_cell_iterator &new_cell);
+
+        /**
+         * Return the velocity at the point with coordinates
+         * @p reference_location in the reference cell, linearly
+         * interpolated in time between the beginning (@p time_fraction
+         * equals zero) and the end (@p time_fraction equals one) of the time
+         * step. The polynomial velocity of the cell is extrapolated for
+         * points outside of the reference cell.
+         */
+        Tensor<1,dim>
+        value (const Point<dim> &reference_location,
+               const double time_fraction) const;
+
+        /**
+         * Compute the coordinates of the point @p location in the reference
+         * cell of @p cell. Returns false if the mapping can not be inverted
+         * at @p location, in which case @p reference_location is not
+         * changed.
+         */
+        bool
+        reference_location (const Point<dim> &location,
+                            Point<dim> &reference_location) const;
+
+        /**
+         * Find the cell that contains @p location by walking from the
+         * current cell across faces, always to the neighbor whose center is
+         * closest to @p location, and reinit() this object for that cell.
+         * Returns true and sets @p reference_location to the coordinates of
+         * @p location in the reference cell of the new cell if this
+         * succeeds. If @p location is outside of the domain, the boundary
+         * cell closest to it is used, and the velocity there is
+         * extrapolated. Returns false if the walk would need to enter an
+         * artificial cell, i.e. @p location is not within the locally owned
+         * and ghost cells of this process, or if the mapping can not be
+         * inverted at @p location.
+         */
+        bool
+        move_to_point (const Point<dim> &location,
+                       Point<dim> &reference_location);
+      };
+
+
       /**
        * An abstract class defining virtual methods for performing integration
        * of particle paths through the simulation velocity field.
@@ -59,6 +162,12 @@ namespace aspect
            * the velocity at the updated particle positions is evaluated and
            * passed as input argument during the next call.
            *
+           * This function is called concurrently for different cells from
+           * several threads. Implementations therefore have to make sure
+           * that modifications of data that is shared between cells are
+           * thread-safe. Per-particle data should be stored in the
+           * integrator data of the particles (see get_n_data_components()).
+           *
            * @param [in] begin_particle An iterator to the first particle to be moved.
            * @param [in] end_particle An iterator to the last particle to be moved.
            * @param [in] old_velocities The velocities at t_n, i.e. before the
@@ -79,6 +188,41 @@ namespace aspect
                                const std::vector<Tensor<1,dim> > &velocities,
                                const double dt) = 0;
 
+          /**
+           * Return whether this integrator needs the velocity field of the
+           * whole cell instead of the velocities at the particle positions.
+           * If this function returns true, local_integrate_cell() is called
+           * instead of local_integrate_step(). The default implementation
+           * returns false.
+           */
+          virtual
+          bool
+          need_cell_velocity_field () const;
+
+          /**
+           * Perform an integration step of moving the particles of one cell
+           * by the specified timestep dt, using the velocity field
+           * @p velocity_field of the cell the particles are in at the
+           * beginning of the time step. This function is only called if
+           * need_cell_velocity_field() returns true, and has to be
+           * implemented by all integrators for which this is the case. The
+           * same thread-safety requirements as for local_integrate_step()
+           * apply.
+           *
+           * @param [in] begin_particle An iterator to the first particle to be moved.
+           * @param [in] end_particle An iterator to the last particle to be moved.
+           * @param [in,out] velocity_field The velocity field of the cell at the
+           * beginning and the end of the time step. Integrators may move it
+           * to other cells with CellVelocityField::move_to_point().
+           * @param [in] dt The length of the integration timestep.
+           */
+          virtual
+          void
+          local_integrate_cell(const typename ParticleHandler<dim>::particle_iterator &begin_particle,
+                               const typename ParticleHandler<dim>::particle_iterator &end_particle,
+                               CellVelocityField<dim> &velocity_field,
+                               const double dt);
+
           /**
            * This function is called at the end of every integration step.
            * In case of multi-step integrators it signals the beginning of a
@@ -91,6 +235,19 @@ namespace aspect
            */
           virtual bool new_integration_step();
 
+          /**
+           * Return the number of values this integrator needs to store for
+           * every particle between its integration substeps (e.g. the
+           * location at the beginning of the integration). The particle
+           * handler reserves this many values per particle next to the
+           * particle properties, where they can be accessed through
+           * ParticleAccessor::get_integrator_data(). Because this storage
+           * belongs to the particle, access to it is thread-safe and it
+           * does not need to be looked up by the particle id. The default
+           * implementation returns zero.
+           */
+          virtual unsigned int get_n_data_components() const;
+
           /**
            * Return data length of the integration related data required for
            * communication in terms of number of bytes. When data about
@@ -81,6 +81,15 @@ namespace aspect
            */
           virtual bool new_integration_step();
 
+          /**
+           * Return the number of values this integrator stores for every
+           * particle. This is the location before the first integration
+           * step, which is used in the second step and transferred to
+           * another process if the particle leaves the domain during the
+           * first step.
+           */
+          virtual unsigned int get_n_data_components() const;
+
           /**
            * Return data length of the integration related data required for
            * communication in terms of number of bytes. When data about
@@ -117,14 +126,6 @@ namespace aspect
            * 0 or 1.
            */
           unsigned int integrator_substep;
-
-          /**
-           * The particle location before the first integration step. This is
-           * used in the second step and transferred to another process if
-           * the particle leaves the domain during the first step.
-           */
-          std::map<types::particle_index, Point<dim> >   loc0;
-
       };
 
     }
@@ -81,6 +81,16 @@ namespace aspect
            */
           virtual bool new_integration_step();
 
+          /**
+           * Return the number of values this integrator stores for every
+           * particle. These are the location before the first integration
+           * step and the intermediate values k1, k2 and k3 of the RK4
+           * scheme, which are used in the following steps and transferred
+           * to another process if the particle leaves the domain during one
+           * of the steps.
+           */
+          virtual unsigned int get_n_data_components() const;
+
           /**
            * Return data length of the integration related data required for
            * communication in terms of number of bytes. When data about
@@ -117,21 +127,6 @@ namespace aspect
            * and 3.
            */
           unsigned int integrator_substep;
-
-          /**
-           * The particle location before the first integration step. This is
-           * used in the following steps and transferred to another process if
-           * the particle leaves the domain during one of the steps.
-           */
-          std::map<types::particle_index, Point<dim> > loc0;
-
-          /**
-           * The intermediate values of the RK4 scheme. These are
-           * used in the following steps and transferred to another process if
-           * the particle leaves the domain during one of the steps.
-           */
-          std::map<types::particle_index, Tensor<1,dim> > k1, k2, k3;
-
       };
     }
   }
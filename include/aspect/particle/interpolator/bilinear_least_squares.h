@@ -31,8 +31,8 @@ namespace aspect
     namespace Interpolator
     {
       /**
-       * Return the interpolated properties of all particles of the given cell using bilinear least squares method.
-       * Currently, only the two dimensional model is supported.
+       * Return the interpolated properties of all particles of the given cell using a bilinear
+       * (in 2D) or trilinear (in 3D) least squares method.
        *
        * @ingroup ParticleInterpolators
        */
@@ -68,6 +68,19 @@ namespace aspect
           parse_parameters (ParameterHandler &prm);
 
         private:
+          /**
+           * Evaluate the 2^dim basis functions of the least squares fit at
+           * @p position, and write them into @p basis_values. The basis
+           * functions are the products of the coordinates relative to
+           * @p expansion_point, scaled by @p cell_diameter.
+           */
+          static
+          void
+          evaluate_basis_functions(const Point<dim> &position,
+                                   const Point<dim> &expansion_point,
+                                   const double cell_diameter,
+                                   double *basis_values);
+
           /**
            * Variables related to a limiting scheme that prevents overshoot and
            * undershoot of interpolated particle properties based on global max
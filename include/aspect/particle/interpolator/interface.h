@@ -90,6 +90,12 @@ namespace aspect
            * will be filled with computed properties, all other components
            * are not filled (or filled with invalid values).
            *
+           * This function is called concurrently from several threads for
+           * different cells when the particle properties are interpolated to
+           * the compositional fields. Implementations must therefore not
+           * modify any data that is shared between calls, which is the reason
+           * why the function is declared const.
+           *
            * @param [in] particle_handler Reference to the particle handler
            * that allows accessing the particles in the domain.
            * @param [in] positions The vector of positions where the properties
@@ -25,6 +25,7 @@
 #include <aspect/simulator_access.h>
 
 #include <deal.II/base/data_out_base.h>
+#include <deal.II/base/thread_management.h>
 
 namespace aspect
 {
@@ -48,6 +49,12 @@ namespace aspect
            */
           HDF5Output();
 
+          /**
+           * Destructor. Makes sure that a file that may still be written in a
+           * background thread is finished before the object is destroyed.
+           */
+          ~HDF5Output();
+
           /**
            * Initialization function. This function is called once at the
            * beginning of the program after parse_parameters is run and after the
@@ -104,7 +111,85 @@ namespace aspect
           void
           load (std::istringstream &is);
 
+          /**
+           * Declare the parameters this class takes through input files.
+           */
+          static
+          void
+          declare_parameters (ParameterHandler &prm);
+
+          /**
+           * Read the parameters this class declares from the parameter file.
+           */
+          virtual
+          void
+          parse_parameters (ParameterHandler &prm);
+
         private:
+          /**
+           * A structure that holds all data of one output step that is
+           * written into a file by write_hdf5_file(), possibly on a
+           * background thread.
+           */
+          struct OutputBuffer
+          {
+            /**
+             * The name of the file to write.
+             */
+            std::string filename;
+
+            /**
+             * The number of particles this process writes, the position of
+             * its first particle in the datasets, and the total number of
+             * particles that are written.
+             */
+            types::particle_index n_local_particles;
+            types::particle_index local_particle_offset;
+            types::particle_index n_global_particles;
+
+            /**
+             * Positions (padded to three components) and ids of the
+             * particles.
+             */
+            std::vector<double> positions;
+            std::vector<types::particle_index> ids;
+
+            /**
+             * Names, number of components, and data of all property datasets,
+             * and whether the particles store the properties of a dataset in
+             * single precision, in which case the dataset is always written
+             * in single precision.
+             */
+            std::vector<std::string> property_names;
+            std::vector<unsigned int> property_components;
+            std::vector<std::vector<double> > properties;
+            std::vector<bool> property_single_precision;
+          };
+
+          /**
+           * Write the data in @p buffer into a new hdf5 file using the
+           * communicator @p communicator. The last three arguments are the
+           * chunk size, compression level and precision of the datasets. This
+           * function may run on a background thread.
+           */
+          static
+          void
+          write_hdf5_file (const OutputBuffer *buffer,
+                           const MPI_Comm communicator,
+                           const unsigned int chunk_size,
+                           const unsigned int compression_level,
+                           const bool write_single_precision);
+
+          /**
+           * Return whether the particle with the given @p id and
+           * @p location should be written, as selected by the subset
+           * parameters below.
+           */
+          bool
+          is_selected_for_output (const types::particle_index id,
+                                  const Point<dim> &location) const;
+
+
           /**
            * Internal index of file output number.
            */
@@ -115,6 +200,61 @@ namespace aspect
            * file).
            */
           std::vector<XDMFEntry> xdmf_entries;
+
+          /**
+           * Number of particles per chunk of the hdf5 datasets. A value of
+           * zero writes contiguous datasets.
+           */
+          unsigned int chunk_size;
+
+          /**
+           * Level of the deflate compression of the datasets, zero
+           * disables compression.
+           */
+          unsigned int compression_level;
+
+          /**
+           * Whether to store positions and properties as single precision
+           * floating point numbers.
+           */
+          bool write_single_precision;
+
+          /**
+           * Only particles whose id is a multiple of this number are written.
+           */
+          types::particle_index output_id_interval;
+
+          /**
+           * If not empty, only particles inside the box spanned by these two
+           * points are written.
+           */
+          std::vector<double> output_region_minimum;
+          std::vector<double> output_region_maximum;
+
+          /**
+           * Whether to write the files on a background thread while the
+           * computation continues. This requires a thread-safe build of the
+           * hdf5 library. In parallel computations it is switched off (with
+           * a warning) by initialize() if MPI does not provide
+           * MPI_THREAD_MULTIPLE thread support.
+           */
+          bool write_in_background_thread;
+
+          /**
+           * Handle to the thread that writes the data in the background, and
+           * the communicator it uses for its (collective) hdf5 operations.
+           */
+          Threads::Thread<void> background_thread;
+          MPI_Comm output_communicator;
+
+          /**
+           * Two buffers for the output data, so that the data of the next
+           * output step can be collected while the previous one is still
+           * being written. The second variable is the index of the buffer
+           * that is filled next.
+           */
+          OutputBuffer output_buffers[2];
+          unsigned int current_output_buffer;
       };
     }
   }
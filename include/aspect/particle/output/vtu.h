@@ -24,6 +24,8 @@
 #include <aspect/particle/output/interface.h>
 #include <aspect/simulator_access.h>
 
+#include <deal.II/base/thread_management.h>
+
 namespace aspect
 {
   namespace Particle
@@ -45,6 +47,12 @@ namespace aspect
            */
           VTUOutput();
 
+          /**
+           * Destructor. Makes sure that a file that may still be written in a
+           * background thread is finished before the object is destroyed.
+           */
+          ~VTUOutput();
+
           /**
            * Initialization function. This function is called once at the
            * beginning of the program after parse_parameters is run and after the
@@ -100,6 +108,20 @@ namespace aspect
           void
           load (std::istringstream &is);
 
+          /**
+           * Declare the parameters this class takes through input files.
+           */
+          static
+          void
+          declare_parameters (ParameterHandler &prm);
+
+          /**
+           * Read the parameters this class declares from the parameter file.
+           */
+          virtual
+          void
+          parse_parameters (ParameterHandler &prm);
+
         private:
           /**
            * Internal index of file output number.
@@ -122,6 +144,38 @@ namespace aspect
            * pair contains all files that together form a time step.
            */
           std::vector<std::pair<double,std::vector<std::string> > > times_and_vtu_file_names;
+
+          /**
+           * Whether to write the data arrays as raw binary data appended to
+           * the end of the file, instead of as ASCII text.
+           */
+          bool write_binary_output;
+
+          /**
+           * Whether to compress the binary data arrays with zlib.
+           */
+          bool compress_output;
+
+          /**
+           * Whether to convert all floating point data to single precision
+           * before writing binary output.
+           */
+          bool write_single_precision;
+
+          /**
+           * The temporary output location and whether to write in a
+           * background thread. Both are read from the `Postprocess/Particles'
+           * section, see the corresponding members of
+           * Postprocess::Particles for a description.
+           */
+          std::string temporary_output_location;
+          bool write_in_background_thread;
+
+          /**
+           * Handle to a thread that is used to write data in the background.
+           * Postprocess::Particles::writer() runs on this background thread.
+           */
+          Threads::Thread<void> background_thread;
       };
     }
   }
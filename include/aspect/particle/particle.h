@@ -261,7 +261,8 @@ namespace aspect
         set_properties (const std::vector<double> &new_properties);
 
         /**
-         * Get write-access to properties of this particle.
+         * Get write-access to properties of this particle. This is only
+         * possible if no particle property is stored in single precision.
          *
          * @return An ArrayView of the properties of this particle.
          */
@@ -269,13 +270,24 @@ namespace aspect
         get_properties ();
 
         /**
-         * Get read-access to properties of this particle.
+         * Get read-access to properties of this particle. This is only
+         * possible if no particle property is stored in single precision.
          *
          * @return An ArrayView of the properties of this particle.
          */
         const ArrayView<const double>
         get_properties () const;
 
+        /**
+         * Copy the properties of this particle into @p properties in double
+         * precision, independent of the precision in which they are stored.
+         *
+         * @param [out] properties A vector that is resized to the number of
+         * properties and filled with the properties of this particle.
+         */
+        void
+        get_properties (std::vector<double> &properties) const;
+
         /**
          * Returns the size in bytes this particle occupies if all of its data is
          * serialized (i.e. the number of bytes that is written by the write_data
@@ -354,9 +366,12 @@ namespace aspect
     template <class Archive>
     void Particle<dim,spacedim>::save (Archive &ar, const unsigned int) const
     {
-      unsigned int n_properties = 0;
+      // Properties are always archived in double precision
+      std::vector<double> particle_properties;
       if ((property_pool != NULL) && (properties != PropertyPool::invalid_handle))
-        n_properties = get_properties().size();
+        get_properties(particle_properties);
+
+      unsigned int n_properties = particle_properties.size();
 
       ar &location
       & reference_location
@@ -364,7 +379,7 @@ namespace aspect
       & n_properties;
 
       if (n_properties > 0)
-        ar &boost::serialization::make_array(properties, n_properties);
+        ar &boost::serialization::make_array(&particle_properties[0], n_properties);
 
     }
   }
@@ -23,6 +23,7 @@
 
 #include <aspect/global.h>
 #include <aspect/particle/particle.h>
+#include <aspect/particle/particle_container.h>
 
 #include <deal.II/base/array_view.h>
 #include <deal.II/distributed/tria.h>
@@ -56,6 +57,17 @@ namespace aspect
         void
         write_data(void *&data) const;
 
+        /**
+         * Write the id, the location, and the properties with the indices
+         * given in @p property_indices of this particle into the data array
+         * @p data and advance the pointer past the written data. This compact
+         * format is used to exchange ghost particles, see
+         * ParticleContainer::write_compact_data() for details.
+         */
+        void
+        write_compact_data(const std::vector<unsigned int> &property_indices,
+                           void *&data) const;
+
         /**
           * Set the location of this particle. Note that this does not check
           * whether this is a valid location in the simulation domain.
@@ -121,7 +133,8 @@ namespace aspect
         set_properties (const std::vector<double> &new_properties);
 
         /**
-         * Get write-access to properties of this particle.
+         * Get write-access to properties of this particle. This is only
+         * possible if no particle property is stored in single precision.
          *
          * @return An ArrayView of the properties of this particle.
          */
@@ -129,13 +142,50 @@ namespace aspect
         get_properties ();
 
         /**
-         * Get read-access to properties of this particle.
+         * Get read-access to properties of this particle. This is only
+         * possible if no particle property is stored in single precision.
          *
          * @return An ArrayView of the properties of this particle.
          */
         const ArrayView<const double>
         get_properties () const;
 
+        /**
+         * Copy the properties of this particle into @p properties in double
+         * precision, independent of the precision in which they are stored.
+         *
+         * @param [out] properties A vector that is resized to the number of
+         * properties and filled with the properties of this particle.
+         */
+        void
+        get_properties (std::vector<double> &properties) const;
+
+        /**
+         * Return the property with index @p property_index of this particle
+         * in double precision, independent of the precision in which it is
+         * stored.
+         */
+        double
+        get_property (const unsigned int property_index) const;
+
+        /**
+         * Get write-access to the data the particle integrator stores for
+         * this particle between its integration substeps.
+         *
+         * @return An ArrayView of the integrator data of this particle.
+         */
+        const ArrayView<double>
+        get_integrator_data ();
+
+        /**
+         * Get read-access to the data the particle integrator stores for
+         * this particle between its integration substeps.
+         *
+         * @return An ArrayView of the integrator data of this particle.
+         */
+        const ArrayView<const double>
+        get_integrator_data () const;
+
         /**
          * Returns the size in bytes this particle occupies if all of its data is
          * serialized (i.e. the number of bytes that is written by the write_data
@@ -186,25 +236,27 @@ namespace aspect
         ParticleAccessor ();
 
         /**
-         * Construct an accessor from a reference to a map and an iterator to the map.
+         * Construct an accessor from a reference to a particle container and
+         * an index into the container. If @p index does not point to a valid
+         * particle, the accessor is moved forward to the next valid particle.
          * This constructor is protected so that it can only be accessed by friend
          * classes.
          */
-        ParticleAccessor (const std::multimap<types::LevelInd, Particle<dim,spacedim> > &map,
-                          const typename std::multimap<types::LevelInd, Particle<dim,spacedim> >::iterator &particle);
+        ParticleAccessor (const ParticleContainer<dim,spacedim> &container,
+                          const typename ParticleContainer<dim,spacedim>::size_type index);
 
       private:
         /**
          * A pointer to the container that stores the particles. Obviously,
          * this accessor is invalidated if the container changes.
          */
-        std::multimap<types::LevelInd, Particle<dim,spacedim> >            *map;
+        ParticleContainer<dim,spacedim> *container;
 
         /**
-         * An iterator into the container of particles. Obviously,
-           * this accessor is invalidated if the container changes.
+         * The index of the particle in the container. Obviously,
+         * this accessor is invalidated if the container is compressed.
          */
-        typename std::multimap<types::LevelInd, Particle<dim,spacedim> >::iterator  particle;
+        typename ParticleContainer<dim,spacedim>::size_type index;
 
         /**
          * Make ParticleIterator a friend to allow it constructing ParticleAccessors.
@@ -0,0 +1,723 @@
+/*
+ Copyright (C) 2017 by the authors of the ASPECT code.
+
+ This file is part of ASPECT.
+
+ ASPECT is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2, or (at your option)
+ any later version.
+
+ ASPECT is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with ASPECT; see the file LICENSE.  If not see
+ <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _aspect_particle_particle_container_h
+#define _aspect_particle_particle_container_h
+
+#include <aspect/global.h>
+#include <aspect/particle/particle.h>
+#include <aspect/particle/property_pool.h>
+
+#include <deal.II/base/point.h>
+#include <deal.II/base/array_view.h>
+
+#include <map>
+#include <vector>
+
+namespace aspect
+{
+  namespace Particle
+  {
+    using namespace dealii;
+
+    /**
+     * This class stores a collection of particles (e.g. all locally owned or
+     * all ghost particles of a process) in a structure-of-arrays layout: The
+     * cells, locations, reference locations, ids and property handles of all
+     * particles are kept in separate contiguous arrays. The arrays consist of
+     * two parts: A sorted part, in which the particles are grouped by the
+     * level/index of the cell they are in, and an unsorted part at the end of
+     * the arrays, to which newly inserted particles are appended. A cell
+     * offset index allows to find the particles of a cell in the sorted part
+     * in $O(\log N_{cells})$ operations.
+     *
+     * Removing a particle only marks its slot as invalid. Invalid slots and
+     * the unsorted part are merged into the sorted part by calling compress(),
+     * which should be done after every operation that inserts or removes many
+     * particles. Indices into this container (and therefore all particle
+     * iterators that point into it) are stable as long as compress() or
+     * clear() is not called.
+     *
+     * @ingroup Particle
+     */
+    template <int dim, int spacedim=dim>
+    class ParticleContainer
+    {
+      public:
+        /**
+         * The type used for indices into the particle arrays.
+         */
+        typedef std::size_t size_type;
+
+        /**
+         * Constructor. Stores a pointer to the property pool that owns the
+         * properties of all particles in this container.
+         */
+        ParticleContainer (PropertyPool *property_pool = NULL);
+
+        /**
+         * Destructor. Releases the properties of all stored particles.
+         */
+        ~ParticleContainer ();
+
+        /**
+         * Set the property pool that is used to allocate the properties of
+         * all particles in this container. This is only allowed if the
+         * container is empty.
+         */
+        void
+        set_property_pool (PropertyPool &property_pool);
+
+        /**
+         * Return the property pool of this container.
+         */
+        PropertyPool &
+        get_property_pool () const;
+
+        /**
+         * Return the number of valid particles in this container.
+         */
+        size_type
+        n_particles () const;
+
+        /**
+         * Return the number of slots in the particle arrays, including the
+         * ones that are marked as removed. This is the index that is one past
+         * the last particle.
+         */
+        size_type
+        storage_size () const;
+
+        /**
+         * Return the number of particles in the cell @p cell, including
+         * particles that have not yet been sorted into the cell offset index.
+         */
+        unsigned int
+        n_particles_in_cell (const types::LevelInd &cell) const;
+
+        /**
+         * Return whether there are particles in cell @p cell that have been
+         * inserted since the last call to compress() and are therefore not
+         * yet part of the range returned by cell_range().
+         */
+        bool
+        has_unsorted_particles_in_cell (const types::LevelInd &cell) const;
+
+        /**
+         * Append the number of particles of every cell that contains
+         * particles to @p particles_per_cell. This only needs to look at the
+         * cell offset index and not at the particles themselves. A cell may
+         * appear twice if some of its particles have not been sorted yet.
+         */
+        void
+        get_particles_per_cell (std::vector<std::pair<types::LevelInd,unsigned int> > &particles_per_cell) const;
+
+        /**
+         * Return the range of indices [first, second) in which the particles
+         * of cell @p cell are stored. The range only contains particles that
+         * were in the container during the last call to compress(), and
+         * it can contain removed slots that need to be skipped.
+         */
+        std::pair<size_type,size_type>
+        cell_range (const types::LevelInd &cell) const;
+
+        /**
+         * Return the smallest index that is at least @p index and that
+         * contains a valid particle, or storage_size() if there is no such
+         * index.
+         */
+        size_type
+        next_valid_index (const size_type index) const;
+
+        /**
+         * Return the largest index that is smaller than @p index and that
+         * contains a valid particle, or storage_size() if there is no such
+         * index.
+         */
+        size_type
+        previous_valid_index (const size_type index) const;
+
+        /**
+         * Append a copy of @p particle in cell @p cell to the container,
+         * including its properties. Returns the index of the new particle.
+         */
+        size_type
+        insert (const types::LevelInd &cell,
+                const Particle<dim,spacedim> &particle);
+
+        /**
+         * Append a particle in cell @p cell to the container that is read
+         * from the data array @p data in the format written by write_data().
+         * The pointer @p data is advanced past the read particle. Returns the
+         * index of the new particle.
+         */
+        size_type
+        insert (const types::LevelInd &cell,
+                const void *&data);
+
+        /**
+         * Append a particle in cell @p cell to the container that is read
+         * from the data array @p data in the compact format written by
+         * write_compact_data() with the same @p property_indices. The
+         * reference location of the new particle and all of its properties
+         * that are not listed in @p property_indices are set to NaN. The
+         * pointer @p data is advanced past the read particle. Returns the
+         * index of the new particle.
+         */
+        size_type
+        insert_compact (const types::LevelInd &cell,
+                        const std::vector<unsigned int> &property_indices,
+                        const void *&data);
+
+        /**
+         * Move the particle at @p index into cell @p cell. If the particle
+         * is part of the sorted part of the container it is moved to the end
+         * of the container (without copying its properties) and its old slot
+         * is marked as removed. Returns the new index of the particle.
+         */
+        size_type
+        move_to_cell (const size_type index,
+                      const types::LevelInd &cell);
+
+        /**
+         * Remove the particle at @p index and release its properties. The
+         * slot is only marked as invalid, the memory is reclaimed during the
+         * next call to compress().
+         */
+        void
+        remove (const size_type index);
+
+        /**
+         * Remove all particles and release their properties.
+         */
+        void
+        clear ();
+
+        /**
+         * Reserve space for @p n_particles particles in the particle arrays.
+         */
+        void
+        reserve (const size_type n_particles);
+
+        /**
+         * Reclaim the space of all removed particles and sort all unsorted
+         * particles into the cell offset index. The relative order of the
+         * particles within each cell is preserved. This function is of
+         * $O(N + M \log M)$ complexity for $N$ sorted and $M$ unsorted
+         * particles and invalidates all indices into the container.
+         */
+        void
+        compress ();
+
+        /**
+         * Append the property handles of all particles in this container to
+         * @p handles, in the order in which the particles are stored.
+         */
+        void
+        get_property_handles (std::vector<PropertyPool::Handle> &handles) const;
+
+        /**
+         * Replace the property handles of all particles in this container, in
+         * the order in which the particles are stored, by the entries of
+         * @p handles starting at @p first_handle. This is the inverse
+         * operation of get_property_handles(), and it is used after the
+         * property pool moved the properties to new memory slots. Returns the
+         * position in @p handles after the last used entry.
+         */
+        std::size_t
+        set_property_handles (const std::vector<PropertyPool::Handle> &handles,
+                              const std::size_t first_handle);
+
+        /**
+         * Return whether the slot at @p index contains a valid particle.
+         */
+        bool
+        is_valid (const size_type index) const;
+
+        /**
+         * Return the cell of the particle at @p index.
+         */
+        const types::LevelInd &
+        get_cell (const size_type index) const;
+
+        /**
+         * Return the location of the particle at @p index.
+         */
+        const Point<spacedim> &
+        get_location (const size_type index) const;
+
+        /**
+         * Set the location of the particle at @p index.
+         */
+        void
+        set_location (const size_type index,
+                      const Point<spacedim> &new_location);
+
+        /**
+         * Return the reference location of the particle at @p index.
+         */
+        const Point<dim> &
+        get_reference_location (const size_type index) const;
+
+        /**
+         * Set the reference location of the particle at @p index.
+         */
+        void
+        set_reference_location (const size_type index,
+                                const Point<dim> &new_reference_location);
+
+        /**
+         * Return the id of the particle at @p index.
+         */
+        types::particle_index
+        get_id (const size_type index) const;
+
+        /**
+         * Return whether the particle at @p index has properties.
+         */
+        bool
+        has_properties (const size_type index) const;
+
+        /**
+         * Set the properties of the particle at @p index.
+         */
+        void
+        set_properties (const size_type index,
+                        const std::vector<double> &new_properties);
+
+        /**
+         * Return write-access to the properties of the particle at @p index.
+         * This is only possible if no property is stored in single
+         * precision, see PropertyPool::has_single_precision_properties().
+         */
+        const ArrayView<double>
+        get_properties (const size_type index);
+
+        /**
+         * Return read-access to the properties of the particle at @p index.
+         * This is only possible if no property is stored in single
+         * precision, see PropertyPool::has_single_precision_properties().
+         */
+        const ArrayView<const double>
+        get_properties (const size_type index) const;
+
+        /**
+         * Copy the properties of the particle at @p index into
+         * @p particle_properties in double precision, independent of the
+         * precision in which they are stored. The vector is resized to the
+         * number of properties.
+         */
+        void
+        get_properties (const size_type index,
+                        std::vector<double> &particle_properties) const;
+
+        /**
+         * Return the property with index @p property_index of the particle at
+         * @p index in double precision.
+         */
+        double
+        get_property (const size_type index,
+                      const unsigned int property_index) const;
+
+        /**
+         * Return write-access to the integrator data of the particle at
+         * @p index.
+         */
+        const ArrayView<double>
+        get_integrator_data (const size_type index);
+
+        /**
+         * Return read-access to the integrator data of the particle at
+         * @p index.
+         */
+        const ArrayView<const double>
+        get_integrator_data (const size_type index) const;
+
+        /**
+         * Write the data of the particle at @p index into the data array
+         * @p data in the same format as Particle::write_data(), and advance
+         * the pointer past the written data.
+         */
+        void
+        write_data (const size_type index,
+                    void *&data) const;
+
+        /**
+         * Return the number of bytes write_data() writes for the particle
+         * at @p index.
+         */
+        std::size_t
+        serialized_size_in_bytes (const size_type index) const;
+
+        /**
+         * Write the id, the location, and the properties with the indices
+         * given in @p property_indices of the particle at @p index into the
+         * data array @p data, and advance the pointer past the written data.
+         * In contrast to write_data() this format does not contain the
+         * reference location and all other properties, and is therefore
+         * only suited for particles that are not integrated or updated after
+         * the transfer, like ghost particles.
+         */
+        void
+        write_compact_data (const size_type index,
+                            const std::vector<unsigned int> &property_indices,
+                            void *&data) const;
+
+        /**
+         * Return the number of bytes write_compact_data() writes per particle
+         * if @p n_selected_properties properties are selected.
+         */
+        static
+        std::size_t
+        compact_size_in_bytes (const unsigned int n_selected_properties);
+
+      private:
+        /**
+         * A structure that stores which range of the sorted part of the
+         * particle arrays belongs to a cell, and how many valid particles
+         * are in this range.
+         */
+        struct CellRange
+        {
+          types::LevelInd cell;
+          size_type begin;
+          size_type end;
+          unsigned int n_particles;
+        };
+
+        /**
+         * Copying a container would require copying the properties of all
+         * particles. Disallow it.
+         */
+        ParticleContainer (const ParticleContainer<dim,spacedim> &);
+        ParticleContainer<dim,spacedim> &operator= (const ParticleContainer<dim,spacedim> &);
+
+        /**
+         * The value that marks a removed slot in the cells array.
+         */
+        static types::LevelInd invalid_cell ();
+
+        /**
+         * Return a pointer to the entry of the cell offset index that
+         * describes cell @p cell, or NULL if the cell has no entry.
+         */
+        const CellRange *
+        find_cell_range (const types::LevelInd &cell) const;
+
+        /**
+         * Decrease the particle count of cell @p cell by one, where the
+         * particle was stored at @p index.
+         */
+        void
+        decrease_particle_count (const size_type index,
+                                 const types::LevelInd &cell);
+
+        /**
+         * Append an empty slot to all particle arrays and return its index.
+         */
+        size_type
+        append_slot (const types::LevelInd &cell);
+
+        /**
+         * The property pool that owns the properties of the particles.
+         */
+        PropertyPool *property_pool;
+
+        /**
+         * The level/index of the cell of every particle. Removed slots are
+         * marked by invalid_cell().
+         */
+        std::vector<types::LevelInd> cells;
+
+        /**
+         * The location of every particle.
+         */
+        std::vector<Point<spacedim> > locations;
+
+        /**
+         * The reference location of every particle in its cell.
+         */
+        std::vector<Point<dim> > reference_locations;
+
+        /**
+         * The id of every particle.
+         */
+        std::vector<types::particle_index> ids;
+
+        /**
+         * The handle to the properties of every particle.
+         */
+        std::vector<PropertyPool::Handle> properties;
+
+        /**
+         * The cell offset index. Sorted by cell, it contains one entry
+         * for every cell that contains particles in the sorted part of the
+         * arrays.
+         */
+        std::vector<CellRange> cell_index;
+
+        /**
+         * The number of particles that have been inserted since the last call
+         * to compress(), sorted by cell.
+         */
+        std::map<types::LevelInd, unsigned int> n_unsorted_particles_per_cell;
+
+        /**
+         * The number of slots at the begin of the particle arrays that are
+         * described by the cell offset index.
+         */
+        size_type n_sorted_slots;
+
+        /**
+         * The number of slots that are marked as removed.
+         */
+        size_type n_removed_slots;
+    };
+
+    /* -------------------------- inline and template functions ---------------------- */
+
+    template <int dim, int spacedim>
+    inline
+    typename ParticleContainer<dim,spacedim>::size_type
+    ParticleContainer<dim,spacedim>::n_particles () const
+    {
+      return cells.size() - n_removed_slots;
+    }
+
+
+
+    template <int dim, int spacedim>
+    inline
+    typename ParticleContainer<dim,spacedim>::size_type
+    ParticleContainer<dim,spacedim>::storage_size () const
+    {
+      return cells.size();
+    }
+
+
+
+    template <int dim, int spacedim>
+    inline
+    types::LevelInd
+    ParticleContainer<dim,spacedim>::invalid_cell ()
+    {
+      return types::LevelInd(-1,-1);
+    }
+
+
+
+    template <int dim, int spacedim>
+    inline
+    bool
+    ParticleContainer<dim,spacedim>::is_valid (const size_type index) const
+    {
+      return (index < cells.size()) && (cells[index] != invalid_cell());
+    }
+
+
+
+    template <int dim, int spacedim>
+    inline
+    typename ParticleContainer<dim,spacedim>::size_type
+    ParticleContainer<dim,spacedim>::next_valid_index (const size_type index) const
+    {
+      size_type i = index;
+      while (i < cells.size() && cells[i] == invalid_cell())
+        ++i;
+      return i;
+    }
+
+
+
+    template <int dim, int spacedim>
+    inline
+    typename ParticleContainer<dim,spacedim>::size_type
+    ParticleContainer<dim,spacedim>::previous_valid_index (const size_type index) const
+    {
+      Assert (index <= cells.size(), ExcInternalError());
+
+      for (size_type i = index; i > 0; --i)
+        if (cells[i-1] != invalid_cell())
+          return i-1;
+
+      return cells.size();
+    }
+
+
+
+    template <int dim, int spacedim>
+    inline
+    const types::LevelInd &
+    ParticleContainer<dim,spacedim>::get_cell (const size_type index) const
+    {
+      Assert (is_valid(index), ExcInternalError());
+      return cells[index];
+    }
+
+
+
+    template <int dim, int spacedim>
+    inline
+    const Point<spacedim> &
+    ParticleContainer<dim,spacedim>::get_location (const size_type index) const
+    {
+      Assert (is_valid(index), ExcInternalError());
+      return locations[index];
+    }
+
+
+
+    template <int dim, int spacedim>
+    inline
+    void
+    ParticleContainer<dim,spacedim>::set_location (const size_type index,
+                                                   const Point<spacedim> &new_location)
+    {
+      Assert (is_valid(index), ExcInternalError());
+      locations[index] = new_location;
+    }
+
+
+
+    template <int dim, int spacedim>
+    inline
+    const Point<dim> &
+    ParticleContainer<dim,spacedim>::get_reference_location (const size_type index) const
+    {
+      Assert (is_valid(index), ExcInternalError());
+      return reference_locations[index];
+    }
+
+
+
+    template <int dim, int spacedim>
+    inline
+    void
+    ParticleContainer<dim,spacedim>::set_reference_location (const size_type index,
+                                                             const Point<dim> &new_reference_location)
+    {
+      Assert (is_valid(index), ExcInternalError());
+      reference_locations[index] = new_reference_location;
+    }
+
+
+
+    template <int dim, int spacedim>
+    inline
+    types::particle_index
+    ParticleContainer<dim,spacedim>::get_id (const size_type index) const
+    {
+      Assert (is_valid(index), ExcInternalError());
+      return ids[index];
+    }
+
+
+
+    template <int dim, int spacedim>
+    inline
+    bool
+    ParticleContainer<dim,spacedim>::has_properties (const size_type index) const
+    {
+      Assert (is_valid(index), ExcInternalError());
+      return (property_pool != NULL)
+             && (properties[index] != PropertyPool::invalid_handle);
+    }
+
+
+
+    template <int dim, int spacedim>
+    inline
+    const ArrayView<double>
+    ParticleContainer<dim,spacedim>::get_properties (const size_type index)
+    {
+      Assert (is_valid(index), ExcInternalError());
+      Assert (property_pool != NULL, ExcInternalError());
+      return property_pool->get_properties(properties[index]);
+    }
+
+
+
+    template <int dim, int spacedim>
+    inline
+    const ArrayView<const double>
+    ParticleContainer<dim,spacedim>::get_properties (const size_type index) const
+    {
+      Assert (is_valid(index), ExcInternalError());
+      Assert (property_pool != NULL, ExcInternalError());
+      return property_pool->get_properties(properties[index]);
+    }
+
+
+
+    template <int dim, int spacedim>
+    inline
+    void
+    ParticleContainer<dim,spacedim>::get_properties (const size_type index,
+                                                     std::vector<double> &particle_properties) const
+    {
+      Assert (is_valid(index), ExcInternalError());
+      Assert (property_pool != NULL, ExcInternalError());
+
+      particle_properties.resize(property_pool->n_properties_per_slot());
+      if (particle_properties.size() > 0)
+        property_pool->get_properties(properties[index],
+                                      ArrayView<double>(&particle_properties[0],particle_properties.size()));
+    }
+
+
+
+    template <int dim, int spacedim>
+    inline
+    double
+    ParticleContainer<dim,spacedim>::get_property (const size_type index,
+                                                   const unsigned int property_index) const
+    {
+      Assert (is_valid(index), ExcInternalError());
+      Assert (property_pool != NULL, ExcInternalError());
+      return property_pool->get_property(properties[index],property_index);
+    }
+
+
+
+    template <int dim, int spacedim>
+    inline
+    const ArrayView<double>
+    ParticleContainer<dim,spacedim>::get_integrator_data (const size_type index)
+    {
+      Assert (is_valid(index), ExcInternalError());
+      Assert (property_pool != NULL, ExcInternalError());
+      return property_pool->get_integrator_data(properties[index]);
+    }
+
+
+
+    template <int dim, int spacedim>
+    inline
+    const ArrayView<const double>
+    ParticleContainer<dim,spacedim>::get_integrator_data (const size_type index) const
+    {
+      Assert (is_valid(index), ExcInternalError());
+      Assert (property_pool != NULL, ExcInternalError());
+      return property_pool->get_integrator_data(properties[index]);
+    }
+  }
+}
+
+#endif
@@ -23,6 +23,7 @@
 
 #include <aspect/global.h>
 #include <aspect/particle/particle.h>
+#include <aspect/particle/particle_container.h>
 #include <aspect/particle/particle_accessor.h>
 #include <aspect/particle/particle_iterator.h>
 
@@ -30,11 +31,13 @@
 
 #include <deal.II/base/subscriptor.h>
 #include <deal.II/base/array_view.h>
+#include <deal.II/base/std_cxx11/array.h>
 #include <deal.II/base/smartpointer.h>
 #include <deal.II/fe/mapping.h>
 
 #include <boost/serialization/map.hpp>
 #include <boost/range/iterator_range.hpp>
+#include <boost/signals2/connection.hpp>
 
 #include <deal.II/base/std_cxx11/function.h>
 
@@ -78,11 +81,19 @@ namespace aspect
          * a given triangulation and MPI communicator. Pointers to the
          * triangulation and the communicator are stored inside of the particle
          *
+         * Every particle stores @p n_properties properties and
+         * @p n_integrator_data values that the particle integrator can use
+         * to store data between its integration substeps. If
+         * @p single_precision_properties is not empty, it determines for
+         * every property whether it is stored in single precision, see
+         * PropertyPool for details.
          */
         ParticleHandler(const parallel::distributed::Triangulation<dim,spacedim> &tria,
                         const Mapping<dim,spacedim> &mapping,
                         const MPI_Comm mpi_communicator,
-                        const unsigned int n_properties = 0);
+                        const unsigned int n_properties = 0,
+                        const unsigned int n_integrator_data = 0,
+                        const std::vector<bool> &single_precision_properties = std::vector<bool>());
 
         /**
          * Destructor.
@@ -97,7 +108,9 @@ namespace aspect
         void initialize(const parallel::distributed::Triangulation<dim,spacedim> &tria,
                         const Mapping<dim,spacedim> &mapping,
                         const MPI_Comm mpi_communicator,
-                        const unsigned int n_properties = 0);
+                        const unsigned int n_properties = 0,
+                        const unsigned int n_integrator_data = 0,
+                        const std::vector<bool> &single_precision_properties = std::vector<bool>());
 
         /**
          * Clear all particle related data.
@@ -105,9 +118,9 @@ namespace aspect
         void clear();
 
         /**
-         * Only clear particle data, but keep cache information about number
-         * of particles. This is useful during reorganization of particle data
-         * between processes.
+         * Only clear particle data (of locally owned and ghost particles),
+         * but keep cache information about number of particles. This is
+         * useful during reorganization of particle data between processes.
          */
         void clear_particles();
 
@@ -135,6 +148,14 @@ namespace aspect
          * Return a pair of particle iterators that mark the begin and end of
          * the particles in a particular cell. The last iterator is the first
          * particle that is no longer in the cell.
+         *
+         * If particles were inserted into this cell since the particle
+         * storage was last compressed, this function compresses the storage
+         * first, which invalidates all existing particle iterators.
+         * Because it may modify the particle storage, this function must
+         * not be called concurrently from several threads. Parallel loops
+         * over cells have to call compress_particle_storage() before they
+         * start and use the const version of this function instead.
          */
         particle_iterator_range
         particles_in_cell(const typename parallel::distributed::Triangulation<dim,spacedim>::active_cell_iterator &cell);
@@ -144,12 +165,19 @@ namespace aspect
          * Return a pair of particle iterators that mark the begin and end of
          * the particles in a particular cell. The last iterator is the first
          * particle that is no longer in the cell.
+         *
+         * In contrast to the non-const version, this function never modifies
+         * the particle storage. It throws an exception if particles were
+         * inserted into this cell since the storage was last compressed.
+         * All functions of this class that insert particles, except for
+         * insert_particle(), compress the storage before they return.
          */
         particle_iterator_range
         particles_in_cell(const typename parallel::distributed::Triangulation<dim,spacedim>::active_cell_iterator &cell) const;
 
         /**
-         * Remove a particle pointed to by the iterator.
+         * Remove a particle pointed to by the iterator. This only marks the
+         * particle as removed, all other particle iterators stay valid.
          */
         void
         remove_particle(const particle_iterator &particle);
@@ -157,8 +185,9 @@ namespace aspect
         /**
          * Insert a particle into the collection of particles. Return an iterator
          * to the new position of the particle. This function involves a copy of
-         * the particle and its properties. Note that this function is of $O(N \log N)$
-         * complexity for $N$ particles.
+         * the particle and its properties. The particle is appended to the
+         * particle storage in amortized constant time, and it is sorted into
+         * its cell the next time the storage is compressed.
          */
         particle_iterator
         insert_particle(const Particle<dim,spacedim> &particle,
@@ -167,11 +196,23 @@ namespace aspect
         /**
          * Insert a number of particle into the collection of particles.
          * This function involves a copy of the particles and their properties.
-         * Note that this function is of O(n_existing_particles + n_particles) complexity.
+         * Note that this function is of O(n_existing_particles + n_particles log n_particles)
+         * complexity.
          */
         void
         insert_particles(const std::multimap<types::LevelInd, Particle<dim,spacedim> > &particles);
 
+        /**
+         * Sort all particles that were inserted since the particle storage
+         * was last compressed into their cells, and release the slots of
+         * removed particles. Afterwards the const version of
+         * particles_in_cell() can be used for every cell. This function
+         * invalidates all existing particle iterators, and does nothing if
+         * the storage is already compressed.
+         */
+        void
+        compress_particle_storage();
+
         /**
          * This function allows to register three additional functions that are
          * called every time a particle is transferred to another process
@@ -239,6 +280,19 @@ namespace aspect
         unsigned int
         n_particles_in_cell(const typename Triangulation<dim,spacedim>::active_cell_iterator &cell) const;
 
+        /**
+         * Return a vector that contains the number of particles in every
+         * active cell of the triangulation, indexed by the
+         * active_cell_index() of the cell. The entries of locally owned
+         * and ghost cells are kept up to date whenever particles are
+         * inserted, removed, sorted into new cells or exchanged between
+         * processes, all other entries are zero. This allows looping over
+         * the particle numbers of all cells without looking at the
+         * particles.
+         */
+        const std::vector<unsigned int> &
+        get_n_particles_per_cell() const;
+
         /**
          * Returns a vector that contains a tensor for every vertex-cell
          * combination of the output of dealii::GridTools::vertex_to_cell_map()
@@ -257,6 +311,13 @@ namespace aspect
          * process and in its current cell, or deleted (if it could not find
          * its new process or cell).
          *
+         * Particles are first searched for in the cells around their old
+         * cell, then in all locally owned and ghost cells. Particles that are
+         * not found in either (e.g. because they moved across more than one
+         * cell in a time step) are sent to the process that owns their new
+         * location, which requires global communication and is therefore
+         * only done if at least one process has such particles.
+         *
          * TODO: Extend this to allow keeping particles on other processes
          * around (with an invalid cell).
          */
@@ -264,6 +325,19 @@ namespace aspect
         sort_particles_into_subdomains_and_cells();
 
 
+        /**
+         * Move the properties of all particles into one contiguous block of
+         * memory, in the order in which the locally owned particles (grouped
+         * by cell) followed by the ghost particles are stored. This removes the
+         * fragmentation of the property memory that results from particles
+         * being created, destroyed, and moved between processes, so that
+         * looping over the particles cell by cell accesses their properties
+         * sequentially. This function invalidates all references to
+         * particle properties, but not the particle iterators.
+         */
+        void
+        sort_property_memory();
+
         /**
          * Exchanges all particles that live in cells that are ghost cells to
          * other processes. Clears and re-populates the ghost_neighbors
@@ -272,6 +346,35 @@ namespace aspect
         void
         exchange_ghost_particles();
 
+        /**
+         * Restrict the data that is sent for ghost particles in
+         * exchange_ghost_particles() to the particle properties with the
+         * indices given in @p property_indices. Ghost particles are then
+         * transferred in a compact format that only contains their id,
+         * location and the selected properties, but neither their reference
+         * location, nor the remaining properties, nor the data of the
+         * additional store and load functions. The reference location and
+         * all properties that are not sent are set to NaN on the receiving
+         * process, and should therefore not be accessed for ghost particles.
+         * This is useful if ghost particles are only needed to interpolate a
+         * subset of the particle properties, and reduces the amount of
+         * communication accordingly.
+         */
+        void
+        set_ghost_property_indices(const std::vector<unsigned int> &property_indices);
+
+        /**
+         * Tell the particle handler that the geometry of the mesh changed
+         * without a change of the triangulation, e.g. because the mapping
+         * describes a deforming mesh. The particle handler caches the
+         * bounding boxes of all locally owned and ghost cells to quickly
+         * locate particles, and this function causes them to be recomputed
+         * before the next particle sorting. Changes of the triangulation
+         * itself (e.g. refinement) are detected automatically.
+         */
+        void
+        notify_mesh_deformation();
+
         /**
          * Serialize the contents of this class.
          */
@@ -304,14 +407,27 @@ namespace aspect
          * Set of particles currently in the local domain, organized by
          * the level/index of the cell they are in.
          */
-        std::multimap<types::LevelInd, Particle<dim,spacedim> > particles;
+        ParticleContainer<dim,spacedim> particles;
 
         /**
          * Set of particles currently in the ghost cells of the local domain,
          * organized by the level/index of the cell they are in. These
          * particles are marked read-only.
          */
-        std::multimap<types::LevelInd, Particle<dim,spacedim> > ghost_particles;
+        ParticleContainer<dim,spacedim> ghost_particles;
+
+        /**
+         * Whether ghost particles are exchanged in the compact format that
+         * only contains the properties listed in ghost_property_indices.
+         * See set_ghost_property_indices() for details.
+         */
+        bool compact_ghost_exchange;
+
+        /**
+         * The indices of the particle properties that are sent for ghost
+         * particles if compact_ghost_exchange is set.
+         */
+        std::vector<unsigned int> ghost_property_indices;
 
         /**
          * This variable stores how many particles are stored globally. It is
@@ -319,6 +435,13 @@ namespace aspect
          */
         types::particle_index global_number_of_particles;
 
+        /**
+         * The number of locally owned or ghost particles in every active
+         * cell, indexed by the active_cell_index() of the cell. See
+         * get_n_particles_per_cell().
+         */
+        std::vector<unsigned int> n_particles_per_cell;
+
         /**
          * The maximum number of particles per cell in the global domain. This
          * variable is important to store and load particle data during
@@ -387,12 +510,261 @@ namespace aspect
          */
         unsigned int data_offset;
 
+        /**
+         * Whether the particles of the current refinement are transferred
+         * through stored_particle_data instead of being attached to the
+         * cells of the triangulation. See register_store_callback_function().
+         */
+        bool transfer_particles_separately;
+
+        /**
+         * The serialized particles of all locally owned cells before the
+         * current refinement, and the size of one serialized particle.
+         */
+        std::vector<char> stored_particle_data;
+        std::size_t stored_particle_size;
+
+        /**
+         * A cell of the refined triangulation whose particles were stored
+         * by another process before the refinement, together with their
+         * number and their location in stored_particle_data of that
+         * process.
+         */
+        struct RemoteCellParticles
+        {
+          typename parallel::distributed::Triangulation<dim,spacedim>::cell_iterator cell;
+          typename parallel::distributed::Triangulation<dim,spacedim>::CellStatus status;
+          unsigned int n_particles;
+          unsigned long long offset;
+        };
+
+        /**
+         * All cells whose particles have to be requested from other
+         * processes after the current refinement, sorted by the process
+         * that stored them.
+         */
+        std::vector<std::vector<RemoteCellParticles> > remote_cell_particles;
+
+        /**
+         * Geometric information about a locally owned or ghost cell that is
+         * used to quickly decide whether a point can be inside the cell.
+         */
+        struct CellGeometry
+        {
+          /**
+           * The corners of an axis-parallel box that contains the mapped
+           * cell.
+           */
+          Point<spacedim> lower_corner;
+          Point<spacedim> upper_corner;
+
+          /**
+           * Whether the mapped cell is exactly the box above (with its
+           * vertices in the standard orientation). In this case the
+           * reference location of a point in the cell can be computed
+           * without the inverse mapping.
+           */
+          bool is_axis_parallel_box;
+        };
+
+        /**
+         * A map from every vertex to its adjacent cells, as computed by
+         * GridTools::vertex_to_cell_map(), and the directions from every
+         * vertex to the centers of these cells. Both only depend on the
+         * triangulation and are recomputed when it changes.
+         */
+        std::vector<std::set<active_cell_it> > vertex_to_cells;
+        std::vector<std::vector<Tensor<1,spacedim> > > vertex_to_cell_centers;
+
+        /**
+         * All locally owned and ghost cells, and their geometric information
+         * indexed by the active cell index. These depend on the triangulation
+         * and the mapping, and are recomputed when the triangulation changes
+         * or notify_mesh_deformation() is called.
+         */
+        std::vector<active_cell_it> local_cells;
+        std::vector<CellGeometry> cell_geometries;
+
+        /**
+         * A uniform grid of buckets that covers the bounding boxes of all
+         * locally owned and ghost cells, given by its lower corner, the
+         * width of a bucket in each direction and the number of buckets in
+         * each direction. Every bucket contains the indices into local_cells
+         * of all cells whose bounding box overlaps the bucket, in increasing
+         * order. find_local_cell_around_point() uses it to only test the
+         * few cells that can contain a point. The grid is recomputed
+         * together with cell_geometries.
+         */
+        Point<spacedim> bucket_grid_lower_corner;
+        Tensor<1,spacedim> bucket_width;
+        std_cxx11::array<unsigned int,spacedim> n_buckets;
+        std::vector<std::vector<unsigned int> > cell_buckets;
+
+        /**
+         * Whether the cached information above is up to date.
+         */
+        bool mesh_topology_is_cached;
+        bool mesh_geometry_is_cached;
+
+        /**
+         * The processes that own ghost cells of this process, i.e. the
+         * processes particles and ghost particles are exchanged with. This
+         * is the same order as used by get_subdomain_id_to_neighbor_map().
+         */
+        std::vector<types::subdomain_id> neighbors;
+
+        /**
+         * The amount of data (in bytes) that is sent to and received from
+         * every neighbor in the current particle exchange, and the offsets
+         * of the data of every neighbor in the send and receive buffers.
+         */
+        std::vector<unsigned int> n_send_data;
+        std::vector<unsigned int> n_recv_data;
+        std::vector<unsigned int> send_offsets;
+        std::vector<unsigned int> recv_offsets;
+
+        /**
+         * Buffers for the serialized particles that are sent to and received
+         * from neighbors. They are kept between particle exchanges to avoid
+         * reallocating them in every time step.
+         */
+        std::vector<char> send_buffer;
+        std::vector<char> recv_buffer;
+
+        /**
+         * Persistent MPI requests that exchange the entries of n_send_data
+         * and n_recv_data with all neighbors. They are created once for the
+         * current set of neighbors and only restarted for every exchange.
+         */
+        std::vector<MPI_Request> size_requests;
+
+        /**
+         * The MPI requests of the particle data of the current exchange.
+         */
+        std::vector<MPI_Request> data_requests;
+
+        /**
+         * Whether neighbors and size_requests are set up for the current
+         * triangulation, and whether a particle exchange was started with
+         * start_particle_exchange() and not yet finished.
+         */
+        bool neighbor_communication_is_set_up;
+        bool particle_exchange_in_progress;
+
+        /**
+         * The connection to the signal of the triangulation that is
+         * triggered whenever the triangulation changes.
+         */
+        boost::signals2::connection triangulation_listener;
+
+        /**
+         * Connect to the signals of the triangulation to invalidate the
+         * cached mesh information whenever the triangulation changes.
+         */
+        void
+        connect_to_triangulation_signals();
+
+        /**
+         * Mark all cached mesh information as outdated. This function is
+         * called whenever the triangulation changes.
+         */
+        void
+        invalidate_cached_mesh_information();
+
+        /**
+         * Recompute vertex_to_cells and vertex_to_cell_centers.
+         */
+        void
+        update_cached_mesh_topology();
+
+        /**
+         * Recompute local_cells, cell_geometries and the bucket grid.
+         */
+        void
+        update_cached_mesh_geometry();
+
+        /**
+         * Return the index of the bucket of the bucket grid that contains the
+         * coordinate @p coordinate in direction @p direction. Coordinates
+         * outside the grid are moved to the first or last bucket.
+         */
+        unsigned int
+        bucket_index(const double coordinate,
+                     const unsigned int direction) const;
+
+        /**
+         * Determine the neighbors of this process and create the persistent
+         * requests for exchanging the amount of particle data with them.
+         */
+        void
+        setup_neighbor_communication();
+
+        /**
+         * Free the persistent requests created by
+         * setup_neighbor_communication().
+         */
+        void
+        free_neighbor_communication();
+
+        /**
+         * Compute the reference location of @p location in the locally owned
+         * or ghost cell @p cell. Returns false if the location is not inside
+         * the cell. Points outside the bounding box of the cell are rejected
+         * without evaluating the mapping, and for axis-parallel box cells the
+         * reference location is computed directly. Only in the remaining
+         * cases the inverse mapping is evaluated, and a failure of the
+         * inverse mapping is treated as the point not being in the cell.
+         */
+        bool
+        compute_reference_location(const active_cell_it &cell,
+                                   const Point<spacedim> &location,
+                                   Point<dim> &reference_location) const;
+
+        /**
+         * Search all locally owned cells (and all ghost cells if
+         * @p include_ghost_cells is set) for the cell that contains
+         * @p location. Returns true and sets @p cell and
+         * @p reference_location if such a cell was found.
+         *
+         * Only the cells in the bucket of the bucket grid that contains
+         * @p location are tested. Their number does not depend on the
+         * number of local cells for reasonably graded meshes. Note that the
+         * reference location can only be computed without the inverse
+         * mapping for cells that are axis-parallel boxes and a mapping that
+         * maps such cells exactly (MappingCartesian or a mapping of degree
+         * one). For higher order mappings, e.g. the MappingQ(4) used for
+         * curved geometries, every candidate cell whose bounding box
+         * contains the point still requires a Newton iteration of the
+         * inverse mapping.
+         */
+        bool
+        find_local_cell_around_point(const Point<spacedim> &location,
+                                     const bool include_ghost_cells,
+                                     active_cell_it &cell,
+                                     Point<dim> &reference_location) const;
+
         /**
          * Calculates the number of particles in the global model domain.
          */
         void
         update_n_global_particles();
 
+        /**
+         * Recompute n_particles_per_cell from the cell offset index of the
+         * particle containers, e.g. after the triangulation changed. Unlike
+         * the incremental updates this does not need to look at every
+         * particle.
+         */
+        void
+        recompute_n_particles_per_cell();
+
+        /**
+         * Return the active cell index of the cell given by its level and
+         * index.
+         */
+        unsigned int
+        get_active_cell_index(const types::LevelInd &cell) const;
+
         /**
          * Calculates and stores the number of particles in the cell that
          * contains the most particles in the global model (stored in the
@@ -417,15 +789,16 @@ namespace aspect
          * Transfer particles that have crossed subdomain boundaries to other
          * processors.
          * All received particles and their new cells will be appended to the
-         * @p received_particles vector.
+         * @p received_particles container.
          *
          * @param [in] particles_to_send All particles that should be sent and
          * their new subdomain_ids are in this map.
          *
-         * @param [in,out] received_particles Vector that stores all received
-         * particles. Note that it is not required nor checked that the list
+         * @param [in,out] received_particles Container that stores all received
+         * particles. Note that it is not required nor checked that the container
          * is empty, received particles are simply attached to the end of
-         * the vector.
+         * the container. The caller is responsible for compressing the
+         * container afterwards.
          *
          * @param [in] new_cells_for_particles Optional vector of cell
          * iterators with the same structure as @p particles_to_send. If this
@@ -436,15 +809,77 @@ namespace aspect
          */
         void
         send_recv_particles(const std::vector<std::vector<particle_iterator> > &particles_to_send,
-                            std::multimap<types::LevelInd,Particle <dim> >     &received_particles,
+                            ParticleContainer<dim,spacedim>                    &received_particles,
                             const std::vector<std::vector<active_cell_it> >    &new_cells_for_particles = std::vector<std::vector<active_cell_it> > ());
 
+        /**
+         * Start a transfer of particles to the neighbors of this process.
+         * This function serializes all particles in @p particles_to_send
+         * into an internal buffer and starts the non-blocking communication
+         * of the data, but does not wait for it to finish. Since the data is
+         * copied, the particles can be modified or removed as soon as this
+         * function returns, and the caller can do other work while the data
+         * is in transit. Every call to this function has to be followed by a
+         * call to finish_particle_exchange() before the next exchange can be
+         * started. The first two arguments have the same meaning as for
+         * send_recv_particles(). If @p compact_format is set, the particles
+         * are sent in the compact format described in
+         * set_ghost_property_indices(), and the same value has to be given
+         * to the matching call of finish_particle_exchange().
+         */
+        void
+        start_particle_exchange(const std::vector<std::vector<particle_iterator> > &particles_to_send,
+                                const std::vector<std::vector<active_cell_it> >    &new_cells_for_particles = std::vector<std::vector<active_cell_it> > (),
+                                const bool                                          compact_format = false);
+
+        /**
+         * Wait for the particle transfer started by start_particle_exchange()
+         * to complete, and append all received particles to
+         * @p received_particles.
+         */
+        void
+        finish_particle_exchange(ParticleContainer<dim,spacedim> &received_particles,
+                                 const bool                       compact_format = false);
+
+        /**
+         * Transfer particles that are neither located in a locally owned nor
+         * in a ghost cell to the process that owns the cell they are
+         * located in. Since this process is not necessarily a neighbor of the
+         * current process, this function determines bounding boxes of the
+         * subdomains of all processes, asks the processes whose bounding box
+         * contains a particle whether they own the particle location, and
+         * sends every particle to the lowest ranked process that does. This
+         * function has to be called by all processes at the same time.
+         *
+         * @param [in] particles_to_send All particles that left the locally
+         * owned and ghost cells. The caller is responsible for removing these
+         * particles afterwards, both the ones that were sent and the ones for
+         * which no owning process was found.
+         *
+         * @param [in,out] received_particles Container that stores all
+         * received particles. Received particles are attached to the end of
+         * the container, the caller is responsible for compressing the
+         * container afterwards.
+         */
+        void
+        send_recv_particles_to_remote_processes(const std::vector<particle_iterator> &particles_to_send,
+                                                ParticleContainer<dim,spacedim>      &received_particles);
+
 
 
         /**
          * Callback function that should be called before every
          * refinement and when writing checkpoints.
          * Allows registering store_particles() in the triangulation.
+         *
+         * When writing checkpoints, the particles are attached to the
+         * triangulation, which requires the same amount of space for every
+         * cell. During refinement the particles are instead packed into a
+         * buffer of this process, and only their location in this buffer is
+         * attached to the cells. The particles are then requested from
+         * this process by the new owners of their cells in
+         * register_load_callback_function(), therefore the memory used for
+         * the transfer is proportional to the number of particles.
          */
         void
         register_store_callback_function(const bool serialization);
@@ -465,7 +900,7 @@ namespace aspect
         void
         store_particles(const typename parallel::distributed::Triangulation<dim,spacedim>::cell_iterator &cell,
                         const typename parallel::distributed::Triangulation<dim,spacedim>::CellStatus status,
-                        void *data) const;
+                        void *data);
 
         /**
          * Called by listener functions after a refinement step. The local map
@@ -476,6 +911,35 @@ namespace aspect
                        const typename parallel::distributed::Triangulation<dim,spacedim>::CellStatus status,
                        const void *data);
 
+        /**
+         * Append the serialized particles in @p particle_range to
+         * stored_particle_data and return their number.
+         */
+        unsigned int
+        pack_particles(const particle_iterator_range &particle_range);
+
+        /**
+         * Read @p n_particles particles from @p data, which is advanced past
+         * the read data, and insert them into the cell @p cell of the
+         * current triangulation, or into its children if @p status
+         * indicates that the cell was refined.
+         */
+        void
+        unpack_particles(const typename parallel::distributed::Triangulation<dim,spacedim>::cell_iterator &cell,
+                         const typename parallel::distributed::Triangulation<dim,spacedim>::CellStatus status,
+                         const unsigned int n_particles,
+                         const void *&data);
+
+        /**
+         * Request the particles of all cells in remote_cell_particles from
+         * the processes that stored them before the refinement, answer the
+         * requests of the other processes and insert the received
+         * particles. This function has to be called by all processes at
+         * the same time.
+         */
+        void
+        receive_remote_cell_particles();
+
         /**
          * Get a map between subdomain id and a contiguous
          * number from 0 to n_neighbors, which is interpreted as the neighbor index.
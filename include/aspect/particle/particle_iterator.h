@@ -45,10 +45,10 @@ namespace aspect
 
         /**
          * Constructor of the iterator. Takes a reference to the particle
-         * container, and an iterator the the cell-particle pair.
+         * container, and the index of the particle in the container.
          */
-        ParticleIterator (const std::multimap<types::LevelInd, Particle<dim,spacedim> > &map,
-                          const typename std::multimap<types::LevelInd, Particle<dim,spacedim> >::iterator &particle);
+        ParticleIterator (const ParticleContainer<dim,spacedim> &container,
+                          const typename ParticleContainer<dim,spacedim>::size_type index);
 
         /**
          * Dereferencing operator, returns a reference to an accessor. Usage is thus
@@ -334,6 +334,15 @@ namespace aspect
            * therefore derived plugins that do not require an update do not
            * need to implement this function.
            *
+           * This function is called concurrently from several threads for
+           * particles in different cells. Implementations must therefore only
+           * modify the @p particle_properties of the current particle, and
+           * only call functions of other objects that are thread-safe, such
+           * as the const member functions of the simulator. This is the
+           * reason why the function is declared const; plugins must not
+           * circumvent this with mutable member variables. In contrast,
+           * initialize_one_particle_property() is never called concurrently.
+           *
            * @param [in] data_position An unsigned integer that denotes which
            * component of the particle property vector is associated with the
            * current property. For properties that own several components it
@@ -562,6 +571,26 @@ namespace aspect
           const ParticlePropertyInformation &
           get_data_info() const;
 
+          /**
+           * Return a component mask that selects all particle property
+           * components whose plugin is initialized by interpolation
+           * (i.e. its late_initialization_mode() is
+           * aspect::Particle::Property::interpolate), and therefore reads
+           * the properties of surrounding particles when new particles are
+           * created.
+           */
+          ComponentMask
+          get_interpolated_late_initialization_components () const;
+
+          /**
+           * Return a vector that contains for every particle property
+           * component whether it should be stored in single precision, as
+           * selected by the `Single precision particle properties' input
+           * parameter.
+           */
+          const std::vector<bool> &
+          get_single_precision_components () const;
+
           /**
            * Get the position of the property specified by name in the property
            * vector of the particles.
@@ -638,6 +667,18 @@ namespace aspect
            * their association with property plugins and their storage pattern.
            */
           ParticlePropertyInformation property_information;
+
+          /**
+           * The names of all property fields that are stored in single
+           * precision, as read from the input file.
+           */
+          std::vector<std::string> single_precision_field_names;
+
+          /**
+           * For every property component whether it is stored in single
+           * precision. See get_single_precision_components().
+           */
+          std::vector<bool> single_precision_components;
       };
 
 
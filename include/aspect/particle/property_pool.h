@@ -25,6 +25,9 @@
 
 #include <deal.II/base/array_view.h>
 
+#include <list>
+#include <vector>
+
 namespace aspect
 {
   namespace Particle
@@ -37,6 +40,33 @@ namespace aspect
      * same amount it is more efficient to let this be handled by a central
      * manager that does not need to allocate/deallocate memory every time a
      * particle is constructed/destroyed.
+     *
+     * Every slot consists of n_properties_per_slot() doubles for the
+     * particle properties, followed by n_integrator_data_per_slot() doubles
+     * in which the particle integrator can store per-particle data between
+     * its integration substeps. Storing this data together with the
+     * properties means it moves with the particle through the particle
+     * storage without any additional bookkeeping.
+     *
+     * Individual properties can be stored in single precision to reduce
+     * the memory footprint of the particles. These properties are packed
+     * as floats behind the integrator data of every slot. Since the
+     * properties of a slot are then no longer a contiguous array of
+     * doubles, get_properties(const Handle) can only be used if all
+     * properties are stored in double precision. The functions
+     * get_properties(const Handle, const ArrayView<double> &) and
+     * set_properties() on the other hand work for every precision and
+     * convert between the stored precision and double precision, as do
+     * get_property() and set_property() for individual properties.
+     *
+     * The memory is organized in large chunks that are each divided into
+     * slots. Released slots are kept in a
+     * free list and are handed out again before a new chunk is allocated, so
+     * that allocating and deallocating a slot is of $O(1)$ complexity. The
+     * chunks are never moved, therefore handles stay valid until they are
+     * deallocated or sort_memory_slots() is called. Note that this class
+     * does not lock, and therefore must not be used to allocate or
+     * deallocate slots from multiple threads at the same time.
      */
     class PropertyPool
     {
@@ -54,9 +84,15 @@ namespace aspect
         static const Handle invalid_handle;
 
         /**
-         * Constructor. Stores the number of properties per reserved slot.
+         * Constructor. Stores the number of properties and the number of
+         * integrator data values per reserved slot. If
+         * @p single_precision_properties is not empty, it has to contain one
+         * entry per property that determines whether this property is stored
+         * in single precision.
          */
-        PropertyPool (const unsigned int n_properties_per_slot);
+        PropertyPool (const unsigned int n_properties_per_slot,
+                      const unsigned int n_integrator_data_per_slot = 0,
+                      const std::vector<bool> &single_precision_properties = std::vector<bool>());
 
         /**
          * Returns a new handle that allows accessing the reserved block
@@ -73,26 +109,213 @@ namespace aspect
 
         /**
          * Return an ArrayView to the properties that correspond to the given
-         * handle @p handle.
+         * handle @p handle. This function can only be used if no property is
+         * stored in single precision, see
+         * has_single_precision_properties().
          */
         ArrayView<double> get_properties (const Handle handle);
 
+        /**
+         * Copy the properties that correspond to the given handle
+         * @p handle into @p properties, which has to have
+         * n_properties_per_slot() entries. Properties that are stored in
+         * single precision are converted to double precision.
+         */
+        void get_properties (const Handle handle,
+                             const ArrayView<double> &properties) const;
+
+        /**
+         * Set the properties that correspond to the given handle @p handle
+         * to @p properties, which has to have n_properties_per_slot()
+         * entries. Properties that are stored in single precision are
+         * rounded to single precision.
+         */
+        void set_properties (const Handle handle,
+                             const ArrayView<const double> &properties);
+
+        /**
+         * Return the property with index @p property_index of the slot
+         * @p handle in double precision.
+         */
+        double get_property (const Handle handle,
+                             const unsigned int property_index) const;
+
+        /**
+         * Set the property with index @p property_index of the slot
+         * @p handle to @p value, rounded to the precision in which the
+         * property is stored.
+         */
+        void set_property (const Handle handle,
+                           const unsigned int property_index,
+                           const double value);
+
+        /**
+         * Copy the properties and the integrator data of the slot @p source
+         * into the slot @p destination without any conversion.
+         */
+        void copy_slot (const Handle source,
+                        const Handle destination) const;
+
+        /**
+         * Write the properties of the slot @p handle into the data array
+         * @p data in their stored precision, and advance the pointer past the
+         * written data. The written data is padded to a multiple of the size
+         * of a double, so that the data after it is properly aligned.
+         */
+        void write_properties (const Handle handle,
+                               void *&data) const;
+
+        /**
+         * Read the properties of the slot @p handle from the data array
+         * @p data in the format written by write_properties(), and advance
+         * the pointer past the read data.
+         */
+        void read_properties (const Handle handle,
+                              const void *&data);
+
+        /**
+         * Return the number of bytes write_properties() writes per slot.
+         */
+        std::size_t serialized_properties_size () const;
+
+        /**
+         * Return an ArrayView to the integrator data that corresponds to the
+         * given handle @p handle.
+         */
+        ArrayView<double> get_integrator_data (const Handle handle);
+
         /**
          * Reserves the dynamic memory needed for storing the properties of
-         * @p size particles.
+         * @p size particles. Slots that are already allocated count towards
+         * @p size, i.e. after calling this function @p size minus the number
+         * of currently allocated slots can be allocated without allocating
+         * new memory.
          */
         void reserve(const std::size_t size);
 
+        /**
+         * Move the properties of all allocated slots into one contiguous
+         * block of memory in the order given by @p handles, and replace every
+         * entry of @p handles by the new handle of its properties. All
+         * other handles that were previously returned by this object become
+         * invalid, therefore @p handles has to contain every slot that is
+         * currently allocated. This function can be used to arrange the
+         * properties in the same order in which the particles are traversed.
+         */
+        void sort_memory_slots (std::vector<Handle> &handles);
+
         /**
          * Returns how many properties are stored per slot in the pool.
          */
         unsigned int n_properties_per_slot() const;
 
+        /**
+         * Returns how many integrator data values are stored per slot in the
+         * pool.
+         */
+        unsigned int n_integrator_data_per_slot() const;
+
+        /**
+         * Returns whether the property with index @p property_index is
+         * stored in single precision.
+         */
+        bool is_single_precision(const unsigned int property_index) const;
+
+        /**
+         * Returns whether any property is stored in single precision.
+         */
+        bool has_single_precision_properties() const;
+
+        /**
+         * Returns the number of slots that are currently allocated.
+         */
+        std::size_t n_allocated_slots() const;
+
       private:
+        /**
+         * Allocate a new chunk of memory that can store @p n_slots slots,
+         * and make it the chunk from which new slots are taken. The unused
+         * slots of the previous chunk are added to the free list.
+         */
+        void allocate_chunk (const std::size_t n_slots);
+
         /**
          * The number of properties that are reserved per particle.
          */
         const unsigned int n_properties;
+
+        /**
+         * The number of integrator data values that are reserved per
+         * particle.
+         */
+        const unsigned int n_integrator_data;
+
+        /**
+         * Whether every property is stored in single precision.
+         */
+        std::vector<bool> single_precision;
+
+        /**
+         * The number of properties that are stored in double precision.
+         */
+        unsigned int n_double_properties;
+
+        /**
+         * The number of properties that are stored in single precision.
+         */
+        unsigned int n_float_properties;
+
+        /**
+         * For every property the position within its part of the slot, i.e.
+         * the index among the doubles at the beginning of the slot for
+         * properties stored in double precision, and the index among the
+         * floats at the end of the slot for properties stored in single
+         * precision.
+         */
+        std::vector<unsigned int> storage_index;
+
+        /**
+         * The total number of doubles in one slot, i.e. the space for the
+         * double precision properties, the integrator data, and the single
+         * precision properties.
+         */
+        unsigned int slot_size;
+
+        /**
+         * Return a pointer to the first single precision property of the slot
+         * @p handle.
+         */
+        float *float_data (const Handle handle) const;
+
+        /**
+         * The chunks of memory that contain the slots.
+         */
+        std::list<std::vector<double> > memory_chunks;
+
+        /**
+         * The next slot of the newest chunk that has never been handed out.
+         */
+        Handle next_unused_slot;
+
+        /**
+         * The end of the newest chunk.
+         */
+        Handle end_of_chunk;
+
+        /**
+         * Slots that have been deallocated and can be handed out again.
+         */
+        std::vector<Handle> free_slots;
+
+        /**
+         * The number of slots that are currently allocated.
+         */
+        std::size_t n_allocated;
+
+        /**
+         * The number of slots that fit into all chunks together.
+         */
+        std::size_t capacity;
     };
 
   }
@@ -39,6 +39,7 @@
 
 #include <deal.II/base/timer.h>
 #include <deal.II/base/array_view.h>
+#include <deal.II/base/table_handler.h>
 
 #include <boost/serialization/unique_ptr.hpp>
 
@@ -48,6 +49,60 @@ namespace aspect
   {
     using namespace dealii;
 
+    namespace internal
+    {
+      /**
+       * Scratch data that is used by the functions that work on the
+       * particles of one cell at a time (initialization, update and
+       * advection of particles). These functions are called through the
+       * WorkStream framework, which creates one copy of this object per
+       * thread and reuses it for all cells that thread works on. This
+       * avoids reallocating the temporary vectors for every cell.
+       */
+      template <int dim>
+      struct ParticleCellScratchData
+      {
+        /**
+         * The degrees of freedom of the current cell.
+         */
+        std::vector<types::global_dof_index> cell_dof_indices;
+
+        /**
+         * The current and old velocities at the particle positions.
+         */
+        std::vector<Tensor<1,dim> > velocities;
+        std::vector<Tensor<1,dim> > old_velocities;
+
+        /**
+         * The velocity field of the current cell, i.e. the current and old
+         * velocities at the support points of the velocity element.
+         */
+        Integrator::CellVelocityField<dim> cell_velocity_field;
+
+        /**
+         * The solution values and gradients at the particle positions.
+         */
+        std::vector<Vector<double> > values;
+        std::vector<std::vector<Tensor<1,dim> > > gradients;
+
+        /**
+         * The reference locations of the particles in the current cell.
+         */
+        std::vector<Point<dim> > positions;
+      };
+
+      /**
+       * Copy data for the cell-wise particle functions. All particle
+       * operations that are run through WorkStream only modify the
+       * particles of the cell they are working on, therefore there is
+       * nothing that needs to be copied into a global object and this
+       * structure is empty.
+       */
+      struct ParticleCellCopyData
+      {
+      };
+    }
+
     /**
      * This class manages the storage and handling of particles. It provides
      * interfaces to generate and store particles, functions to initialize,
@@ -107,6 +162,20 @@ namespace aspect
         const Interpolator::Interface<dim> &
         get_interpolator() const;
 
+        /**
+         * Return the index of the particle property that is interpolated
+         * to the compositional field with index @p compositional_field,
+         * which has to be advected with the particle method. This is either
+         * the property given by the `Mapped particle properties' parameter,
+         * or, if this parameter is empty, the property with the same index
+         * as the field has among all particle advected fields.
+         *
+         * @return The index of the first component of the property, plus
+         * the component of the property that is mapped to the field.
+         */
+        unsigned int
+        get_property_index_of_compositional_field (const unsigned int compositional_field) const;
+
         /**
          * Initialize the particle properties.
          */
@@ -165,6 +234,28 @@ namespace aspect
          */
         void update_particles();
 
+        /**
+         * Add statistics about the particle load balancing to
+         * @p statistics. This only adds columns if the particle weight is
+         * calibrated adaptively: the current particle weight and the ratio
+         * of the maximum to the average wall time per process spent on
+         * particles in the last time step.
+         */
+        void
+        write_load_balancing_statistics(TableHandler &statistics) const;
+
+        /**
+         * Add the wall time @p time that was spent on particles outside of
+         * this class, for example on interpolating particle properties to
+         * the compositional fields, to the particle time of the current time
+         * step. The adaptive particle weight is computed from the sum of this
+         * time and the time spent in advance_timestep(). Since this only
+         * updates a measurement, the function can be called through a const
+         * reference to the particle world.
+         */
+        void
+        add_external_particle_time(const double time) const;
+
         /**
          * Generate the selected particle output.
          */
@@ -289,9 +380,51 @@ namespace aspect
          * particle load balancing strategy 'repartition' is used. This value
          * determines how costly the computation of a single particle is compared
          * to the computation of a whole cell, which is arbitrarily defined
-         * to represent a cost of 1000.
+         * to represent a cost of 1000. If adaptive_particle_weight is set, this
+         * is only the initial value.
+         */
+        double particle_weight;
+
+        /**
+         * Whether the particle weight is recalibrated in every time step
+         * from the measured wall time spent on particles and on the rest of
+         * the time step, instead of staying at the value given in the input
+         * file.
+         */
+        bool adaptive_particle_weight;
+
+        /**
+         * Timers that measure the wall time spent in advance_timestep() and
+         * the wall time of the whole time step on this process. They are
+         * only used if adaptive_particle_weight is set.
+         */
+        Timer particle_timer;
+        Timer time_step_timer;
+
+        /**
+         * The wall time spent on particles outside of this class in the
+         * current time step, see add_external_particle_time().
+         */
+        mutable double external_particle_time;
+
+        /**
+         * The ratio of the maximum to the average wall time per process
+         * spent on particles in the last time step, or NaN if it has not
+         * been measured yet.
+         */
+        double particle_load_imbalance;
+
+        /**
+         * Compute a particle weight from the wall times measured in the last
+         * time step and update particle_weight and particle_load_imbalance.
+         * The particle weight is chosen such that the weight of a particle
+         * relative to the weight of a cell (1000) equals the measured cost
+         * of a particle relative to the measured cost of all field-based
+         * computations per cell. This function has to be called by all
+         * processes at the same time.
          */
-        unsigned int particle_weight;
+        void
+        update_adaptive_particle_weight();
 
         /**
          * Some particle interpolation algorithms require knowledge
@@ -302,6 +435,21 @@ namespace aspect
          */
         bool update_ghost_particles;
 
+        /**
+         * Whether ghost particles only carry the particle properties that
+         * are interpolated to compositional fields or used to initialize
+         * new particles by interpolation, instead of all properties. See
+         * get_ghost_property_indices().
+         */
+        bool exchange_interpolated_ghost_properties_only;
+
+        /**
+         * Whether to move the properties of all particles into one
+         * contiguous block of memory in the order of the cells after the
+         * particles have been sorted into their new cells.
+         */
+        bool sort_property_memory;
+
         /**
          * Get a map between subdomain id and the neighbor index. In other words
          * the returned map answers the question: Given a subdomain id, which
@@ -311,6 +459,16 @@ namespace aspect
         std::map<types::subdomain_id, unsigned int>
         get_subdomain_id_to_neighbor_map() const;
 
+        /**
+         * Return the indices of all particle properties that are read from
+         * ghost particles, i.e. the properties that are mapped to
+         * compositional fields advected with the particle method and the
+         * properties of plugins that initialize new particles by
+         * interpolating the properties of surrounding particles.
+         */
+        std::vector<unsigned int>
+        get_ghost_property_indices() const;
+
         /**
          * Apply the bounds for the maximum and minimum number of particles
          * per cell, if the appropriate @p particle_load_balancing strategy
@@ -343,25 +501,38 @@ namespace aspect
                                    const typename ParticleHandler<dim>::particle_iterator &end_particle);
 
         /**
-         * Update the particle properties of one cell.
+         * Update the particle properties of the particles in one cell.
+         * This function is called from update_particles() through the
+         * WorkStream framework and can therefore run concurrently for
+         * different cells.
          */
         void
         local_update_particles(const typename DoFHandler<dim>::active_cell_iterator &cell,
-                               const typename ParticleHandler<dim>::particle_iterator &begin_particle,
-                               const typename ParticleHandler<dim>::particle_iterator &end_particle);
+                               internal::ParticleCellScratchData<dim> &scratch,
+                               internal::ParticleCellCopyData &data);
 
         /**
          * Advect the particles of one cell. Performs only one step for
          * multi-step integrators. Needs to be called until integrator->continue()
          * evaluates to false. Particles that moved out of their old cell
-         * during this advection step are removed from the local multimap and
-         * stored in @p particles_out_of_cell for further treatment (sorting
-         * them into the new cell).
+         * during this advection step are sorted into their new cell
+         * afterwards by ParticleHandler::sort_particles_into_subdomains_and_cells().
+         * This function is called from advect_particles() through the
+         * WorkStream framework and can therefore run concurrently for
+         * different cells.
          */
         void
         local_advect_particles(const typename DoFHandler<dim>::active_cell_iterator &cell,
-                               const typename ParticleHandler<dim>::particle_iterator &begin_particle,
-                               const typename ParticleHandler<dim>::particle_iterator &end_particle);
+                               internal::ParticleCellScratchData<dim> &scratch,
+                               internal::ParticleCellCopyData &data);
+
+        /**
+         * The copier function for the cell-wise particle functions above.
+         * Since the particles of each cell are modified in place there is
+         * nothing to do here.
+         */
+        void
+        copy_local_particle_data(const internal::ParticleCellCopyData &data);
     };
 
     /* -------------------------- inline and template functions ---------------------- */
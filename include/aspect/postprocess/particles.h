@@ -206,6 +206,23 @@ namespace aspect
         void
         parse_parameters (ParameterHandler &prm);
 
+        /**
+         * A function that writes the text in the second argument to a file
+         * with the name given in the first argument. The function is run on a
+         * separate thread to allow computations to continue even though
+         * writing data is still continuing. The function takes over ownership
+         * of these arguments and deletes them at the end of its work.
+         *
+         * If the second argument is not empty, the file is first written
+         * to a temporary file in this directory and then moved to its final
+         * location. This function is also used by the particle output
+         * plugins that write their own file formats.
+         */
+        static
+        void writer (const std::string filename,
+                     const std::string temporary_filename,
+                     const std::string *file_contents);
+
       private:
         /**
          * The world holding the particles
@@ -233,6 +250,23 @@ namespace aspect
          */
         void set_last_output_time (const double current_time);
 
+        /**
+         * On large clusters it can be advantageous to first write the
+         * output to a temporary file on a local file system and later
+         * move this file to a network file system. If this variable is
+         * set to a non-empty string it will be interpreted as a temporary
+         * storage location.
+         */
+        std::string temporary_output_location;
+
+        /**
+         * File operations can potentially take a long time, blocking the
+         * progress of the rest of the model run. Setting this variable to
+         * 'true' moves this process into a background thread, while the
+         * rest of the model continues.
+         */
+        bool write_in_background_thread;
+
 #if DEAL_II_VERSION_GTE(9,0,0)
         /**
          * Consecutively counted number indicating the how-manyth time we will
@@ -285,41 +319,12 @@ namespace aspect
          */
         unsigned int group_files;
 
-        /**
-         * On large clusters it can be advantageous to first write the
-         * output to a temporary file on a local file system and later
-         * move this file to a network file system. If this variable is
-         * set to a non-empty string it will be interpreted as a temporary
-         * storage location.
-         */
-        std::string temporary_output_location;
-
-        /**
-         * File operations can potentially take a long time, blocking the
-         * progress of the rest of the model run. Setting this variable to
-         * 'true' moves this process into a background thread, while the
-         * rest of the model continues.
-         */
-        bool write_in_background_thread;
-
         /**
          * Handle to a thread that is used to write data in the background.
          * The writer() function runs on this background thread.
          */
         Threads::Thread<void> background_thread;
 
-        /**
-         * A function that writes the text in the second argument to a file
-         * with the name given in the first argument. The function is run on a
-         * separate thread to allow computations to continue even though
-         * writing data is still continuing. The function takes over ownership
-         * of these arguments and deletes them at the end of its work.
-         */
-        static
-        void writer (const std::string filename,
-                     const std::string temporary_filename,
-                     const std::string *file_contents);
-
         /**
          * Write the various master record files. The master files are used by
          * visualization programs to identify which of the output files in a
@@ -607,9 +607,11 @@ namespace aspect
       double solve_advection (const AdvectionField &advection_field);
 
       /**
-       * Interpolate a particular particle property to the solution field.
+       * Interpolate the particle properties that belong to the given
+       * compositional fields to the solution. All fields are
+       * interpolated in a single pass over the cells.
        */
-      void interpolate_particle_properties (const AdvectionField &advection_field);
+      void interpolate_particle_properties (const std::vector<unsigned int> &compositional_fields);
 
       /**
        * Solve the Stokes linear system.
@@ -25,6 +25,7 @@
 #include <aspect/global.h>
 
 #include <deal.II/base/std_cxx11/array.h>
+#include <deal.II/base/std_cxx11/shared_ptr.h>
 #include <deal.II/base/point.h>
 #include <deal.II/base/conditional_ostream.h>
 #include <deal.II/base/table_indices.h>
@@ -273,19 +274,143 @@ namespace aspect
      */
     bool fexists(const std::string &filename);
 
+    /**
+     * A class that reads files on process 0 of a communicator in background
+     * threads, without any communication. A later call to
+     * read_and_distribute_file_content() for one of these files with this
+     * object as argument then only waits for the thread to finish and
+     * distributes the content, instead of reading the file. This allows to
+     * overlap reading files that will be needed in the future (e.g. the next
+     * file of a time-dependent boundary condition) with computations.
+     *
+     * Objects of this class are meant to be owned by the plugin that knows
+     * which files it will need next. The object only keeps the files that
+     * were requested by the last call to prefetch(), and waits for all
+     * background threads to finish before a file is discarded and in its
+     * destructor, so that no thread outlives the memory it writes into.
+     */
+    class FilePrefetcher
+    {
+      public:
+        /**
+         * Constructor.
+         */
+        FilePrefetcher ();
+
+        /**
+         * Destructor. Waits for all background threads to finish.
+         */
+        ~FilePrefetcher ();
+
+        /**
+         * Start reading all existing files in @p filenames in background
+         * threads on process 0 of @p comm, unless they are already being read.
+         * Files that were prefetched earlier, but are not contained in
+         * @p filenames are discarded. On all other processes this function
+         * does nothing.
+         */
+        void
+        prefetch (const std::vector<std::string> &filenames,
+                  const MPI_Comm &comm);
+
+        /**
+         * If the file @p filename was prefetched and could be read, wait
+         * for the background thread to finish, move the content of the file
+         * into @p content and return true. Otherwise return false. In both
+         * cases the file is no longer stored in this object afterwards.
+         */
+        bool
+        take_content (const std::string &filename,
+                      std::string &content);
+
+        /**
+         * Discard all prefetched files, after waiting for their background
+         * threads to finish.
+         */
+        void
+        clear ();
+
+      private:
+        /**
+         * The content of a file that is read in the background. The
+         * structure is defined in the .cc file.
+         */
+        struct PrefetchedFile;
+
+        /**
+         * All files for which prefetch() was called, but that were not
+         * yet requested by take_content(). This object is only accessed
+         * from the thread that owns this object, the background threads only
+         * write into the PrefetchedFile they were given.
+         */
+        std::map<std::string, std_cxx11::shared_ptr<PrefetchedFile> > files;
+
+        /**
+         * Read the whole file file->filename into file->content, without
+         * any communication, and record in file->success whether reading
+         * was successful. This function is run in a background thread, and
+         * the object @p file has to stay alive until this thread was joined.
+         */
+        static
+        void
+        read_file_in_background (PrefetchedFile *file);
+
+        /**
+         * Objects of this class own running threads, and can therefore
+         * not be copied.
+         */
+        FilePrefetcher (const FilePrefetcher &);
+        FilePrefetcher &operator= (const FilePrefetcher &);
+    };
+
     /**
      * Reads the content of the ascii file @p filename on process 0 and
      * distributes the content by MPI_Bcast to all processes. The function
      * returns the content of the file on all processes.
      *
+     * The file size is broadcast once, and the content is then broadcast in
+     * chunks of fixed size, so that files larger than the range of the 'int'
+     * arguments of MPI functions can be read. Process 0 reads the next chunk
+     * on a separate thread while the current one is broadcast.
+     *
      * @param [in] filename The name of the ascii file to load.
      * @param [in] comm The MPI communicator in which the content is
      * distributed.
+     * @param [in] prefetcher If this is not a null pointer, and the file was
+     * prefetched by this object on process 0, the content read in the
+     * background is used instead of reading the file again.
      * @return A string which contains the data in @p filename.
      */
     std::string
     read_and_distribute_file_content(const std::string &filename,
-                                     const MPI_Comm &comm);
+                                     const MPI_Comm &comm,
+                                     FilePrefetcher *prefetcher = NULL);
+
+    /**
+     * Plugins that interpolate in time between a series of numbered data
+     * files, one every @p data_file_time_step, can use this function to
+     * predict which files they will load at the beginning of the next
+     * time step, assuming the time step size does not change. This uses the
+     * same logic the plugins use to determine the files when they update
+     * their data.
+     *
+     * @param [in] next_time_since_start The model time of the next time step
+     * minus the model time of the first data file.
+     * @param [in] data_file_time_step The time between two data files.
+     * @param [in] first_data_file_number The number of the first data file.
+     * @param [in] current_file_number The number of the older one of the
+     * two data files that are currently used.
+     * @param [in] decreasing_file_order Whether the file numbers decrease
+     * with increasing model time.
+     * @return The numbers of the files that will be loaded at the next time
+     * step. The vector is empty if no new files will be needed.
+     */
+    std::vector<int>
+    predict_next_data_file_numbers (const double next_time_since_start,
+                                    const double data_file_time_step,
+                                    const int first_data_file_number,
+                                    const int current_file_number,
+                                    const bool decreasing_file_order);
 
     /**
      * Creates a path as if created by the shell command "mkdir -p", therefore
@@ -484,6 +609,41 @@ namespace aspect
         load_file(const std::string &filename,
                   const MPI_Comm &communicator);
 
+        /**
+         * Loads a data text file like the function above, but only stores
+         * the data points that are necessary to interpolate the data within
+         * @p region, which contains the minimum and maximum coordinate in
+         * each direction (in the coordinates of the data file). All points
+         * within the region, the points directly adjacent to it, and one
+         * additional layer of points are stored. Requesting data outside
+         * of this region returns the value at the nearest stored point.
+         * The maximum component values are still computed from all data
+         * in the file. If @p prefetcher is not a null pointer, the content
+         * of the file that was read in the background by this object is
+         * used, if available.
+         *
+         * If the region of any process is bounded, only process 0 reads and
+         * parses the file, and sends every other process only the part of
+         * the data it stores. Otherwise, the whole file is distributed to
+         * and parsed on all processes.
+         */
+        void
+        load_file(const std::string &filename,
+                  const MPI_Comm &communicator,
+                  const std_cxx11::array<std::pair<double,double>,dim> &region,
+                  FilePrefetcher *prefetcher = NULL);
+
+        /**
+         * Loads the file that was read by the last call to one of the
+         * load_file() functions again, but only stores the data necessary to
+         * interpolate within @p region. This is useful if the region
+         * of interest changes, e.g. after the mesh was repartitioned. The
+         * function does nothing if no file was loaded before.
+         */
+        void
+        reload_file(const MPI_Comm &communicator,
+                    const std_cxx11::array<std::pair<double,double>,dim> &region);
+
         /**
          * Returns the computed data (velocity, temperature, etc. - according
          * to the used plugin) in Cartesian coordinates.
@@ -557,10 +717,17 @@ namespace aspect
         std::vector<double> maximum_component_value;
 
         /**
-         * The min and max of the coordinates in the data file.
+         * The min and max of the coordinates of the data that is stored.
          */
         std_cxx11::array<std::pair<double,double>,dim> grid_extent;
 
+        /**
+         * The min and max of the coordinates in the data file. This is
+         * only different from grid_extent if not the whole file is
+         * stored.
+         */
+        std_cxx11::array<std::pair<double,double>,dim> file_grid_extent;
+
         /**
          * Number of points in the data grid as specified in the data file.
          */
@@ -572,6 +739,11 @@ namespace aspect
          */
         const double scale_factor;
 
+        /**
+         * The name of the file that was loaded last.
+         */
+        std::string loaded_filename;
+
         /**
          * Computes the table indices of each entry in the input data file.
          * The index depends on dim, grid_dim and the number of components.
@@ -579,6 +751,25 @@ namespace aspect
         TableIndices<dim>
         compute_table_indices(const unsigned int i) const;
 
+        /**
+         * Parse the @p content of the data file @p filename. This reads the
+         * number of points, the number of components and the column names
+         * from the header, and updates the maximum component values. The
+         * values of the file are returned split into the vectors
+         * @p chunk_values, where @p chunk_offsets contains the index of the
+         * first value of each chunk, followed by the total number of values.
+         * The coordinates of the points in each direction are returned in
+         * @p file_coordinate_values, and @p equidistant_grid is set to
+         * whether they are equidistant.
+         */
+        void
+        parse_file_content(const std::string &content,
+                           const std::string &filename,
+                           std::vector<std::vector<double> > &chunk_values,
+                           std::vector<std::size_t> &chunk_offsets,
+                           std_cxx11::array<std::vector<double>,dim> &file_coordinate_values,
+                           bool &equidistant_grid);
+
     };
 
     /**
@@ -784,12 +975,50 @@ namespace aspect
         void
         end_time_dependence ();
 
+        /**
+         * Whether to only store the part of the data files that is needed
+         * to evaluate the data on the cells of the current process.
+         */
+        bool restrict_to_local_subdomain;
+
+        /**
+         * Returns the region (in the coordinates of the data files) in
+         * which the data of boundary @p boundary_id is needed on the current
+         * process. If restrict_to_local_subdomain is not set the region
+         * is unbounded.
+         */
+        std_cxx11::array<std::pair<double,double>,dim-1>
+        get_local_data_region (const types::boundary_id boundary_id) const;
+
+        /**
+         * Reload all currently used data files, only storing the data
+         * in the region needed by the current process. This function is
+         * connected to a signal that is triggered whenever the mesh was
+         * changed.
+         */
+        void
+        reload_data_for_local_subdomain ();
+
         /**
          * Create a filename out of the name template.
          */
         std::string
         create_filename (const int timestep,
                          const types::boundary_id boundary_id) const;
+
+        /**
+         * Reads the data files that will be needed in the next time step
+         * in the background.
+         */
+        FilePrefetcher file_prefetcher;
+
+        /**
+         * Predict which data files will be needed in the next time step,
+         * assuming the time step size does not change, and start reading
+         * them in the background if they are not loaded yet.
+         */
+        void
+        prefetch_data_files ();
     };
 
     /**
@@ -821,12 +1050,42 @@ namespace aspect
         get_data_component (const Point<dim>                    &position,
                             const unsigned int                   component) const;
 
+        /**
+         * Declare the parameters all derived classes take from input files.
+         */
+        static
+        void
+        declare_parameters (ParameterHandler  &prm,
+                            const std::string &default_directory,
+                            const std::string &default_filename);
+
+        /**
+         * Read the parameters from the parameter file.
+         */
+        void
+        parse_parameters (ParameterHandler &prm);
+
       protected:
         /**
          * Pointer to an object that reads and processes data we get from text
          * files.
          */
         std_cxx11::shared_ptr<aspect::Utilities::AsciiDataLookup<dim> > lookup;
+
+        /**
+         * Whether to only store the part of the data file that is needed
+         * to evaluate the data on the cells of the current process.
+         */
+        bool restrict_to_local_subdomain;
+
+        /**
+         * Load the data file, only storing the data in the region needed
+         * by the current process, and along the reference profile of the
+         * geometry model. This function is connected to a signal that is
+         * triggered whenever the mesh was changed.
+         */
+        void
+        load_data_for_local_subdomain ();
     };
 
     /**
@@ -27,6 +27,11 @@
 #include <deal.II/base/table.h>
 #include <fstream>
 #include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <boost/property_tree/xml_parser.hpp>
 #include <boost/property_tree/ptree.hpp>
@@ -101,6 +106,8 @@ namespace aspect
             rotation_matrix[1][1] = 1.0;
             rotation_matrix[2][2] = 1.0;
           }
+
+        inverse_rotation_matrix = transpose(rotation_matrix);
       }
 
       template <int dim>
@@ -142,14 +149,85 @@ namespace aspect
         return output.str();
       }
 
+      namespace
+      {
+        /**
+         * A string at the beginning of binary cache files, used to identify
+         * the file type and version of the format.
+         */
+        const char binary_cache_identifier[8] = {'A','G','P','M','L','B','C','1'};
+
+        /**
+         * The header of binary cache files. It is followed by the
+         * theta velocities and the phi velocities of all grid points.
+         */
+        struct BinaryCacheHeader
+        {
+          char identifier[8];
+          unsigned long long source_size;
+          long long source_modification_time;
+          unsigned int n_theta;
+          unsigned int n_phi;
+        };
+      }
+
       template <int dim>
       void
       GPlatesLookup<dim>::load_file(const std::string &filename,
-                                    const MPI_Comm &comm)
+                                    const MPI_Comm &comm,
+                                    const bool use_binary_cache,
+                                    Utilities::FilePrefetcher *prefetcher)
       {
+        const std::string cache_filename = filename + ".cache";
+
+        // Process 0 decides whether there is a valid cache file, i.e. one
+        // that was created from a gpml file of the same size and
+        // modification time as the current one.
+        int cache_is_valid = 0;
+        unsigned long long source_size = 0;
+        long long source_modification_time = 0;
+
+        if (use_binary_cache && Utilities::MPI::this_mpi_process(comm) == 0)
+          {
+            struct stat source_status;
+            if (stat(filename.c_str(), &source_status) == 0)
+              {
+                source_size = source_status.st_size;
+                source_modification_time = source_status.st_mtime;
+
+                std::ifstream cache_stream(cache_filename.c_str(), std::ios::in | std::ios::binary);
+                BinaryCacheHeader header;
+                if (cache_stream.read(reinterpret_cast<char *>(&header), sizeof(header)))
+                  cache_is_valid = (std::equal(binary_cache_identifier, binary_cache_identifier + 8, header.identifier)
+                                    && header.source_size == source_size
+                                    && header.source_modification_time == source_modification_time);
+              }
+          }
+
+        if (use_binary_cache)
+          MPI_Bcast(&cache_is_valid, 1, MPI_INT, 0, comm);
+
+        if (cache_is_valid)
+          {
+            parse_binary_cache_content(Utilities::read_and_distribute_file_content(cache_filename, comm, prefetcher));
+            return;
+          }
+
         // Read data from disk and distribute among processes
-        std::istringstream filecontent(
-          Utilities::read_and_distribute_file_content(filename, comm));
+        parse_gpml_content(Utilities::read_and_distribute_file_content(filename, comm, prefetcher));
+
+        // Failing to write the cache file (e.g. because the data
+        // directory is not writable) is not an error, it only means
+        // the gpml file will be parsed again the next time.
+        if (use_binary_cache && Utilities::MPI::this_mpi_process(comm) == 0)
+          write_binary_cache(cache_filename, source_size, source_modification_time);
+      }
+
+      template <int dim>
+      void
+      GPlatesLookup<dim>::parse_gpml_content(const std::string &content)
+      {
+        std::istringstream filecontent(content);
 
         boost::property_tree::ptree pt;
 
@@ -178,7 +256,8 @@ namespace aspect
          * velocity_values[0] is the table for the theta component, whereas
          * velocity_values[1] is the table for the phi component.
          */
-        Table<2,double> velocity_values[2] = {Table<2,double>(n_theta,n_phi), Table<2,double>(n_theta,n_phi)};
+        velocity_values[0].reinit(n_theta,n_phi);
+        velocity_values[1].reinit(n_theta,n_phi);
 
         std::string velos = pt.get<std::string>("gpml:FeatureCollection.gml:featureMember.gpml:VelocityField.gml:rangeSet.gml:DataBlock.gml:tupleList");
         std::stringstream in(velos, std::ios::in);
@@ -208,36 +287,83 @@ namespace aspect
             i++;
           }
 
-        // number of intervals in the direction of theta and phi
-        std_cxx11::array<unsigned int,2> table_intervals;
-        table_intervals[0] = n_theta - 1;
-        table_intervals[1] = n_phi - 1;
-
-        // Min and Max coordinates in data file
-        std_cxx11::array<std::pair<double,double>,2> grid_extent;
-
-        // min and max extent of the grid in the direction of theta and phi (whole spheres in GPlates)
-        // polar angle theta: from 0° to 180°(PI)
-        grid_extent[0].first = 0;
-        grid_extent[0].second = numbers::PI;
-        // azimuthal angle phi: from 0° to 360°(2*PI)
-        grid_extent[1].first = 0;
-        grid_extent[1].second = 2 * numbers::PI;
+        AssertThrow(i == n_points,
+                    ExcMessage (std::string("Number of read in points does not match number of points in file. File corrupted?")));
+      }
 
-        for (unsigned int i = 0; i < 2; i++)
+      template <int dim>
+      void
+      GPlatesLookup<dim>::parse_binary_cache_content(const std::string &content)
+      {
+        BinaryCacheHeader header;
+        AssertThrow(content.size() >= sizeof(header),
+                    ExcMessage("The binary cache file of a GPlates velocity file is corrupted. "
+                               "Please delete the file and restart the model."));
+        std::memcpy(&header, content.data(), sizeof(header));
+
+        const std::size_t n_values = static_cast<std::size_t>(header.n_theta) * header.n_phi;
+        AssertThrow(header.n_theta > 1 && header.n_phi > 1
+                    && content.size() == sizeof(header) + 2 * n_values * sizeof(double),
+                    ExcMessage("The binary cache file of a GPlates velocity file is corrupted. "
+                               "Please delete the file and restart the model."));
+
+        delta_theta =   numbers::PI / (header.n_theta-1);
+        delta_phi   = 2*numbers::PI / header.n_phi;
+
+        for (unsigned int c = 0; c < 2; ++c)
           {
-            velocities[i].reset(new Functions::InterpolatedUniformGridData<2> (grid_extent,
-                                                                               table_intervals,
-                                                                               velocity_values[i]));
+            velocity_values[c].reinit(header.n_theta,header.n_phi);
+            std::memcpy(&velocity_values[c][0][0],
+                        content.data() + sizeof(header) + c * n_values * sizeof(double),
+                        n_values * sizeof(double));
           }
+      }
 
-        AssertThrow(i == n_points,
-                    ExcMessage (std::string("Number of read in points does not match number of points in file. File corrupted?")));
+      template <int dim>
+      void
+      GPlatesLookup<dim>::write_binary_cache(const std::string &cache_filename,
+                                             const unsigned long long source_size,
+                                             const long long source_modification_time) const
+      {
+        BinaryCacheHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::copy(binary_cache_identifier, binary_cache_identifier + 8, header.identifier);
+        header.source_size = source_size;
+        header.source_modification_time = source_modification_time;
+        header.n_theta = velocity_values[0].size()[0];
+        header.n_phi = velocity_values[0].size()[1];
+
+        const std::size_t n_values = static_cast<std::size_t>(header.n_theta) * header.n_phi;
+
+        // Write into a temporary file first and move it to its final
+        // place afterwards, so that other runs never see incomplete files.
+        // The name of the temporary file contains the host name and the
+        // process id, so that concurrent runs that share the data directory
+        // (possibly on different machines) do not write into the same file.
+        const std::string tmp_filename = cache_filename + "."
+                                         + dealii::Utilities::System::get_hostname() + "."
+                                         + dealii::Utilities::int_to_string(getpid()) + ".tmp";
+        {
+          std::ofstream cache_stream(tmp_filename.c_str(), std::ios::out | std::ios::binary);
+          cache_stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+          for (unsigned int c = 0; c < 2; ++c)
+            cache_stream.write(reinterpret_cast<const char *>(&velocity_values[c][0][0]),
+                               n_values * sizeof(double));
+
+          if (!cache_stream)
+            {
+              std::remove(tmp_filename.c_str());
+              return;
+            }
+        }
+
+        if (std::rename(tmp_filename.c_str(), cache_filename.c_str()) != 0)
+          std::remove(tmp_filename.c_str());
       }
 
       template <int dim>
-      Tensor<1,dim>
-      GPlatesLookup<dim>::surface_velocity(const Point<dim> &position) const
+      std_cxx11::array<double,3>
+      GPlatesLookup<dim>::spherical_surface_position(const Point<dim> &position) const
       {
         const Point<3> internal_position ((dim == 2)
                                           ?
@@ -246,8 +372,21 @@ namespace aspect
                                           convert_tensor<dim,3>(position));
 
         // transform internal_position in spherical coordinates
-        std_cxx11::array<double,3> spherical_point =
-          Utilities::Coordinates::cartesian_to_spherical_coordinates(internal_position);
+        return Utilities::Coordinates::cartesian_to_spherical_coordinates(internal_position);
+      }
+
+      template <int dim>
+      Tensor<1,dim>
+      GPlatesLookup<dim>::surface_velocity(const Point<dim> &position) const
+      {
+        return surface_velocity(spherical_surface_position(position));
+      }
+
+      template <int dim>
+      Tensor<1,dim>
+      GPlatesLookup<dim>::surface_velocity(const std_cxx11::array<double,3> &position) const
+      {
+        std_cxx11::array<double,3> spherical_point = position;
 
         Tensor<1,dim> output_boundary_velocity;
         // Handle all points that are not close to the poles
@@ -294,17 +433,54 @@ namespace aspect
       }
 
       template <int dim>
-      Tensor<1,dim>
-      GPlatesLookup<dim>::cartesian_velocity_at_surface_point(const std_cxx11::array<double,3> &spherical_point) const
+      Tensor<1,2>
+      GPlatesLookup<dim>::interpolate_velocity(const double theta,
+                                               const double phi) const
       {
-        // Re-sort the components of the spherical position from [r,phi,theta] to [theta, phi]
-        const Point<2> lookup_coordinates(spherical_point[2],spherical_point[1]);
+        // This is a bilinear interpolation on a grid that covers the
+        // whole sphere, and that is equivalent to the one
+        // Functions::InterpolatedUniformGridData would compute for the
+        // extents [0,pi] and [0,2*pi]. Computing both velocity components
+        // together avoids computing the cell and weights twice.
+        const double coordinates[2] = {theta, phi};
+        const double extents[2] = {numbers::PI, 2 * numbers::PI};
+
+        unsigned int ix[2];
+        double p_unit[2];
+        for (unsigned int d = 0; d < 2; ++d)
+          {
+            const unsigned int n_subintervals = velocity_values[0].size()[d] - 1;
+            const double delta_x = extents[d] / n_subintervals;
+
+            if (coordinates[d] <= 0.0)
+              ix[d] = 0;
+            else if (coordinates[d] >= extents[d] - delta_x)
+              ix[d] = n_subintervals - 1;
+            else
+              ix[d] = static_cast<unsigned int>(coordinates[d] / delta_x);
+
+            p_unit[d] = std::max(std::min((coordinates[d] - ix[d] * delta_x) / delta_x, 1.), 0.);
+          }
+
+        Tensor<1,2> velocity;
+        for (unsigned int c = 0; c < 2; ++c)
+          {
+            const Table<2,double> &values = velocity_values[c];
+            velocity[c] = (((1-p_unit[0])*values[ix[0]][ix[1]] + p_unit[0]*values[ix[0]+1][ix[1]])*(1-p_unit[1]) +
+                           ((1-p_unit[0])*values[ix[0]][ix[1]+1] + p_unit[0]*values[ix[0]+1][ix[1]+1])*p_unit[1]);
+          }
 
-        // Main work, interpolate velocity at this point
-        Tensor<1,2> interpolated_velocity;
+        return velocity;
+      }
 
-        for (unsigned int i = 0; i < 2; i++)
-          interpolated_velocity[i] = velocities[i]->value(lookup_coordinates);
+      template <int dim>
+      Tensor<1,dim>
+      GPlatesLookup<dim>::cartesian_velocity_at_surface_point(const std_cxx11::array<double,3> &spherical_point) const
+      {
+        // Main work, interpolate velocity at this point. Note that the
+        // components of the spherical position are sorted as [r,phi,theta],
+        // the data as [theta, phi].
+        const Tensor<1,2> interpolated_velocity = interpolate_velocity(spherical_point[2],spherical_point[1]);
 
         // Transform interpolated_velocity in cartesian coordinates
         const Tensor<1,3> interpolated_velocity_in_cart = sphere_to_cart_velocity(interpolated_velocity,spherical_point);
@@ -313,7 +489,7 @@ namespace aspect
         // omitting the z-component of velocity (since the 2D model lies in the x-y plane).
         const Tensor<1,dim> output_boundary_velocity = (dim == 2)
                                                        ?
-                                                       convert_tensor<3,dim>(transpose(rotation_matrix) * interpolated_velocity_in_cart)
+                                                       convert_tensor<3,dim>(inverse_rotation_matrix * interpolated_velocity_in_cart)
                                                        :
                                                        convert_tensor<3,dim>(interpolated_velocity_in_cart);
 
@@ -338,11 +514,16 @@ namespace aspect
       {
         Tensor<1,3> velocity;
 
-        velocity[0] = std::cos(s_position[2]) * std::cos(s_position[1]) * s_velocities[0]
-                      - 1.0 * std::sin(s_position[1]) * s_velocities[1];
-        velocity[1] = std::cos(s_position[2]) * std::sin(s_position[1]) * s_velocities[0]
-                      + std::cos(s_position[1]) * s_velocities[1];
-        velocity[2] = -1.0 * std::sin(s_position[2]) * s_velocities[0];
+        const double cos_theta = std::cos(s_position[2]);
+        const double sin_theta = std::sin(s_position[2]);
+        const double cos_phi = std::cos(s_position[1]);
+        const double sin_phi = std::sin(s_position[1]);
+
+        velocity[0] = cos_theta * cos_phi * s_velocities[0]
+                      - 1.0 * sin_phi * s_velocities[1];
+        velocity[1] = cos_theta * sin_phi * s_velocities[0]
+                      + cos_phi * s_velocities[1];
+        velocity[2] = -1.0 * sin_theta * s_velocities[0];
 
         return velocity;
       }
@@ -537,6 +718,7 @@ namespace aspect
       point1("0.0,0.0"),
       point2("0.0,0.0"),
       lithosphere_thickness(0.0),
+      use_binary_cache(false),
       lookup(),
       old_lookup()
     {}
@@ -587,7 +769,7 @@ namespace aspect
 
       const std::string filename (create_filename (current_file_number));
       if (Utilities::fexists(filename))
-        lookup->load_file(filename,this->get_mpi_communicator());
+        lookup->load_file(filename,this->get_mpi_communicator(),use_binary_cache);
       else
         AssertThrow(false,
                     ExcMessage (std::string("GPlates data file <")
@@ -612,7 +794,8 @@ namespace aspect
           if (Utilities::fexists(filename))
             {
               lookup.swap(old_lookup);
-              lookup->load_file(filename,this->get_mpi_communicator());
+              lookup->load_file(filename,this->get_mpi_communicator(),use_binary_cache,
+                                &file_prefetcher);
             }
           else
             end_time_dependence ();
@@ -682,6 +865,38 @@ namespace aspect
                   ExcMessage (
                     "Error in set_current_time. Time_weight has to be in [0,1]"));
         }
+
+      if (time_dependent)
+        prefetch_data_files();
+    }
+
+
+    template <int dim>
+    void
+    GPlates<dim>::prefetch_data_files ()
+    {
+      const std::vector<int> file_numbers =
+        Utilities::predict_next_data_file_numbers (this->get_time() + this->get_timestep() - first_data_file_model_time,
+                                                   data_file_time_step,
+                                                   first_data_file_number,
+                                                   current_file_number,
+                                                   decreasing_file_order);
+
+      // If binary caching is enabled, load_file() reads the cache file
+      // instead of the gpml file if it is up to date. A cache file that
+      // turns out to be outdated is simply discarded by the next call to
+      // prefetch().
+      std::vector<std::string> filenames;
+      for (unsigned int i = 0; i < file_numbers.size(); ++i)
+        {
+          const std::string filename = create_filename (file_numbers[i]);
+          if (use_binary_cache && Utilities::fexists(filename + ".cache"))
+            filenames.push_back(filename + ".cache");
+          else
+            filenames.push_back(filename);
+        }
+
+      file_prefetcher.prefetch(filenames, this->get_mpi_communicator());
     }
 
     template <int dim>
@@ -699,7 +914,8 @@ namespace aspect
           if (Utilities::fexists(filename))
             {
               lookup.swap(old_lookup);
-              lookup->load_file(filename,this->get_mpi_communicator());
+              lookup->load_file(filename,this->get_mpi_communicator(),use_binary_cache,
+                                &file_prefetcher);
             }
 
           // If loading current_time_step failed, end time dependent part with old_file_number.
@@ -720,7 +936,8 @@ namespace aspect
       if (Utilities::fexists(filename))
         {
           lookup.swap(old_lookup);
-          lookup->load_file(filename,this->get_mpi_communicator());
+          lookup->load_file(filename,this->get_mpi_communicator(),use_binary_cache,
+                            &file_prefetcher);
         }
 
       // If next file does not exist, end time dependent part with current_time_step.
@@ -761,12 +978,16 @@ namespace aspect
 
       if ((this->get_time() - first_data_file_model_time >= 0.0) && (this->get_geometry_model().depth(position) <= lithosphere_thickness + magic_number))
         {
-          const Tensor<1,dim> data = lookup->surface_velocity(position);
+          // Both lookups use the same rotation, therefore the position
+          // only needs to be transformed once
+          const std_cxx11::array<double,3> spherical_position = lookup->spherical_surface_position(position);
+
+          const Tensor<1,dim> data = lookup->surface_velocity(spherical_position);
 
           if (!time_dependent)
             return data;
 
-          const Tensor<1,dim> old_data = old_lookup->surface_velocity(position);
+          const Tensor<1,dim> old_data = old_lookup->surface_velocity(spherical_position);
 
           return time_weight * data + (1 - time_weight) * old_data;
         }
@@ -838,6 +1059,15 @@ namespace aspect
                              Patterns::Double (0),
                              "Determines the depth of the lithosphere, so that the GPlates velocities can be applied at the sides of the model "
                              "as well as at the surface.");
+          prm.declare_entry ("Cache velocity files", "false",
+                             Patterns::Bool (),
+                             "Whether to convert each gpml velocity file into a binary file "
+                             "the first time it is read. The binary file is written next to the "
+                             "gpml file, with the additional ending `.cache', and is read instead "
+                             "of the gpml file in later model runs, which is much faster. If the "
+                             "gpml file was modified after the binary file was created, the "
+                             "binary file is recreated. If the data directory is not writable, "
+                             "the gpml files are read as usual.");
         }
         prm.leave_subsection();
       }
@@ -864,6 +1094,7 @@ namespace aspect
           point1                = prm.get ("Point one");
           point2                = prm.get ("Point two");
           lithosphere_thickness = prm.get_double ("Lithosphere thickness");
+          use_binary_cache      = prm.get_bool ("Cache velocity files");
 
           if (this->convert_output_to_years())
             {
@@ -56,9 +56,9 @@ namespace aspect
     {
       prm.enter_subsection("Initial composition model");
       {
-        Utilities::AsciiDataBase<dim>::declare_parameters(prm,
-                                                          "$ASPECT_SOURCE_DIR/data/initial-composition/ascii-data/test/",
-                                                          "box_2d.txt");
+        Utilities::AsciiDataInitial<dim>::declare_parameters(prm,
+                                                             "$ASPECT_SOURCE_DIR/data/initial-composition/ascii-data/test/",
+                                                             "box_2d.txt");
       }
       prm.leave_subsection();
     }
@@ -70,7 +70,7 @@ namespace aspect
     {
       prm.enter_subsection("Initial composition model");
       {
-        Utilities::AsciiDataBase<dim>::parse_parameters(prm);
+        Utilities::AsciiDataInitial<dim>::parse_parameters(prm);
       }
       prm.leave_subsection();
     }
@@ -54,9 +54,9 @@ namespace aspect
     {
       prm.enter_subsection ("Initial temperature model");
       {
-        Utilities::AsciiDataBase<dim>::declare_parameters(prm,
-                                                          "$ASPECT_SOURCE_DIR/data/initial-temperature/ascii-data/test/",
-                                                          "box_2d.txt");
+        Utilities::AsciiDataInitial<dim>::declare_parameters(prm,
+                                                             "$ASPECT_SOURCE_DIR/data/initial-temperature/ascii-data/test/",
+                                                             "box_2d.txt");
       }
       prm.leave_subsection();
     }
@@ -68,7 +68,7 @@ namespace aspect
     {
       prm.enter_subsection ("Initial temperature model");
       {
-        Utilities::AsciiDataBase<dim>::parse_parameters(prm);
+        Utilities::AsciiDataInitial<dim>::parse_parameters(prm);
       }
       prm.leave_subsection();
     }
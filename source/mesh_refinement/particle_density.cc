@@ -40,20 +40,20 @@ namespace aspect
       const Postprocess::Particles<dim> &particle_postprocessor =
         this->get_postprocess_manager().template get_matching_postprocessor<Postprocess::Particles<dim> >();
 
-      const Particle::ParticleHandler<dim> &particle_handler = particle_postprocessor.get_particle_world().get_particle_handler();
+      const std::vector<unsigned int> &n_particles_per_cell =
+        particle_postprocessor.get_particle_world().get_particle_handler().get_n_particles_per_cell();
 
-      unsigned int i = 0;
       typename DoFHandler<dim>::active_cell_iterator
       cell = this->get_dof_handler().begin_active(),
       endc = this->get_dof_handler().end();
-      for (; cell!=endc; ++cell,++i)
+      for (; cell!=endc; ++cell)
         if (cell->is_locally_owned())
           {
             // Note  that this refinement indicator will level out the number
             // of particles per cell, therefore creating fine cells in regions
             // of high particle density and coarse cells in low particle
             // density regions.
-            indicators(i) = static_cast<float>(particle_handler.n_particles_in_cell(cell));
+            indicators(cell->active_cell_index()) = static_cast<float>(n_particles_per_cell[cell->active_cell_index()]);
           }
       return;
     }
@@ -44,21 +44,29 @@ namespace aspect
             getline(in,temp);
           }
 
-        // Read data lines
+        // Read data lines. Only keep positions that can be in the local
+        // domain, the cells of all others would be searched in vain.
+        const std::pair<Point<dim>,Point<dim> > local_bounding_box = this->compute_local_bounding_box();
+
+        std::vector<std::pair<Point<dim>,types::particle_index> > local_positions;
         types::particle_index particle_index = 0;
         Point<dim> particle_position;
 
         while (in >> particle_position)
           {
-            // Try to add the particle. If it is not in this domain, do not
-            // worry about it and move on to next point.
-            try
-              {
-                particles.insert(this->generate_particle(particle_position,particle_index++));
-              }
-            catch (ExcParticlePointNotInDomain &)
-              {}
+            bool is_in_bounding_box = true;
+            for (unsigned int d=0; d<dim; ++d)
+              if ((particle_position[d] < local_bounding_box.first[d]) ||
+                  (particle_position[d] > local_bounding_box.second[d]))
+                is_in_bounding_box = false;
+
+            if (is_in_bounding_box)
+              local_positions.push_back(std::make_pair(particle_position,particle_index));
+
+            ++particle_index;
           }
+
+        this->generate_particles_at_positions(local_positions,particles);
       }
 
 
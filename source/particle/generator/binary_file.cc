@@ -0,0 +1,226 @@
+/*
+  Copyright (C) 2017 by the authors of the ASPECT code.
+
+ This file is part of ASPECT.
+
+ ASPECT is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2, or (at your option)
+ any later version.
+
+ ASPECT is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with ASPECT; see the file LICENSE.  If not see
+ <http://www.gnu.org/licenses/>.
+ */
+
+#include <aspect/particle/generator/binary_file.h>
+#include <aspect/utilities.h>
+
+#include <stdint.h>
+
+
+namespace aspect
+{
+  namespace Particle
+  {
+    namespace Generator
+    {
+      template <int dim>
+      void
+      BinaryFile<dim>::generate_particles(std::multimap<types::LevelInd, Particle<dim> > &particles)
+      {
+        const std::string filename = data_directory+data_filename;
+
+        // Every process reads the header and the list of blocks by itself
+        std::ifstream in(filename.c_str(), std::ios::binary);
+        AssertThrow (in,
+                     ExcMessage (std::string("Couldn't open particle data file <") + filename + ">."));
+
+        char file_identifier[8];
+        uint32_t file_dimension, n_blocks;
+        uint64_t n_particles;
+        in.read(file_identifier, sizeof(file_identifier));
+        in.read(reinterpret_cast<char *>(&file_dimension), sizeof(file_dimension));
+        in.read(reinterpret_cast<char *>(&n_blocks), sizeof(n_blocks));
+        in.read(reinterpret_cast<char *>(&n_particles), sizeof(n_particles));
+
+        AssertThrow (in && (std::string(file_identifier, sizeof(file_identifier)) == "ASPECTPB"),
+                     ExcMessage ("The file <" + filename + "> is not a binary particle file."));
+        AssertThrow (file_dimension == dim,
+                     ExcMessage ("The binary particle file <" + filename + "> contains positions in "
+                                 + Utilities::int_to_string(file_dimension) + " dimensions, but the model "
+                                 "is computed in " + Utilities::int_to_string(dim) + " dimensions."));
+
+        std::vector<double> block_bounds(2 * dim * n_blocks);
+        std::vector<uint64_t> block_particles(2 * n_blocks);
+        for (unsigned int block = 0; block < n_blocks; ++block)
+          {
+            in.read(reinterpret_cast<char *>(&block_bounds[2*dim*block]), 2 * dim * sizeof(double));
+            in.read(reinterpret_cast<char *>(&block_particles[2*block]), 2 * sizeof(uint64_t));
+          }
+        AssertThrow (in,
+                     ExcMessage ("The list of blocks in the binary particle file <" + filename + "> is incomplete."));
+
+        const std::streampos data_begin = in.tellg();
+
+        // Only read the blocks that overlap with the local domain, and only
+        // keep positions that can be in the local domain
+        const std::pair<Point<dim>,Point<dim> > local_bounding_box = this->compute_local_bounding_box();
+
+        std::vector<std::pair<Point<dim>,types::particle_index> > local_positions;
+        std::vector<double> block_positions;
+        for (unsigned int block = 0; block < n_blocks; ++block)
+          {
+            bool block_overlaps_domain = true;
+            for (unsigned int d=0; d<dim; ++d)
+              if ((block_bounds[2*dim*block+dim+d] < local_bounding_box.first[d]) ||
+                  (block_bounds[2*dim*block+d] > local_bounding_box.second[d]))
+                block_overlaps_domain = false;
+
+            if (!block_overlaps_domain)
+              continue;
+
+            const uint64_t first_particle = block_particles[2*block];
+            const uint64_t n_block_particles = block_particles[2*block+1];
+            AssertThrow (first_particle + n_block_particles <= n_particles,
+                         ExcMessage ("A block in the binary particle file <" + filename
+                                     + "> contains particles beyond the end of the file."));
+
+            block_positions.resize(dim * n_block_particles);
+            if (n_block_particles > 0)
+              {
+                in.seekg(data_begin + static_cast<std::streamoff>(dim * first_particle * sizeof(double)));
+                in.read(reinterpret_cast<char *>(&block_positions[0]), dim * n_block_particles * sizeof(double));
+                AssertThrow (in,
+                             ExcMessage ("Reading the particle positions from the binary particle file <"
+                                         + filename + "> failed. File corrupted?"));
+              }
+
+            for (uint64_t i = 0; i < n_block_particles; ++i)
+              {
+                Point<dim> particle_position;
+                bool is_in_bounding_box = true;
+                for (unsigned int d=0; d<dim; ++d)
+                  {
+                    particle_position[d] = block_positions[dim*i+d];
+                    if ((particle_position[d] < local_bounding_box.first[d]) ||
+                        (particle_position[d] > local_bounding_box.second[d]))
+                      is_in_bounding_box = false;
+                  }
+
+                if (is_in_bounding_box)
+                  local_positions.push_back(std::make_pair(particle_position,
+                                                           static_cast<types::particle_index>(first_particle + i)));
+              }
+          }
+
+        this->generate_particles_at_positions(local_positions,particles);
+      }
+
+
+      template <int dim>
+      void
+      BinaryFile<dim>::declare_parameters (ParameterHandler &prm)
+      {
+        prm.enter_subsection("Postprocess");
+        {
+          prm.enter_subsection("Particles");
+          {
+            prm.enter_subsection("Generator");
+            {
+              prm.enter_subsection("Binary file");
+              {
+                prm.declare_entry ("Data directory",
+                                   "$ASPECT_SOURCE_DIR/data/particle/generator/binary/",
+                                   Patterns::DirectoryName (),
+                                   "The name of a directory that contains the particle data. This path "
+                                   "may either be absolute (if starting with a '/') or relative to "
+                                   "the current directory. The path may also include the special "
+                                   "text '$ASPECT_SOURCE_DIR' which will be interpreted as the path "
+                                   "in which the ASPECT source files were located when ASPECT was "
+                                   "compiled. This interpretation allows, for example, to reference "
+                                   "files located in the `data/' subdirectory of ASPECT. ");
+                prm.declare_entry ("Data file name", "particle.bin",
+                                   Patterns::Anything (),
+                                   "The name of the particle file.");
+              }
+              prm.leave_subsection();
+            }
+            prm.leave_subsection();
+          }
+          prm.leave_subsection();
+        }
+        prm.leave_subsection();
+      }
+
+
+      template <int dim>
+      void
+      BinaryFile<dim>::parse_parameters (ParameterHandler &prm)
+      {
+        prm.enter_subsection("Postprocess");
+        {
+          prm.enter_subsection("Particles");
+          {
+            prm.enter_subsection("Generator");
+            {
+              prm.enter_subsection("Binary file");
+              {
+                data_directory = Utilities::expand_ASPECT_SOURCE_DIR(prm.get ("Data directory"));
+
+                data_filename    = prm.get ("Data file name");
+              }
+              prm.leave_subsection();
+            }
+            prm.leave_subsection();
+          }
+          prm.leave_subsection();
+        }
+        prm.leave_subsection();
+      }
+    }
+  }
+}
+
+
+// explicit instantiations
+namespace aspect
+{
+  namespace Particle
+  {
+    namespace Generator
+    {
+      ASPECT_REGISTER_PARTICLE_GENERATOR(BinaryFile,
+                                         "binary file",
+                                         "Generates a distribution of particles from coordinates "
+                                         "specified in a binary data file. Contrary to the "
+                                         "`ascii file' generator, every process reads only the "
+                                         "parts of the file that overlap with its part of the "
+                                         "domain, which makes this generator suitable for very "
+                                         "large numbers of particles. All numbers are stored in "
+                                         "the byte order of the machine. The file starts with the "
+                                         "8 characters `ASPECTPB', followed by the number of "
+                                         "spatial dimensions and the number of blocks (both "
+                                         "32 bit unsigned integers) and the total number of "
+                                         "particles (64 bit unsigned integer). Then follows for "
+                                         "every block the lower and upper corner of the bounding "
+                                         "box of its particles (dim double precision numbers "
+                                         "each), the index of its first particle and its number "
+                                         "of particles (64 bit unsigned integers). The rest of "
+                                         "the file contains the coordinates of all particles as "
+                                         "double precision numbers, ordered by particle index. "
+                                         "The particles of every block need to be stored "
+                                         "consecutively, and the index of a particle in the file "
+                                         "becomes its id. "
+                                         "All of the values that define this generator are read "
+                                         "from a section ``Particle generator/Binary file'' in the "
+                                         "input file, see "
+                                         "Section~\\ref{parameters:Particle_20generator/Binary_20file}.")
+    }
+  }
+}
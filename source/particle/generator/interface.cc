@@ -22,6 +22,8 @@
 
 #include <deal.II/base/std_cxx1x/tuple.h>
 #include <deal.II/grid/grid_tools.h>
+#include <deal.II/base/multithread_info.h>
+#include <deal.II/base/thread_management.h>
 
 #include <boost/lexical_cast.hpp>
 
@@ -88,6 +90,69 @@ namespace aspect
         // will be used to generate random particle locations.
         boost::uniform_01<double> uniform_distribution_01;
 
+        // Generate random points in the bounding box of the cell until one
+        // is within the cell
+        unsigned int iteration = 0;
+        const unsigned int maximum_iterations = 100;
+        double random_numbers[dim];
+        std::pair<types::LevelInd,Particle<dim> > particle;
+        while (iteration < maximum_iterations)
+          {
+            for (unsigned int d=0; d<dim; ++d)
+              random_numbers[d] = uniform_distribution_01(random_number_generator);
+
+            if (try_generate_particle(cell,id,random_numbers,particle))
+              return particle;
+
+            iteration++;
+          }
+
+        const std::pair<Point<dim>,Point<dim> > bounds = get_cell_bounds(cell);
+        AssertThrow (iteration < maximum_iterations,
+                     ExcMessage ("Couldn't generate particle (unusual cell shape?). "
+                                 "The ratio between the bounding box volume in which the particle is "
+                                 "generated and the actual cell volume is approximately: " +
+                                 boost::lexical_cast<std::string>(cell->measure() / (bounds.second-bounds.first).norm_square())));
+
+        return std::make_pair(types::LevelInd(),Particle<dim>());
+      }
+
+      template <int dim>
+      bool
+      Interface<dim>::try_generate_particle (const typename parallel::distributed::Triangulation<dim>::active_cell_iterator &cell,
+                                             const types::particle_index id,
+                                             const double *random_numbers,
+                                             std::pair<types::LevelInd,Particle<dim> > &particle) const
+      {
+        const std::pair<Point<dim>,Point<dim> > bounds = get_cell_bounds(cell);
+
+        Point<dim> particle_position;
+        for (unsigned int d=0; d<dim; ++d)
+          particle_position[d] = random_numbers[d] * (bounds.second[d]-bounds.first[d]) + bounds.first[d];
+
+        try
+          {
+            const Point<dim> p_unit = this->get_mapping().transform_real_to_unit_cell(cell, particle_position);
+            if (GeometryInfo<dim>::is_inside_unit_cell(p_unit))
+              {
+                const Particle<dim> new_particle(particle_position, p_unit, id);
+                const types::LevelInd cellid(cell->level(), cell->index());
+                particle = std::make_pair(cellid,new_particle);
+                return true;
+              }
+          }
+        catch (typename Mapping<dim>::ExcTransformationFailed &)
+          {
+            // The point is not in this cell.
+          }
+
+        return false;
+      }
+
+      template <int dim>
+      std::pair<Point<dim>,Point<dim> >
+      Interface<dim>::get_cell_bounds (const typename parallel::distributed::Triangulation<dim>::active_cell_iterator &cell)
+      {
         Point<dim> max_bounds, min_bounds;
         // Get the bounds of the cell defined by the vertices
         for (unsigned int d=0; d<dim; ++d)
@@ -106,41 +171,87 @@ namespace aspect
               }
           }
 
-        // Generate random points in these bounds until one is within the cell
-        unsigned int iteration = 0;
-        const unsigned int maximum_iterations = 100;
-        Point<dim> particle_position;
-        while (iteration < maximum_iterations)
+        return std::make_pair(min_bounds,max_bounds);
+      }
+
+      template <int dim>
+      void
+      Interface<dim>::generate_particles_at_positions (const std::vector<std::pair<Point<dim>,types::particle_index> > &positions,
+                                                       std::multimap<types::LevelInd, Particle<dim> > &particles) const
+      {
+        // Split the positions into chunks and search their cells in
+        // separate tasks
+        const std::size_t min_chunk_size = 1000;
+        const std::size_t n_chunks = std::max<std::size_t>(1,
+                                                           std::min<std::size_t>(MultithreadInfo::n_threads(),
+                                                               positions.size() / min_chunk_size));
+
+        std::vector<std::vector<std::pair<types::LevelInd,Particle<dim> > > > chunk_particles(n_chunks);
+        Threads::TaskGroup<void> tasks;
+        for (unsigned int c = 0; c < n_chunks; ++c)
+          tasks += Threads::new_task<void> (std_cxx11::bind(&Interface<dim>::generate_particles_in_range,
+                                                            std_cxx11::cref(*this),
+                                                            std_cxx11::cref(positions),
+                                                            c * positions.size() / n_chunks,
+                                                            (c+1) * positions.size() / n_chunks,
+                                                            &chunk_particles[c]));
+        tasks.join_all();
+
+        for (unsigned int c = 0; c < n_chunks; ++c)
+          particles.insert(chunk_particles[c].begin(),chunk_particles[c].end());
+      }
+
+      template <int dim>
+      void
+      Interface<dim>::generate_particles_in_range (const std::vector<std::pair<Point<dim>,types::particle_index> > &positions,
+                                                   const std::size_t begin,
+                                                   const std::size_t end,
+                                                   std::vector<std::pair<types::LevelInd,Particle<dim> > > *particles) const
+      {
+        for (std::size_t i = begin; i < end; ++i)
           {
-            for (unsigned int d=0; d<dim; ++d)
-              {
-                particle_position[d] = uniform_distribution_01(random_number_generator) *
-                                       (max_bounds[d]-min_bounds[d]) + min_bounds[d];
-              }
+            // Try to add the particle. If it is not in this domain, do not
+            // worry about it and move on to next point.
             try
               {
-                const Point<dim> p_unit = this->get_mapping().transform_real_to_unit_cell(cell, particle_position);
-                if (GeometryInfo<dim>::is_inside_unit_cell(p_unit))
-                  {
-                    // Add the generated particle to the set
-                    const Particle<dim> new_particle(particle_position, p_unit, id);
-                    const types::LevelInd cellid(cell->level(), cell->index());
-                    return std::make_pair(cellid,new_particle);
-                  }
+                particles->push_back(generate_particle(positions[i].first,positions[i].second));
               }
-            catch (typename Mapping<dim>::ExcTransformationFailed &)
-              {
-                // The point is not in this cell. Do nothing, just try again.
-              }
-            iteration++;
+            catch (ExcParticlePointNotInDomain &)
+              {}
           }
-        AssertThrow (iteration < maximum_iterations,
-                     ExcMessage ("Couldn't generate particle (unusual cell shape?). "
-                                 "The ratio between the bounding box volume in which the particle is "
-                                 "generated and the actual cell volume is approximately: " +
-                                 boost::lexical_cast<std::string>(cell->measure() / (max_bounds-min_bounds).norm_square())));
+      }
 
-        return std::make_pair(types::LevelInd(),Particle<dim>());
+      template <int dim>
+      std::pair<Point<dim>,Point<dim> >
+      Interface<dim>::compute_local_bounding_box () const
+      {
+        Point<dim> min_bounds, max_bounds;
+        for (unsigned int d=0; d<dim; ++d)
+          {
+            min_bounds[d] = std::numeric_limits<double>::max();
+            max_bounds[d] = - std::numeric_limits<double>::max();
+          }
+
+        for (typename Triangulation<dim>::active_cell_iterator cell = this->get_triangulation().begin_active();
+             cell != this->get_triangulation().end(); ++cell)
+          if (cell->is_locally_owned())
+            {
+              // Enlarge the box of the vertices by a fraction of the cell
+              // size to also include the curved faces of cells with
+              // higher order mappings
+              const double tolerance = 0.25 * cell->diameter();
+              for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell; ++v)
+                {
+                  const Point<dim> vertex_position = cell->vertex(v);
+                  for (unsigned int d=0; d<dim; ++d)
+                    {
+                      min_bounds[d] = std::min(vertex_position[d] - tolerance, min_bounds[d]);
+                      max_bounds[d] = std::max(vertex_position[d] + tolerance, max_bounds[d]);
+                    }
+                }
+            }
+
+        return std::make_pair(min_bounds,max_bounds);
       }
 
       template <int dim>
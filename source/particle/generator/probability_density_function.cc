@@ -23,6 +23,7 @@
 #include <deal.II/base/quadrature_lib.h>
 #include <deal.II/fe/fe_values.h>
 #include <deal.II/base/geometry_info.h>
+#include <deal.II/base/thread_management.h>
 
 #include <boost/lexical_cast.hpp>
 
@@ -176,33 +177,101 @@ namespace aspect
                                                                         const types::particle_index n_local_particles,
                                                                         std::multimap<types::LevelInd, Particle<dim> > &particles)
       {
-        // Generate particles per cell
-        unsigned int cell_index = 0;
-        unsigned int current_particle_index = first_particle_index;
+        std::vector<typename parallel::distributed::Triangulation<dim>::active_cell_iterator> local_cells;
+        local_cells.reserve(particles_per_cell.size());
+        for (typename DoFHandler<dim>::active_cell_iterator cell = this->get_dof_handler().begin_active();
+             cell!=this->get_dof_handler().end();
+             ++cell)
+          if (cell->is_locally_owned())
+            local_cells.push_back(cell);
+
+        // Determine the index of the cell of every particle
+        std::vector<unsigned int> particle_cells;
+        particle_cells.reserve(n_local_particles);
+        for (unsigned int cell_index = 0; cell_index < local_cells.size(); ++cell_index)
+          particle_cells.insert(particle_cells.end(),particles_per_cell[cell_index],cell_index);
+
+        const types::particle_index n_generated_particles = particle_cells.size();
+        Assert (n_generated_particles == n_local_particles, ExcInternalError());
 
         // We first store the generated particles in a vector. Since they are
         // generated cell-by-cell, they will already be sorted in the correct
         // order to be later transferred to the multimap with O(N) complexity.
         // If we would insert them into the multimap one-by-one it would
         // increase the complexity to O(N log(N)).
-        std::vector<std::pair<types::LevelInd, Particle<dim> > > local_particles;
-        local_particles.reserve(n_local_particles);
-        for (typename DoFHandler<dim>::active_cell_iterator cell = this->get_dof_handler().begin_active();
-             cell!=this->get_dof_handler().end();
-             ++cell)
-          if (cell->is_locally_owned())
-            {
-              for (unsigned int i = 0; i < particles_per_cell[cell_index]; ++i)
-                {
-                  local_particles.push_back(this->generate_particle(cell,current_particle_index));
-                  ++current_particle_index;
-                }
-              ++cell_index;
-            }
+        std::vector<std::pair<types::LevelInd, Particle<dim> > > local_particles(n_generated_particles);
+
+        // Draw the random numbers for the first candidate position of every
+        // particle in the order in which a sequential generation would draw
+        // them, and test the candidates in parallel. Finding the cell
+        // coordinates of a candidate is much more expensive than drawing
+        // the random numbers.
+        const boost::mt19937 initial_random_number_generator = this->random_number_generator;
+        boost::uniform_01<double> uniform_distribution_01;
+        std::vector<double> random_numbers(dim * n_generated_particles);
+        for (std::size_t i = 0; i < random_numbers.size(); ++i)
+          random_numbers[i] = uniform_distribution_01(this->random_number_generator);
+
+        std::vector<unsigned char> accepted_candidates(n_generated_particles,0);
+
+        // Test the candidates in chunks with a fixed number of particles
+        // in separate tasks
+        const types::particle_index particles_per_chunk = 10000;
+        Threads::TaskGroup<void> tasks;
+        for (types::particle_index begin = 0; begin < n_generated_particles; begin += particles_per_chunk)
+          tasks += Threads::new_task<void> (std_cxx11::bind(&ProbabilityDensityFunction<dim>::generate_particles_in_range,
+                                                            std_cxx11::cref(*this),
+                                                            std_cxx11::cref(local_cells),
+                                                            std_cxx11::cref(particle_cells),
+                                                            begin,
+                                                            std::min(begin + particles_per_chunk, n_generated_particles),
+                                                            first_particle_index,
+                                                            std_cxx11::cref(random_numbers),
+                                                            &local_particles,
+                                                            &accepted_candidates));
+        tasks.join_all();
+
+        // If a candidate is outside of its cell, the sequential generation
+        // would have drawn new random numbers for this particle, which shifts
+        // the random numbers of all following particles. Therefore generate
+        // the remaining particles sequentially, starting with the random
+        // numbers of the rejected candidate. This keeps the particle
+        // positions independent of the number of threads, and identical to
+        // a sequential generation.
+        const types::particle_index first_rejected_particle = std::find(accepted_candidates.begin(),
+                                                                        accepted_candidates.end(),
+                                                                        0) - accepted_candidates.begin();
+        if (first_rejected_particle < n_generated_particles)
+          {
+            this->random_number_generator = initial_random_number_generator;
+            this->random_number_generator.discard(dim * first_rejected_particle);
+
+            for (types::particle_index i = first_rejected_particle; i < n_generated_particles; ++i)
+              local_particles[i] = this->generate_particle(local_cells[particle_cells[i]],
+                                                           first_particle_index + i);
+          }
 
         particles.insert(local_particles.begin(),local_particles.end());
       }
 
+      template <int dim>
+      void
+      ProbabilityDensityFunction<dim>::generate_particles_in_range (const std::vector<typename parallel::distributed::Triangulation<dim>::active_cell_iterator> &local_cells,
+                                                                    const std::vector<unsigned int> &particle_cells,
+                                                                    const types::particle_index begin,
+                                                                    const types::particle_index end,
+                                                                    const types::particle_index first_particle_id,
+                                                                    const std::vector<double> &random_numbers,
+                                                                    std::vector<std::pair<types::LevelInd, Particle<dim> > > *local_particles,
+                                                                    std::vector<unsigned char> *accepted_candidates) const
+      {
+        for (types::particle_index i = begin; i < end; ++i)
+          (*accepted_candidates)[i] = this->try_generate_particle(local_cells[particle_cells[i]],
+                                                                  first_particle_id + i,
+                                                                  &random_numbers[dim * i],
+                                                                  (*local_particles)[i]);
+      }
+
 
 
       template <int dim>
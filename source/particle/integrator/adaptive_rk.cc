@@ -0,0 +1,266 @@
+/*
+  Copyright (C) 2017 by the authors of the ASPECT code.
+
+ This file is part of ASPECT.
+
+ ASPECT is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2, or (at your option)
+ any later version.
+
+ ASPECT is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with ASPECT; see the file LICENSE.  If not see
+ <http://www.gnu.org/licenses/>.
+ */
+
+#include <aspect/particle/integrator/adaptive_rk.h>
+
+namespace aspect
+{
+  namespace Particle
+  {
+    namespace Integrator
+    {
+      template <int dim>
+      AdaptiveRK<dim>::AdaptiveRK()
+        :
+        relative_tolerance(1e-4),
+        max_substeps(100)
+      {}
+
+      template <int dim>
+      bool
+      AdaptiveRK<dim>::need_cell_velocity_field () const
+      {
+        return true;
+      }
+
+      template <int dim>
+      void
+      AdaptiveRK<dim>::local_integrate_cell(const typename ParticleHandler<dim>::particle_iterator &begin_particle,
+                                            const typename ParticleHandler<dim>::particle_iterator &end_particle,
+                                            CellVelocityField<dim> &velocity_field,
+                                            const double dt)
+      {
+        if (dt == 0.0)
+          return;
+
+        // Every particle starts in this cell, but integrate_particle() moves
+        // the velocity field to the cells the particle passes through
+        const typename DoFHandler<dim>::active_cell_iterator cell = velocity_field.cell;
+        const double tolerance = relative_tolerance * cell->diameter();
+
+        for (typename ParticleHandler<dim>::particle_iterator it = begin_particle;
+             it != end_particle; ++it)
+          {
+            if (velocity_field.cell != cell)
+              velocity_field.reinit(cell);
+
+            it->set_location(integrate_particle(it->get_location(),
+                                                it->get_reference_location(),
+                                                velocity_field,
+                                                dt,
+                                                tolerance));
+          }
+      }
+
+      template <int dim>
+      Point<dim>
+      AdaptiveRK<dim>::integrate_particle (const Point<dim> &location,
+                                           const Point<dim> &reference_location,
+                                           CellVelocityField<dim> &velocity_field,
+                                           const double dt,
+                                           const double tolerance) const
+      {
+        // The Bogacki-Shampine method evaluates the velocity at the end of an
+        // accepted substep as its last stage, which is reused as the first
+        // stage of the next substep.
+        Point<dim> x = location;
+        Tensor<1,dim> k1 = velocity_field.value(reference_location, 0.0);
+
+        double t = 0.0;
+        double h = dt;
+        unsigned int n_substeps = 0;
+
+        while (t < dt)
+          {
+            // Do not step beyond the end of the time step, and finish
+            // without error control if the particle needs too many substeps.
+            // Rejected substeps count towards the limit as well.
+            const bool last_substep = (n_substeps + 1 >= max_substeps);
+            if (last_substep || t + h > dt)
+              h = dt - t;
+
+            ++n_substeps;
+
+            // Evaluate the velocity at every stage point in the cell that
+            // contains it. If a stage point is outside of the locally owned
+            // and ghost cells, retry with a shorter substep.
+            Point<dim> x_reference;
+            bool found_all_stages = true;
+
+            const Point<dim> x2 = x + 0.5 * h * k1;
+            Tensor<1,dim> k2, k3, k4;
+            if (velocity_field.move_to_point(x2, x_reference))
+              k2 = velocity_field.value(x_reference, (t + 0.5 * h) / dt);
+            else
+              found_all_stages = false;
+
+            const Point<dim> x3 = x + 0.75 * h * k2;
+            if (found_all_stages && velocity_field.move_to_point(x3, x_reference))
+              k3 = velocity_field.value(x_reference, (t + 0.75 * h) / dt);
+            else
+              found_all_stages = false;
+
+            const Point<dim> x_new = x + h * (2./9. * k1 + 1./3. * k2 + 4./9. * k3);
+            if (found_all_stages && velocity_field.move_to_point(x_new, x_reference))
+              k4 = velocity_field.value(x_reference, std::min((t + h) / dt, 1.0));
+            else
+              found_all_stages = false;
+
+            if (!found_all_stages)
+              {
+                AssertThrow (!last_substep,
+                             ExcMessage("The adaptive RK particle integrator could not follow a "
+                                        "particle, because its path left the locally owned and "
+                                        "ghost cells of this process. This happens if the time "
+                                        "step is larger than the time a particle needs to cross "
+                                        "a cell, i.e. if the CFL number is larger than one. "
+                                        "Reduce the CFL number or the maximal time step."));
+                h *= 0.5;
+                continue;
+              }
+
+            // The difference to the embedded second order solution
+            // estimates the error of the substep
+            const double error = (h * (-5./72. * k1 + 1./12. * k2 + 1./9. * k3 - 1./8. * k4)).norm();
+
+            if (error <= tolerance || last_substep)
+              {
+                t += h;
+                x = x_new;
+                k1 = k4;
+              }
+
+            // Choose the next substep length from the error estimate of
+            // this one, with the usual safety factor and limits
+            const double factor = (error > 0.0
+                                   ?
+                                   0.9 * std::pow(tolerance / error, 1./3.)
+                                   :
+                                   5.0);
+            h *= std::max(0.2, std::min(5.0, factor));
+          }
+
+        return x;
+      }
+
+      template <int dim>
+      void
+      AdaptiveRK<dim>::local_integrate_step(const typename ParticleHandler<dim>::particle_iterator &,
+                                            const typename ParticleHandler<dim>::particle_iterator &,
+                                            const std::vector<Tensor<1,dim> > &,
+                                            const std::vector<Tensor<1,dim> > &,
+                                            const double)
+      {
+        Assert(false,
+               ExcMessage("The adaptive RK integrator uses the velocity field of the cell, "
+                          "and should only be called through local_integrate_cell()."));
+      }
+
+      template <int dim>
+      void
+      AdaptiveRK<dim>::declare_parameters (ParameterHandler &prm)
+      {
+        prm.enter_subsection("Postprocess");
+        {
+          prm.enter_subsection("Particles");
+          {
+            prm.enter_subsection("Integrator");
+            {
+              prm.enter_subsection("Adaptive RK");
+              {
+                prm.declare_entry ("Error tolerance", "1e-4",
+                                   Patterns::Double (1e-12),
+                                   "The maximal estimated error of the particle position after "
+                                   "every substep, relative to the diameter of the cell the particle "
+                                   "is in at the beginning of the time step. Has to be strictly "
+                                   "positive.");
+                prm.declare_entry ("Maximum number of substeps", "100",
+                                   Patterns::Integer (1),
+                                   "The maximal number of substeps every particle may take in one "
+                                   "time step, counting both accepted substeps and substeps that "
+                                   "are rejected and repeated with a shorter length. If a particle "
+                                   "needs more substeps to reach the error tolerance, the rest of "
+                                   "the time step is integrated in a single substep without error "
+                                   "control.");
+              }
+              prm.leave_subsection();
+            }
+            prm.leave_subsection();
+          }
+          prm.leave_subsection();
+        }
+        prm.leave_subsection();
+      }
+
+      template <int dim>
+      void
+      AdaptiveRK<dim>::parse_parameters (ParameterHandler &prm)
+      {
+        prm.enter_subsection("Postprocess");
+        {
+          prm.enter_subsection("Particles");
+          {
+            prm.enter_subsection("Integrator");
+            {
+              prm.enter_subsection("Adaptive RK");
+              {
+                relative_tolerance = prm.get_double ("Error tolerance");
+                max_substeps = prm.get_integer ("Maximum number of substeps");
+              }
+              prm.leave_subsection();
+            }
+            prm.leave_subsection();
+          }
+          prm.leave_subsection();
+        }
+        prm.leave_subsection();
+      }
+    }
+  }
+}
+
+
+// explicit instantiations
+namespace aspect
+{
+  namespace Particle
+  {
+    namespace Integrator
+    {
+      ASPECT_REGISTER_PARTICLE_INTEGRATOR(AdaptiveRK,
+                                          "adaptive rk",
+                                          "An adaptive third order Runge Kutta integrator "
+                                          "(Bogacki-Shampine) that subdivides the time step "
+                                          "of every particle into as many substeps as are "
+                                          "necessary to keep the error estimated by the "
+                                          "embedded second order method below a tolerance. "
+                                          "The velocity at every stage is evaluated from "
+                                          "the velocity field of the cell that contains the "
+                                          "stage point, and linearly interpolated in time "
+                                          "between the old and the current solution. "
+                                          "Particles are followed through the locally owned "
+                                          "and ghost cells, which requires a CFL number of at "
+                                          "most one. This allows larger time steps "
+                                          "in models where the particle paths in regions "
+                                          "with strong velocity gradients would otherwise "
+                                          "limit the accuracy.")
+    }
+  }
+}
@@ -22,6 +22,7 @@
 #include <aspect/simulator_access.h>
 
 #include <deal.II/base/std_cxx1x/tuple.h>
+#include <deal.II/base/geometry_info.h>
 
 namespace aspect
 {
@@ -29,6 +30,143 @@ namespace aspect
   {
     namespace Integrator
     {
+      template <int dim>
+      CellVelocityField<dim>::CellVelocityField ()
+        :
+        fe (NULL),
+        first_velocity_component (numbers::invalid_unsigned_int),
+        velocity_fe (NULL),
+        mapping (NULL),
+        solution (NULL),
+        old_solution (NULL)
+      {}
+
+
+
+      template <int dim>
+      void
+      CellVelocityField<dim>::reinit (const typename DoFHandler<dim>::active_cell_iterator &new_cell)
+      {
+        cell = new_cell;
+
+        cell_dof_indices.resize(fe->dofs_per_cell);
+        cell->get_dof_indices (cell_dof_indices);
+
+        velocities.resize(velocity_fe->dofs_per_cell);
+        old_velocities.resize(velocity_fe->dofs_per_cell);
+
+        for (unsigned int j=0; j<velocity_fe->dofs_per_cell; ++j)
+          for (unsigned int dir=0; dir<dim; ++dir)
+            {
+              const unsigned int support_point_index
+                = fe->component_to_system_index(first_velocity_component + dir,j);
+
+              velocities[j][dir] = (*solution)[cell_dof_indices[support_point_index]];
+              old_velocities[j][dir] = (*old_solution)[cell_dof_indices[support_point_index]];
+            }
+      }
+
+
+
+      template <int dim>
+      Tensor<1,dim>
+      CellVelocityField<dim>::value (const Point<dim> &reference_location,
+                                     const double time_fraction) const
+      {
+        Tensor<1,dim> velocity;
+        for (unsigned int j=0; j<velocity_fe->dofs_per_cell; ++j)
+          velocity += velocity_fe->shape_value(j,reference_location)
+                      * ((1.0 - time_fraction) * old_velocities[j] + time_fraction * velocities[j]);
+
+        return velocity;
+      }
+
+
+
+      template <int dim>
+      bool
+      CellVelocityField<dim>::reference_location (const Point<dim> &location,
+                                                  Point<dim> &reference_location) const
+      {
+        try
+          {
+            reference_location = mapping->transform_real_to_unit_cell(cell, location);
+            return true;
+          }
+        catch (const typename Mapping<dim>::ExcTransformationFailed &)
+          {
+            return false;
+          }
+      }
+
+
+
+      template <int dim>
+      bool
+      CellVelocityField<dim>::move_to_point (const Point<dim> &location,
+                                             Point<dim> &reference_location)
+      {
+        typename DoFHandler<dim>::active_cell_iterator current_cell = cell;
+        double current_distance = current_cell->center().distance(location);
+
+        while (true)
+          {
+            if (current_cell != cell)
+              reinit(current_cell);
+
+            // Most of the time the point is still in the current cell
+            if (this->reference_location(location, reference_location)
+                && GeometryInfo<dim>::is_inside_unit_cell(reference_location, 1e-10))
+              return true;
+
+            // Otherwise find the neighbor (or the child of a neighbor across
+            // a refined face) whose center is closest to the point. The
+            // distance strictly decreases, so the walk terminates.
+            typename DoFHandler<dim>::cell_iterator closest_neighbor;
+            double closest_distance = current_distance;
+
+            for (unsigned int f=0; f<GeometryInfo<dim>::faces_per_cell; ++f)
+              {
+                if (current_cell->at_boundary(f))
+                  continue;
+
+                std::vector<typename DoFHandler<dim>::cell_iterator> neighbors;
+                if (current_cell->neighbor(f)->has_children())
+                  for (unsigned int subface=0; subface<current_cell->face(f)->n_children(); ++subface)
+                    neighbors.push_back(current_cell->neighbor_child_on_subface(f,subface));
+                else
+                  neighbors.push_back(current_cell->neighbor(f));
+
+                for (unsigned int n=0; n<neighbors.size(); ++n)
+                  {
+                    const double distance = neighbors[n]->center().distance(location);
+                    if (distance < closest_distance)
+                      {
+                        closest_neighbor = neighbors[n];
+                        closest_distance = distance;
+                      }
+                  }
+              }
+
+            // No neighbor is closer, so the point is outside of the domain
+            // next to the current cell (or the mesh is so distorted that
+            // cell centers are no good guide, in which case we also use the
+            // closest cell). Extrapolate the velocity of this cell, if
+            // the mapping can be inverted at the point.
+            if (closest_distance == current_distance)
+              return this->reference_location(location, reference_location);
+
+            // There is no velocity information on artificial cells
+            if (closest_neighbor->is_artificial())
+              return false;
+
+            current_cell = typename DoFHandler<dim>::active_cell_iterator(closest_neighbor);
+            current_distance = closest_distance;
+          }
+      }
+
+
+
       template <int dim>
       Interface<dim>::~Interface ()
       {}
@@ -43,6 +181,25 @@ namespace aspect
       Interface<dim>::parse_parameters (ParameterHandler &)
       {}
 
+      template <int dim>
+      bool
+      Interface<dim>::need_cell_velocity_field () const
+      {
+        return false;
+      }
+
+      template <int dim>
+      void
+      Interface<dim>::local_integrate_cell(const typename ParticleHandler<dim>::particle_iterator &,
+                                           const typename ParticleHandler<dim>::particle_iterator &,
+                                           CellVelocityField<dim> &,
+                                           const double)
+      {
+        AssertThrow(false,
+                    ExcMessage("The particle integrator requested the velocity field of the cell, "
+                               "but does not implement the function local_integrate_cell()."));
+      }
+
       template <int dim>
       bool
       Interface<dim>::new_integration_step()
@@ -50,6 +207,13 @@ namespace aspect
         return false;
       }
 
+      template <int dim>
+      unsigned int
+      Interface<dim>::get_n_data_components() const
+      {
+        return 0;
+      }
+
       template <int dim>
       std::size_t
       Interface<dim>::get_data_size() const
@@ -240,6 +404,7 @@ namespace aspect
     namespace Integrator
     {
 #define INSTANTIATE(dim) \
+  template struct CellVelocityField<dim>; \
   template class Interface<dim>; \
   \
   template \
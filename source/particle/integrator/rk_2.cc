@@ -56,16 +56,22 @@ namespace aspect
         for (typename ParticleHandler<dim>::particle_iterator it = begin_particle;
              it != end_particle; ++it, ++velocity, ++old_velocity)
           {
-            const types::particle_index particle_id = it->get_id();
+            // The location before the first integration step is stored
+            // in the integrator data of the particle
+            const ArrayView<double> loc0 = it->get_integrator_data();
             const Point<dim> loc = it->get_location();
             if (integrator_substep == 0)
               {
-                loc0[particle_id] = loc;
+                for (unsigned int i=0; i<dim; ++i)
+                  loc0[i] = loc(i);
                 it->set_location(loc + 0.5 * dt * (*old_velocity));
               }
             else if (integrator_substep == 1)
               {
-                it->set_location(loc0[particle_id] + dt * (*old_velocity + *velocity) / 2.0);
+                Point<dim> start_location;
+                for (unsigned int i=0; i<dim; ++i)
+                  start_location(i) = loc0[i];
+                it->set_location(start_location + dt * (*old_velocity + *velocity) / 2.0);
               }
             else
               {
@@ -79,13 +85,19 @@ namespace aspect
       bool
       RK2<dim>::new_integration_step()
       {
-        if (integrator_substep == 1) loc0.clear();
         integrator_substep = (integrator_substep + 1) % 2;
 
         // Continue until we're at the last step
         return (integrator_substep != 0);
       }
 
+      template <int dim>
+      unsigned int
+      RK2<dim>::get_n_data_components() const
+      {
+        return dim;
+      }
+
       template <int dim>
       std::size_t
       RK2<dim>::get_data_size() const
@@ -112,9 +124,12 @@ namespace aspect
 
         const double *integrator_data = static_cast<const double *> (data);
 
-        // Read location data
+        // Read location data. The iterator argument only gives read
+        // access, therefore write through a copy of it.
+        typename ParticleHandler<dim>::particle_iterator writable_particle = particle;
+        const ArrayView<double> loc0 = writable_particle->get_integrator_data();
         for (unsigned int i=0; i<dim; ++i)
-          loc0[particle->get_id()](i) = *integrator_data++;
+          loc0[i] = *integrator_data++;
 
         return static_cast<const void *> (integrator_data);
       }
@@ -133,9 +148,9 @@ namespace aspect
         double *integrator_data = static_cast<double *> (data);
 
         // Write location data
-        const typename std::map<types::particle_index, Point<dim> >::const_iterator it = loc0.find(particle->get_id());
+        const ArrayView<const double> loc0 = particle->get_integrator_data();
         for (unsigned int i=0; i<dim; ++i,++integrator_data)
-          *integrator_data = it->second(i);
+          *integrator_data = loc0[i];
 
         return static_cast<void *> (integrator_data);
       }
@@ -58,27 +58,54 @@ namespace aspect
         for (typename ParticleHandler<dim>::particle_iterator it = begin_particle;
              it != end_particle; ++it, ++velocity, ++old_velocity)
           {
-            const types::particle_index particle_id = it->get_id();
+            // The integrator data of the particle stores the location
+            // before the first integration step, followed by k1, k2 and k3
+            const ArrayView<double> integrator_data = it->get_integrator_data();
+            double *loc0 = &integrator_data[0];
+            double *k1 = loc0 + dim;
+            double *k2 = k1 + dim;
+            double *k3 = k2 + dim;
+
             if (integrator_substep == 0)
               {
-                loc0[particle_id] = it->get_location();
-                k1[particle_id] = dt * (*old_velocity);
-                it->set_location(it->get_location() + 0.5*k1[particle_id]);
+                const Point<dim> loc = it->get_location();
+                const Tensor<1,dim> k = dt * (*old_velocity);
+                for (unsigned int i=0; i<dim; ++i)
+                  {
+                    loc0[i] = loc(i);
+                    k1[i] = k[i];
+                  }
+                it->set_location(loc + 0.5*k);
               }
             else if (integrator_substep == 1)
               {
-                k2[particle_id] = dt * (*old_velocity + *velocity) / 2.0;
-                it->set_location(loc0[particle_id] + 0.5*k2[particle_id]);
+                const Tensor<1,dim> k = dt * (*old_velocity + *velocity) / 2.0;
+                Point<dim> new_location;
+                for (unsigned int i=0; i<dim; ++i)
+                  {
+                    k2[i] = k[i];
+                    new_location(i) = loc0[i] + 0.5*k[i];
+                  }
+                it->set_location(new_location);
               }
             else if (integrator_substep == 2)
               {
-                k3[particle_id] = dt * (*old_velocity + *velocity) / 2.0;
-                it->set_location(loc0[particle_id] + k3[particle_id]);
+                const Tensor<1,dim> k = dt * (*old_velocity + *velocity) / 2.0;
+                Point<dim> new_location;
+                for (unsigned int i=0; i<dim; ++i)
+                  {
+                    k3[i] = k[i];
+                    new_location(i) = loc0[i] + k[i];
+                  }
+                it->set_location(new_location);
               }
             else if (integrator_substep == 3)
               {
                 const Tensor<1,dim> k4 = dt * (*velocity);
-                it->set_location(loc0[particle_id] + (k1[particle_id] + 2.0*k2[particle_id] + 2.0*k3[particle_id] + k4)/6.0);
+                Point<dim> new_location;
+                for (unsigned int i=0; i<dim; ++i)
+                  new_location(i) = loc0[i] + (k1[i] + 2.0*k2[i] + 2.0*k3[i] + k4[i])/6.0;
+                it->set_location(new_location);
               }
             else
               {
@@ -92,20 +119,19 @@ namespace aspect
       bool
       RK4<dim>::new_integration_step()
       {
-        if (integrator_substep == 3)
-          {
-            loc0.clear();
-            k1.clear();
-            k2.clear();
-            k3.clear();
-          }
-
         integrator_substep = (integrator_substep+1)%4;
 
         // Continue until we're at the last step
         return (integrator_substep != 0);
       }
 
+      template <int dim>
+      unsigned int
+      RK4<dim>::get_n_data_components() const
+      {
+        return 4*dim;
+      }
+
       template <int dim>
       std::size_t
       RK4<dim>::get_data_size() const
@@ -132,19 +158,12 @@ namespace aspect
 
         const double *integrator_data = static_cast<const double *> (data);
 
-        // Read location data
-        for (unsigned int i=0; i<dim; ++i)
-          loc0[particle->get_id()](i) = *integrator_data++;
-
-        // Read k1, k2 and k3
-        for (unsigned int i=0; i<dim; ++i)
-          k1[particle->get_id()][i] = *integrator_data++;
-
-        for (unsigned int i=0; i<dim; ++i)
-          k2[particle->get_id()][i] = *integrator_data++;
-
-        for (unsigned int i=0; i<dim; ++i)
-          k3[particle->get_id()][i] = *integrator_data++;
+        // Read location data, and k1, k2 and k3. The iterator argument
+        // only gives read access, therefore write through a copy of it.
+        typename ParticleHandler<dim>::particle_iterator writable_particle = particle;
+        const ArrayView<double> particle_data = writable_particle->get_integrator_data();
+        for (unsigned int i=0; i<4*dim; ++i)
+          particle_data[i] = *integrator_data++;
 
         return static_cast<const void *> (integrator_data);
       }
@@ -162,23 +181,10 @@ namespace aspect
 
         double *integrator_data = static_cast<double *> (data);
 
-        // Write location data
-        typename std::map<types::particle_index, Point<dim> >::const_iterator it = loc0.find(particle->get_id());
-        for (unsigned int i=0; i<dim; ++i,++integrator_data)
-          *integrator_data = it->second(i);
-
-        // Write k1, k2 and k3
-        typename std::map<types::particle_index, Tensor<1,dim> >::const_iterator it_k = k1.find(particle->get_id());
-        for (unsigned int i=0; i<dim; ++i,++integrator_data)
-          *integrator_data = it_k->second[i];
-
-        it_k = k2.find(particle->get_id());
-        for (unsigned int i=0; i<dim; ++i,++integrator_data)
-          *integrator_data = it_k->second[i];
-
-        it_k = k3.find(particle->get_id());
-        for (unsigned int i=0; i<dim; ++i,++integrator_data)
-          *integrator_data = it_k->second[i];
+        // Write location data, and k1, k2 and k3
+        const ArrayView<const double> particle_data = particle->get_integrator_data();
+        for (unsigned int i=0; i<4*dim; ++i,++integrator_data)
+          *integrator_data = particle_data[i];
 
         return static_cast<void *> (integrator_data);
       }
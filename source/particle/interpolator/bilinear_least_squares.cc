@@ -43,18 +43,20 @@ namespace aspect
       {
         const unsigned int n_particle_properties = particle_handler.n_properties_per_particle();
 
-        const unsigned int property_index = selected_properties.first_selected_component(selected_properties.size());
-
-        AssertThrow(property_index != numbers::invalid_unsigned_int,
+        // Collect the indices of all properties that should be interpolated
+        std::vector<unsigned int> property_indices;
+        for (unsigned int i = 0; i < n_particle_properties; ++i)
+          if (selected_properties[i])
+            property_indices.push_back(i);
+        const unsigned int n_selected_properties = property_indices.size();
+
+        AssertThrow(n_selected_properties != 0,
                     ExcMessage("Internal error: the particle property interpolator was "
                                "called without a specified component to interpolate."));
 
-        AssertThrow(dim == 2,
-                    ExcMessage("Currently, the particle interpolator `bilinear' is only supported for 2D models."));
-
-        AssertThrow(selected_properties.n_selected_components(n_particle_properties) == 1,
-                    ExcNotImplemented("Interpolation of multiple components is not supported."));
-
+        Assert(positions.size() > 0,
+               ExcMessage("The particle property interpolator was not given any "
+                          "positions to evaluate the particle cell_properties at."));
 
         const Point<dim> approximated_cell_midpoint = std::accumulate (positions.begin(), positions.end(), Point<dim>())
                                                       / static_cast<double> (positions.size());
@@ -66,11 +68,6 @@ namespace aspect
             // We can not simply use one of the points as input for find_active_cell_around_point
             // because for vertices of mesh cells we might end up getting ghost_cells as return value
             // instead of the local active cell. So make sure we are well in the inside of a cell.
-            Assert(positions.size() > 0,
-                   ExcMessage("The particle property interpolator was not given any "
-                              "positions to evaluate the particle cell_properties at."));
-
-
             found_cell =
               (GridTools::find_active_cell_around_point<> (this->get_mapping(),
                                                            this->get_triangulation(),
@@ -93,68 +90,120 @@ namespace aspect
                     ExcMessage("At least one cell contained no particles. The `bilinear'"
                                "interpolation scheme does not support this case. "));
 
+        // We fit the function f(x) = sum_i c_i phi_i(x) to the particle
+        // properties in the least squares sense, where the phi_i are the
+        // 2^dim products of the scaled coordinates relative to the mean of
+        // the positions (1, x, y, xy in 2D and additionally z, xz, yz, xyz
+        // in 3D). If A^TA is singular, e.g. because the cell contains fewer
+        // particles than basis functions, the solution of smallest norm
+        // depends on this expansion point.
+        // The matrix A with A_ji = phi_i(x_j) for every particle j is usually
+        // not square, therefore we solve Ac=r by solving A^TAc=A^Tr. We
+        // never build A itself, but directly accumulate A^TA and A^Tr for
+        // all selected properties in one loop over the particles. A^TA only
+        // depends on the particle positions, therefore it is only inverted
+        // once and the inverse is applied to the right hand sides of all
+        // selected properties.
+        const unsigned int n_basis_functions = GeometryInfo<dim>::vertices_per_cell;
 
-        // Noticed that the size of matrix A is n_particles x matrix_dimension
-        // which usually is not a square matrix. Therefore, we solve Ax=r by
-        // solving A^TAx= A^Tr.
-        const unsigned int matrix_dimension = 4;
-        dealii::LAPACKFullMatrix<double> A(n_particles, matrix_dimension);
-        Vector<double> r(n_particles);
-        r = 0;
-
-        unsigned int index = 0;
         const double cell_diameter = found_cell->diameter();
+
+        double normal_matrix[n_basis_functions][n_basis_functions] = {};
+        std::vector<double> right_hand_sides(n_selected_properties * n_basis_functions, 0.0);
+
         for (typename ParticleHandler<dim>::particle_iterator particle = particle_range.begin();
-             particle != particle_range.end(); ++particle, ++index)
+             particle != particle_range.end(); ++particle)
           {
-            const double particle_property_value = particle->get_properties()[property_index];
-            r[index] = particle_property_value;
-
-            const Point<dim> position = particle->get_location();
-            A(index,0) = 1;
-            A(index,1) = (position[0] - approximated_cell_midpoint[0])/cell_diameter;
-            A(index,2) = (position[1] - approximated_cell_midpoint[1])/cell_diameter;
-            A(index,3) = (position[0] - approximated_cell_midpoint[0]) * (position[1] - approximated_cell_midpoint[1])/std::pow(cell_diameter,2);
-          }
+            double basis_values[n_basis_functions];
+            evaluate_basis_functions(particle->get_location(), approximated_cell_midpoint, cell_diameter, basis_values);
 
-        dealii::LAPACKFullMatrix<double> B(matrix_dimension, matrix_dimension);
+            for (unsigned int i = 0; i < n_basis_functions; ++i)
+              for (unsigned int j = 0; j < n_basis_functions; ++j)
+                normal_matrix[i][j] += basis_values[i] * basis_values[j];
 
-        Vector<double> c_ATr(matrix_dimension);
-        Vector<double> c(matrix_dimension);
+            for (unsigned int k = 0; k < n_selected_properties; ++k)
+              {
+                const double property_value = particle->get_property(property_indices[k]);
+                double *rhs = &right_hand_sides[k * n_basis_functions];
 
-        const double threshold = 1e-15;
-        unsigned int index_positions = 0;
+                for (unsigned int i = 0; i < n_basis_functions; ++i)
+                  rhs[i] += property_value * basis_values[i];
+              }
+          }
 
         // Matrix A can be rank deficient if it does not have full rank, therefore singular.
         // To circumvent this issue, we solve A^TAx=A^Tr by using singular value
         // decomposition (SVD).
-        A.Tmmult(B, A, false);
-        A.Tvmult(c_ATr,r);
+        dealii::LAPACKFullMatrix<double> B_inverse(n_basis_functions, n_basis_functions);
+        for (unsigned int i = 0; i < n_basis_functions; ++i)
+          for (unsigned int j = 0; j < n_basis_functions; ++j)
+            B_inverse(i,j) = normal_matrix[i][j];
 
-        dealii::LAPACKFullMatrix<double> B_inverse(B);
+        const double threshold = 1e-15;
         B_inverse.compute_inverse_svd(threshold);
-        B_inverse.vmult(c, c_ATr);
 
-        for (typename std::vector<Point<dim> >::const_iterator itr = positions.begin(); itr != positions.end(); ++itr, ++index_positions)
+        // Evaluate the basis functions at the positions once for all properties
+        std::vector<double> position_basis_values(positions.size() * n_basis_functions);
+        for (unsigned int p = 0; p < positions.size(); ++p)
+          evaluate_basis_functions(positions[p], approximated_cell_midpoint, cell_diameter, &position_basis_values[p * n_basis_functions]);
+
+        Vector<double> c_ATr(n_basis_functions);
+        Vector<double> c(n_basis_functions);
+
+        for (unsigned int k = 0; k < n_selected_properties; ++k)
           {
-            const Point<dim> support_point = *itr;
-            double interpolated_value = c[0] +
-                                        c[1]*(support_point[0] - approximated_cell_midpoint[0])/cell_diameter +
-                                        c[2]*(support_point[1] - approximated_cell_midpoint[1])/cell_diameter +
-                                        c[3]*(support_point[0] - approximated_cell_midpoint[0])*(support_point[1] - approximated_cell_midpoint[1])/std::pow(cell_diameter,2);
-
-            // Overshoot and undershoot correction of interpolated particle property.
-            if (use_global_valued_limiter)
+            const unsigned int property_index = property_indices[k];
+
+            for (unsigned int i = 0; i < n_basis_functions; ++i)
+              c_ATr[i] = right_hand_sides[k * n_basis_functions + i];
+            B_inverse.vmult(c, c_ATr);
+
+            for (unsigned int p = 0; p < positions.size(); ++p)
               {
-                interpolated_value = std::min(interpolated_value, global_maximum_particle_properties[property_index]);
-                interpolated_value = std::max(interpolated_value, global_minimum_particle_properties[property_index]);
-              }
+                double interpolated_value = 0.0;
+                for (unsigned int i = 0; i < n_basis_functions; ++i)
+                  interpolated_value += c[i] * position_basis_values[p * n_basis_functions + i];
+
+                // Overshoot and undershoot correction of interpolated particle property.
+                if (use_global_valued_limiter)
+                  {
+                    interpolated_value = std::min(interpolated_value, global_maximum_particle_properties[property_index]);
+                    interpolated_value = std::max(interpolated_value, global_minimum_particle_properties[property_index]);
+                  }
 
-            cell_properties[index_positions][property_index] = interpolated_value;
+                cell_properties[p][property_index] = interpolated_value;
+              }
           }
         return cell_properties;
       }
 
+
+
+      template <int dim>
+      void
+      BilinearLeastSquares<dim>::evaluate_basis_functions(const Point<dim> &position,
+                                                          const Point<dim> &expansion_point,
+                                                          const double cell_diameter,
+                                                          double *basis_values)
+      {
+        // Basis function i is the product of all coordinate differences d
+        // for which bit d of i is set, divided by the cell diameter to the
+        // power of the number of factors
+        for (unsigned int i = 0; i < GeometryInfo<dim>::vertices_per_cell; ++i)
+          {
+            double product = 1.0;
+            unsigned int n_factors = 0;
+            for (unsigned int d = 0; d < dim; ++d)
+              if (i & (1 << d))
+                {
+                  product *= position[d] - expansion_point[d];
+                  ++n_factors;
+                }
+
+            basis_values[i] = product / std::pow(cell_diameter,static_cast<int>(n_factors));
+          }
+      }
+
       template <int dim>
       void
       BilinearLeastSquares<dim>::declare_parameters (ParameterHandler &prm)
@@ -250,8 +299,8 @@ namespace aspect
       ASPECT_REGISTER_PARTICLE_INTERPOLATOR(BilinearLeastSquares,
                                             "bilinear least squares",
                                             "Interpolates particle properties onto a vector of points using a "
-                                            "bilinear least squares method. Currently only 2D models are "
-                                            "supported. Note that deal.II must be configured with BLAS/LAPACK.")
+                                            "bilinear (in 2D) or trilinear (in 3D) least squares method. "
+                                            "Note that deal.II must be configured with BLAS/LAPACK.")
     }
   }
 }
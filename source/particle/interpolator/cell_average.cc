@@ -66,27 +66,29 @@ namespace aspect
         const unsigned int n_particles = std::distance(particle_range.begin(),particle_range.end());
         const unsigned int n_particle_properties = particle_handler.n_properties_per_particle();
 
-        std::vector<double> cell_properties (n_particle_properties,numbers::signaling_nan<double>());
-
+        // Collect the indices of all properties that should be interpolated,
+        // so that the loops over particles only touch these properties
+        std::vector<unsigned int> property_indices;
         for (unsigned int i = 0; i < n_particle_properties; ++i)
           if (selected_properties[i])
-            cell_properties[i] = 0.0;
+            property_indices.push_back(i);
+
+        std::vector<double> cell_properties (n_particle_properties,numbers::signaling_nan<double>());
+
+        for (unsigned int i = 0; i < property_indices.size(); ++i)
+          cell_properties[property_indices[i]] = 0.0;
 
         if (n_particles > 0)
           {
             for (typename ParticleHandler<dim>::particle_iterator particle = particle_range.begin();
                  particle != particle_range.end(); ++particle)
               {
-                const ArrayView<const double> &particle_properties = particle->get_properties();
-
-                for (unsigned int i = 0; i < particle_properties.size(); ++i)
-                  if (selected_properties[i])
-                    cell_properties[i] += particle_properties[i];
+                for (unsigned int i = 0; i < property_indices.size(); ++i)
+                  cell_properties[property_indices[i]] += particle->get_property(property_indices[i]);
               }
 
-            for (unsigned int i = 0; i < n_particle_properties; ++i)
-              if (selected_properties[i])
-                cell_properties[i] /= n_particles;
+            for (unsigned int i = 0; i < property_indices.size(); ++i)
+              cell_properties[property_indices[i]] /= n_particles;
           }
         // If there are no particles in this cell use the average of the
         // neighboring cells.
@@ -95,22 +97,33 @@ namespace aspect
             std::vector<typename parallel::distributed::Triangulation<dim>::active_cell_iterator> neighbors;
             GridTools::get_active_neighbors<parallel::distributed::Triangulation<dim> >(found_cell,neighbors);
 
+            std::vector<double> neighbor_properties (n_particle_properties);
+
             unsigned int non_empty_neighbors = 0;
             for (unsigned int i=0; i<neighbors.size(); ++i)
               {
-                // Only recursively call this function if the neighbor cell contains
-                // particles (else we end up in an endless recursion)
-                if (particle_handler.n_particles_in_cell(neighbors[i]) == 0)
+                const typename ParticleHandler<dim>::particle_iterator_range neighbor_particle_range =
+                  particle_handler.particles_in_cell(neighbors[i]);
+
+                const unsigned int n_neighbor_particles = std::distance(neighbor_particle_range.begin(),
+                                                                        neighbor_particle_range.end());
+
+                if (n_neighbor_particles == 0)
                   continue;
 
-                const std::vector<double> neighbor_properties = properties_at_points(particle_handler,
-                                                                                     std::vector<Point<dim> > (1,neighbors[i]->center(true,false)),
-                                                                                     selected_properties,
-                                                                                     neighbors[i])[0];
+                // Average the properties of the neighbor cell, and add the
+                // average to the average of all neighbors
+                std::fill(neighbor_properties.begin(),neighbor_properties.end(),0.0);
+
+                for (typename ParticleHandler<dim>::particle_iterator particle = neighbor_particle_range.begin();
+                     particle != neighbor_particle_range.end(); ++particle)
+                  {
+                    for (unsigned int j = 0; j < property_indices.size(); ++j)
+                      neighbor_properties[property_indices[j]] += particle->get_property(property_indices[j]);
+                  }
 
-                for (unsigned int i = 0; i < n_particle_properties; ++i)
-                  if (selected_properties[i])
-                    cell_properties[i] += neighbor_properties[i];
+                for (unsigned int j = 0; j < property_indices.size(); ++j)
+                  cell_properties[property_indices[j]] += neighbor_properties[property_indices[j]] / n_neighbor_particles;
 
                 ++non_empty_neighbors;
               }
@@ -119,9 +132,8 @@ namespace aspect
                         ExcMessage("A cell and all of its neighbors do not contain any particles. "
                                    "The `cell average' interpolation scheme does not support this case."));
 
-            for (unsigned int i = 0; i < n_particle_properties; ++i)
-              if (selected_properties[i])
-                cell_properties[i] /= non_empty_neighbors;
+            for (unsigned int i = 0; i < property_indices.size(); ++i)
+              cell_properties[property_indices[i]] /= non_empty_neighbors;
           }
 
         return std::vector<std::vector<double> > (positions.size(),cell_properties);
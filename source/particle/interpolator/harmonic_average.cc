@@ -78,11 +78,9 @@ namespace aspect
             for (typename ParticleHandler<dim>::particle_iterator particle = particle_range.begin();
                  particle != particle_range.end(); ++particle)
               {
-                const ArrayView<const double> &particle_properties = particle->get_properties();
-
-                for (unsigned int i = 0; i < particle_properties.size(); ++i)
+                for (unsigned int i = 0; i < n_particle_properties; ++i)
                   if (selected_properties[i])
-                    cell_properties[i] += 1/particle_properties[i];
+                    cell_properties[i] += 1/particle->get_property(i);
               }
 
             for (unsigned int i = 0; i < n_particle_properties; ++i)
@@ -83,10 +83,9 @@ namespace aspect
                         nearest_neighbor = particle;
                       }
                   }
-                const dealii::ArrayView<const double> neighbor_props = nearest_neighbor->get_properties();
                 for (unsigned int i = 0; i < n_particle_properties; ++i)
                   if (selected_properties[i])
-                    point_properties[pos_idx][i] = neighbor_props[i];
+                    point_properties[pos_idx][i] = nearest_neighbor->get_property(i);
               }
             else
               {
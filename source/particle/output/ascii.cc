@@ -89,6 +89,7 @@ namespace aspect
         output << "\n";
 
         // And print the data for each particle
+        std::vector<double> properties;
         for (typename ParticleHandler<dim>::particle_iterator it=particle_handler.begin(); it!=particle_handler.end(); ++it)
           {
 
@@ -97,7 +98,7 @@ namespace aspect
 
             if (property_information.n_fields() > 0)
               {
-                const ArrayView<const double> properties = it->get_properties();
+                it->get_properties(properties);
 
                 for (unsigned int i = 0; i < properties.size(); ++i)
                   output << ' ' << properties[i];
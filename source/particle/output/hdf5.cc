@@ -46,14 +46,112 @@ namespace aspect
 
 #endif
 
+#ifdef DEAL_II_WITH_HDF5
+      namespace
+      {
+        /**
+         * Create a dataset with the given @p name in @p h5_file and write
+         * the locally owned entries of it from @p data. The dataset has
+         * rank @p rank and @p n_components components per entry (the
+         * latter is only used if @p rank is two). If @p chunk_size is not
+         * zero the dataset is stored in chunks of this many entries, which
+         * are compressed if @p compression_level is not zero.
+         */
+        void
+        write_dataset (const hid_t h5_file,
+                       const std::string &name,
+                       const hid_t memory_type,
+                       const hid_t file_type,
+                       const void *data,
+                       const unsigned int rank,
+                       const unsigned int n_components,
+                       const hsize_t n_global_entries,
+                       const hsize_t n_local_entries,
+                       const hsize_t local_offset,
+                       const hsize_t chunk_size,
+                       const unsigned int compression_level,
+                       const hid_t write_properties)
+        {
+          const hsize_t global_dataset_size[2] = {n_global_entries, n_components};
+          const hsize_t local_dataset_size[2] = {n_local_entries, n_components};
+          const hsize_t offset[2] = {local_offset, 0};
+
+          const hid_t dataspace = H5Screate_simple(rank, global_dataset_size, NULL);
+          const hid_t local_dataspace = H5Screate_simple(rank, local_dataset_size, NULL);
+
+          // Chunks may not be larger than the dataset, and empty datasets
+          // can not be chunked at all
+          const hid_t create_properties = H5Pcreate(H5P_DATASET_CREATE);
+          if ((chunk_size > 0) && (n_global_entries > 0))
+            {
+              const hsize_t chunk_dimensions[2] = {std::min(chunk_size, n_global_entries), n_components};
+              H5Pset_chunk(create_properties, rank, chunk_dimensions);
+
+              if (compression_level > 0)
+                {
+                  H5Pset_shuffle(create_properties);
+                  H5Pset_deflate(create_properties, compression_level);
+                }
+            }
+
+#if H5Dcreate_vers == 1
+          const hid_t dataset = H5Dcreate(h5_file, name.c_str(), file_type, dataspace, create_properties);
+#else
+          const hid_t dataset = H5Dcreate(h5_file, name.c_str(), file_type, dataspace, H5P_DEFAULT, create_properties, H5P_DEFAULT);
+#endif
+          H5Pclose(create_properties);
+
+          // Select the local hyperslab from the dataspace. Processes without
+          // data still need to take part in the collective write.
+          if (n_local_entries > 0)
+            H5Sselect_hyperslab(dataspace, H5S_SELECT_SET, offset, NULL, local_dataset_size, NULL);
+          else
+            {
+              H5Sselect_none(dataspace);
+              H5Sselect_none(local_dataspace);
+            }
+
+          // Write the data to the HDF5 file, converting it to the file type
+          // if necessary
+          H5Dwrite(dataset, memory_type, local_dataspace, dataspace, write_properties, data);
+
+          H5Sclose(local_dataspace);
+          H5Sclose(dataspace);
+          H5Dclose(dataset);
+        }
+      }
+#endif
+
+
+
       template <int dim>
       HDF5Output<dim>::HDF5Output()
         :
-        file_index(0)
+        file_index(0),
+        chunk_size(0),
+        compression_level(0),
+        write_single_precision(false),
+        output_id_interval(1),
+        write_in_background_thread(false),
+        output_communicator(MPI_COMM_NULL),
+        current_output_buffer(0)
       {}
 
 
 
+      template <int dim>
+      HDF5Output<dim>::~HDF5Output()
+      {
+        // make sure a thread that may still be running in the background,
+        // writing data, finishes
+        background_thread.join ();
+
+        if (output_communicator != MPI_COMM_NULL)
+          MPI_Comm_free(&output_communicator);
+      }
+
+
+
       template <int dim>
       void HDF5Output<dim>::initialize ()
       {
@@ -63,199 +161,271 @@ namespace aspect
                                  "so HDF5 output is not possible. Please "
                                  "recompile deal.ii with HDF5 support turned on "
                                  "or select a different particle output format."));
+#else
+#if defined(H5_HAVE_PARALLEL) && ((H5_VERS_MAJOR == 1) && ((H5_VERS_MINOR < 10) || ((H5_VERS_MINOR == 10) && (H5_VERS_RELEASE < 2))))
+        AssertThrow ((compression_level == 0)
+                     ||
+                     (Utilities::MPI::n_mpi_processes(this->get_mpi_communicator()) == 1),
+                     ExcMessage ("Writing compressed particle output in parallel requires "
+                                 "HDF5 version 1.10.2 or newer."));
+#endif
 #endif
 
         aspect::Utilities::create_directory (this->get_output_directory() + "particles/",
                                              this->get_mpi_communicator(),
                                              true);
+
+        // The background thread does its collective operations on a separate
+        // communicator, which requires full thread support from MPI if more
+        // than one process is involved. Otherwise we write synchronously,
+        // and tell the user that the requested setting has no effect.
+        if (write_in_background_thread
+            &&
+            (Utilities::MPI::n_mpi_processes(this->get_mpi_communicator()) > 1))
+          {
+            int provided_thread_support;
+            MPI_Query_thread(&provided_thread_support);
+            if (provided_thread_support < MPI_THREAD_MULTIPLE)
+              {
+                write_in_background_thread = false;
+                this->get_pcout() << std::endl
+                                  << "   ***** WARNING: The hdf5 particle output can only be written in a "
+                                  << "background thread in parallel computations if MPI provides "
+                                  << "MPI_THREAD_MULTIPLE thread support, which is not the case "
+                                  << "for this run. The parameter `Write in background thread' is "
+                                  << "ignored, and the particle output is written synchronously."
+                                  << std::endl << std::endl;
+              }
+          }
+
+        output_communicator = Utilities::MPI::duplicate_communicator(this->get_mpi_communicator());
       }
 
 
 
       template <int dim>
-      std::string
-      HDF5Output<dim>::output_particle_data(const ParticleHandler<dim> &particle_handler,
-                                            const Property::ParticlePropertyInformation &property_information,
-                                            const double current_time)
+      bool
+      HDF5Output<dim>::is_selected_for_output (const types::particle_index id,
+                                               const Point<dim> &location) const
       {
-#ifdef DEAL_II_WITH_HDF5
-        // Create the filename
-        const std::string output_file_prefix = "particles-" + Utilities::int_to_string (file_index, 5);
-        const std::string output_path_prefix =
-          this->get_output_directory()
-          + "particles/"
-          + output_file_prefix;
-        const std::string h5_filename = output_path_prefix+".h5";
-
-        // Create the hdf5 output size information
-        types::particle_index n_local_particles = particle_handler.n_locally_owned_particles();
-        const types::particle_index n_global_particles = particle_handler.n_global_particles();
+        if (id % output_id_interval != 0)
+          return false;
 
-        hsize_t global_dataset_size[2];
-        global_dataset_size[0] = n_global_particles;
-        global_dataset_size[1] = 3;
+        if (output_region_minimum.size() > 0)
+          for (unsigned int d=0; d<dim; ++d)
+            if ((location[d] < output_region_minimum[d]) || (location[d] > output_region_maximum[d]))
+              return false;
 
-        hsize_t local_dataset_size[2];
-        local_dataset_size[0] = n_local_particles;
-        local_dataset_size[1] = 3;
-
-        // Get the offset of the local particles among all processes
-        types::particle_index local_particle_index_offset;
-        MPI_Scan(&n_local_particles, &local_particle_index_offset, 1, ASPECT_PARTICLE_INDEX_MPI_TYPE, MPI_SUM, this->get_mpi_communicator());
-
-        hsize_t offset[2];
-        offset[0] = local_particle_index_offset - n_local_particles;
-        offset[1] = 0;
-
-        // Prepare the output data
-        std::vector<double> position_data (3 * n_local_particles,0.0);
-        std::vector<types::particle_index> index_data (n_local_particles);
-        std::vector<std::vector<double> > property_data;
-
-        // Resize the property vectors
-        for (unsigned int property = 0; property < property_information.n_fields(); ++property)
-          {
-            const unsigned int n_components = property_information.get_components_by_field_index(property);
-
-            if (n_components == dim)
-              property_data.push_back(std::vector<double> (3 * n_local_particles,0.0));
-            else
-              for (unsigned int component = 0; component < n_components; ++component)
-                property_data.push_back(std::vector<double> (1 * n_local_particles));
-          }
-
-        // Write into the output vectors
-        typename ParticleHandler<dim>::particle_iterator it = particle_handler.begin();
-        for (unsigned int i = 0; it != particle_handler.end(); ++i, ++it)
-          {
-            for (unsigned int d = 0; d < dim; ++d)
-              position_data[i*3+d] = it->get_location()(d);
-
-            index_data[i] = it->get_id();
-
-            const ArrayView<const double> properties = it->get_properties();
-
-            unsigned int particle_property_index = 0;
+        return true;
+      }
 
-            unsigned int output_field_index = 0;
-            for (unsigned int property = 0; property < property_information.n_fields(); ++property)
-              {
-                const unsigned int n_components = property_information.get_components_by_field_index(property);
-                if (n_components == dim)
-                  {
-                    for (unsigned int component = 0; component < n_components; ++component,++particle_property_index)
-                      property_data[output_field_index][i * 3 + component] = properties[particle_property_index];
 
-                    ++output_field_index;
-                  }
-                else
-                  for (unsigned int component = 0; component < n_components; ++component,++particle_property_index,++output_field_index)
-                    property_data[output_field_index][i] = properties[particle_property_index];
-              }
-          }
 
+      template <int dim>
+      void
+      HDF5Output<dim>::write_hdf5_file (const OutputBuffer *buffer,
+                                        const MPI_Comm communicator,
+                                        const unsigned int chunk_size,
+                                        const unsigned int compression_level,
+                                        const bool write_single_precision)
+      {
+#ifdef DEAL_II_WITH_HDF5
         // Create parallel file access
         const hid_t plist_id = H5Pcreate(H5P_FILE_ACCESS);
         // Create property list for collective dataset write
         const hid_t write_properties = H5Pcreate(H5P_DATASET_XFER);
 #ifdef H5_HAVE_PARALLEL
-        H5Pset_fapl_mpio(plist_id, this->get_mpi_communicator(), MPI_INFO_NULL);
+        H5Pset_fapl_mpio(plist_id, communicator, MPI_INFO_NULL);
         H5Pset_dxpl_mpio(write_properties, H5FD_MPIO_COLLECTIVE);
+#else
+        (void) communicator;
 #endif
 
         // Create the file
-        const hid_t h5_file = H5Fcreate(h5_filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, plist_id);
+        const hid_t h5_file = H5Fcreate(buffer->filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, plist_id);
         H5Pclose(plist_id);
 
-        // Write the position data
-        const hid_t position_dataspace = H5Screate_simple(2, global_dataset_size, NULL);
-        const hid_t local_position_dataspace = H5Screate_simple(2, local_dataset_size, NULL);
-
-#if H5Dcreate_vers == 1
-        hid_t position_dataset = H5Dcreate(h5_file, "nodes", H5T_NATIVE_DOUBLE, position_dataspace, H5P_DEFAULT);
-#else
-        hid_t position_dataset = H5Dcreate(h5_file, "nodes", H5T_NATIVE_DOUBLE, position_dataspace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-#endif
-
-        // Select the local hyperslab from the dataspace
-        H5Sselect_hyperslab(position_dataspace, H5S_SELECT_SET, offset, NULL, local_dataset_size, NULL);
-
-        // Write position data to the HDF5 file
-        H5Dwrite(position_dataset, H5T_NATIVE_DOUBLE, local_position_dataspace, position_dataspace, write_properties, &position_data[0]);
+        // HDF5 converts the data to single precision while writing if requested
+        const hid_t floating_point_file_type = (write_single_precision
+                                                ?
+                                                H5T_NATIVE_FLOAT
+                                                :
+                                                H5T_NATIVE_DOUBLE);
 
-        H5Sclose(local_position_dataspace);
-        H5Sclose(position_dataspace);
-        H5Dclose(position_dataset);
+        // Write the position data
+        write_dataset(h5_file, "nodes", H5T_NATIVE_DOUBLE, floating_point_file_type,
+                      (buffer->positions.size() > 0 ? &buffer->positions[0] : NULL),
+                      2, 3,
+                      buffer->n_global_particles, buffer->n_local_particles, buffer->local_particle_offset,
+                      chunk_size, compression_level, write_properties);
 
         // Write the index data
+        write_dataset(h5_file, "id", HDF5_PARTICLE_INDEX_TYPE, HDF5_PARTICLE_INDEX_TYPE,
+                      (buffer->ids.size() > 0 ? &buffer->ids[0] : NULL),
+                      1, 1,
+                      buffer->n_global_particles, buffer->n_local_particles, buffer->local_particle_offset,
+                      chunk_size, compression_level, write_properties);
 
-        global_dataset_size[1] = 1;
-        local_dataset_size[1] = 1;
-        const hid_t index_dataspace = H5Screate_simple(1, global_dataset_size, NULL);
-        const hid_t local_index_dataspace = H5Screate_simple(1, local_dataset_size, NULL);
-#if H5Dcreate_vers == 1
-        const hid_t particle_index_dataset = H5Dcreate(h5_file, "id", HDF5_PARTICLE_INDEX_TYPE, index_dataspace, H5P_DEFAULT);
+        // Write the property data
+        for (unsigned int i = 0; i < buffer->properties.size(); ++i)
+          write_dataset(h5_file, buffer->property_names[i], H5T_NATIVE_DOUBLE,
+                        (buffer->property_single_precision[i] ? H5T_NATIVE_FLOAT : floating_point_file_type),
+                        (buffer->properties[i].size() > 0 ? &buffer->properties[i][0] : NULL),
+                        2, buffer->property_components[i],
+                        buffer->n_global_particles, buffer->n_local_particles, buffer->local_particle_offset,
+                        chunk_size, compression_level, write_properties);
+
+        H5Pclose(write_properties);
+        H5Fclose(h5_file);
 #else
-        const hid_t particle_index_dataset = H5Dcreate(h5_file, "id", HDF5_PARTICLE_INDEX_TYPE, index_dataspace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+        (void) buffer;
+        (void) communicator;
+        (void) chunk_size;
+        (void) compression_level;
+        (void) write_single_precision;
 #endif
+      }
 
-        // Select the local hyperslab from the dataspace
-        H5Sselect_hyperslab(index_dataspace, H5S_SELECT_SET, offset, NULL, local_dataset_size, NULL);
 
-        // Write index data to the HDF5 file
-        H5Dwrite(particle_index_dataset, HDF5_PARTICLE_INDEX_TYPE, local_index_dataspace, index_dataspace, write_properties, &index_data[0]);
 
-        H5Sclose(local_index_dataspace);
-        H5Sclose(index_dataspace);
-        H5Dclose(particle_index_dataset);
+      template <int dim>
+      std::string
+      HDF5Output<dim>::output_particle_data(const ParticleHandler<dim> &particle_handler,
+                                            const Property::ParticlePropertyInformation &property_information,
+                                            const double current_time)
+      {
+#ifdef DEAL_II_WITH_HDF5
+        // Create the filename
+        const std::string output_file_prefix = "particles-" + Utilities::int_to_string (file_index, 5);
+        const std::string output_path_prefix =
+          this->get_output_directory()
+          + "particles/"
+          + output_file_prefix;
 
-        // Write the property data
-        unsigned int output_index = 0;
-        for (unsigned int property = 0; property != property_information.n_fields(); ++property)
+        // Fill the buffer that is not used by a write operation that may
+        // still run in the background. This buffer was last used two
+        // output steps ago, and that write operation finished before the
+        // previous one was started.
+        OutputBuffer &buffer = output_buffers[current_output_buffer];
+        buffer.filename = output_path_prefix+".h5";
+
+        // Determine the datasets of the properties. Properties with dim
+        // components are written as vectors padded to 3 components, all other
+        // properties as one dataset per component.
+        const PropertyPool &property_pool = particle_handler.get_property_pool();
+        buffer.property_names.clear();
+        buffer.property_components.clear();
+        buffer.property_single_precision.clear();
+        for (unsigned int property = 0; property < property_information.n_fields(); ++property)
           {
             const unsigned int n_components = property_information.get_components_by_field_index(property);
-            const unsigned int data_components = ((n_components == dim)
-                                                  ?
-                                                  3
-                                                  :
-                                                  1);
-            const unsigned int data_fields = ((n_components == dim) || (n_components == 1)) ?
-                                             1
-                                             :
-                                             n_components;
-
-            global_dataset_size[1] = data_components;
-            local_dataset_size[1] = data_components;
-
-            for (unsigned int i = 0; i < data_fields; ++i)
+            const std::string field_name = property_information.get_field_name_by_index(property);
+            const unsigned int first_component = property_information.get_position_by_field_index(property);
+
+            if (n_components == dim)
               {
-                std::string field_name = property_information.get_field_name_by_index(property);
-                if (data_fields > 1)
-                  field_name.append('_' + Utilities::to_string(i));
+                bool single_precision = false;
+                for (unsigned int component = 0; component < n_components; ++component)
+                  single_precision |= property_pool.is_single_precision(first_component+component);
 
-                const hid_t property_dataspace = H5Screate_simple(2, global_dataset_size, NULL);
-                const hid_t local_property_dataspace = H5Screate_simple(2, local_dataset_size, NULL);
-#if H5Dcreate_vers == 1
-                const hid_t particle_property_dataset = H5Dcreate(h5_file, field_name.c_str(), H5T_NATIVE_DOUBLE, property_dataspace, H5P_DEFAULT);
-#else
-                const hid_t particle_property_dataset = H5Dcreate(h5_file, field_name.c_str(), H5T_NATIVE_DOUBLE, property_dataspace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-#endif
+                buffer.property_names.push_back(field_name);
+                buffer.property_components.push_back(3);
+                buffer.property_single_precision.push_back(single_precision);
+              }
+            else if (n_components == 1)
+              {
+                buffer.property_names.push_back(field_name);
+                buffer.property_components.push_back(1);
+                buffer.property_single_precision.push_back(property_pool.is_single_precision(first_component));
+              }
+            else
+              for (unsigned int component = 0; component < n_components; ++component)
+                {
+                  buffer.property_names.push_back(field_name + "_" + Utilities::to_string(component));
+                  buffer.property_components.push_back(1);
+                  buffer.property_single_precision.push_back(property_pool.is_single_precision(first_component+component));
+                }
+          }
+
+        // Collect the output data of all selected particles in one pass
+        const types::particle_index n_locally_owned_particles = particle_handler.n_locally_owned_particles();
+        buffer.positions.clear();
+        buffer.positions.reserve(3 * n_locally_owned_particles);
+        buffer.ids.clear();
+        buffer.ids.reserve(n_locally_owned_particles);
+        buffer.properties.resize(buffer.property_names.size());
+        for (unsigned int i = 0; i < buffer.properties.size(); ++i)
+          {
+            buffer.properties[i].clear();
+            buffer.properties[i].reserve(buffer.property_components[i] * n_locally_owned_particles);
+          }
+
+        std::vector<double> properties;
+        for (typename ParticleHandler<dim>::particle_iterator it = particle_handler.begin();
+             it != particle_handler.end(); ++it)
+          {
+            const Point<dim> location = it->get_location();
+            if (!is_selected_for_output(it->get_id(), location))
+              continue;
+
+            for (unsigned int d = 0; d < 3; ++d)
+              buffer.positions.push_back(d < dim ? location[d] : 0.0);
 
-                // Select the local hyperslab from the dataspace
-                H5Sselect_hyperslab(property_dataspace, H5S_SELECT_SET, offset, NULL, local_dataset_size, NULL);
+            buffer.ids.push_back(it->get_id());
 
-                // Write index data to the HDF5 file
-                H5Dwrite(particle_property_dataset, H5T_NATIVE_DOUBLE, local_property_dataspace, property_dataspace, write_properties, &property_data[output_index][0]);
+            if (buffer.properties.size() > 0)
+              {
+                it->get_properties(properties);
 
-                H5Sclose(local_property_dataspace);
-                H5Sclose(property_dataspace);
-                H5Dclose(particle_property_dataset);
-                ++output_index;
+                unsigned int particle_property_index = 0;
+                unsigned int output_field_index = 0;
+                for (unsigned int property = 0; property < property_information.n_fields(); ++property)
+                  {
+                    const unsigned int n_components = property_information.get_components_by_field_index(property);
+                    if (n_components == dim)
+                      {
+                        for (unsigned int component = 0; component < 3; ++component)
+                          buffer.properties[output_field_index].push_back(component < n_components
+                                                                          ?
+                                                                          properties[particle_property_index+component]
+                                                                          :
+                                                                          0.0);
+
+                        particle_property_index += n_components;
+                        ++output_field_index;
+                      }
+                    else
+                      for (unsigned int component = 0; component < n_components; ++component,++particle_property_index,++output_field_index)
+                        buffer.properties[output_field_index].push_back(properties[particle_property_index]);
+                  }
               }
           }
 
-        H5Pclose(write_properties);
-        H5Fclose(h5_file);
+        // Get the offset of the local particles among all processes
+        buffer.n_local_particles = buffer.ids.size();
+        types::particle_index local_particle_index_offset;
+        MPI_Scan(&buffer.n_local_particles, &local_particle_index_offset, 1, ASPECT_PARTICLE_INDEX_MPI_TYPE, MPI_SUM, this->get_mpi_communicator());
+        buffer.local_particle_offset = local_particle_index_offset - buffer.n_local_particles;
+        buffer.n_global_particles = Utilities::MPI::sum(buffer.n_local_particles, this->get_mpi_communicator());
+
+        if (write_in_background_thread)
+          {
+            // Wait for the previous write operation to finish, should it
+            // still be active,
+            background_thread.join ();
+
+            // then continue with writing our own data.
+            background_thread = Threads::new_thread (&HDF5Output<dim>::write_hdf5_file,
+                                                     static_cast<const OutputBuffer *>(&buffer),
+                                                     output_communicator,
+                                                     chunk_size,
+                                                     compression_level,
+                                                     write_single_precision);
+          }
+        else
+          write_hdf5_file(&buffer, output_communicator, chunk_size, compression_level, write_single_precision);
+
+        current_output_buffer = 1 - current_output_buffer;
 
         // Record and output XDMF info on root process
         if (Utilities::MPI::this_mpi_process(this->get_mpi_communicator()) == 0)
@@ -264,24 +434,14 @@ namespace aspect
               "particles/"
               + output_file_prefix
               + ".h5";
-            XDMFEntry   entry(local_h5_filename, current_time, n_global_particles, 0, 3);
+            XDMFEntry   entry(local_h5_filename, current_time, buffer.n_global_particles, 0, 3);
             DataOut<dim> data_out;
             const std::string xdmf_filename = (this->get_output_directory() + "particles.xdmf");
 
             entry.add_attribute("id", 1);
 
-            for (unsigned int property = 0; property < property_information.n_fields(); ++property)
-              {
-                const unsigned int n_components = property_information.get_components_by_field_index(property);
-
-                if (n_components == 1)
-                  entry.add_attribute(property_information.get_field_name_by_index(property), 1);
-                else if (n_components == dim)
-                  entry.add_attribute(property_information.get_field_name_by_index(property), 3);
-                else
-                  for (unsigned int component = 0; component < n_components; ++component)
-                    entry.add_attribute(property_information.get_field_name_by_index(property) + "_" + Utilities::to_string(component), 1);
-              }
+            for (unsigned int i = 0; i < buffer.property_names.size(); ++i)
+              entry.add_attribute(buffer.property_names[i], buffer.property_components[i]);
 
             xdmf_entries.push_back(entry);
 
@@ -327,6 +487,104 @@ namespace aspect
         aspect::iarchive ia (is);
         ia >> (*this);
       }
+
+
+
+      template <int dim>
+      void
+      HDF5Output<dim>::declare_parameters (ParameterHandler &prm)
+      {
+        prm.enter_subsection("Postprocess");
+        {
+          prm.enter_subsection("Particles");
+          {
+            prm.enter_subsection("Output");
+            {
+              prm.enter_subsection("Hdf5");
+              {
+                prm.declare_entry ("Chunk size", "0",
+                                   Patterns::Integer (0),
+                                   "The number of particles that are stored together in one chunk "
+                                   "of the hdf5 datasets. Chunked datasets are required for "
+                                   "compression, in which case a value of the order of 65536 is "
+                                   "a reasonable choice. A value of zero writes contiguous "
+                                   "datasets, which is the layout of files written by earlier "
+                                   "versions of this plugin.");
+                prm.declare_entry ("Compression level", "0",
+                                   Patterns::Integer (0,9),
+                                   "The level of the deflate (zlib) compression of the hdf5 "
+                                   "datasets, between 1 (fastest) and 9 (smallest files). A value "
+                                   "of zero disables compression.");
+                prm.declare_entry ("Write single precision", "false",
+                                   Patterns::Bool (),
+                                   "Whether to store positions and particle properties as single "
+                                   "precision floating point numbers, which halves the size of "
+                                   "the files.");
+                prm.declare_entry ("Particle id interval", "1",
+                                   Patterns::Integer (1),
+                                   "Only write particles whose id is a multiple of this number. "
+                                   "This selects a subset of the particles that stays the same "
+                                   "between output steps.");
+                prm.declare_entry ("Output region minimum", "",
+                                   Patterns::List (Patterns::Double ()),
+                                   "If not empty, only particles inside the box between this "
+                                   "point and the point given in `Output region maximum' are "
+                                   "written. The point is given as a comma separated list of "
+                                   "its dim coordinates.");
+                prm.declare_entry ("Output region maximum", "",
+                                   Patterns::List (Patterns::Double ()),
+                                   "The upper corner of the output region, see "
+                                   "`Output region minimum'.");
+              }
+              prm.leave_subsection ();
+            }
+            prm.leave_subsection ();
+          }
+          prm.leave_subsection ();
+        }
+        prm.leave_subsection ();
+      }
+
+
+      template <int dim>
+      void
+      HDF5Output<dim>::parse_parameters (ParameterHandler &prm)
+      {
+        prm.enter_subsection("Postprocess");
+        {
+          prm.enter_subsection("Particles");
+          {
+            write_in_background_thread = prm.get_bool("Write in background thread");
+
+            prm.enter_subsection("Output");
+            {
+              prm.enter_subsection("Hdf5");
+              {
+                chunk_size = prm.get_integer ("Chunk size");
+                compression_level = prm.get_integer ("Compression level");
+                write_single_precision = prm.get_bool ("Write single precision");
+                output_id_interval = prm.get_integer ("Particle id interval");
+
+                output_region_minimum = Utilities::string_to_double(Utilities::split_string_list(prm.get ("Output region minimum")));
+                output_region_maximum = Utilities::string_to_double(Utilities::split_string_list(prm.get ("Output region maximum")));
+
+                AssertThrow ((compression_level == 0) || (chunk_size > 0),
+                             ExcMessage ("Compressed hdf5 particle output requires a chunk size "
+                                         "larger than zero."));
+                AssertThrow ((output_region_minimum.size() == output_region_maximum.size())
+                             &&
+                             ((output_region_minimum.size() == 0) || (output_region_minimum.size() == dim)),
+                             ExcMessage ("The parameters `Output region minimum' and `Output region maximum' "
+                                         "need to be either both empty or both contain dim coordinates."));
+              }
+              prm.leave_subsection ();
+            }
+            prm.leave_subsection ();
+          }
+          prm.leave_subsection ();
+        }
+        prm.leave_subsection ();
+      }
     }
   }
 }
@@ -343,7 +601,17 @@ namespace aspect
       ASPECT_REGISTER_PARTICLE_OUTPUT(HDF5Output,
                                       "hdf5",
                                       "This particle output plugin writes particle "
-                                      "positions and properties into hdf5 files.")
+                                      "positions and properties into hdf5 files. The "
+                                      "datasets can be chunked and compressed, stored in "
+                                      "single precision, and restricted to a reproducible "
+                                      "subset of the particles, see the `Output/Hdf5' "
+                                      "subsection. If the parameter `Write in background thread' "
+                                      "is set, the files are written by a separate thread while "
+                                      "the model continues. This requires an hdf5 library that "
+                                      "was built thread-safe (with --enable-threadsafe), and in "
+                                      "parallel computations an MPI library that provides "
+                                      "MPI_THREAD_MULTIPLE thread support; otherwise the files are "
+                                      "written synchronously.")
     }
   }
 }
@@ -19,22 +19,156 @@
  */
 
 #include <aspect/particle/output/vtu.h>
+#include <aspect/postprocess/particles.h>
 #include <aspect/utilities.h>
 
 #include <deal.II/numerics/data_out.h>
 
+#ifdef DEAL_II_WITH_ZLIB
+#  include <zlib.h>
+#endif
+
+#include <stdint.h>
+
 namespace aspect
 {
   namespace Particle
   {
     namespace Output
     {
+      namespace
+      {
+        /**
+         * Information about one data array in the vtu file: its name, the
+         * number of components written to the file (vectors are padded to
+         * three components), and the range of particle properties it
+         * contains. The next member indicates whether the array contains
+         * only one of several components of a property field, and the last
+         * one whether it is written in single precision in binary output.
+         */
+        struct DataArrayInformation
+        {
+          std::string name;
+          unsigned int n_output_components;
+          unsigned int first_property;
+          unsigned int n_properties;
+          bool is_field_component;
+          bool single_precision;
+        };
+
+        /**
+         * Append the content of @p data to @p appended_data in the format
+         * VTK expects for raw appended data with a UInt64 header, i.e.
+         * preceded by its size in bytes, or if @p compress is set as one
+         * zlib compressed block preceded by the compression header.
+         */
+        template <typename T>
+        void
+        append_binary_data (const std::vector<T> &data,
+                            const bool compress,
+                            std::string &appended_data)
+        {
+          const uint64_t n_bytes = data.size() * sizeof(T);
+          const char *raw_data = (data.size() > 0
+                                  ?
+                                  reinterpret_cast<const char *>(&data[0])
+                                  :
+                                  NULL);
+
+          if (compress == false)
+            {
+              appended_data.append(reinterpret_cast<const char *>(&n_bytes), sizeof(n_bytes));
+              if (n_bytes > 0)
+                appended_data.append(raw_data, n_bytes);
+              return;
+            }
+
+#ifdef DEAL_II_WITH_ZLIB
+          if (n_bytes == 0)
+            {
+              const uint64_t compression_header[3] = { 0, 0, 0 };
+              appended_data.append(reinterpret_cast<const char *>(compression_header),
+                                   sizeof(compression_header));
+              return;
+            }
+
+          uLongf compressed_data_length = compressBound (n_bytes);
+          std::vector<char> compressed_data (compressed_data_length);
+          const int err = compress2 ((Bytef *) &compressed_data[0],
+                                     &compressed_data_length,
+                                     (const Bytef *) raw_data,
+                                     n_bytes,
+                                     Z_BEST_SPEED);
+          AssertThrow (err == Z_OK,
+                       ExcMessage ("Compressing the particle output data with zlib failed."));
+
+          const uint64_t compression_header[4]
+            = { 1,                                 /* number of blocks */
+                n_bytes,                           /* size of block */
+                n_bytes,                           /* size of last block */
+                (uint64_t) compressed_data_length  /* compressed size of block */
+              };
+          appended_data.append(reinterpret_cast<const char *>(compression_header),
+                               sizeof(compression_header));
+          appended_data.append(&compressed_data[0], compressed_data_length);
+#else
+          AssertThrow (false,
+                       ExcMessage ("You need to have deal.II configured with the `libz' "
+                                   "option to write compressed particle output."));
+#endif
+        }
+
+        /**
+         * Same as above, but for floating point data that is optionally
+         * converted to single precision before being written.
+         */
+        void
+        append_floating_point_data (const std::vector<double> &data,
+                                    const bool single_precision,
+                                    const bool compress,
+                                    std::string &appended_data)
+        {
+          if (single_precision)
+            {
+              const std::vector<float> single_precision_data (data.begin(), data.end());
+              append_binary_data (single_precision_data, compress, appended_data);
+            }
+          else
+            append_binary_data (data, compress, appended_data);
+        }
+
+        /**
+         * Return whether this machine stores numbers in little endian byte
+         * order, which determines the byte order of the binary output.
+         */
+        bool
+        is_little_endian ()
+        {
+          const unsigned int one = 1;
+          return (*reinterpret_cast<const unsigned char *>(&one) == 1);
+        }
+      }
+
+
+
       template <int dim>
       VTUOutput<dim>::VTUOutput()
         :
-        file_index(0)
+        file_index(0),
+        write_binary_output(false),
+        compress_output(false),
+        write_single_precision(false),
+        write_in_background_thread(false)
       {}
 
+      template <int dim>
+      VTUOutput<dim>::~VTUOutput()
+      {
+        // make sure a thread that may still be running in the background,
+        // writing data, finishes
+        background_thread.join ();
+      }
+
       template <int dim>
       void VTUOutput<dim>::initialize ()
       {
@@ -62,121 +196,261 @@ namespace aspect
                                           + "particles/"
                                           + filename;
 
-        std::ofstream output (full_filename.c_str());
-        AssertThrow (output, ExcIO());
-
         const unsigned int n_particles = particle_handler.n_locally_owned_particles();
 
+        // Determine which data arrays we write. If a property has one component
+        // or as many components as spatial dimensions, output it as one
+        // scalar / vector field. Vector fields are padded with zeroes to
+        // 3 dimensions (vtk limitation). Otherwise create n_components scalar fields.
+        // Binary output of properties that are only stored in single precision
+        // is always written in single precision.
+        const PropertyPool &property_pool = particle_handler.get_property_pool();
+        std::vector<DataArrayInformation> data_arrays;
+        {
+          unsigned int data_offset = 0;
+          for (unsigned int field_index = 0; field_index < property_information.n_fields(); ++field_index)
+            {
+              const unsigned int n_components = property_information.get_components_by_field_index(field_index);
+              const std::string field_name = property_information.get_field_name_by_index(field_index);
+
+              if ((n_components == 1) || (n_components == dim))
+                {
+                  bool single_precision = write_single_precision;
+                  for (unsigned int d=0; d<n_components; ++d)
+                    single_precision |= property_pool.is_single_precision(data_offset+d);
+
+                  const DataArrayInformation array = {field_name, (n_components == 1 ? 1u : 3u), data_offset, n_components, false,
+                                                      single_precision
+                                                     };
+                  data_arrays.push_back(array);
+                }
+              else
+                for (unsigned int d=0; d<n_components; ++d)
+                  {
+                    const DataArrayInformation array = {field_name + "_" + Utilities::int_to_string(d), 1, data_offset+d, 1, true,
+                                                        write_single_precision || property_pool.is_single_precision(data_offset+d)
+                                                       };
+                    data_arrays.push_back(array);
+                  }
+
+              data_offset += n_components;
+            }
+        }
+
+        // Gather the positions, ids and properties of all particles in a
+        // single pass over the particles into contiguous arrays
+        std::vector<double> positions (3 * n_particles, 0.0);
+        std::vector<uint64_t> ids (n_particles);
+        std::vector<std::vector<double> > data (data_arrays.size());
+        for (unsigned int i=0; i<data_arrays.size(); ++i)
+          data[i].resize(data_arrays[i].n_output_components * n_particles, 0.0);
+
+        {
+          std::vector<double> particle_data;
+          unsigned int particle_index = 0;
+          for (typename ParticleHandler<dim>::particle_iterator
+               it=particle_handler.begin(); it!=particle_handler.end(); ++it, ++particle_index)
+            {
+              const Point<dim> location = it->get_location();
+              for (unsigned int d=0; d<dim; ++d)
+                positions[3*particle_index+d] = location[d];
+
+              ids[particle_index] = it->get_id();
+
+              if (data_arrays.size() > 0)
+                {
+                  it->get_properties(particle_data);
+                  for (unsigned int i=0; i<data_arrays.size(); ++i)
+                    for (unsigned int d=0; d<data_arrays[i].n_properties; ++d)
+                      data[i][data_arrays[i].n_output_components*particle_index+d]
+                        = particle_data[data_arrays[i].first_property+d];
+                }
+            }
+        }
+
+        const std::string float_type = ((write_binary_output && write_single_precision)
+                                        ?
+                                        "Float32"
+                                        :
+                                        "Float64");
+        const std::string byte_order = (is_little_endian() ? "LittleEndian" : "BigEndian");
+
+        // For binary output, all data arrays are stored in raw form at the
+        // end of the file and the xml headers only reference their offsets
+        std::string appended_data;
+        std::ostringstream output;
+
         // Write VTU file XML
         output << "<?xml version=\"1.0\"?>\n";
-        output << "<VTKFile type=\"UnstructuredGrid\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
+        if (write_binary_output)
+          output << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"" << byte_order
+                 << "\" header_type=\"UInt64\""
+                 << (compress_output ? " compressor=\"vtkZLibDataCompressor\"" : "")
+                 << ">\n";
+        else
+          output << "<VTKFile type=\"UnstructuredGrid\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
         output << "  <UnstructuredGrid>\n";
         output << "    <Piece NumberOfPoints=\"" << n_particles << "\" NumberOfCells=\"" << n_particles << "\">\n";
 
-        // Go through the particles on this domain and print the position of each one
+        // Write the position of each particle on this domain
         output << "      <Points>\n";
-        output << "        <DataArray name=\"Position\" type=\"Float64\" NumberOfComponents=\"3\" Format=\"ascii\">\n";
-        for (typename ParticleHandler<dim>::particle_iterator
-             it=particle_handler.begin(); it!=particle_handler.end(); ++it)
+        if (write_binary_output)
+          {
+            output << "        <DataArray Name=\"Position\" type=\"" << float_type
+                   << "\" NumberOfComponents=\"3\" format=\"appended\" offset=\"" << appended_data.size() << "\"/>\n";
+            append_floating_point_data (positions, write_single_precision, compress_output, appended_data);
+          }
+        else
           {
-            output << "          " << it->get_location();
+            output << "        <DataArray name=\"Position\" type=\"Float64\" NumberOfComponents=\"3\" Format=\"ascii\">\n";
+            for (unsigned int i=0; i<n_particles; ++i)
+              {
+                output << "          " << positions[3*i];
+                for (unsigned int d=1; d<dim; ++d)
+                  output << ' ' << positions[3*i+d];
 
-            // pad with zeros since VTU format wants x/y/z coordinates
-            for (unsigned int d=dim; d<3; ++d)
-              output << " 0.0";
+                // pad with zeros since VTU format wants x/y/z coordinates
+                for (unsigned int d=dim; d<3; ++d)
+                  output << " 0.0";
 
-            output << "\n";
+                output << "\n";
+              }
+            output << "        </DataArray>\n";
           }
-        output << "        </DataArray>\n";
         output << "      </Points>\n";
 
         // Write cell related data (empty)
         output << "      <Cells>\n";
-        output << "        <DataArray type=\"Int32\" Name=\"connectivity\" Format=\"ascii\">\n";
-        for (unsigned int i=1; i<=n_particles; ++i)
-          output << "          " << i-1 << "\n";
-        output << "        </DataArray>\n";
-        output << "        <DataArray type=\"Int32\" Name=\"offsets\" Format=\"ascii\">\n";
-        for (unsigned int i=1; i<=n_particles; ++i)
-          output << "          " << i << "\n";
-        output << "        </DataArray>\n";
-        output << "        <DataArray type=\"UInt8\" Name=\"types\" Format=\"ascii\">\n";
-        for (unsigned int i=1; i<=n_particles; ++i)
-          output << "          1\n";
-        output << "        </DataArray>\n";
+        if (write_binary_output)
+          {
+            std::vector<int32_t> cell_data (n_particles);
+            for (unsigned int i=0; i<n_particles; ++i)
+              cell_data[i] = i;
+            output << "        <DataArray type=\"Int32\" Name=\"connectivity\" format=\"appended\" offset=\""
+                   << appended_data.size() << "\"/>\n";
+            append_binary_data (cell_data, compress_output, appended_data);
+
+            for (unsigned int i=0; i<n_particles; ++i)
+              cell_data[i] = i+1;
+            output << "        <DataArray type=\"Int32\" Name=\"offsets\" format=\"appended\" offset=\""
+                   << appended_data.size() << "\"/>\n";
+            append_binary_data (cell_data, compress_output, appended_data);
+
+            const std::vector<uint8_t> cell_types (n_particles, 1);
+            output << "        <DataArray type=\"UInt8\" Name=\"types\" format=\"appended\" offset=\""
+                   << appended_data.size() << "\"/>\n";
+            append_binary_data (cell_types, compress_output, appended_data);
+          }
+        else
+          {
+            output << "        <DataArray type=\"Int32\" Name=\"connectivity\" Format=\"ascii\">\n";
+            for (unsigned int i=1; i<=n_particles; ++i)
+              output << "          " << i-1 << "\n";
+            output << "        </DataArray>\n";
+            output << "        <DataArray type=\"Int32\" Name=\"offsets\" Format=\"ascii\">\n";
+            for (unsigned int i=1; i<=n_particles; ++i)
+              output << "          " << i << "\n";
+            output << "        </DataArray>\n";
+            output << "        <DataArray type=\"UInt8\" Name=\"types\" Format=\"ascii\">\n";
+            for (unsigned int i=1; i<=n_particles; ++i)
+              output << "          1\n";
+            output << "        </DataArray>\n";
+          }
         output << "      </Cells>\n";
 
         // Write data for each particle (id, velocity, etc)
         output << "      <PointData Scalars=\"scalars\">\n";
 
-        output << "        <DataArray type=\"UInt64\" Name=\"id\" NumberOfComponents=\"1\" Format=\"ascii\">\n";
-        for (typename ParticleHandler<dim>::particle_iterator
-             it=particle_handler.begin(); it!=particle_handler.end(); ++it)
-          output << "          " << it->get_id() << "\n" ;
-
-        output << "        </DataArray>\n";
+        if (write_binary_output)
+          {
+            output << "        <DataArray type=\"UInt64\" Name=\"id\" NumberOfComponents=\"1\" format=\"appended\" offset=\""
+                   << appended_data.size() << "\"/>\n";
+            append_binary_data (ids, compress_output, appended_data);
+          }
+        else
+          {
+            output << "        <DataArray type=\"UInt64\" Name=\"id\" NumberOfComponents=\"1\" Format=\"ascii\">\n";
+            for (unsigned int i=0; i<n_particles; ++i)
+              output << "          " << ids[i] << "\n" ;
+            output << "        </DataArray>\n";
+          }
 
         // Print the data associated with the particles
-        unsigned int data_offset = 0;
-
-        for (unsigned int field_index = 0; field_index < property_information.n_fields(); ++field_index)
+        for (unsigned int i=0; i<data_arrays.size(); ++i)
           {
-            const unsigned int n_components = property_information.get_components_by_field_index(field_index);
+            const unsigned int n_output_components = data_arrays[i].n_output_components;
 
-            // If this is a property with one component or as many components
-            // as spatial dimensions, output it as one scalar / vector field.
-            // Vector fields are padded with zeroes to 3 dimensions (vtk limitation).
-            if ((n_components == 1) || (n_components == dim))
+            if (write_binary_output)
               {
-                output << "        <DataArray type=\"Float64\" Name=\""
-                       << property_information.get_field_name_by_index(field_index)
-                       << "\" NumberOfComponents=\"" << (n_components == 1 ? 1 : 3)
-                       << "\" Format=\"ascii\">\n";
-                for (typename ParticleHandler<dim>::particle_iterator
-                     it=particle_handler.begin(); it!=particle_handler.end(); ++it)
-                  {
-                    const ArrayView<const double> particle_data = it->get_properties();
-
-                    output << "         ";
-                    for (unsigned int d=0; d < n_components; ++d)
-                      output << ' ' << particle_data[data_offset+d];
-
-                    if (n_components == 2)
-                      output << " 0";
-                    output << "\n";
-                  }
-                data_offset += n_components;
-                output << "        </DataArray>\n";
+                output << "        <DataArray type=\"" << (data_arrays[i].single_precision ? "Float32" : "Float64")
+                       << "\" Name=\"" << data_arrays[i].name
+                       << "\" NumberOfComponents=\"" << n_output_components
+                       << "\" format=\"appended\" offset=\"" << appended_data.size() << "\"/>\n";
+                append_floating_point_data (data[i], data_arrays[i].single_precision, compress_output, appended_data);
               }
-            // Otherwise create n_components scalar fields
             else
               {
-                for (unsigned int d=0; d<n_components; ++d)
+                output << "        <DataArray type=\"Float64\" Name=\"" << data_arrays[i].name
+                       << "\" NumberOfComponents=\"" << n_output_components
+                       << "\" Format=\"ascii\">\n";
+
+                for (unsigned int p=0; p<n_particles; ++p)
                   {
-                    output << "        <DataArray type=\"Float64\" Name=\""
-                           << property_information.get_field_name_by_index(field_index) << '_' << d
-                           << "\" NumberOfComponents=\"1"
-                           << "\" Format=\"ascii\">\n";
-                    for (typename ParticleHandler<dim>::particle_iterator
-                         it=particle_handler.begin(); it!=particle_handler.end(); ++it)
+                    const double *particle_data = &data[i][n_output_components*p];
+
+                    if (data_arrays[i].is_field_component)
+                      output << particle_data[0] << "\n";
+                    else
                       {
-                        const ArrayView<const double> particle_data = it->get_properties();
+                        output << "         ";
+                        for (unsigned int d=0; d < data_arrays[i].n_properties; ++d)
+                          output << ' ' << particle_data[d];
 
-                        output << particle_data[data_offset+d] << "\n";
+                        if (data_arrays[i].n_properties == 2)
+                          output << " 0";
+                        output << "\n";
                       }
-                    output << "        </DataArray>\n";
                   }
-                data_offset += n_components;
-
+                output << "        </DataArray>\n";
               }
           }
         output << "      </PointData>\n";
 
         output << "    </Piece>\n";
         output << "  </UnstructuredGrid>\n";
-        output << "</VTKFile>\n";
 
-        output.close();
+        if (write_binary_output)
+          output << "  <AppendedData encoding=\"raw\">\n_";
+        else
+          output << "</VTKFile>\n";
+
+        // Put the content we want to write into a string object that
+        // we can then write in the background
+        std::string *file_contents = new std::string (output.str());
+        if (write_binary_output)
+          {
+            file_contents->reserve (file_contents->size() + appended_data.size() + 30);
+            file_contents->append (appended_data);
+            file_contents->append ("\n  </AppendedData>\n</VTKFile>\n");
+
+            // release the memory of the data arrays before writing
+            std::string().swap(appended_data);
+          }
+
+        if (write_in_background_thread)
+          {
+            // Wait for all previous write operations to finish, should
+            // any be still active,
+            background_thread.join ();
+
+            // then continue with writing our own data.
+            background_thread = Threads::new_thread (&aspect::Postprocess::Particles<dim>::writer,
+                                                     full_filename,
+                                                     temporary_output_location,
+                                                     static_cast<const std::string *>(file_contents));
+          }
+        else
+          aspect::Postprocess::Particles<dim>::writer(full_filename,temporary_output_location,file_contents);
 
 
         // Write the parallel pvtu and pvd files on the root process
@@ -191,28 +465,22 @@ namespace aspect
             AssertThrow (pvtu_output, ExcIO());
 
             pvtu_output << "<?xml version=\"1.0\"?>\n";
-            pvtu_output << "<VTKFile type=\"PUnstructuredGrid\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
+            const std::string data_format = (write_binary_output ? "appended" : "ascii");
+
+            pvtu_output << "<VTKFile type=\"PUnstructuredGrid\" version=\"0.1\" byte_order=\"" << byte_order << "\">\n";
             pvtu_output << "  <PUnstructuredGrid GhostLevel=\"0\">\n";
             pvtu_output << "    <PPoints>\n";
-            pvtu_output << "      <PDataArray type=\"Float64\" NumberOfComponents=\"3\" format=\"ascii\"/>\n";
+            pvtu_output << "      <PDataArray type=\"" << float_type << "\" NumberOfComponents=\"3\" format=\"" << data_format << "\"/>\n";
             pvtu_output << "    </PPoints>\n";
             pvtu_output << "    <PPointData Scalars=\"scalars\">\n";
-            pvtu_output << "      <PDataArray type=\"UInt64\" Name=\"id\" NumberOfComponents=\"1\" Format=\"ascii\"/>\n";
-
-            for (unsigned int field_index = 0; field_index < property_information.n_fields(); ++field_index)
-              {
-                const unsigned int n_components = property_information.get_components_by_field_index(field_index);
-                if ((n_components == 1) || (n_components == dim))
-                  pvtu_output << "      <PDataArray type=\"Float64\" Name=\"" << property_information.get_field_name_by_index(field_index)
-                              << "\" NumberOfComponents=\"" << (n_components == 1 ? 1 : 3)
-                              << "\" format=\"ascii\"/>\n";
-                else
-                  for (unsigned int component = 0; component < property_information.get_components_by_field_index(field_index); ++component)
-                    pvtu_output << "      <PDataArray type=\"Float64\" Name=\"" << property_information.get_field_name_by_index(field_index)
-                                << '_' << component
-                                << "\" NumberOfComponents=\"1"
-                                << "\" format=\"ascii\"/>\n";
-              }
+            pvtu_output << "      <PDataArray type=\"UInt64\" Name=\"id\" NumberOfComponents=\"1\" Format=\"" << data_format << "\"/>\n";
+
+            for (unsigned int i=0; i<data_arrays.size(); ++i)
+              pvtu_output << "      <PDataArray type=\""
+                          << ((write_binary_output && data_arrays[i].single_precision) ? "Float32" : "Float64")
+                          << "\" Name=\"" << data_arrays[i].name
+                          << "\" NumberOfComponents=\"" << data_arrays[i].n_output_components
+                          << "\" format=\"" << data_format << "\"/>\n";
             pvtu_output << "    </PPointData>\n";
             for (unsigned int i=0; i<Utilities::MPI::n_mpi_processes(this->get_mpi_communicator()); ++i)
               {
@@ -276,6 +544,81 @@ namespace aspect
         aspect::iarchive ia (is);
         ia >> (*this);
       }
+
+
+      template <int dim>
+      void
+      VTUOutput<dim>::declare_parameters (ParameterHandler &prm)
+      {
+        prm.enter_subsection("Postprocess");
+        {
+          prm.enter_subsection("Particles");
+          {
+            prm.enter_subsection("Output");
+            {
+              prm.enter_subsection("Vtu");
+              {
+                prm.declare_entry ("Data format", "ascii",
+                                   Patterns::Selection ("ascii|binary"),
+                                   "Whether to write the particle data as ASCII text or "
+                                   "as raw binary data appended to the end of the vtu files. "
+                                   "Binary output is considerably smaller and faster to write "
+                                   "and to read for large numbers of particles.");
+                prm.declare_entry ("Compress output", "false",
+                                   Patterns::Bool (),
+                                   "Whether to compress the data arrays of binary output "
+                                   "with zlib. This parameter is ignored for ASCII output.");
+                prm.declare_entry ("Write single precision", "false",
+                                   Patterns::Bool (),
+                                   "Whether to convert positions and particle properties "
+                                   "to single precision floating point numbers for binary "
+                                   "output, which halves the size of the files. This parameter "
+                                   "is ignored for ASCII output.");
+              }
+              prm.leave_subsection ();
+            }
+            prm.leave_subsection ();
+          }
+          prm.leave_subsection ();
+        }
+        prm.leave_subsection ();
+      }
+
+
+      template <int dim>
+      void
+      VTUOutput<dim>::parse_parameters (ParameterHandler &prm)
+      {
+        prm.enter_subsection("Postprocess");
+        {
+          prm.enter_subsection("Particles");
+          {
+            write_in_background_thread = prm.get_bool("Write in background thread");
+            temporary_output_location = prm.get("Temporary output location");
+
+            prm.enter_subsection("Output");
+            {
+              prm.enter_subsection("Vtu");
+              {
+                write_binary_output = (prm.get ("Data format") == "binary");
+                compress_output = prm.get_bool ("Compress output");
+                write_single_precision = prm.get_bool ("Write single precision");
+
+#ifndef DEAL_II_WITH_ZLIB
+                AssertThrow (!write_binary_output || !compress_output,
+                             ExcMessage ("You need to have deal.II configured with the `libz' "
+                                         "option if you want to compress the particle output, but deal.II "
+                                         "did not detect its presence when you called `cmake'."));
+#endif
+              }
+              prm.leave_subsection ();
+            }
+            prm.leave_subsection ();
+          }
+          prm.leave_subsection ();
+        }
+        prm.leave_subsection ();
+      }
     }
   }
 }
@@ -292,7 +635,10 @@ namespace aspect
       ASPECT_REGISTER_PARTICLE_OUTPUT(VTUOutput,
                                       "vtu",
                                       "This particle output plugin writes particle "
-                                      "positions and properties into vtu files.")
+                                      "positions and properties into vtu files. The "
+                                      "data can be written as ASCII text or as "
+                                      "(optionally compressed and single precision) "
+                                      "binary data, see the `Output/Vtu' subsection.")
     }
   }
 }
@@ -59,12 +59,7 @@ namespace aspect
       properties ((particle.has_properties()) ? property_pool->allocate_properties_array() : PropertyPool::invalid_handle)
     {
       if (particle.has_properties())
-        {
-          const ArrayView<double> my_properties = property_pool->get_properties(properties);
-          const ArrayView<const double> their_properties = particle.get_properties();
-
-          std::copy(&their_properties[0],&their_properties[0]+their_properties.size(),&my_properties[0]);
-        }
+        property_pool->copy_slot(particle.properties, properties);
     }
 
 
@@ -85,15 +80,11 @@ namespace aspect
       property_pool = &new_property_pool;
       properties = property_pool->allocate_properties_array();
 
+      data = static_cast<const void *> (pdata);
+
       // See if there are properties to load
       if (has_properties())
-        {
-          const ArrayView<double> particle_properties = property_pool->get_properties(properties);
-          for (unsigned int i = 0; i < particle_properties.size(); ++i)
-            particle_properties[i] = *pdata++;
-        }
-
-      data = static_cast<const void *> (pdata);
+        property_pool->read_properties(properties, data);
     }
 
 #ifdef DEAL_II_WITH_CXX11
@@ -124,10 +115,7 @@ namespace aspect
           if (particle.has_properties())
             {
               properties = property_pool->allocate_properties_array();
-              const ArrayView<const double> their_properties = particle.get_properties();
-              const ArrayView<double> my_properties = property_pool->get_properties(properties);
-
-              std::copy(&their_properties[0],&their_properties[0]+their_properties.size(),&my_properties[0]);
+              property_pool->copy_slot(particle.properties, properties);
             }
           else
             properties = PropertyPool::invalid_handle;
@@ -176,15 +164,11 @@ namespace aspect
       for (unsigned int i = 0; i < dim; ++i,++pdata)
         *pdata = reference_location(i);
 
-      // Write property data
-      if (has_properties())
-        {
-          const ArrayView<double> particle_properties = property_pool->get_properties(properties);
-          for (unsigned int i = 0; i < particle_properties.size(); ++i,++pdata)
-            *pdata = particle_properties[i];
-        }
-
       data = static_cast<void *> (pdata);
+
+      // Write property data in the precision in which it is stored
+      if (has_properties())
+        property_pool->write_properties(properties, data);
     }
 
     template <int dim, int spacedim>
@@ -196,10 +180,8 @@ namespace aspect
                          + sizeof(reference_location);
 
       if (has_properties())
-        {
-          const ArrayView<double> particle_properties = property_pool->get_properties(properties);
-          size += sizeof(double) * particle_properties.size();
-        }
+        size += property_pool->serialized_properties_size();
+
       return size;
     }
 
@@ -252,16 +234,15 @@ namespace aspect
       if (properties == PropertyPool::invalid_handle)
         properties = property_pool->allocate_properties_array();
 
-      const ArrayView<double> old_properties = property_pool->get_properties(properties);
-
-      Assert (new_properties.size() == old_properties.size(),
+      Assert (new_properties.size() == property_pool->n_properties_per_slot(),
               ExcMessage(std::string("You are trying to assign properties with an incompatible length. ")
-                         + "The particle has space to store " + Utilities::to_string(old_properties.size()) + " properties, "
+                         + "The particle has space to store " + Utilities::to_string(property_pool->n_properties_per_slot()) + " properties, "
                          + "and this function tries to assign" + Utilities::to_string(new_properties.size()) + " properties. "
                          + "This is not allowed."));
 
-      if (old_properties.size() > 0)
-        std::copy(new_properties.begin(),new_properties.end(),&old_properties[0]);
+      if (new_properties.size() > 0)
+        property_pool->set_properties(properties,
+                                      ArrayView<const double>(&new_properties[0],new_properties.size()));
     }
 
     template <int dim, int spacedim>
@@ -285,6 +266,19 @@ namespace aspect
       return property_pool->get_properties(properties);
     }
 
+    template <int dim, int spacedim>
+    void
+    Particle<dim,spacedim>::get_properties (std::vector<double> &particle_properties) const
+    {
+      Assert(property_pool != NULL,
+             ExcInternalError());
+
+      particle_properties.resize(property_pool->n_properties_per_slot());
+      if (particle_properties.size() > 0)
+        property_pool->get_properties(properties,
+                                      ArrayView<double>(&particle_properties[0],particle_properties.size()));
+    }
+
     template <int dim, int spacedim>
     bool
     Particle<dim,spacedim>::has_properties () const
@@ -27,18 +27,18 @@ namespace aspect
     template <int dim, int spacedim>
     ParticleAccessor<dim,spacedim>::ParticleAccessor ()
       :
-      map (NULL),
-      particle ()
+      container (NULL),
+      index (numbers::invalid_unsigned_int)
     {}
 
 
 
     template <int dim, int spacedim>
-    ParticleAccessor<dim,spacedim>::ParticleAccessor (const std::multimap<types::LevelInd, Particle<dim,spacedim> > &map,
-                                                      const typename std::multimap<types::LevelInd, Particle<dim,spacedim> >::iterator &particle)
+    ParticleAccessor<dim,spacedim>::ParticleAccessor (const ParticleContainer<dim,spacedim> &container,
+                                                      const typename ParticleContainer<dim,spacedim>::size_type index)
       :
-      map (const_cast<std::multimap<types::LevelInd, Particle<dim,spacedim> > *> (&map)),
-      particle (particle)
+      container (const_cast<ParticleContainer<dim,spacedim> *> (&container)),
+      index (container.next_valid_index(index))
     {}
 
 
@@ -47,10 +47,23 @@ namespace aspect
     void
     ParticleAccessor<dim,spacedim>::write_data (void *&data) const
     {
-      Assert(particle != map->end(),
+      Assert(container->is_valid(index),
              ExcInternalError());
 
-      particle->second.write_data(data);
+      container->write_data(index,data);
+    }
+
+
+
+    template <int dim, int spacedim>
+    void
+    ParticleAccessor<dim,spacedim>::write_compact_data (const std::vector<unsigned int> &property_indices,
+                                                        void *&data) const
+    {
+      Assert(container->is_valid(index),
+             ExcInternalError());
+
+      container->write_compact_data(index,property_indices,data);
     }
 
 
@@ -59,10 +72,10 @@ namespace aspect
     void
     ParticleAccessor<dim,spacedim>::set_location (const Point<spacedim> &new_loc)
     {
-      Assert(particle != map->end(),
+      Assert(container->is_valid(index),
              ExcInternalError());
 
-      particle->second.set_location(new_loc);
+      container->set_location(index,new_loc);
     }
 
 
@@ -71,10 +84,10 @@ namespace aspect
     const Point<spacedim> &
     ParticleAccessor<dim,spacedim>::get_location () const
     {
-      Assert(particle != map->end(),
+      Assert(container->is_valid(index),
              ExcInternalError());
 
-      return particle->second.get_location();
+      return container->get_location(index);
     }
 
 
@@ -83,10 +96,10 @@ namespace aspect
     void
     ParticleAccessor<dim,spacedim>::set_reference_location (const Point<dim> &new_loc)
     {
-      Assert(particle != map->end(),
+      Assert(container->is_valid(index),
              ExcInternalError());
 
-      particle->second.set_reference_location(new_loc);
+      container->set_reference_location(index,new_loc);
     }
 
 
@@ -95,10 +108,10 @@ namespace aspect
     const Point<dim> &
     ParticleAccessor<dim,spacedim>::get_reference_location () const
     {
-      Assert(particle != map->end(),
+      Assert(container->is_valid(index),
              ExcInternalError());
 
-      return particle->second.get_reference_location();
+      return container->get_reference_location(index);
     }
 
 
@@ -107,10 +120,10 @@ namespace aspect
     types::particle_index
     ParticleAccessor<dim,spacedim>::get_id () const
     {
-      Assert(particle != map->end(),
+      Assert(container->is_valid(index),
              ExcInternalError());
 
-      return particle->second.get_id();
+      return container->get_id(index);
     }
 
 
@@ -119,10 +132,15 @@ namespace aspect
     void
     ParticleAccessor<dim,spacedim>::set_property_pool (PropertyPool &new_property_pool)
     {
-      Assert(particle != map->end(),
+      Assert(container->is_valid(index),
              ExcInternalError());
 
-      particle->second.set_property_pool(new_property_pool);
+      // All particles in a container share the property pool of the
+      // container, their properties are allocated when they are inserted.
+      Assert(&new_property_pool == &container->get_property_pool(),
+             ExcMessage("All particles stored in a particle container have to use "
+                        "the property pool of that container."));
+      (void)new_property_pool;
     }
 
 
@@ -131,10 +149,10 @@ namespace aspect
     bool
     ParticleAccessor<dim,spacedim>::has_properties () const
     {
-      Assert(particle != map->end(),
+      Assert(container->is_valid(index),
              ExcInternalError());
 
-      return particle->second.has_properties();
+      return container->has_properties(index);
     }
 
 
@@ -143,11 +161,10 @@ namespace aspect
     void
     ParticleAccessor<dim,spacedim>::set_properties (const std::vector<double> &new_properties)
     {
-      Assert(particle != map->end(),
+      Assert(container->is_valid(index),
              ExcInternalError());
 
-      particle->second.set_properties(new_properties);
-      return;
+      container->set_properties(index,new_properties);
     }
 
 
@@ -156,10 +173,58 @@ namespace aspect
     const ArrayView<const double>
     ParticleAccessor<dim,spacedim>::get_properties () const
     {
-      Assert(particle != map->end(),
+      Assert(container->is_valid(index),
+             ExcInternalError());
+
+      return static_cast<const ParticleContainer<dim,spacedim> *> (container)->get_properties(index);
+    }
+
+
+
+    template <int dim, int spacedim>
+    void
+    ParticleAccessor<dim,spacedim>::get_properties (std::vector<double> &properties) const
+    {
+      Assert(container->is_valid(index),
+             ExcInternalError());
+
+      container->get_properties(index,properties);
+    }
+
+
+
+    template <int dim, int spacedim>
+    double
+    ParticleAccessor<dim,spacedim>::get_property (const unsigned int property_index) const
+    {
+      Assert(container->is_valid(index),
+             ExcInternalError());
+
+      return container->get_property(index,property_index);
+    }
+
+
+
+    template <int dim, int spacedim>
+    const ArrayView<double>
+    ParticleAccessor<dim,spacedim>::get_integrator_data ()
+    {
+      Assert(container->is_valid(index),
+             ExcInternalError());
+
+      return container->get_integrator_data(index);
+    }
+
+
+
+    template <int dim, int spacedim>
+    const ArrayView<const double>
+    ParticleAccessor<dim,spacedim>::get_integrator_data () const
+    {
+      Assert(container->is_valid(index),
              ExcInternalError());
 
-      return particle->second.get_properties();
+      return static_cast<const ParticleContainer<dim,spacedim> *> (container)->get_integrator_data(index);
     }
 
 
@@ -168,12 +233,13 @@ namespace aspect
     typename parallel::distributed::Triangulation<dim,spacedim>::cell_iterator
     ParticleAccessor<dim,spacedim>::get_surrounding_cell (const parallel::distributed::Triangulation<dim,spacedim> &triangulation) const
     {
-      Assert(particle != map->end(),
+      Assert(container->is_valid(index),
              ExcInternalError());
 
+      const types::LevelInd &level_index = container->get_cell(index);
       const typename parallel::distributed::Triangulation<dim,spacedim>::cell_iterator cell (&triangulation,
-          particle->first.first,
-          particle->first.second);
+          level_index.first,
+          level_index.second);
       return cell;
     }
 
@@ -183,10 +249,10 @@ namespace aspect
     const ArrayView<double>
     ParticleAccessor<dim,spacedim>::get_properties ()
     {
-      Assert(particle != map->end(),
+      Assert(container->is_valid(index),
              ExcInternalError());
 
-      return particle->second.get_properties();
+      return container->get_properties(index);
     }
 
 
@@ -195,10 +261,10 @@ namespace aspect
     std::size_t
     ParticleAccessor<dim,spacedim>::serialized_size_in_bytes () const
     {
-      Assert(particle != map->end(),
+      Assert(container->is_valid(index),
              ExcInternalError());
 
-      return particle->second.serialized_size_in_bytes();
+      return container->serialized_size_in_bytes(index);
     }
 
 
@@ -207,8 +273,8 @@ namespace aspect
     void
     ParticleAccessor<dim,spacedim>::next ()
     {
-      Assert (particle != map->end(),ExcInternalError());
-      ++particle;
+      Assert (index < container->storage_size(),ExcInternalError());
+      index = container->next_valid_index(index+1);
     }
 
 
@@ -217,8 +283,9 @@ namespace aspect
     void
     ParticleAccessor<dim,spacedim>::prev ()
     {
-      Assert (particle != map->begin(),ExcInternalError());
-      --particle;
+      index = container->previous_valid_index(index);
+      Assert (index != container->storage_size(),
+              ExcMessage("There is no particle before the current one in the particle storage."));
     }
 
 
@@ -227,7 +294,7 @@ namespace aspect
     bool
     ParticleAccessor<dim,spacedim>::operator != (const ParticleAccessor<dim,spacedim> &other) const
     {
-      return (map != other.map) || (particle != other.particle);
+      return (container != other.container) || (index != other.index);
     }
 
 
@@ -236,7 +303,7 @@ namespace aspect
     bool
     ParticleAccessor<dim,spacedim>::operator == (const ParticleAccessor<dim,spacedim> &other) const
     {
-      return (map == other.map) && (particle == other.particle);
+      return (container == other.container) && (index == other.index);
     }
   }
 }
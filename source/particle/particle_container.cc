@@ -0,0 +1,661 @@
+/*
+ Copyright (C) 2017 by the authors of the ASPECT code.
+
+ This file is part of ASPECT.
+
+ ASPECT is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2, or (at your option)
+ any later version.
+
+ ASPECT is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with ASPECT; see the file LICENSE.  If not see
+ <http://www.gnu.org/licenses/>.
+ */
+
+#include <aspect/particle/particle_container.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace aspect
+{
+  namespace Particle
+  {
+    namespace
+    {
+      /**
+       * A comparison object that orders indices into the particle arrays
+       * by the cell of the particles they point to.
+       */
+      class CompareCells
+      {
+        public:
+          CompareCells (const std::vector<types::LevelInd> &cells)
+            :
+            cells (&cells)
+          {}
+
+          bool operator() (const std::size_t a,
+                           const std::size_t b) const
+          {
+            return (*cells)[a] < (*cells)[b];
+          }
+
+        private:
+          const std::vector<types::LevelInd> *cells;
+      };
+
+      /**
+       * Reorder the entries of @p values such that the new entry i is the
+       * old entry permutation[i]. Entries that are not part of the
+       * permutation are dropped.
+       */
+      template <typename T>
+      void
+      apply_permutation (std::vector<T> &values,
+                         const std::vector<std::size_t> &permutation)
+      {
+        std::vector<T> permuted_values;
+        permuted_values.reserve(permutation.size());
+
+        for (unsigned int i=0; i<permutation.size(); ++i)
+          permuted_values.push_back(values[permutation[i]]);
+
+        values.swap(permuted_values);
+      }
+    }
+
+
+
+    template <int dim, int spacedim>
+    ParticleContainer<dim,spacedim>::ParticleContainer (PropertyPool *property_pool)
+      :
+      property_pool(property_pool),
+      n_sorted_slots(0),
+      n_removed_slots(0)
+    {}
+
+
+
+    template <int dim, int spacedim>
+    ParticleContainer<dim,spacedim>::~ParticleContainer ()
+    {
+      clear();
+    }
+
+
+
+    template <int dim, int spacedim>
+    void
+    ParticleContainer<dim,spacedim>::set_property_pool (PropertyPool &new_property_pool)
+    {
+      Assert (cells.size() == 0,
+              ExcMessage("The property pool of a particle container can only be changed "
+                         "while the container is empty."));
+
+      property_pool = &new_property_pool;
+    }
+
+
+
+    template <int dim, int spacedim>
+    PropertyPool &
+    ParticleContainer<dim,spacedim>::get_property_pool () const
+    {
+      Assert (property_pool != NULL, ExcInternalError());
+      return *property_pool;
+    }
+
+
+
+    template <int dim, int spacedim>
+    const typename ParticleContainer<dim,spacedim>::CellRange *
+    ParticleContainer<dim,spacedim>::find_cell_range (const types::LevelInd &cell) const
+    {
+      size_type first = 0;
+      size_type last = cell_index.size();
+
+      // Binary search in the sorted cell offset index
+      while (first < last)
+        {
+          const size_type middle = first + (last - first) / 2;
+          if (cell_index[middle].cell < cell)
+            first = middle + 1;
+          else
+            last = middle;
+        }
+
+      if (first < cell_index.size() && cell_index[first].cell == cell)
+        return &cell_index[first];
+
+      return NULL;
+    }
+
+
+
+    template <int dim, int spacedim>
+    unsigned int
+    ParticleContainer<dim,spacedim>::n_particles_in_cell (const types::LevelInd &cell) const
+    {
+      unsigned int n_particles = 0;
+
+      const CellRange *range = find_cell_range(cell);
+      if (range != NULL)
+        n_particles += range->n_particles;
+
+      if (n_unsorted_particles_per_cell.size() > 0)
+        {
+          const typename std::map<types::LevelInd, unsigned int>::const_iterator unsorted =
+            n_unsorted_particles_per_cell.find(cell);
+          if (unsorted != n_unsorted_particles_per_cell.end())
+            n_particles += unsorted->second;
+        }
+
+      return n_particles;
+    }
+
+
+
+    template <int dim, int spacedim>
+    bool
+    ParticleContainer<dim,spacedim>::has_unsorted_particles_in_cell (const types::LevelInd &cell) const
+    {
+      return (n_unsorted_particles_per_cell.size() > 0)
+             && (n_unsorted_particles_per_cell.find(cell) != n_unsorted_particles_per_cell.end());
+    }
+
+
+
+    template <int dim, int spacedim>
+    void
+    ParticleContainer<dim,spacedim>::get_particles_per_cell (std::vector<std::pair<types::LevelInd,unsigned int> > &particles_per_cell) const
+    {
+      particles_per_cell.reserve(particles_per_cell.size()
+                                 + cell_index.size()
+                                 + n_unsorted_particles_per_cell.size());
+
+      for (unsigned int i=0; i<cell_index.size(); ++i)
+        if (cell_index[i].n_particles > 0)
+          particles_per_cell.push_back(std::make_pair(cell_index[i].cell,
+                                                      cell_index[i].n_particles));
+
+      particles_per_cell.insert(particles_per_cell.end(),
+                                n_unsorted_particles_per_cell.begin(),
+                                n_unsorted_particles_per_cell.end());
+    }
+
+
+
+    template <int dim, int spacedim>
+    std::pair<typename ParticleContainer<dim,spacedim>::size_type,
+        typename ParticleContainer<dim,spacedim>::size_type>
+        ParticleContainer<dim,spacedim>::cell_range (const types::LevelInd &cell) const
+    {
+      const CellRange *range = find_cell_range(cell);
+
+      if (range != NULL)
+        return std::make_pair(range->begin, range->end);
+
+      return std::make_pair(n_sorted_slots, n_sorted_slots);
+    }
+
+
+
+    template <int dim, int spacedim>
+    typename ParticleContainer<dim,spacedim>::size_type
+    ParticleContainer<dim,spacedim>::append_slot (const types::LevelInd &cell)
+    {
+      const size_type index = cells.size();
+
+      cells.push_back(cell);
+      locations.push_back(Point<spacedim>());
+      reference_locations.push_back(Point<dim>());
+      ids.push_back(0);
+      properties.push_back(PropertyPool::invalid_handle);
+
+      ++n_unsorted_particles_per_cell[cell];
+
+      return index;
+    }
+
+
+
+    template <int dim, int spacedim>
+    typename ParticleContainer<dim,spacedim>::size_type
+    ParticleContainer<dim,spacedim>::insert (const types::LevelInd &cell,
+                                             const Particle<dim,spacedim> &particle)
+    {
+      const size_type index = append_slot(cell);
+
+      locations[index] = particle.get_location();
+      reference_locations[index] = particle.get_reference_location();
+      ids[index] = particle.get_id();
+
+      if (property_pool != NULL
+          && property_pool->n_properties_per_slot() + property_pool->n_integrator_data_per_slot() > 0)
+        {
+          properties[index] = property_pool->allocate_properties_array();
+
+          if (particle.has_properties() && property_pool->n_properties_per_slot() > 0)
+            {
+              std::vector<double> their_properties;
+              particle.get_properties(their_properties);
+
+              Assert (their_properties.size() == property_pool->n_properties_per_slot(),
+                      ExcInternalError());
+
+              property_pool->set_properties(properties[index],
+                                            ArrayView<const double>(&their_properties[0],their_properties.size()));
+            }
+        }
+
+      return index;
+    }
+
+
+
+    template <int dim, int spacedim>
+    typename ParticleContainer<dim,spacedim>::size_type
+    ParticleContainer<dim,spacedim>::insert (const types::LevelInd &cell,
+                                             const void *&data)
+    {
+      const size_type index = append_slot(cell);
+
+      const types::particle_index *id_data = static_cast<const types::particle_index *> (data);
+      ids[index] = *id_data++;
+      const double *pdata = reinterpret_cast<const double *> (id_data);
+
+      for (unsigned int i = 0; i < dim; ++i)
+        locations[index](i) = *pdata++;
+
+      for (unsigned int i = 0; i < dim; ++i)
+        reference_locations[index](i) = *pdata++;
+
+      // See if there are properties to load. The integrator data is not
+      // part of the serialized particle, but the slot has to be reserved.
+      if (property_pool != NULL
+          && property_pool->n_properties_per_slot() + property_pool->n_integrator_data_per_slot() > 0)
+        {
+          properties[index] = property_pool->allocate_properties_array();
+
+          const void *property_data = static_cast<const void *> (pdata);
+          property_pool->read_properties(properties[index], property_data);
+          pdata = static_cast<const double *> (property_data);
+        }
+
+      data = static_cast<const void *> (pdata);
+      return index;
+    }
+
+
+
+    template <int dim, int spacedim>
+    typename ParticleContainer<dim,spacedim>::size_type
+    ParticleContainer<dim,spacedim>::insert_compact (const types::LevelInd &cell,
+                                                     const std::vector<unsigned int> &property_indices,
+                                                     const void *&data)
+    {
+      const size_type index = append_slot(cell);
+
+      const types::particle_index *id_data = static_cast<const types::particle_index *> (data);
+      ids[index] = *id_data++;
+      const double *pdata = reinterpret_cast<const double *> (id_data);
+
+      for (unsigned int i = 0; i < spacedim; ++i)
+        locations[index](i) = *pdata++;
+
+      // The reference location is not transferred
+      for (unsigned int i = 0; i < dim; ++i)
+        reference_locations[index](i) = std::numeric_limits<double>::quiet_NaN();
+
+      if (property_pool != NULL
+          && property_pool->n_properties_per_slot() + property_pool->n_integrator_data_per_slot() > 0)
+        {
+          properties[index] = property_pool->allocate_properties_array();
+
+          for (unsigned int i = 0; i < property_pool->n_properties_per_slot(); ++i)
+            property_pool->set_property(properties[index], i, std::numeric_limits<double>::quiet_NaN());
+
+          for (unsigned int i = 0; i < property_indices.size(); ++i)
+            property_pool->set_property(properties[index], property_indices[i], *pdata++);
+        }
+      else
+        Assert (property_indices.size() == 0, ExcInternalError());
+
+      data = static_cast<const void *> (pdata);
+      return index;
+    }
+
+
+
+    template <int dim, int spacedim>
+    void
+    ParticleContainer<dim,spacedim>::decrease_particle_count (const size_type index,
+                                                              const types::LevelInd &cell)
+    {
+      if (index < n_sorted_slots)
+        {
+          CellRange *range = const_cast<CellRange *> (find_cell_range(cell));
+          Assert (range != NULL && range->n_particles > 0, ExcInternalError());
+          --range->n_particles;
+        }
+      else
+        {
+          const typename std::map<types::LevelInd, unsigned int>::iterator unsorted =
+            n_unsorted_particles_per_cell.find(cell);
+          Assert (unsorted != n_unsorted_particles_per_cell.end(), ExcInternalError());
+
+          if (--unsorted->second == 0)
+            n_unsorted_particles_per_cell.erase(unsorted);
+        }
+    }
+
+
+
+    template <int dim, int spacedim>
+    typename ParticleContainer<dim,spacedim>::size_type
+    ParticleContainer<dim,spacedim>::move_to_cell (const size_type index,
+                                                   const types::LevelInd &cell)
+    {
+      Assert (is_valid(index), ExcInternalError());
+
+      // Particles in the unsorted part can simply change their cell
+      if (index >= n_sorted_slots)
+        {
+          decrease_particle_count(index, cells[index]);
+          cells[index] = cell;
+          ++n_unsorted_particles_per_cell[cell];
+          return index;
+        }
+
+      // Particles in the sorted part are appended to the unsorted part and
+      // take their properties with them
+      const Point<spacedim> location = locations[index];
+      const Point<dim> reference_location = reference_locations[index];
+      const types::particle_index id = ids[index];
+      const PropertyPool::Handle handle = properties[index];
+
+      decrease_particle_count(index, cells[index]);
+      cells[index] = invalid_cell();
+      properties[index] = PropertyPool::invalid_handle;
+      ++n_removed_slots;
+
+      const size_type new_index = append_slot(cell);
+      locations[new_index] = location;
+      reference_locations[new_index] = reference_location;
+      ids[new_index] = id;
+      properties[new_index] = handle;
+
+      return new_index;
+    }
+
+
+
+    template <int dim, int spacedim>
+    void
+    ParticleContainer<dim,spacedim>::remove (const size_type index)
+    {
+      Assert (is_valid(index), ExcInternalError());
+
+      decrease_particle_count(index, cells[index]);
+
+      if (properties[index] != PropertyPool::invalid_handle)
+        property_pool->deallocate_properties_array(properties[index]);
+
+      cells[index] = invalid_cell();
+      properties[index] = PropertyPool::invalid_handle;
+      ++n_removed_slots;
+    }
+
+
+
+    template <int dim, int spacedim>
+    void
+    ParticleContainer<dim,spacedim>::clear ()
+    {
+      for (size_type i=0; i<properties.size(); ++i)
+        if (properties[i] != PropertyPool::invalid_handle)
+          property_pool->deallocate_properties_array(properties[i]);
+
+      cells.clear();
+      locations.clear();
+      reference_locations.clear();
+      ids.clear();
+      properties.clear();
+      cell_index.clear();
+      n_unsorted_particles_per_cell.clear();
+
+      n_sorted_slots = 0;
+      n_removed_slots = 0;
+    }
+
+
+
+    template <int dim, int spacedim>
+    void
+    ParticleContainer<dim,spacedim>::reserve (const size_type n_particles)
+    {
+      cells.reserve(n_particles);
+      locations.reserve(n_particles);
+      reference_locations.reserve(n_particles);
+      ids.reserve(n_particles);
+      properties.reserve(n_particles);
+    }
+
+
+
+    template <int dim, int spacedim>
+    void
+    ParticleContainer<dim,spacedim>::compress ()
+    {
+      if (n_sorted_slots == cells.size() && n_removed_slots == 0)
+        return;
+
+      // The valid particles of the sorted part are already in the right
+      // order. Sort the valid particles of the unsorted part by cell, and
+      // merge both sequences. Both std::stable_sort and std::merge keep
+      // the relative order of particles within a cell.
+      std::vector<size_type> sorted_indices;
+      sorted_indices.reserve(n_sorted_slots);
+      for (size_type i=0; i<n_sorted_slots; ++i)
+        if (cells[i] != invalid_cell())
+          sorted_indices.push_back(i);
+
+      std::vector<size_type> unsorted_indices;
+      unsorted_indices.reserve(cells.size() - n_sorted_slots);
+      for (size_type i=n_sorted_slots; i<cells.size(); ++i)
+        if (cells[i] != invalid_cell())
+          unsorted_indices.push_back(i);
+
+      const CompareCells compare_cells(cells);
+      std::stable_sort(unsorted_indices.begin(),unsorted_indices.end(),compare_cells);
+
+      std::vector<size_type> permutation(sorted_indices.size() + unsorted_indices.size());
+      std::merge(sorted_indices.begin(),sorted_indices.end(),
+                 unsorted_indices.begin(),unsorted_indices.end(),
+                 permutation.begin(),
+                 compare_cells);
+
+      apply_permutation(cells,permutation);
+      apply_permutation(locations,permutation);
+      apply_permutation(reference_locations,permutation);
+      apply_permutation(ids,permutation);
+      apply_permutation(properties,permutation);
+
+      // Rebuild the cell offset index
+      cell_index.clear();
+      for (size_type i=0; i<cells.size(); ++i)
+        {
+          if (cell_index.size() == 0 || cell_index.back().cell != cells[i])
+            {
+              const CellRange range = {cells[i], i, i, 0};
+              cell_index.push_back(range);
+            }
+
+          ++cell_index.back().end;
+          ++cell_index.back().n_particles;
+        }
+
+      n_unsorted_particles_per_cell.clear();
+      n_sorted_slots = cells.size();
+      n_removed_slots = 0;
+    }
+
+
+
+    template <int dim, int spacedim>
+    void
+    ParticleContainer<dim,spacedim>::get_property_handles (std::vector<PropertyPool::Handle> &handles) const
+    {
+      for (size_type i=0; i<properties.size(); ++i)
+        if (properties[i] != PropertyPool::invalid_handle)
+          handles.push_back(properties[i]);
+    }
+
+
+
+    template <int dim, int spacedim>
+    std::size_t
+    ParticleContainer<dim,spacedim>::set_property_handles (const std::vector<PropertyPool::Handle> &handles,
+                                                           const std::size_t first_handle)
+    {
+      std::size_t handle = first_handle;
+      for (size_type i=0; i<properties.size(); ++i)
+        if (properties[i] != PropertyPool::invalid_handle)
+          {
+            Assert (handle < handles.size(), ExcInternalError());
+            properties[i] = handles[handle++];
+          }
+
+      return handle;
+    }
+
+
+
+    template <int dim, int spacedim>
+    void
+    ParticleContainer<dim,spacedim>::set_properties (const size_type index,
+                                                     const std::vector<double> &new_properties)
+    {
+      Assert (is_valid(index), ExcInternalError());
+      Assert (property_pool != NULL, ExcInternalError());
+
+      if (properties[index] == PropertyPool::invalid_handle)
+        properties[index] = property_pool->allocate_properties_array();
+
+      Assert (new_properties.size() == property_pool->n_properties_per_slot(),
+              ExcMessage(std::string("You are trying to assign properties with an incompatible length. ")
+                         + "The particle has space to store " + Utilities::to_string(property_pool->n_properties_per_slot()) + " properties, "
+                         + "and this function tries to assign" + Utilities::to_string(new_properties.size()) + " properties. "
+                         + "This is not allowed."));
+
+      if (new_properties.size() > 0)
+        property_pool->set_properties(properties[index],
+                                      ArrayView<const double>(&new_properties[0],new_properties.size()));
+    }
+
+
+
+    template <int dim, int spacedim>
+    void
+    ParticleContainer<dim,spacedim>::write_data (const size_type index,
+                                                 void *&data) const
+    {
+      Assert (is_valid(index), ExcInternalError());
+
+      types::particle_index *id_data  = static_cast<types::particle_index *> (data);
+      *id_data = ids[index];
+      ++id_data;
+      double *pdata = reinterpret_cast<double *> (id_data);
+
+      // Write location data
+      for (unsigned int i = 0; i < dim; ++i,++pdata)
+        *pdata = locations[index](i);
+
+      // Write reference location data
+      for (unsigned int i = 0; i < dim; ++i,++pdata)
+        *pdata = reference_locations[index](i);
+
+      data = static_cast<void *> (pdata);
+
+      // Write property data in the precision in which it is stored
+      if (has_properties(index))
+        property_pool->write_properties(properties[index], data);
+    }
+
+
+
+    template <int dim, int spacedim>
+    std::size_t
+    ParticleContainer<dim,spacedim>::serialized_size_in_bytes (const size_type index) const
+    {
+      std::size_t size = sizeof(types::particle_index)
+                         + sizeof(Point<spacedim>)
+                         + sizeof(Point<dim>);
+
+      if (has_properties(index))
+        size += property_pool->serialized_properties_size();
+
+      return size;
+    }
+
+
+
+    template <int dim, int spacedim>
+    void
+    ParticleContainer<dim,spacedim>::write_compact_data (const size_type index,
+                                                         const std::vector<unsigned int> &property_indices,
+                                                         void *&data) const
+    {
+      Assert (is_valid(index), ExcInternalError());
+
+      types::particle_index *id_data  = static_cast<types::particle_index *> (data);
+      *id_data = ids[index];
+      ++id_data;
+      double *pdata = reinterpret_cast<double *> (id_data);
+
+      for (unsigned int i = 0; i < spacedim; ++i,++pdata)
+        *pdata = locations[index](i);
+
+      if (property_indices.size() > 0)
+        {
+          Assert (has_properties(index), ExcInternalError());
+
+          for (unsigned int i = 0; i < property_indices.size(); ++i,++pdata)
+            *pdata = property_pool->get_property(properties[index], property_indices[i]);
+        }
+
+      data = static_cast<void *> (pdata);
+    }
+
+
+
+    template <int dim, int spacedim>
+    std::size_t
+    ParticleContainer<dim,spacedim>::compact_size_in_bytes (const unsigned int n_selected_properties)
+    {
+      return sizeof(types::particle_index)
+             + sizeof(Point<spacedim>)
+             + sizeof(double) * n_selected_properties;
+    }
+  }
+}
+
+
+// explicit instantiation of the functions we implement in this file
+namespace aspect
+{
+  namespace Particle
+  {
+#define INSTANTIATE(dim) \
+  template class ParticleContainer<dim>;
+
+    ASPECT_INSTANTIATE(INSTANTIATE)
+  }
+}
@@ -20,6 +20,9 @@
 
 #include <aspect/particle/particle_handler.h>
 
+#include <deal.II/base/std_cxx11/array.h>
+#include <deal.II/fe/mapping_cartesian.h>
+#include <deal.II/fe/mapping_q_generic.h>
 #include <deal.II/grid/grid_tools.h>
 
 namespace aspect
@@ -33,15 +36,27 @@ namespace aspect
       mpi_communicator(),
       particles(),
       ghost_particles(),
+      compact_ghost_exchange(false),
+      ghost_property_indices(),
       global_number_of_particles(0),
+      n_particles_per_cell(),
       global_max_particles_per_cell(0),
       next_free_particle_index(0),
       property_pool(new PropertyPool(0)),
       size_callback(),
       store_callback(),
       load_callback(),
-      data_offset(numbers::invalid_unsigned_int)
-    {}
+      data_offset(numbers::invalid_unsigned_int),
+      transfer_particles_separately(false),
+      stored_particle_size(0),
+      mesh_topology_is_cached(false),
+      mesh_geometry_is_cached(false),
+      neighbor_communication_is_set_up(false),
+      particle_exchange_in_progress(false)
+    {
+      particles.set_property_pool(*property_pool);
+      ghost_particles.set_property_pool(*property_pool);
+    }
 
 
 
@@ -49,28 +64,51 @@ namespace aspect
     ParticleHandler<dim,spacedim>::ParticleHandler(const parallel::distributed::Triangulation<dim,spacedim> &triangulation,
                                                    const Mapping<dim,spacedim> &mapping,
                                                    const MPI_Comm mpi_communicator,
-                                                   const unsigned int n_properties)
+                                                   const unsigned int n_properties,
+                                                   const unsigned int n_integrator_data,
+                                                   const std::vector<bool> &single_precision_properties)
       :
       triangulation(&triangulation, typeid(*this).name()),
       mapping(&mapping, typeid(*this).name()),
       mpi_communicator(mpi_communicator),
       particles(),
       ghost_particles(),
+      compact_ghost_exchange(false),
+      ghost_property_indices(),
       global_number_of_particles(0),
+      n_particles_per_cell(triangulation.n_active_cells(),0),
       global_max_particles_per_cell(0),
       next_free_particle_index(0),
-      property_pool(new PropertyPool(n_properties)),
+      property_pool(new PropertyPool(n_properties,n_integrator_data,single_precision_properties)),
       size_callback(),
       store_callback(),
       load_callback(),
-      data_offset(numbers::invalid_unsigned_int)
-    {}
+      data_offset(numbers::invalid_unsigned_int),
+      transfer_particles_separately(false),
+      stored_particle_size(0),
+      mesh_topology_is_cached(false),
+      mesh_geometry_is_cached(false),
+      neighbor_communication_is_set_up(false),
+      particle_exchange_in_progress(false)
+    {
+      particles.set_property_pool(*property_pool);
+      ghost_particles.set_property_pool(*property_pool);
+
+      connect_to_triangulation_signals();
+    }
 
 
 
     template <int dim,int spacedim>
     ParticleHandler<dim,spacedim>::~ParticleHandler()
-    {}
+    {
+      // Release all particle properties before the property pool is destroyed
+      particles.clear();
+      ghost_particles.clear();
+
+      triangulation_listener.disconnect();
+      free_neighbor_communication();
+    }
 
 
 
@@ -79,14 +117,65 @@ namespace aspect
     ParticleHandler<dim,spacedim>::initialize(const parallel::distributed::Triangulation<dim,spacedim> &tria,
                                               const Mapping<dim,spacedim> &mapp,
                                               const MPI_Comm communicator,
-                                              const unsigned int n_properties)
+                                              const unsigned int n_properties,
+                                              const unsigned int n_integrator_data,
+                                              const std::vector<bool> &single_precision_properties)
     {
       triangulation = &tria;
       mapping = &mapp;
       mpi_communicator = communicator;
 
+      // Release all properties that are stored in the old memory pool
+      particles.clear();
+      ghost_particles.clear();
+      n_particles_per_cell.assign(triangulation->n_active_cells(),0);
+
       // Create the memory pool that will store all particle properties
-      property_pool.reset(new PropertyPool(n_properties));
+      property_pool.reset(new PropertyPool(n_properties,n_integrator_data,single_precision_properties));
+      particles.set_property_pool(*property_pool);
+      ghost_particles.set_property_pool(*property_pool);
+
+      connect_to_triangulation_signals();
+    }
+
+
+
+    template <int dim,int spacedim>
+    void
+    ParticleHandler<dim,spacedim>::connect_to_triangulation_signals()
+    {
+      // The cached mesh information refers to the cells of the
+      // triangulation, and has to be recomputed whenever it changes
+      triangulation_listener.disconnect();
+      invalidate_cached_mesh_information();
+
+      triangulation_listener = triangulation->signals.any_change.connect(std_cxx11::bind(&ParticleHandler<dim,spacedim>::invalidate_cached_mesh_information,
+                                                                                          std_cxx11::ref(*this)));
+    }
+
+
+
+    template <int dim,int spacedim>
+    void
+    ParticleHandler<dim,spacedim>::invalidate_cached_mesh_information()
+    {
+      Assert (!particle_exchange_in_progress,
+              ExcMessage("The triangulation must not change while particles are exchanged."));
+
+      mesh_topology_is_cached = false;
+      mesh_geometry_is_cached = false;
+
+      // The neighbors of this process might change with the triangulation
+      free_neighbor_communication();
+    }
+
+
+
+    template <int dim,int spacedim>
+    void
+    ParticleHandler<dim,spacedim>::notify_mesh_deformation()
+    {
+      mesh_geometry_is_cached = false;
     }
 
 
@@ -108,6 +197,8 @@ namespace aspect
     ParticleHandler<dim,spacedim>::clear_particles()
     {
       particles.clear();
+      ghost_particles.clear();
+      std::fill(n_particles_per_cell.begin(),n_particles_per_cell.end(),0);
     }
 
 
@@ -116,7 +207,7 @@ namespace aspect
     typename ParticleHandler<dim,spacedim>::particle_iterator
     ParticleHandler<dim,spacedim>::begin() const
     {
-      return particle_iterator(particles,(const_cast<ParticleHandler<dim,spacedim> *> (this))->particles.begin());
+      return (const_cast<ParticleHandler<dim,spacedim> *> (this))->begin();
     }
 
 
@@ -125,7 +216,7 @@ namespace aspect
     typename ParticleHandler<dim,spacedim>::particle_iterator
     ParticleHandler<dim,spacedim>::begin()
     {
-      return ParticleHandler<dim,spacedim>::particle_iterator(particles,particles.begin());
+      return ParticleHandler<dim,spacedim>::particle_iterator(particles,0);
     }
 
 
@@ -143,7 +234,7 @@ namespace aspect
     typename ParticleHandler<dim,spacedim>::particle_iterator
     ParticleHandler<dim,spacedim>::end()
     {
-      return ParticleHandler<dim,spacedim>::particle_iterator(particles,particles.end());
+      return ParticleHandler<dim,spacedim>::particle_iterator(particles,particles.storage_size());
     }
 
 
@@ -152,7 +243,29 @@ namespace aspect
     typename ParticleHandler<dim,spacedim>::particle_iterator_range
     ParticleHandler<dim,spacedim>::particles_in_cell(const active_cell_it &cell) const
     {
-      return (const_cast<ParticleHandler<dim,spacedim> *> (this))->particles_in_cell(cell);
+      const types::LevelInd level_index = std::make_pair<int, int> (cell->level(),cell->index());
+
+      const ParticleContainer<dim,spacedim> &container = (!cell->is_ghost()
+                                                          ?
+                                                          particles
+                                                          :
+                                                          ghost_particles);
+
+      // This function must not modify the particle storage, therefore
+      // the storage has to be compressed after inserting particles
+      AssertThrow (!container.has_unsorted_particles_in_cell(level_index),
+                   ExcMessage("Particles were inserted into this cell since the particle "
+                              "storage was last compressed. Call the non-const version of this "
+                              "function, or compress the storage after inserting particles."));
+
+      const std::pair<typename ParticleContainer<dim,spacedim>::size_type,
+            typename ParticleContainer<dim,spacedim>::size_type> particles_in_cell = container.cell_range(level_index);
+
+      // The particle iterators can modify the particles they point to,
+      // but the range itself does not change the storage.
+      ParticleContainer<dim,spacedim> &iterator_container = const_cast<ParticleContainer<dim,spacedim> &> (container);
+      return boost::make_iterator_range(particle_iterator(iterator_container,particles_in_cell.first),
+                                        particle_iterator(iterator_container,particles_in_cell.second));
     }
 
 
@@ -163,16 +276,22 @@ namespace aspect
     {
       const types::LevelInd level_index = std::make_pair<int, int> (cell->level(),cell->index());
 
-      std::pair<typename std::multimap<types::LevelInd, Particle<dim,spacedim> >::iterator,
-          typename std::multimap<types::LevelInd, Particle<dim,spacedim> >::iterator> particles_in_cell;
+      ParticleContainer<dim,spacedim> &container = (!cell->is_ghost()
+                                                    ?
+                                                    particles
+                                                    :
+                                                    ghost_particles);
 
-      if (!cell->is_ghost())
-        particles_in_cell = particles.equal_range(level_index);
-      else
-        particles_in_cell = ghost_particles.equal_range(level_index);
+      // Particles that were inserted since the last compression are not
+      // part of the cell offset index yet
+      if (container.has_unsorted_particles_in_cell(level_index))
+        container.compress();
 
-      return boost::make_iterator_range(particle_iterator(particles,particles_in_cell.first),
-                                        particle_iterator(particles,particles_in_cell.second));
+      const std::pair<typename ParticleContainer<dim,spacedim>::size_type,
+            typename ParticleContainer<dim,spacedim>::size_type> particles_in_cell = container.cell_range(level_index);
+
+      return boost::make_iterator_range(particle_iterator(container,particles_in_cell.first),
+                                        particle_iterator(container,particles_in_cell.second));
     }
 
 
@@ -181,7 +300,11 @@ namespace aspect
     void
     ParticleHandler<dim,spacedim>::remove_particle(const ParticleHandler<dim,spacedim>::particle_iterator &particle)
     {
-      particles.erase(particle->particle);
+      Assert (particle->container == &particles,
+              ExcMessage("Only locally owned particles can be removed."));
+
+      --n_particles_per_cell[particle->get_surrounding_cell(*triangulation)->active_cell_index()];
+      particles.remove(particle->index);
     }
 
 
@@ -191,26 +314,38 @@ namespace aspect
     ParticleHandler<dim,spacedim>::insert_particle(const Particle<dim,spacedim> &particle,
                                                    const typename parallel::distributed::Triangulation<dim>::active_cell_iterator &cell)
     {
-      typename std::multimap<types::LevelInd, Particle<dim,spacedim> >::iterator it =
-        particles.insert(std::make_pair(types::LevelInd(cell->level(),cell->index()),particle));
+      const typename ParticleContainer<dim,spacedim>::size_type index =
+        particles.insert(types::LevelInd(cell->level(),cell->index()),particle);
+      ++n_particles_per_cell[cell->active_cell_index()];
 
-      particle_iterator particle_it (particles,it);
-      particle_it->set_property_pool(*property_pool);
+      return particle_iterator(particles,index);
+    }
 
-      if (particle.has_properties())
-        for (unsigned int n=0; n<particle.get_properties().size(); ++n)
-          particle_it->get_properties()[n] = particle.get_properties()[n];
 
-      return particle_it;
+
+    template <int dim,int spacedim>
+    void
+    ParticleHandler<dim,spacedim>::insert_particles(const std::multimap<types::LevelInd, Particle<dim,spacedim> > &new_particles)
+    {
+      particles.reserve(particles.storage_size() + new_particles.size());
+
+      for (typename std::multimap<types::LevelInd, Particle<dim,spacedim> >::const_iterator
+           particle = new_particles.begin(); particle != new_particles.end(); ++particle)
+        {
+          particles.insert(particle->first,particle->second);
+          ++n_particles_per_cell[get_active_cell_index(particle->first)];
+        }
+
+      particles.compress();
     }
 
 
 
     template <int dim,int spacedim>
     void
-    ParticleHandler<dim,spacedim>::insert_particles(const std::multimap<types::LevelInd, Particle<dim,spacedim> > &new_particles)
+    ParticleHandler<dim,spacedim>::compress_particle_storage()
     {
-      particles.insert(new_particles.begin(),new_particles.end());
+      particles.compress();
     }
 
 
@@ -228,7 +363,7 @@ namespace aspect
     types::particle_index
     ParticleHandler<dim,spacedim>::n_locally_owned_particles() const
     {
-      return particles.size();
+      return particles.n_particles();
     }
 
 
@@ -246,7 +381,7 @@ namespace aspect
     void
     ParticleHandler<dim,spacedim>::update_n_global_particles()
     {
-      global_number_of_particles = dealii::Utilities::MPI::sum (particles.size(), mpi_communicator);
+      global_number_of_particles = dealii::Utilities::MPI::sum (particles.n_particles(), mpi_communicator);
     }
 
 
@@ -255,16 +390,50 @@ namespace aspect
     unsigned int
     ParticleHandler<dim,spacedim>::n_particles_in_cell(const typename Triangulation<dim,spacedim>::active_cell_iterator &cell) const
     {
-      const types::LevelInd found_cell = std::make_pair<int, int> (cell->level(),cell->index());
-
-      if (cell->is_locally_owned())
-        return particles.count(found_cell);
-      else if (cell->is_ghost())
-        return ghost_particles.count(found_cell);
-      else if (cell->is_artificial())
+      if (cell->is_artificial())
         AssertThrow(false,ExcInternalError());
 
-      return 0;
+      AssertIndexRange(cell->active_cell_index(), n_particles_per_cell.size());
+      return n_particles_per_cell[cell->active_cell_index()];
+    }
+
+
+
+    template <int dim,int spacedim>
+    const std::vector<unsigned int> &
+    ParticleHandler<dim,spacedim>::get_n_particles_per_cell() const
+    {
+      Assert (n_particles_per_cell.size() == triangulation->n_active_cells(),
+              ExcInternalError());
+      return n_particles_per_cell;
+    }
+
+
+
+    template <int dim,int spacedim>
+    unsigned int
+    ParticleHandler<dim,spacedim>::get_active_cell_index(const types::LevelInd &cell) const
+    {
+      const typename Triangulation<dim,spacedim>::cell_iterator
+      cell_it (&(*triangulation), cell.first, cell.second);
+
+      return cell_it->active_cell_index();
+    }
+
+
+
+    template <int dim,int spacedim>
+    void
+    ParticleHandler<dim,spacedim>::recompute_n_particles_per_cell()
+    {
+      n_particles_per_cell.assign(triangulation->n_active_cells(),0);
+
+      std::vector<std::pair<types::LevelInd,unsigned int> > particles_per_cell;
+      particles.get_particles_per_cell(particles_per_cell);
+      ghost_particles.get_particles_per_cell(particles_per_cell);
+
+      for (unsigned int i=0; i<particles_per_cell.size(); ++i)
+        n_particles_per_cell[get_active_cell_index(particles_per_cell[i].first)] += particles_per_cell[i].second;
     }
 
 
@@ -403,6 +572,321 @@ namespace aspect
 
         return closest_vertex;
       }
+
+      /**
+       * The information that is attached to every cell during refinement
+       * if the particles are transferred separately from the
+       * triangulation: the process that stored the particles of the cell,
+       * their number, and their offset in the buffer of that process.
+       */
+      struct CellTransferInfo
+      {
+        unsigned long long offset;
+        unsigned int n_particles;
+        unsigned int process;
+      };
+
+      /**
+       * Return whether the box given by @p lower_corner and @p upper_corner
+       * contains the point @p position.
+       */
+      template <int spacedim>
+      bool
+      box_contains_point(const Point<spacedim> &lower_corner,
+                         const Point<spacedim> &upper_corner,
+                         const Point<spacedim> &position)
+      {
+        for (unsigned int d=0; d<spacedim; ++d)
+          if (position[d] < lower_corner[d] || position[d] > upper_corner[d])
+            return false;
+        return true;
+      }
+
+    }
+
+
+
+    template <int dim, int spacedim>
+    void
+    ParticleHandler<dim,spacedim>::update_cached_mesh_topology()
+    {
+      vertex_to_cells = GridTools::vertex_to_cell_map(*triangulation);
+      vertex_to_cell_centers = vertex_to_cell_centers_directions(vertex_to_cells);
+      mesh_topology_is_cached = true;
+    }
+
+
+
+    template <int dim, int spacedim>
+    void
+    ParticleHandler<dim,spacedim>::setup_neighbor_communication()
+    {
+      free_neighbor_communication();
+
+      const std::set<types::subdomain_id> ghost_owners = triangulation->ghost_owners();
+      neighbors.assign(ghost_owners.begin(), ghost_owners.end());
+      const unsigned int n_neighbors = neighbors.size();
+
+      n_send_data.assign(n_neighbors,0);
+      n_recv_data.assign(n_neighbors,0);
+      send_offsets.assign(n_neighbors,0);
+      recv_offsets.assign(n_neighbors,0);
+
+      // The persistent requests refer to the entries of n_send_data and
+      // n_recv_data, these vectors must therefore not be resized until the
+      // requests are freed.
+      size_requests.resize(2*n_neighbors);
+      for (unsigned int i=0; i<n_neighbors; ++i)
+        {
+          MPI_Recv_init(&(n_recv_data[i]), 1, MPI_UNSIGNED, neighbors[i], 0, mpi_communicator, &(size_requests[2*i]));
+          MPI_Send_init(&(n_send_data[i]), 1, MPI_UNSIGNED, neighbors[i], 0, mpi_communicator, &(size_requests[2*i+1]));
+        }
+
+      neighbor_communication_is_set_up = true;
+    }
+
+
+
+    template <int dim, int spacedim>
+    void
+    ParticleHandler<dim,spacedim>::free_neighbor_communication()
+    {
+      for (unsigned int i=0; i<size_requests.size(); ++i)
+        if (size_requests[i] != MPI_REQUEST_NULL)
+          MPI_Request_free(&(size_requests[i]));
+
+      size_requests.clear();
+      neighbor_communication_is_set_up = false;
+    }
+
+
+
+    template <int dim, int spacedim>
+    void
+    ParticleHandler<dim,spacedim>::update_cached_mesh_geometry()
+    {
+      // For these mappings a cell whose vertices form an axis-parallel box
+      // is mapped exactly onto this box
+      const MappingQGeneric<dim,spacedim> *mapping_q_generic = dynamic_cast<const MappingQGeneric<dim,spacedim> *> (&*mapping);
+      const bool mapping_preserves_boxes = (dim == spacedim)
+                                           &&
+                                           ((dynamic_cast<const MappingCartesian<dim,spacedim> *> (&*mapping) != NULL)
+                                            ||
+                                            (mapping_q_generic != NULL && mapping_q_generic->get_degree() == 1));
+
+      local_cells.clear();
+      cell_geometries.resize(triangulation->n_active_cells());
+
+      for (active_cell_it cell = triangulation->begin_active(); cell != triangulation->end(); ++cell)
+        if (cell->is_locally_owned() || cell->is_ghost())
+          {
+            local_cells.push_back(cell);
+
+            const std_cxx11::array<Point<spacedim>, GeometryInfo<dim>::vertices_per_cell> vertices
+              = mapping->get_vertices(cell);
+
+            CellGeometry &geometry = cell_geometries[cell->active_cell_index()];
+            geometry.lower_corner = vertices[0];
+            geometry.upper_corner = vertices[0];
+            for (unsigned int v=1; v<GeometryInfo<dim>::vertices_per_cell; ++v)
+              for (unsigned int d=0; d<spacedim; ++d)
+                {
+                  geometry.lower_corner[d] = std::min(geometry.lower_corner[d], vertices[v][d]);
+                  geometry.upper_corner[d] = std::max(geometry.upper_corner[d], vertices[v][d]);
+                }
+
+            // Vertex v of a cell in standard orientation is at the upper end
+            // of the cell in direction d if bit d of v is set
+            geometry.is_axis_parallel_box = mapping_preserves_boxes;
+            for (unsigned int v=0; v<GeometryInfo<dim>::vertices_per_cell && geometry.is_axis_parallel_box; ++v)
+              for (unsigned int d=0; d<spacedim; ++d)
+                if (vertices[v][d] != ((v & (1 << d)) ? geometry.upper_corner[d] : geometry.lower_corner[d]))
+                  {
+                    geometry.is_axis_parallel_box = false;
+                    break;
+                  }
+
+            // Curved cells may extend beyond the box around their
+            // vertices. Enlarge their box by a quarter of its diagonal, it is
+            // only used to reject points that are clearly not in the cell.
+            if (!geometry.is_axis_parallel_box)
+              {
+                const double tolerance = 0.25 * geometry.lower_corner.distance(geometry.upper_corner);
+                for (unsigned int d=0; d<spacedim; ++d)
+                  {
+                    geometry.lower_corner[d] -= tolerance;
+                    geometry.upper_corner[d] += tolerance;
+                  }
+              }
+          }
+
+      // Build a uniform grid of buckets around all local cells. The width
+      // of the buckets is chosen such that there is about one bucket per
+      // cell, which keeps the number of cells in each bucket small for
+      // reasonably graded meshes.
+      cell_buckets.clear();
+      if (local_cells.size() == 0)
+        {
+          mesh_geometry_is_cached = true;
+          return;
+        }
+
+      bucket_grid_lower_corner = cell_geometries[local_cells[0]->active_cell_index()].lower_corner;
+      Point<spacedim> bucket_grid_upper_corner = cell_geometries[local_cells[0]->active_cell_index()].upper_corner;
+      for (unsigned int i=1; i<local_cells.size(); ++i)
+        {
+          const CellGeometry &geometry = cell_geometries[local_cells[i]->active_cell_index()];
+          for (unsigned int d=0; d<spacedim; ++d)
+            {
+              bucket_grid_lower_corner[d] = std::min(bucket_grid_lower_corner[d], geometry.lower_corner[d]);
+              bucket_grid_upper_corner[d] = std::max(bucket_grid_upper_corner[d], geometry.upper_corner[d]);
+            }
+        }
+
+      double volume = 1.0;
+      for (unsigned int d=0; d<spacedim; ++d)
+        volume *= bucket_grid_upper_corner[d] - bucket_grid_lower_corner[d];
+      const double typical_width = std::pow(volume / local_cells.size(), 1.0/spacedim);
+
+      std::size_t n_total_buckets = 1;
+      for (unsigned int d=0; d<spacedim; ++d)
+        {
+          const double extent = bucket_grid_upper_corner[d] - bucket_grid_lower_corner[d];
+          n_buckets[d] = (typical_width > 0.0)
+                         ?
+                         static_cast<unsigned int> (std::min<double>(std::ceil(extent / typical_width),
+                                                                     local_cells.size()))
+                         :
+                         1;
+          n_buckets[d] = std::max(n_buckets[d], 1u);
+          bucket_width[d] = extent / n_buckets[d];
+          n_total_buckets *= n_buckets[d];
+        }
+
+      cell_buckets.resize(n_total_buckets);
+      for (unsigned int i=0; i<local_cells.size(); ++i)
+        {
+          const CellGeometry &geometry = cell_geometries[local_cells[i]->active_cell_index()];
+
+          std_cxx11::array<unsigned int,spacedim> first_bucket, last_bucket;
+          std::size_t n_overlapping_buckets = 1;
+          for (unsigned int d=0; d<spacedim; ++d)
+            {
+              first_bucket[d] = bucket_index(geometry.lower_corner[d], d);
+              last_bucket[d] = bucket_index(geometry.upper_corner[d], d);
+              n_overlapping_buckets *= last_bucket[d] - first_bucket[d] + 1;
+            }
+
+          // Loop over all buckets in the range [first_bucket,last_bucket]
+          for (std::size_t b=0; b<n_overlapping_buckets; ++b)
+            {
+              std::size_t remainder = b;
+              std::size_t bucket = 0;
+              for (int d=spacedim-1; d>=0; --d)
+                {
+                  const unsigned int n_in_direction = last_bucket[d] - first_bucket[d] + 1;
+                  bucket = bucket * n_buckets[d] + first_bucket[d] + remainder % n_in_direction;
+                  remainder /= n_in_direction;
+                }
+              cell_buckets[bucket].push_back(i);
+            }
+        }
+
+      mesh_geometry_is_cached = true;
+    }
+
+
+
+    template <int dim, int spacedim>
+    unsigned int
+    ParticleHandler<dim,spacedim>::bucket_index(const double coordinate,
+                                                const unsigned int direction) const
+    {
+      if (bucket_width[direction] <= 0.0
+          || coordinate <= bucket_grid_lower_corner[direction])
+        return 0;
+
+      return std::min(static_cast<unsigned int> ((coordinate - bucket_grid_lower_corner[direction])
+                                                 / bucket_width[direction]),
+                      n_buckets[direction] - 1);
+    }
+
+
+
+    template <int dim, int spacedim>
+    bool
+    ParticleHandler<dim,spacedim>::compute_reference_location(const active_cell_it &cell,
+                                                              const Point<spacedim> &location,
+                                                              Point<dim> &reference_location) const
+    {
+      Assert (mesh_geometry_is_cached, ExcInternalError());
+      Assert (cell->is_locally_owned() || cell->is_ghost(), ExcInternalError());
+
+      const CellGeometry &geometry = cell_geometries[cell->active_cell_index()];
+
+      if (!box_contains_point(geometry.lower_corner, geometry.upper_corner, location))
+        return false;
+
+      if (geometry.is_axis_parallel_box)
+        {
+          for (unsigned int d=0; d<dim; ++d)
+            reference_location[d] = (location[d] - geometry.lower_corner[d])
+                                    / (geometry.upper_corner[d] - geometry.lower_corner[d]);
+          return GeometryInfo<dim>::is_inside_unit_cell(reference_location);
+        }
+
+      try
+        {
+          reference_location = mapping->transform_real_to_unit_cell(cell, location);
+          return GeometryInfo<dim>::is_inside_unit_cell(reference_location);
+        }
+      catch (typename Mapping<dim,spacedim>::ExcTransformationFailed &)
+        {
+          return false;
+        }
+    }
+
+
+
+    template <int dim, int spacedim>
+    bool
+    ParticleHandler<dim,spacedim>::find_local_cell_around_point(const Point<spacedim> &location,
+                                                                const bool include_ghost_cells,
+                                                                active_cell_it &cell,
+                                                                Point<dim> &reference_location) const
+    {
+      Assert (mesh_geometry_is_cached, ExcInternalError());
+
+      if (cell_buckets.size() == 0)
+        return false;
+
+      // Points outside the bucket grid are not in any local cell. Inside,
+      // the bucket in direction d is found by bucket_index(), and the
+      // buckets are numbered lexicographically with direction 0 running
+      // fastest.
+      std::size_t bucket = 0;
+      for (int d=spacedim-1; d>=0; --d)
+        {
+          if (location[d] < bucket_grid_lower_corner[d]
+              || location[d] > bucket_grid_lower_corner[d] + n_buckets[d] * bucket_width[d])
+            return false;
+
+          bucket = bucket * n_buckets[d] + bucket_index(location[d], d);
+        }
+
+      const std::vector<unsigned int> &candidate_cells = cell_buckets[bucket];
+      for (unsigned int i=0; i<candidate_cells.size(); ++i)
+        {
+          const active_cell_it &local_cell = local_cells[candidate_cells[i]];
+          if ((include_ghost_cells || local_cell->is_locally_owned())
+              && compute_reference_location(local_cell, location, reference_location))
+            {
+              cell = local_cell;
+              return true;
+            }
+        }
+
+      return false;
     }
 
 
@@ -414,44 +898,41 @@ namespace aspect
       std::vector<particle_iterator> particles_out_of_cell;
       particles_out_of_cell.reserve(n_locally_owned_particles());
 
+      if (!mesh_topology_is_cached)
+        update_cached_mesh_topology();
+      if (!mesh_geometry_is_cached)
+        update_cached_mesh_geometry();
+
       // Now update the reference locations of the moved particles
       for (particle_iterator it=begin(); it!=end(); ++it)
         {
-          const typename parallel::distributed::Triangulation<dim,spacedim>::cell_iterator cell = it->get_surrounding_cell(*triangulation);
+          const active_cell_it cell (it->get_surrounding_cell(*triangulation));
 
-          try
+          Point<dim> p_unit;
+          if (compute_reference_location(cell, it->get_location(), p_unit))
             {
-              const Point<dim> p_unit = mapping->transform_real_to_unit_cell(cell, it->get_location());
-              if (GeometryInfo<dim>::is_inside_unit_cell(p_unit))
-                {
-                  it->set_reference_location(p_unit);
-                }
-              else
-                {
-                  // The particle has left the cell
-                  particles_out_of_cell.push_back(it);
-                }
+              it->set_reference_location(p_unit);
             }
-          catch (typename Mapping<dim>::ExcTransformationFailed &)
+          else
             {
               // The particle has left the cell
               particles_out_of_cell.push_back(it);
             }
         }
 
-      // TODO: The current algorithm only works for CFL numbers <= 1.0,
-      // because it only knows the subdomain_id of ghost cells, but not
-      // of artificial cells.
-
       // There are three reasons why a particle is not in its old cell:
       // It moved to another cell, to another subdomain or it left the mesh.
-      // Particles that moved to another cell are updated and stored inside the
-      // sorted_particles vector, particles that moved to another domain are
-      // collected in the moved_particles_domain vector. Particles that left
-      // the mesh completely are ignored and removed.
-      std::vector<std::pair<types::LevelInd, Particle<dim,spacedim> > > sorted_particles;
+      // Particles that moved to another cell are moved to the end of the
+      // particle storage (without copying their properties) and are sorted
+      // into their new cell when the storage is compressed, particles that
+      // moved to a neighboring domain are collected in the moved_particles
+      // vector. Particles that are neither in a locally owned nor in a ghost
+      // cell (e.g. because they moved further than one cell in one time
+      // step) are collected in particles_out_of_domain and are sent to the
+      // process that owns their new cell, if there is one.
       std::vector<std::vector<particle_iterator> > moved_particles;
       std::vector<std::vector<active_cell_it> > moved_cells;
+      std::vector<particle_iterator> particles_out_of_domain;
 
       // We do not know exactly how many particles are lost, exchanged between
       // domains, or remain on this process. Therefore we pre-allocate approximate
@@ -459,7 +940,7 @@ namespace aspect
       // relatively fast (compared to other parts of this algorithm)
       // re-allocation will happen.
       typedef typename std::vector<particle_iterator>::size_type vector_size;
-      sorted_particles.reserve(static_cast<vector_size> (particles_out_of_cell.size()*1.25));
+      particles.reserve(particles.storage_size() + particles_out_of_cell.size());
       const std::map<types::subdomain_id, unsigned int> subdomain_to_neighbor_map(get_subdomain_id_to_neighbor_map());
 
       moved_particles.resize(subdomain_to_neighbor_map.size());
@@ -472,13 +953,6 @@ namespace aspect
         }
 
       {
-        // Create a map from vertices to adjacent cells
-        const std::vector<std::set<typename Triangulation<dim,spacedim>::active_cell_iterator> >
-        vertex_to_cells(GridTools::vertex_to_cell_map(*triangulation));
-
-        // Create a corresponding map of vectors from vertex to cell center
-        const std::vector<std::vector<Tensor<1,spacedim> > > vertex_to_cell_centers(vertex_to_cell_centers_directions(vertex_to_cells));
-
         std::vector<unsigned int> neighbor_permutation;
 
         // Find the cells that the particles moved to.
@@ -488,12 +962,13 @@ namespace aspect
         for (; it!=end_particle; ++it)
           {
             // The cell the particle is in
-            Point<spacedim> current_reference_position;
+            Point<dim> current_reference_position;
             bool found_cell = false;
 
             // Check if the particle is in one of the old cell's neighbors
             // that are adjacent to the closest vertex
             active_cell_it current_cell = (*it)->get_surrounding_cell(*triangulation);
+            const unsigned int old_cell_index = current_cell->active_cell_index();
 
             const unsigned int closest_vertex = get_closest_vertex_of_cell(current_cell,(*it)->get_location());
             Tensor<1,spacedim> vertex_to_particle = (*it)->get_location() - current_cell->vertex(closest_vertex);
@@ -518,43 +993,36 @@ namespace aspect
             // Most likely we will find the particle in them.
             for (unsigned int i=0; i<n_neighbor_cells; ++i)
               {
-                try
+                typename std::set<active_cell_it>::const_iterator cell = vertex_to_cells[closest_vertex_index].begin();
+                std::advance(cell,neighbor_permutation[i]);
+
+                // We do not know the owner of artificial cells
+                if ((*cell)->is_artificial())
+                  continue;
+
+                if (compute_reference_location(*cell, (*it)->get_location(), current_reference_position))
                   {
-                    typename std::set<typename Triangulation<dim>::active_cell_iterator>::const_iterator cell = vertex_to_cells[closest_vertex_index].begin();
-                    std::advance(cell,neighbor_permutation[i]);
-                    const Point<dim> p_unit = mapping->transform_real_to_unit_cell(*cell,
-                                                                                   (*it)->get_location());
-                    if (GeometryInfo<dim>::is_inside_unit_cell(p_unit))
-                      {
-                        current_cell = *cell;
-                        current_reference_position = p_unit;
-                        found_cell = true;
-                        break;
-                      }
+                    current_cell = *cell;
+                    found_cell = true;
+                    break;
                   }
-                catch (typename Mapping<dim>::ExcTransformationFailed &)
-                  {}
               }
 
             if (!found_cell)
               {
                 // The particle is not in a neighbor of the old cell.
-                // Look for the new cell in the whole local domain.
-                // This case is rare.
-                try
+                // Look for the new cell in all locally owned and ghost
+                // cells. This case is rare.
+                if (!find_local_cell_around_point((*it)->get_location(),
+                                                  true,
+                                                  current_cell,
+                                                  current_reference_position))
                   {
-                    const std::pair<const typename parallel::distributed::Triangulation<dim>::active_cell_iterator,
-                          Point<dim> > current_cell_and_position =
-                            GridTools::find_active_cell_around_point<> (*mapping,
-                                                                        *triangulation,
-                                                                        (*it)->get_location());
-                    current_cell = current_cell_and_position.first;
-                    current_reference_position = current_cell_and_position.second;
-                  }
-                catch (GridTools::ExcPointNotFound<dim> &)
-                  {
-                    // We can find no cell for this particle. It has left the
-                    // domain due to an integration error or an open boundary.
+                    // We can find no local cell for this particle. It either
+                    // moved into the domain of a process that is not our
+                    // neighbor, or it has left the domain due to an
+                    // integration error or an open boundary.
+                    particles_out_of_domain.push_back(*it);
                     continue;
                   }
               }
@@ -562,12 +1030,14 @@ namespace aspect
             // If we are here, we found a cell and reference position for this particle
             (*it)->set_reference_location(current_reference_position);
 
-            // Reinsert the particle into our domain if we own its cell.
+            // Move the particle into its new cell if we own the cell.
             // Mark it for MPI transfer otherwise
             if (current_cell->is_locally_owned())
               {
-                sorted_particles.push_back(std::make_pair(types::LevelInd(current_cell->level(),current_cell->index()),
-                                                          (*it)->particle->second));
+                --n_particles_per_cell[old_cell_index];
+                ++n_particles_per_cell[current_cell->active_cell_index()];
+                particles.move_to_cell((*it)->index,
+                                       types::LevelInd(current_cell->level(),current_cell->index()));
               }
             else
               {
@@ -578,20 +1048,61 @@ namespace aspect
           }
       }
 
-      // Sort the updated particles. This pre-sort speeds up inserting
-      // them into particles to O(N) complexity.
-      std::multimap<types::LevelInd,Particle <dim,spacedim> > sorted_particles_map;
+      // Exchange particles between processors if we have more than one process.
+      // Received particles are appended to the particle storage, which
+      // keeps the iterators to the sent particles valid.
+      const bool is_parallel = (dealii::Utilities::MPI::n_mpi_processes(mpi_communicator) > 1);
+      if (is_parallel)
+        start_particle_exchange(moved_particles,moved_cells);
 
-      // Exchange particles between processors if we have more than one process
-      if (dealii::Utilities::MPI::n_mpi_processes(mpi_communicator) > 1)
-        send_recv_particles(moved_particles,sorted_particles_map,moved_cells);
+      // The data of the moved particles is now stored in the send buffer,
+      // so they can be removed while their data is in transit.
+      for (unsigned int i=0; i<moved_particles.size(); ++i)
+        for (unsigned int j=0; j<moved_particles[i].size(); ++j)
+          remove_particle(moved_particles[i][j]);
 
-      sorted_particles_map.insert(sorted_particles.begin(),sorted_particles.end());
+      if (is_parallel)
+        {
+          // Particles that moved further than into a ghost cell have to
+          // be sent to processes that are not necessarily our neighbors.
+          // This needs global communication, therefore only do it if some
+          // process found such particles. This overlaps with the exchange
+          // between neighbors, which uses different message tags.
+          if (dealii::Utilities::MPI::max(static_cast<unsigned int> (particles_out_of_domain.size()),mpi_communicator) > 0)
+            send_recv_particles_to_remote_processes(particles_out_of_domain,particles);
+
+          finish_particle_exchange(particles);
+        }
+
+      // Particles that were sent to a remote process, or for which no
+      // process was found, have left the local domain
+      for (unsigned int i=0; i<particles_out_of_domain.size(); ++i)
+        remove_particle(particles_out_of_domain[i]);
+
+      // Sort all moved and received particles into their new cells and
+      // reclaim the space of the removed particles.
+      particles.compress();
+    }
+
+
+
+    template <int dim, int spacedim>
+    void
+    ParticleHandler<dim,spacedim>::sort_property_memory()
+    {
+      if (property_pool->n_properties_per_slot() + property_pool->n_integrator_data_per_slot() == 0)
+        return;
 
-      for (unsigned int i=0; i<particles_out_of_cell.size(); ++i)
-        remove_particle(particles_out_of_cell[i]);
+      std::vector<PropertyPool::Handle> handles;
+      handles.reserve(particles.n_particles() + ghost_particles.n_particles());
 
-      particles.insert(sorted_particles_map.begin(),sorted_particles_map.end());
+      particles.get_property_handles(handles);
+      ghost_particles.get_property_handles(handles);
+
+      property_pool->sort_memory_slots(handles);
+
+      const std::size_t n_local_handles = particles.set_property_handles(handles,0);
+      ghost_particles.set_property_handles(handles,n_local_handles);
     }
 
 
@@ -604,9 +1115,6 @@ namespace aspect
       if (dealii::Utilities::MPI::n_mpi_processes(mpi_communicator) == 1)
         return;
 
-      // First clear the current ghost_particle information
-      ghost_particles.clear();
-
       const std::map<types::subdomain_id, unsigned int> subdomain_to_neighbor_map(get_subdomain_id_to_neighbor_map());
 
       std::vector<std::vector<particle_iterator> > ghost_particles_by_domain(subdomain_to_neighbor_map.size());
@@ -651,8 +1159,37 @@ namespace aspect
             }
         }
 
-      send_recv_particles(ghost_particles_by_domain,
-                          ghost_particles);
+      start_particle_exchange(ghost_particles_by_domain,
+                              std::vector<std::vector<active_cell_it> >(),
+                              compact_ghost_exchange);
+
+      // Clear the current ghost particle information while the new
+      // ghost particles are in transit. Only ghost particles count for
+      // ghost cells, so their particle numbers can simply be reset.
+      std::vector<std::pair<types::LevelInd,unsigned int> > ghost_particles_per_cell;
+      ghost_particles.get_particles_per_cell(ghost_particles_per_cell);
+      for (unsigned int i=0; i<ghost_particles_per_cell.size(); ++i)
+        n_particles_per_cell[get_active_cell_index(ghost_particles_per_cell[i].first)] = 0;
+
+      ghost_particles.clear();
+
+      finish_particle_exchange(ghost_particles,
+                               compact_ghost_exchange);
+
+      ghost_particles.compress();
+    }
+
+
+
+    template <int dim, int spacedim>
+    void
+    ParticleHandler<dim,spacedim>::set_ghost_property_indices(const std::vector<unsigned int> &property_indices)
+    {
+      for (unsigned int i=0; i<property_indices.size(); ++i)
+        AssertIndexRange(property_indices[i], property_pool->n_properties_per_slot());
+
+      ghost_property_indices = property_indices;
+      compact_ghost_exchange = true;
     }
 
 
@@ -660,13 +1197,28 @@ namespace aspect
     template <int dim, int spacedim>
     void
     ParticleHandler<dim,spacedim>::send_recv_particles(const std::vector<std::vector<particle_iterator> > &particles_to_send,
-                                                       std::multimap<types::LevelInd,Particle <dim> >     &received_particles,
+                                                       ParticleContainer<dim,spacedim>                    &received_particles,
                                                        const std::vector<std::vector<active_cell_it> >    &send_cells)
     {
+      start_particle_exchange(particles_to_send,send_cells);
+      finish_particle_exchange(received_particles);
+    }
+
+
+
+    template <int dim, int spacedim>
+    void
+    ParticleHandler<dim,spacedim>::start_particle_exchange(const std::vector<std::vector<particle_iterator> > &particles_to_send,
+                                                           const std::vector<std::vector<active_cell_it> >    &send_cells,
+                                                           const bool                                          compact_format)
+    {
+      Assert(!particle_exchange_in_progress,
+             ExcMessage("A particle exchange has to be finished before the next one can be started."));
+
       // Determine the communication pattern
-      const std::set<types::subdomain_id> ghost_owners = triangulation->ghost_owners();
-      const std::vector<types::subdomain_id> neighbors (ghost_owners.begin(),
-                                                        ghost_owners.end());
+      if (!neighbor_communication_is_set_up)
+        setup_neighbor_communication();
+
       const unsigned int n_neighbors = neighbors.size();
 
       Assert(n_neighbors == particles_to_send.size(),
@@ -681,26 +1233,31 @@ namespace aspect
 
       const unsigned int cellid_size = sizeof(CellId::binary_type);
 
-      // Containers for the amount and offsets of data we will send
-      // to other processors and the data itself.
-      std::vector<unsigned int> n_send_data(n_neighbors,0);
-      std::vector<unsigned int> send_offsets(n_neighbors,0);
-      std::vector<char> send_data;
+      std::fill(n_send_data.begin(),n_send_data.end(),0);
+      std::fill(send_offsets.begin(),send_offsets.end(),0);
 
       // Only serialize things if there are particles to be send.
       // We can not return early even if no particles
       // are send, because we might receive particles from other processes
       if (n_send_particles > 0)
         {
-          // Allocate space for sending particle data
-          const unsigned int particle_size = begin()->serialized_size_in_bytes() + cellid_size + (size_callback ? size_callback() : 0);
-          send_data.resize(n_send_particles * particle_size);
-          void *data = static_cast<void *> (&send_data.front());
+          // Allocate space for sending particle data. The buffer keeps its
+          // capacity between exchanges, so this only allocates memory if
+          // more data is sent than ever before.
+          // The compact format only contains the id, the location, and the
+          // selected properties of every particle.
+          const unsigned int particle_size = (compact_format
+                                              ?
+                                              ParticleContainer<dim,spacedim>::compact_size_in_bytes(ghost_property_indices.size()) + cellid_size
+                                              :
+                                              begin()->serialized_size_in_bytes() + cellid_size + (size_callback ? size_callback() : 0));
+          send_buffer.resize(n_send_particles * particle_size);
+          void *data = static_cast<void *> (&send_buffer.front());
 
           // Serialize the data sorted by receiving process
           for (types::subdomain_id neighbor_id = 0; neighbor_id < n_neighbors; ++neighbor_id)
             {
-              send_offsets[neighbor_id] = reinterpret_cast<std::size_t> (data) - reinterpret_cast<std::size_t> (&send_data.front());
+              send_offsets[neighbor_id] = reinterpret_cast<std::size_t> (data) - reinterpret_cast<std::size_t> (&send_buffer.front());
 
               for (unsigned int i=0; i<particles_to_send[neighbor_id].size(); ++i)
                 {
@@ -715,27 +1272,52 @@ namespace aspect
                   memcpy(data, &cellid, cellid_size);
                   data = static_cast<char *>(data) + cellid_size;
 
-                  particles_to_send[neighbor_id][i]->write_data(data);
-                  if (store_callback)
-                    data = store_callback(particles_to_send[neighbor_id][i],data);
+                  if (compact_format)
+                    particles_to_send[neighbor_id][i]->write_compact_data(ghost_property_indices,data);
+                  else
+                    {
+                      particles_to_send[neighbor_id][i]->write_data(data);
+                      if (store_callback)
+                        data = store_callback(particles_to_send[neighbor_id][i],data);
+                    }
                 }
-              n_send_data[neighbor_id] = reinterpret_cast<std::size_t> (data) - send_offsets[neighbor_id] - reinterpret_cast<std::size_t> (&send_data.front());
+              n_send_data[neighbor_id] = reinterpret_cast<std::size_t> (data) - send_offsets[neighbor_id] - reinterpret_cast<std::size_t> (&send_buffer.front());
             }
         }
 
-      // Containers for the data we will receive from other processors
-      std::vector<unsigned int> n_recv_data(n_neighbors);
-      std::vector<unsigned int> recv_offsets(n_neighbors);
-
       // Notify other processors how many particles we will send
-      {
-        std::vector<MPI_Request> n_requests(2*n_neighbors);
-        for (unsigned int i=0; i<n_neighbors; ++i)
-          MPI_Irecv(&(n_recv_data[i]), 1, MPI_INT, neighbors[i], 0, mpi_communicator, &(n_requests[2*i]));
-        for (unsigned int i=0; i<n_neighbors; ++i)
-          MPI_Isend(&(n_send_data[i]), 1, MPI_INT, neighbors[i], 0, mpi_communicator, &(n_requests[2*i+1]));
-        MPI_Waitall(2*n_neighbors,&n_requests[0],MPI_STATUSES_IGNORE);
-      }
+      if (n_neighbors > 0)
+        MPI_Startall(size_requests.size(),&size_requests[0]);
+
+      // We already know what we send, so the particle data can be sent
+      // without waiting for the sizes. The receives are posted in
+      // finish_particle_exchange() once the sizes have arrived.
+      data_requests.clear();
+      for (unsigned int i=0; i<n_neighbors; ++i)
+        if (n_send_data[i] > 0)
+          {
+            data_requests.push_back(MPI_Request());
+            MPI_Isend(&(send_buffer[send_offsets[i]]), n_send_data[i], MPI_CHAR, neighbors[i], 1, mpi_communicator, &data_requests.back());
+          }
+
+      particle_exchange_in_progress = true;
+    }
+
+
+
+    template <int dim, int spacedim>
+    void
+    ParticleHandler<dim,spacedim>::finish_particle_exchange(ParticleContainer<dim,spacedim> &received_particles,
+                                                            const bool                       compact_format)
+    {
+      Assert(particle_exchange_in_progress,
+             ExcMessage("finish_particle_exchange() can only be called after start_particle_exchange()."));
+
+      const unsigned int n_neighbors = neighbors.size();
+      const unsigned int cellid_size = sizeof(CellId::binary_type);
+
+      if (n_neighbors > 0)
+        MPI_Waitall(size_requests.size(),&size_requests[0],MPI_STATUSES_IGNORE);
 
       // Determine how many particles and data we will receive
       unsigned int total_recv_data = 0;
@@ -746,34 +1328,28 @@ namespace aspect
         }
 
       // Set up the space for the received particle data
-      std::vector<char> recv_data(total_recv_data);
+      recv_buffer.resize(total_recv_data);
 
-      // Exchange the particle data between domains
-      {
-        std::vector<MPI_Request> requests(2*n_neighbors);
-        unsigned int send_ops = 0;
-        unsigned int recv_ops = 0;
+      // Receive the particle data and wait for our own sends to finish
+      for (unsigned int i=0; i<n_neighbors; ++i)
+        if (n_recv_data[i] > 0)
+          {
+            data_requests.push_back(MPI_Request());
+            MPI_Irecv(&(recv_buffer[recv_offsets[i]]), n_recv_data[i], MPI_CHAR, neighbors[i], 1, mpi_communicator, &data_requests.back());
+          }
 
-        for (unsigned int i=0; i<n_neighbors; ++i)
-          if (n_recv_data[i] > 0)
-            {
-              MPI_Irecv(&(recv_data[recv_offsets[i]]), n_recv_data[i], MPI_CHAR, neighbors[i], 1, mpi_communicator,&(requests[send_ops]));
-              send_ops++;
-            }
+      if (data_requests.size() > 0)
+        MPI_Waitall(data_requests.size(),&data_requests[0],MPI_STATUSES_IGNORE);
 
-        for (unsigned int i=0; i<n_neighbors; ++i)
-          if (n_send_data[i] > 0)
-            {
-              MPI_Isend(&(send_data[send_offsets[i]]), n_send_data[i], MPI_CHAR, neighbors[i], 1, mpi_communicator,&(requests[send_ops+recv_ops]));
-              recv_ops++;
-            }
-        MPI_Waitall(send_ops+recv_ops,&requests[0],MPI_STATUSES_IGNORE);
-      }
+      particle_exchange_in_progress = false;
+
+      if (total_recv_data == 0)
+        return;
 
       // Put the received particles into the domain if they are in the triangulation
-      const void *recv_data_it = static_cast<const void *> (&recv_data.front());
+      const void *recv_data_it = static_cast<const void *> (&recv_buffer.front());
 
-      while (reinterpret_cast<std::size_t> (recv_data_it) - reinterpret_cast<std::size_t> (&recv_data.front()) < total_recv_data)
+      while (reinterpret_cast<std::size_t> (recv_data_it) - reinterpret_cast<std::size_t> (&recv_buffer.front()) < total_recv_data)
         {
           CellId::binary_type binary_cellid;
           memcpy(&binary_cellid, recv_data_it, cellid_size);
@@ -781,22 +1357,276 @@ namespace aspect
           recv_data_it = static_cast<const char *> (recv_data_it) + cellid_size;
 
           const active_cell_it cell = id.to_cell(*triangulation);
+          ++n_particles_per_cell[cell->active_cell_index()];
 
-          typename std::multimap<types::LevelInd,Particle <dim> >::iterator recv_particle =
-            received_particles.insert(std::make_pair(types::LevelInd(cell->level(),cell->index()),
-                                                     Particle<dim,spacedim>(recv_data_it,*property_pool)));
+          if (compact_format)
+            received_particles.insert_compact(types::LevelInd(cell->level(),cell->index()),
+                                              ghost_property_indices,
+                                              recv_data_it);
+          else
+            {
+              const typename ParticleContainer<dim,spacedim>::size_type recv_particle =
+                received_particles.insert(types::LevelInd(cell->level(),cell->index()),
+                                          recv_data_it);
 
-          if (load_callback)
-            recv_data_it = load_callback(particle_iterator(received_particles,recv_particle),
-                                         recv_data_it);
+              if (load_callback)
+                recv_data_it = load_callback(particle_iterator(received_particles,recv_particle),
+                                             recv_data_it);
+            }
         }
 
-      AssertThrow(recv_data_it == &recv_data.back()+1,
+      AssertThrow(recv_data_it == &recv_buffer.back()+1,
                   ExcMessage("The amount of data that was read into new particles "
                              "does not match the amount of data sent around."));
     }
 
 
+
+    template <int dim, int spacedim>
+    void
+    ParticleHandler<dim,spacedim>::send_recv_particles_to_remote_processes(const std::vector<particle_iterator> &particles_to_send,
+                                                                           ParticleContainer<dim,spacedim>      &received_particles)
+    {
+      const unsigned int n_processes = dealii::Utilities::MPI::n_mpi_processes(mpi_communicator);
+      const unsigned int my_rank = dealii::Utilities::MPI::this_mpi_process(mpi_communicator);
+      const unsigned int cellid_size = sizeof(CellId::binary_type);
+
+      Assert (mesh_geometry_is_cached, ExcInternalError());
+
+      // Determine a bounding box for the locally owned domain of every process
+      std::vector<double> local_domain_box(2*spacedim);
+      for (unsigned int d=0; d<spacedim; ++d)
+        {
+          local_domain_box[d] = std::numeric_limits<double>::max();
+          local_domain_box[spacedim+d] = -std::numeric_limits<double>::max();
+        }
+
+      for (typename std::vector<active_cell_it>::const_iterator
+           cell = local_cells.begin(); cell != local_cells.end(); ++cell)
+        if ((*cell)->is_locally_owned())
+          {
+            const CellGeometry &geometry = cell_geometries[(*cell)->active_cell_index()];
+            for (unsigned int d=0; d<spacedim; ++d)
+              {
+                local_domain_box[d] = std::min(local_domain_box[d], geometry.lower_corner[d]);
+                local_domain_box[spacedim+d] = std::max(local_domain_box[spacedim+d], geometry.upper_corner[d]);
+              }
+          }
+
+      std::vector<double> domain_boxes(2*spacedim*n_processes);
+      MPI_Allgather(&local_domain_box[0], 2*spacedim, MPI_DOUBLE,
+                    &domain_boxes[0], 2*spacedim, MPI_DOUBLE,
+                    mpi_communicator);
+
+      // Ask every process whose domain box contains one of our particles
+      // whether it owns the cell around the particle location
+      std::vector<std::vector<double> > send_queries(n_processes);
+      std::vector<std::vector<unsigned int> > queried_particles(n_processes);
+
+      for (unsigned int i=0; i<particles_to_send.size(); ++i)
+        {
+          const Point<spacedim> location = particles_to_send[i]->get_location();
+
+          for (unsigned int rank=0; rank<n_processes; ++rank)
+            {
+              if (rank == my_rank)
+                continue;
+
+              Point<spacedim> lower_corner, upper_corner;
+              for (unsigned int d=0; d<spacedim; ++d)
+                {
+                  lower_corner[d] = domain_boxes[2*spacedim*rank+d];
+                  upper_corner[d] = domain_boxes[2*spacedim*rank+spacedim+d];
+                }
+
+              if (box_contains_point(lower_corner,upper_corner,location))
+                {
+                  for (unsigned int d=0; d<spacedim; ++d)
+                    send_queries[rank].push_back(location[d]);
+                  queried_particles[rank].push_back(i);
+                }
+            }
+        }
+
+      std::vector<unsigned int> n_send_queries(n_processes);
+      std::vector<unsigned int> n_recv_queries(n_processes);
+      for (unsigned int rank=0; rank<n_processes; ++rank)
+        n_send_queries[rank] = queried_particles[rank].size();
+
+      MPI_Alltoall(&n_send_queries[0], 1, MPI_UNSIGNED,
+                   &n_recv_queries[0], 1, MPI_UNSIGNED,
+                   mpi_communicator);
+
+      std::vector<std::vector<double> > recv_queries(n_processes);
+      {
+        std::vector<MPI_Request> requests;
+        requests.reserve(2*n_processes);
+        for (unsigned int rank=0; rank<n_processes; ++rank)
+          if (n_recv_queries[rank] > 0)
+            {
+              recv_queries[rank].resize(spacedim*n_recv_queries[rank]);
+              requests.push_back(MPI_Request());
+              MPI_Irecv(&recv_queries[rank][0], spacedim*n_recv_queries[rank], MPI_DOUBLE, rank, 2, mpi_communicator, &requests.back());
+            }
+        for (unsigned int rank=0; rank<n_processes; ++rank)
+          if (n_send_queries[rank] > 0)
+            {
+              requests.push_back(MPI_Request());
+              MPI_Isend(&send_queries[rank][0], spacedim*n_send_queries[rank], MPI_DOUBLE, rank, 2, mpi_communicator, &requests.back());
+            }
+        if (requests.size() > 0)
+          MPI_Waitall(requests.size(),&requests[0],MPI_STATUSES_IGNORE);
+      }
+
+      // Answer the queries of other processes. Every answer consists of one
+      // byte that states whether we own the location, followed by the id
+      // of the cell that contains it.
+      const unsigned int answer_size = 1 + cellid_size;
+      std::vector<std::vector<char> > send_answers(n_processes);
+      std::vector<std::vector<char> > recv_answers(n_processes);
+      for (unsigned int rank=0; rank<n_processes; ++rank)
+        {
+          send_answers[rank].resize(answer_size*n_recv_queries[rank],0);
+
+          for (unsigned int i=0; i<n_recv_queries[rank]; ++i)
+            {
+              Point<spacedim> location;
+              for (unsigned int d=0; d<spacedim; ++d)
+                location[d] = recv_queries[rank][spacedim*i+d];
+
+              active_cell_it cell;
+              Point<dim> reference_position;
+              if (find_local_cell_around_point(location,false,cell,reference_position))
+                {
+                  const CellId::binary_type cellid = cell->id().template to_binary<dim>();
+                  send_answers[rank][answer_size*i] = 1;
+                  memcpy(&send_answers[rank][answer_size*i+1], &cellid, cellid_size);
+                }
+            }
+
+          recv_answers[rank].resize(answer_size*n_send_queries[rank]);
+        }
+
+      {
+        std::vector<MPI_Request> requests;
+        requests.reserve(2*n_processes);
+        for (unsigned int rank=0; rank<n_processes; ++rank)
+          if (n_send_queries[rank] > 0)
+            {
+              requests.push_back(MPI_Request());
+              MPI_Irecv(&recv_answers[rank][0], recv_answers[rank].size(), MPI_CHAR, rank, 3, mpi_communicator, &requests.back());
+            }
+        for (unsigned int rank=0; rank<n_processes; ++rank)
+          if (n_recv_queries[rank] > 0)
+            {
+              requests.push_back(MPI_Request());
+              MPI_Isend(&send_answers[rank][0], send_answers[rank].size(), MPI_CHAR, rank, 3, mpi_communicator, &requests.back());
+            }
+        if (requests.size() > 0)
+          MPI_Waitall(requests.size(),&requests[0],MPI_STATUSES_IGNORE);
+      }
+
+      // Every particle is sent to the process with the lowest rank that
+      // owns its location. This avoids duplicating particles that are
+      // located exactly on the boundary between two domains. Particles
+      // that are not owned by any process have left the model domain.
+      const unsigned int particle_size = (particles_to_send.size() > 0
+                                          ?
+                                          particles_to_send.front()->serialized_size_in_bytes() + cellid_size + (size_callback ? size_callback() : 0)
+                                          :
+                                          0);
+
+      std::vector<bool> particle_is_sent(particles_to_send.size(),false);
+      std::vector<std::vector<char> > send_data(n_processes);
+      for (unsigned int rank=0; rank<n_processes; ++rank)
+        for (unsigned int i=0; i<n_send_queries[rank]; ++i)
+          {
+            const unsigned int particle_index = queried_particles[rank][i];
+            if (recv_answers[rank][answer_size*i] == 0 || particle_is_sent[particle_index])
+              continue;
+
+            particle_is_sent[particle_index] = true;
+
+            const std::size_t offset = send_data[rank].size();
+            send_data[rank].resize(offset + particle_size);
+            void *data = static_cast<void *> (&send_data[rank][offset]);
+
+            memcpy(data, &recv_answers[rank][answer_size*i+1], cellid_size);
+            data = static_cast<char *>(data) + cellid_size;
+
+            particles_to_send[particle_index]->write_data(data);
+            if (store_callback)
+              data = store_callback(particles_to_send[particle_index],data);
+          }
+
+      std::vector<unsigned int> n_send_data(n_processes);
+      std::vector<unsigned int> n_recv_data(n_processes);
+      for (unsigned int rank=0; rank<n_processes; ++rank)
+        n_send_data[rank] = send_data[rank].size();
+
+      MPI_Alltoall(&n_send_data[0], 1, MPI_UNSIGNED,
+                   &n_recv_data[0], 1, MPI_UNSIGNED,
+                   mpi_communicator);
+
+      std::vector<std::vector<char> > recv_data(n_processes);
+      {
+        std::vector<MPI_Request> requests;
+        requests.reserve(2*n_processes);
+        for (unsigned int rank=0; rank<n_processes; ++rank)
+          if (n_recv_data[rank] > 0)
+            {
+              recv_data[rank].resize(n_recv_data[rank]);
+              requests.push_back(MPI_Request());
+              MPI_Irecv(&recv_data[rank][0], n_recv_data[rank], MPI_CHAR, rank, 4, mpi_communicator, &requests.back());
+            }
+        for (unsigned int rank=0; rank<n_processes; ++rank)
+          if (n_send_data[rank] > 0)
+            {
+              requests.push_back(MPI_Request());
+              MPI_Isend(&send_data[rank][0], n_send_data[rank], MPI_CHAR, rank, 4, mpi_communicator, &requests.back());
+            }
+        if (requests.size() > 0)
+          MPI_Waitall(requests.size(),&requests[0],MPI_STATUSES_IGNORE);
+      }
+
+      // Insert the received particles into the cells that we determined
+      // when answering the queries
+      for (unsigned int rank=0; rank<n_processes; ++rank)
+        {
+          if (recv_data[rank].size() == 0)
+            continue;
+
+          const void *recv_data_it = static_cast<const void *> (&recv_data[rank].front());
+          const void *recv_data_end = static_cast<const void *> (&recv_data[rank].back()+1);
+
+          while (recv_data_it != recv_data_end)
+            {
+              CellId::binary_type binary_cellid;
+              memcpy(&binary_cellid, recv_data_it, cellid_size);
+              const CellId id(binary_cellid);
+              recv_data_it = static_cast<const char *> (recv_data_it) + cellid_size;
+
+              const active_cell_it cell = id.to_cell(*triangulation);
+              ++n_particles_per_cell[cell->active_cell_index()];
+
+              const typename ParticleContainer<dim,spacedim>::size_type recv_particle =
+                received_particles.insert(types::LevelInd(cell->level(),cell->index()),
+                                          recv_data_it);
+
+              // The sending process did not know the reference location
+              // of the particle in its new cell
+              received_particles.set_reference_location(recv_particle,
+                                                        mapping->transform_real_to_unit_cell(cell,
+                                                            received_particles.get_location(recv_particle)));
+
+              if (load_callback)
+                recv_data_it = load_callback(particle_iterator(received_particles,recv_particle),
+                                             recv_data_it);
+            }
+        }
+    }
+
+
     template <int dim, int spacedim>
     void
     ParticleHandler<dim,spacedim>::register_additional_store_load_functions(const std_cxx11::function<std::size_t ()> &size_callb,
@@ -828,32 +1658,41 @@ namespace aspect
           const std_cxx11::function<void(const typename parallel::distributed::Triangulation<dim>::cell_iterator &,
                                          const typename parallel::distributed::Triangulation<dim>::CellStatus, void *) > callback_function
             = std_cxx11::bind(&ParticleHandler<dim>::store_particles,
-                              std_cxx11::cref(*this),
+                              std_cxx11::ref(*this),
                               std_cxx11::_1,
                               std_cxx11::_2,
                               std_cxx11::_3);
 
+          // During refinement the particles are packed into a buffer of
+          // this process, and only their location in the buffer is
+          // attached to the cells.
+          transfer_particles_separately = !serialization;
+
+          if (transfer_particles_separately)
+            {
+              stored_particle_data.clear();
+              stored_particle_size = 0;
+              if (particles.n_particles() > 0)
+                stored_particle_data.reserve(particles.n_particles() * begin()->serialized_size_in_bytes());
+
+              data_offset = non_const_triangulation->register_data_attach(sizeof(CellTransferInfo),callback_function);
+              return;
+            }
+
           // Compute the size per serialized particle. This is simple if we own
           // particles, simply ask one of them. Otherwise create a temporary particle,
           // ask it for its size and add the size of its properties.
-          const std::size_t size_per_particle = (particles.size() > 0)
+          const std::size_t size_per_particle = (particles.n_particles() > 0)
                                                 ?
                                                 begin()->serialized_size_in_bytes()
                                                 :
                                                 Particle<dim,spacedim>().serialized_size_in_bytes()
-                                                + property_pool->n_properties_per_slot() * sizeof(double);
+                                                + property_pool->serialized_properties_size();
 
           // We need to transfer the number of particles for this cell and
-          // the particle data itself. If we are in the process of refinement
-          // (i.e. not in serialization) we need to provide 2^dim times the
-          // space for the data in case a cell is coarsened and all particles
-          // of the children have to be stored in the parent cell.
+          // the particle data itself.
           const std::size_t transfer_size_per_cell = sizeof (unsigned int) +
-                                                     (size_per_particle * global_max_particles_per_cell) *
-                                                     (serialization ?
-                                                      1
-                                                      :
-                                                      std::pow(2,dim));
+                                                     (size_per_particle * global_max_particles_per_cell);
 
           data_offset = non_const_triangulation->register_data_attach(transfer_size_per_cell,callback_function);
         }
@@ -881,7 +1720,7 @@ namespace aspect
           const std_cxx11::function<void(const typename parallel::distributed::Triangulation<dim>::cell_iterator &,
                                          const typename parallel::distributed::Triangulation<dim>::CellStatus, void *) > callback_function
             = std_cxx11::bind(&ParticleHandler<dim>::store_particles,
-                              std_cxx11::cref(*this),
+                              std_cxx11::ref(*this),
                               std_cxx11::_1,
                               std_cxx11::_2,
                               std_cxx11::_3);
@@ -889,18 +1728,18 @@ namespace aspect
           // Compute the size per serialized particle. This is simple if we own
           // particles, simply ask one of them. Otherwise create a temporary particle,
           // ask it for its size and add the size of its properties.
-          const std::size_t size_per_particle = (particles.size() > 0)
+          const std::size_t size_per_particle = (particles.n_particles() > 0)
                                                 ?
                                                 begin()->serialized_size_in_bytes()
                                                 :
                                                 Particle<dim,spacedim>().serialized_size_in_bytes()
-                                                + property_pool->n_properties_per_slot() * sizeof(double);
+                                                + property_pool->serialized_properties_size();
 
           // We need to transfer the number of particles for this cell and
-          // the particle data itself and we need to provide 2^dim times the
-          // space for the data in case a cell is coarsened
+          // the particle data itself
           const std::size_t transfer_size_per_cell = sizeof (unsigned int) +
                                                      (size_per_particle * global_max_particles_per_cell);
+          transfer_particles_separately = false;
           data_offset = non_const_triangulation->register_data_attach(transfer_size_per_cell,callback_function);
         }
 
@@ -916,13 +1755,62 @@ namespace aspect
                               std_cxx11::_2,
                               std_cxx11::_3);
 
+          if (transfer_particles_separately)
+            remote_cell_particles.resize(dealii::Utilities::MPI::n_mpi_processes(mpi_communicator));
+
           non_const_triangulation->notify_ready_to_unpack(data_offset,callback_function);
 
+          if (transfer_particles_separately)
+            {
+              // The particles of cells that were stored by this process
+              // have been loaded, get the rest from the other processes
+              receive_remote_cell_particles();
+
+              std::vector<char>().swap(stored_particle_data);
+              std::vector<std::vector<RemoteCellParticles> >().swap(remote_cell_particles);
+              transfer_particles_separately = false;
+            }
+
+          // The loaded particles were appended cell by cell, sort them into
+          // the cell offset index
+          particles.compress();
+
           // Reset offset and update global number of particles. The number
           // can change because of discarded or newly generated particles
           data_offset = numbers::invalid_unsigned_int;
           update_n_global_particles();
         }
+
+      // The triangulation has changed, so the particle numbers have to be
+      // assigned to the new cells
+      recompute_n_particles_per_cell();
+    }
+
+
+
+    template <int dim, int spacedim>
+    unsigned int
+    ParticleHandler<dim,spacedim>::pack_particles(const particle_iterator_range &particle_range)
+    {
+      const unsigned int n_particles = std::distance(particle_range.begin(),particle_range.end());
+
+      if (n_particles == 0)
+        return 0;
+
+      stored_particle_size = particle_range.begin()->serialized_size_in_bytes();
+
+      const std::size_t offset = stored_particle_data.size();
+      stored_particle_data.resize(offset + n_particles * stored_particle_size);
+
+      void *data = static_cast<void *> (&stored_particle_data[offset]);
+      for (particle_iterator particle = particle_range.begin();
+           particle != particle_range.end(); ++particle)
+        particle->write_data(data);
+
+      Assert (data == &stored_particle_data.back()+1,
+              ExcInternalError());
+
+      return n_particles;
     }
 
 
@@ -931,8 +1819,30 @@ namespace aspect
     void
     ParticleHandler<dim,spacedim>::store_particles(const typename parallel::distributed::Triangulation<dim,spacedim>::cell_iterator &cell,
                                                    const typename parallel::distributed::Triangulation<dim,spacedim>::CellStatus status,
-                                                   void *data) const
+                                                   void *data)
     {
+      // If the particles are transferred separately, pack them into
+      // stored_particle_data and only attach their location to the cell.
+      if (transfer_particles_separately)
+        {
+          CellTransferInfo info;
+          info.offset = stored_particle_data.size();
+          info.n_particles = 0;
+          info.process = dealii::Utilities::MPI::this_mpi_process(mpi_communicator);
+
+          if (status == parallel::distributed::Triangulation<dim,spacedim>::CELL_PERSIST
+              || status == parallel::distributed::Triangulation<dim,spacedim>::CELL_REFINE)
+            info.n_particles = pack_particles(particles_in_cell(cell));
+          else if (status == parallel::distributed::Triangulation<dim,spacedim>::CELL_COARSEN)
+            for (unsigned int child_index = 0; child_index < GeometryInfo<dim>::max_children_per_cell; ++child_index)
+              info.n_particles += pack_particles(particles_in_cell(cell->child(child_index)));
+          else
+            Assert (false, ExcInternalError());
+
+          memcpy(data, &info, sizeof(info));
+          return;
+        }
+
       unsigned int n_particles(0);
 
       // If the cell persist or is refined store all particles of the current cell.
@@ -992,71 +1902,82 @@ namespace aspect
                                                   const typename parallel::distributed::Triangulation<dim,spacedim>::CellStatus status,
                                                   const void *data)
     {
+      if (transfer_particles_separately)
+        {
+          CellTransferInfo info;
+          memcpy(&info, data, sizeof(info));
+
+          if (info.n_particles == 0)
+            return;
+
+          // Particles that this process stored itself can be loaded
+          // right away, the others are requested from the process that
+          // stored them after all cells have been visited.
+          if (info.process == dealii::Utilities::MPI::this_mpi_process(mpi_communicator))
+            {
+              const void *pdata = static_cast<const void *> (&stored_particle_data[info.offset]);
+              unpack_particles(cell,status,info.n_particles,pdata);
+            }
+          else
+            {
+              RemoteCellParticles remote_cell;
+              remote_cell.cell = cell;
+              remote_cell.status = status;
+              remote_cell.n_particles = info.n_particles;
+              remote_cell.offset = info.offset;
+              remote_cell_particles[info.process].push_back(remote_cell);
+            }
+          return;
+        }
+
       const unsigned int *n_particles_in_cell_ptr = static_cast<const unsigned int *> (data);
       const void *pdata = reinterpret_cast<const void *> (n_particles_in_cell_ptr + 1);
 
-      if (*n_particles_in_cell_ptr == 0)
+      unpack_particles(cell,status,*n_particles_in_cell_ptr,pdata);
+    }
+
+
+
+    template <int dim, int spacedim>
+    void
+    ParticleHandler<dim,spacedim>::unpack_particles(const typename parallel::distributed::Triangulation<dim,spacedim>::cell_iterator &cell,
+                                                    const typename parallel::distributed::Triangulation<dim,spacedim>::CellStatus status,
+                                                    const unsigned int n_particles,
+                                                    const void *&pdata)
+    {
+      if (n_particles == 0)
         return;
 
-      // Load all particles from the data stream and store them in the local
-      // particle map.
+      // Load all particles from the data stream and append them to the local
+      // particle storage. They are sorted into their cells by compressing
+      // the storage after all cells have been loaded.
       if (status == parallel::distributed::Triangulation<dim,spacedim>::CELL_PERSIST)
         {
-          typename std::multimap<types::LevelInd,Particle<dim,spacedim> >::iterator position_hint = particles.end();
-          for (unsigned int i = 0; i < *n_particles_in_cell_ptr; ++i)
-            {
-              // Use std::multimap::emplace_hint to speed up insertion of
-              // particles. This is a C++11 function, but not all compilers
-              // that report a -std=c++11 (like gcc 4.6) implement it, so
-              // require C++14 instead.
-#ifdef DEAL_II_WITH_CXX14
-              position_hint = particles.emplace_hint(position_hint,
-                                                     std::make_pair(cell->level(),cell->index()),
-                                                     Particle<dim,spacedim>(pdata,*property_pool));
-#else
-              position_hint = particles.insert(position_hint,
-                                               std::make_pair(std::make_pair(cell->level(),cell->index()),
-                                                              Particle<dim,spacedim>(pdata,*property_pool)));
-#endif
-              ++position_hint;
-            }
+          const types::LevelInd level_index(cell->level(),cell->index());
+          for (unsigned int i = 0; i < n_particles; ++i)
+            particles.insert(level_index,pdata);
         }
 
       else if (status == parallel::distributed::Triangulation<dim,spacedim>::CELL_COARSEN)
         {
-          typename std::multimap<types::LevelInd,Particle<dim,spacedim> >::iterator position_hint = particles.end();
-          for (unsigned int i = 0; i < *n_particles_in_cell_ptr; ++i)
+          const types::LevelInd level_index(cell->level(),cell->index());
+          for (unsigned int i = 0; i < n_particles; ++i)
             {
-              // Use std::multimap::emplace_hint to speed up insertion of
-              // particles. This is a C++11 function, but not all compilers
-              // that report a -std=c++11 (like gcc 4.6) implement it, so
-              // require C++14 instead.
-#ifdef DEAL_II_WITH_CXX14
-              position_hint = particles.emplace_hint(position_hint,
-                                                     std::make_pair(cell->level(),cell->index()),
-                                                     Particle<dim,spacedim>(pdata,*property_pool));
-#else
-              position_hint = particles.insert(position_hint,
-                                               std::make_pair(std::make_pair(cell->level(),cell->index()),
-                                                              Particle<dim,spacedim>(pdata,*property_pool)));
-#endif
-              const Point<dim> p_unit = mapping->transform_real_to_unit_cell(cell, position_hint->second.get_location());
-              position_hint->second.set_reference_location(p_unit);
-              ++position_hint;
+              const typename ParticleContainer<dim,spacedim>::size_type index = particles.insert(level_index,pdata);
+              const Point<dim> p_unit = mapping->transform_real_to_unit_cell(cell, particles.get_location(index));
+              particles.set_reference_location(index,p_unit);
             }
         }
       else if (status == parallel::distributed::Triangulation<dim,spacedim>::CELL_REFINE)
         {
-          std::vector<typename std::multimap<types::LevelInd, Particle<dim,spacedim> >::iterator > position_hints(GeometryInfo<dim>::max_children_per_cell);
-          for (unsigned int child_index=0; child_index<GeometryInfo<dim>::max_children_per_cell; ++child_index)
+          const types::LevelInd level_index(cell->level(),cell->index());
+          for (unsigned int i = 0; i < n_particles; ++i)
             {
-              const typename parallel::distributed::Triangulation<dim,spacedim>::cell_iterator child = cell->child(child_index);
-              position_hints[child_index] = particles.upper_bound(std::make_pair(child->level(),child->index()));
-            }
-
-          for (unsigned int i = 0; i < *n_particles_in_cell_ptr; ++i)
-            {
-              Particle<dim,spacedim> p (pdata,*property_pool);
+              // Insert the particle into the parent cell first and move it to
+              // the child it belongs to afterwards. Particles that are not in
+              // any child are discarded.
+              const typename ParticleContainer<dim,spacedim>::size_type index = particles.insert(level_index,pdata);
+              bool found_child = false;
 
               for (unsigned int child_index = 0; child_index < GeometryInfo<dim>::max_children_per_cell; ++child_index)
                 {
@@ -1065,32 +1986,130 @@ namespace aspect
                   try
                     {
                       const Point<dim> p_unit = mapping->transform_real_to_unit_cell(child,
-                                                                                     p.get_location());
+                                                                                     particles.get_location(index));
                       if (GeometryInfo<dim>::is_inside_unit_cell(p_unit))
                         {
-                          p.set_reference_location(p_unit);
-                          // Use std::multimap::emplace_hint to speed up insertion of
-                          // particles. This is a C++11 function, but not all compilers
-                          // that report a -std=c++11 (like gcc 4.6) implement it, so
-                          // require C++14 instead.
-#ifdef DEAL_II_WITH_CXX14
-                          position_hints[child_index] = particles.emplace_hint(position_hints[child_index],
-                                                                               std::make_pair(child->level(),child->index()),
-                                                                               std::move(p));
-#else
-                          position_hints[child_index] = particles.insert(position_hints[child_index],
-                                                                         std::make_pair(std::make_pair(child->level(),child->index()),
-                                                                                        p));
-#endif
-                          ++position_hints[child_index];
+                          particles.set_reference_location(index,p_unit);
+                          particles.move_to_cell(index,types::LevelInd(child->level(),child->index()));
+                          found_child = true;
                           break;
                         }
                     }
                   catch (typename Mapping<dim>::ExcTransformationFailed &)
                     {}
                 }
+
+              if (!found_child)
+                particles.remove(index);
+            }
+        }
+    }
+
+
+
+    template <int dim, int spacedim>
+    void
+    ParticleHandler<dim,spacedim>::receive_remote_cell_particles()
+    {
+      const unsigned int n_processes = dealii::Utilities::MPI::n_mpi_processes(mpi_communicator);
+
+      // Send to every process the location and number of the particles
+      // we need from its buffer
+      std::vector<unsigned int> n_send_requests(n_processes,0);
+      std::vector<std::vector<unsigned long long> > send_requests(n_processes);
+      for (unsigned int rank=0; rank<n_processes; ++rank)
+        {
+          n_send_requests[rank] = remote_cell_particles[rank].size();
+          for (unsigned int i=0; i<remote_cell_particles[rank].size(); ++i)
+            {
+              send_requests[rank].push_back(remote_cell_particles[rank][i].offset);
+              send_requests[rank].push_back(remote_cell_particles[rank][i].n_particles);
             }
         }
+
+      std::vector<unsigned int> n_recv_requests(n_processes);
+      MPI_Alltoall(&n_send_requests[0], 1, MPI_UNSIGNED,
+                   &n_recv_requests[0], 1, MPI_UNSIGNED,
+                   mpi_communicator);
+
+      std::vector<std::vector<unsigned long long> > recv_requests(n_processes);
+      {
+        std::vector<MPI_Request> requests;
+        requests.reserve(2*n_processes);
+
+        for (unsigned int rank=0; rank<n_processes; ++rank)
+          if (n_recv_requests[rank] > 0)
+            {
+              recv_requests[rank].resize(2*n_recv_requests[rank]);
+              requests.push_back(MPI_Request());
+              MPI_Irecv(&recv_requests[rank][0], 2*n_recv_requests[rank], MPI_UNSIGNED_LONG_LONG, rank, 5, mpi_communicator, &requests.back());
+            }
+
+        for (unsigned int rank=0; rank<n_processes; ++rank)
+          if (n_send_requests[rank] > 0)
+            {
+              requests.push_back(MPI_Request());
+              MPI_Isend(&send_requests[rank][0], 2*n_send_requests[rank], MPI_UNSIGNED_LONG_LONG, rank, 5, mpi_communicator, &requests.back());
+            }
+
+        if (requests.size() > 0)
+          MPI_Waitall(requests.size(),&requests[0],MPI_STATUSES_IGNORE);
+      }
+
+      // Answer the requests with the particle data in the requested order
+      std::vector<std::vector<char> > send_data(n_processes);
+      std::vector<MPI_Request> send_data_requests;
+      send_data_requests.reserve(n_processes);
+
+      for (unsigned int rank=0; rank<n_processes; ++rank)
+        if (n_recv_requests[rank] > 0)
+          {
+            for (unsigned int i=0; i<n_recv_requests[rank]; ++i)
+              {
+                const std::size_t offset = recv_requests[rank][2*i];
+                const std::size_t n_bytes = recv_requests[rank][2*i+1] * stored_particle_size;
+
+                AssertThrow(offset + n_bytes <= stored_particle_data.size(),
+                            ExcMessage("Another process requested particles that were not stored "
+                                       "by this process during the last mesh refinement."));
+
+                send_data[rank].insert(send_data[rank].end(),
+                                       stored_particle_data.begin() + offset,
+                                       stored_particle_data.begin() + offset + n_bytes);
+              }
+
+            send_data_requests.push_back(MPI_Request());
+            MPI_Isend(&send_data[rank][0], send_data[rank].size(), MPI_CHAR, rank, 6, mpi_communicator, &send_data_requests.back());
+          }
+
+      // Receive the requested particles and insert them into their cells
+      std::vector<char> recv_data;
+      for (unsigned int rank=0; rank<n_processes; ++rank)
+        if (n_send_requests[rank] > 0)
+          {
+            MPI_Status status;
+            MPI_Probe(rank, 6, mpi_communicator, &status);
+
+            int n_bytes;
+            MPI_Get_count(&status, MPI_CHAR, &n_bytes);
+
+            recv_data.resize(n_bytes);
+            MPI_Recv(&recv_data[0], n_bytes, MPI_CHAR, rank, 6, mpi_communicator, MPI_STATUS_IGNORE);
+
+            const void *data = static_cast<const void *> (&recv_data[0]);
+            for (unsigned int i=0; i<remote_cell_particles[rank].size(); ++i)
+              unpack_particles(remote_cell_particles[rank][i].cell,
+                               remote_cell_particles[rank][i].status,
+                               remote_cell_particles[rank][i].n_particles,
+                               data);
+
+            AssertThrow(data == &recv_data.back()+1,
+                        ExcMessage("The amount of data that was read into new particles "
+                                   "does not match the amount of data sent around."));
+          }
+
+      if (send_data_requests.size() > 0)
+        MPI_Waitall(send_data_requests.size(),&send_data_requests[0],MPI_STATUSES_IGNORE);
     }
   }
 }
@@ -33,10 +33,10 @@ namespace aspect
 
 
     template <int dim, int spacedim>
-    ParticleIterator<dim,spacedim>::ParticleIterator (const std::multimap<types::LevelInd, Particle<dim,spacedim> > &map,
-                                                      const typename std::multimap<types::LevelInd, Particle<dim,spacedim> >::iterator &particle)
+    ParticleIterator<dim,spacedim>::ParticleIterator (const ParticleContainer<dim,spacedim> &container,
+                                                      const typename ParticleContainer<dim,spacedim>::size_type index)
       :
-      accessor (map, particle)
+      accessor (container, index)
     {}
 
 
@@ -250,6 +250,28 @@ namespace aspect
 
         // Initialize our property information
         property_information = ParticlePropertyInformation(info);
+
+        // Determine which property components are stored in single precision
+        single_precision_components.assign(property_information.n_components(),false);
+        const bool all_fields = (std::find(single_precision_field_names.begin(),
+                                           single_precision_field_names.end(),
+                                           "all") != single_precision_field_names.end());
+
+        for (unsigned int field_index = 0; field_index < property_information.n_fields(); ++field_index)
+          if (all_fields
+              || std::find(single_precision_field_names.begin(),
+                           single_precision_field_names.end(),
+                           property_information.get_field_name_by_index(field_index)) != single_precision_field_names.end())
+            for (unsigned int component = 0; component < property_information.get_components_by_field_index(field_index); ++component)
+              single_precision_components[property_information.get_position_by_field_index(field_index) + component] = true;
+
+        for (std::vector<std::string>::const_iterator name = single_precision_field_names.begin();
+             name != single_precision_field_names.end(); ++name)
+          AssertThrow(*name == "all" || property_information.fieldname_exists(*name),
+                      ExcMessage("The particle property field <" + *name + "> that was selected in the "
+                                 "parameter 'Postprocess/Particles/Single precision particle properties' "
+                                 "does not exist. Please check the names of the fields of the selected "
+                                 "particle properties."));
       }
 
       template <int dim>
@@ -349,6 +371,23 @@ namespace aspect
                                          const Vector<double> &solution,
                                          const std::vector<Tensor<1,dim> > &gradients) const
       {
+        // If some properties are stored in single precision the plugins
+        // update a copy of the properties in double precision, which is
+        // rounded to the stored precision afterwards
+        const bool update_copy = (std::find(single_precision_components.begin(),
+                                            single_precision_components.end(),
+                                            true) != single_precision_components.end());
+
+        std::vector<double> particle_properties;
+        if (update_copy)
+          particle->get_properties(particle_properties);
+
+        const ArrayView<double> properties = (update_copy
+                                              ?
+                                              ArrayView<double>(&particle_properties[0],particle_properties.size())
+                                              :
+                                              particle->get_properties());
+
         unsigned int plugin_index = 0;
         for (typename std::list<std_cxx11::shared_ptr<Interface<dim> > >::const_iterator
              p = property_list.begin(); p!=property_list.end(); ++p,++plugin_index)
@@ -357,8 +396,11 @@ namespace aspect
                                                particle->get_location(),
                                                solution,
                                                gradients,
-                                               particle->get_properties());
+                                               properties);
           }
+
+        if (update_copy)
+          particle->set_properties(particle_properties);
       }
 
       template <int dim>
@@ -399,7 +441,15 @@ namespace aspect
       std::size_t
       Manager<dim>::get_particle_size () const
       {
-        return (property_information.n_components()+2*dim) * sizeof(double) + sizeof(types::particle_index);
+        // Properties stored in single precision are serialized as floats,
+        // padded to a multiple of the size of a double
+        const unsigned int n_single_precision_components = std::count(single_precision_components.begin(),
+                                                                      single_precision_components.end(),
+                                                                      true);
+        const unsigned int n_double_precision_components = property_information.n_components() - n_single_precision_components;
+
+        return (n_double_precision_components + (n_single_precision_components+1)/2 + 2*dim) * sizeof(double)
+               + sizeof(types::particle_index);
       }
 
       template <int dim>
@@ -409,6 +459,29 @@ namespace aspect
         return property_information;
       }
 
+      template <int dim>
+      ComponentMask
+      Manager<dim>::get_interpolated_late_initialization_components () const
+      {
+        ComponentMask mask(property_information.n_components(),false);
+
+        unsigned int plugin_index = 0;
+        for (typename std::list<std_cxx11::shared_ptr<Interface<dim> > >::const_iterator
+             p = property_list.begin(); p!=property_list.end(); ++p, ++plugin_index)
+          if ((*p)->late_initialization_mode() == aspect::Particle::Property::interpolate)
+            for (unsigned int component = 0; component < property_information.get_components_by_plugin_index(plugin_index); ++component)
+              mask.set(property_information.get_position_by_plugin_index(plugin_index) + component, true);
+
+        return mask;
+      }
+
+      template <int dim>
+      const std::vector<bool> &
+      Manager<dim>::get_single_precision_components () const
+      {
+        return single_precision_components;
+      }
+
       template <int dim>
       unsigned int
       Manager<dim>::get_property_component_by_name(const std::string &name) const
@@ -447,6 +520,19 @@ namespace aspect
                               "The following properties are available:\n\n"
                               +
                               std_cxx11::get<dim>(registered_plugins).get_description_string());
+            prm.declare_entry("Single precision particle properties",
+                              "",
+                              Patterns::Anything(),
+                              "A comma separated list of the names of particle property fields "
+                              "that are stored in single precision instead of double precision, "
+                              "or `all' to store all properties in single precision. The names "
+                              "are the names of the fields as they appear in the particle output "
+                              "(e.g. `initial position' or `initial C_1'). Storing properties in "
+                              "single precision halves the memory they need, and the amount of data "
+                              "that is communicated, checkpointed and written for them, but limits "
+                              "their accuracy to about 7 significant digits. Properties stored in "
+                              "single precision are still computed in double precision, and "
+                              "only rounded when they are stored.");
           }
           prm.leave_subsection();
         }
@@ -472,6 +558,7 @@ namespace aspect
           {
             // now also see which derived quantities we are to compute
             prop_names = Utilities::split_string_list(prm.get("List of particle properties"));
+            single_precision_field_names = Utilities::split_string_list(prm.get("Single precision particle properties"));
             AssertThrow(Utilities::has_unique_entries(prop_names),
                         ExcMessage("The list of strings for the parameter "
                                    "'Postprocess/Particles/List of particle properties' contains entries more than once. "
@@ -21,27 +21,101 @@
 #include <aspect/particle/property_pool.h>
 #include <aspect/particle/particle.h>
 
+#include <algorithm>
+#include <cstring>
+
 namespace aspect
 {
   namespace Particle
   {
     const PropertyPool::Handle PropertyPool::invalid_handle = NULL;
 
+    namespace
+    {
+      /**
+       * The minimal number of slots in a newly allocated chunk. Chunks grow
+       * geometrically beyond this size to keep the number of chunks small.
+       */
+      const std::size_t minimal_chunk_size = 1024;
+    }
+
 
-    PropertyPool::PropertyPool (const unsigned int n_properties_per_slot)
+    PropertyPool::PropertyPool (const unsigned int n_properties_per_slot,
+                                const unsigned int n_integrator_data_per_slot,
+                                const std::vector<bool> &single_precision_properties)
       :
-      n_properties (n_properties_per_slot)
-    {}
+      n_properties (n_properties_per_slot),
+      n_integrator_data (n_integrator_data_per_slot),
+      single_precision (single_precision_properties.size() > 0
+                        ?
+                        single_precision_properties
+                        :
+                        std::vector<bool>(n_properties_per_slot,false)),
+      n_double_properties (0),
+      n_float_properties (0),
+      storage_index (n_properties_per_slot),
+      slot_size (0),
+      next_unused_slot (NULL),
+      end_of_chunk (NULL),
+      n_allocated (0),
+      capacity (0)
+    {
+      AssertDimension (single_precision.size(), n_properties);
+
+      for (unsigned int i=0; i<n_properties; ++i)
+        storage_index[i] = (single_precision[i] ? n_float_properties++ : n_double_properties++);
+
+      // Two floats fit into the space of one double
+      slot_size = n_double_properties + n_integrator_data + (n_float_properties + 1) / 2;
+    }
+
+
+
+    inline
+    float *
+    PropertyPool::float_data (const Handle handle) const
+    {
+      return reinterpret_cast<float *> (handle + n_double_properties + n_integrator_data);
+    }
+
+
+
+    void
+    PropertyPool::allocate_chunk (const std::size_t n_slots)
+    {
+      // Do not waste the rest of the current chunk
+      for (; next_unused_slot != end_of_chunk; next_unused_slot += slot_size)
+        free_slots.push_back(next_unused_slot);
+
+      memory_chunks.push_back(std::vector<double>(n_slots * slot_size));
+      next_unused_slot = &memory_chunks.back()[0];
+      end_of_chunk = next_unused_slot + n_slots * slot_size;
+      capacity += n_slots;
+    }
 
 
 
     PropertyPool::Handle
     PropertyPool::allocate_properties_array ()
     {
-      if (n_properties > 0)
-        return new double[n_properties];
+      if (slot_size == 0)
+        return invalid_handle;
 
-      return invalid_handle;
+      ++n_allocated;
+
+      if (free_slots.size() > 0)
+        {
+          const Handle handle = free_slots.back();
+          free_slots.pop_back();
+          return handle;
+        }
+
+      if (next_unused_slot == end_of_chunk)
+        allocate_chunk(std::max(minimal_chunk_size, capacity));
+
+      const Handle handle = next_unused_slot;
+      next_unused_slot += slot_size;
+      return handle;
     }
 
 
@@ -49,7 +123,13 @@ namespace aspect
     void
     PropertyPool::deallocate_properties_array (Handle handle)
     {
-      delete[] handle;
+      if (handle == invalid_handle)
+        return;
+
+      Assert (n_allocated > 0, ExcInternalError());
+
+      --n_allocated;
+      free_slots.push_back(handle);
     }
 
 
@@ -57,20 +137,244 @@ namespace aspect
     ArrayView<double>
     PropertyPool::get_properties (const Handle handle)
     {
+      Assert (n_float_properties == 0,
+              ExcMessage("The properties of a slot can only be accessed as an array "
+                         "if no property is stored in single precision."));
+
       return ArrayView<double>(handle, n_properties);
     }
 
 
+
+    void
+    PropertyPool::get_properties (const Handle handle,
+                                  const ArrayView<double> &properties) const
+    {
+      AssertDimension (properties.size(), n_properties);
+
+      if (n_float_properties == 0)
+        {
+          if (n_properties > 0)
+            std::copy(handle, handle + n_properties, &properties[0]);
+          return;
+        }
+
+      const float *float_properties = float_data(handle);
+      for (unsigned int i=0; i<n_properties; ++i)
+        properties[i] = (single_precision[i]
+                         ?
+                         static_cast<double> (float_properties[storage_index[i]])
+                         :
+                         handle[storage_index[i]]);
+    }
+
+
+
+    void
+    PropertyPool::set_properties (const Handle handle,
+                                  const ArrayView<const double> &properties)
+    {
+      AssertDimension (properties.size(), n_properties);
+
+      if (n_float_properties == 0)
+        {
+          if (n_properties > 0)
+            std::copy(&properties[0], &properties[0] + n_properties, handle);
+          return;
+        }
+
+      float *float_properties = float_data(handle);
+      for (unsigned int i=0; i<n_properties; ++i)
+        if (single_precision[i])
+          float_properties[storage_index[i]] = static_cast<float> (properties[i]);
+        else
+          handle[storage_index[i]] = properties[i];
+    }
+
+
+
+    double
+    PropertyPool::get_property (const Handle handle,
+                                const unsigned int property_index) const
+    {
+      AssertIndexRange (property_index, n_properties);
+
+      if (single_precision[property_index])
+        return float_data(handle)[storage_index[property_index]];
+      else
+        return handle[storage_index[property_index]];
+    }
+
+
+
+    void
+    PropertyPool::set_property (const Handle handle,
+                                const unsigned int property_index,
+                                const double value)
+    {
+      AssertIndexRange (property_index, n_properties);
+
+      if (single_precision[property_index])
+        float_data(handle)[storage_index[property_index]] = static_cast<float> (value);
+      else
+        handle[storage_index[property_index]] = value;
+    }
+
+
+
+    void
+    PropertyPool::copy_slot (const Handle source,
+                             const Handle destination) const
+    {
+      std::copy(source, source + slot_size, destination);
+    }
+
+
+
+    void
+    PropertyPool::write_properties (const Handle handle,
+                                    void *&data) const
+    {
+      double *double_data = static_cast<double *> (data);
+      for (unsigned int i=0; i<n_double_properties; ++i)
+        *double_data++ = handle[i];
+
+      // The single precision properties are written as a block of floats
+      // that is padded to a multiple of the size of a double
+      if (n_float_properties > 0)
+        {
+          const std::size_t n_float_bytes = ((n_float_properties + 1) / 2) * sizeof(double);
+          std::memset(double_data, 0, n_float_bytes);
+          std::memcpy(double_data, float_data(handle), n_float_properties * sizeof(float));
+          double_data += (n_float_properties + 1) / 2;
+        }
+
+      data = static_cast<void *> (double_data);
+    }
+
+
+
+    void
+    PropertyPool::read_properties (const Handle handle,
+                                   const void *&data)
+    {
+      const double *double_data = static_cast<const double *> (data);
+      for (unsigned int i=0; i<n_double_properties; ++i)
+        handle[i] = *double_data++;
+
+      if (n_float_properties > 0)
+        {
+          std::memcpy(float_data(handle), double_data, n_float_properties * sizeof(float));
+          double_data += (n_float_properties + 1) / 2;
+        }
+
+      data = static_cast<const void *> (double_data);
+    }
+
+
+
+    std::size_t
+    PropertyPool::serialized_properties_size () const
+    {
+      return (n_double_properties + (n_float_properties + 1) / 2) * sizeof(double);
+    }
+
+
+
+    ArrayView<double>
+    PropertyPool::get_integrator_data (const Handle handle)
+    {
+      return ArrayView<double>(handle + n_double_properties, n_integrator_data);
+    }
+
+
+
     void
     PropertyPool::reserve(const std::size_t size)
     {
-      (void)size;
+      if (slot_size == 0 || size <= capacity)
+        return;
+
+      allocate_chunk(size - capacity);
+    }
+
+
+
+    void
+    PropertyPool::sort_memory_slots (std::vector<Handle> &handles)
+    {
+      if (slot_size == 0)
+        return;
+
+      // Slots that are not in the list would point into memory that is
+      // released below, so this has to be checked in release mode as well.
+      AssertThrow (handles.size() == n_allocated,
+                   ExcMessage("To sort the memory slots of the property pool, all "
+                              "allocated slots have to be provided."));
+
+      // Copy all properties into a new chunk that is large enough to
+      // hold all currently allocated slots, but not smaller than the
+      // previously reserved memory.
+      std::vector<double> sorted_chunk(std::max(capacity, minimal_chunk_size) * slot_size);
+
+      for (std::size_t i=0; i<handles.size(); ++i)
+        {
+          Assert (handles[i] != invalid_handle, ExcInternalError());
+
+          double *new_slot = &sorted_chunk[i * slot_size];
+          std::copy(handles[i], handles[i] + slot_size, new_slot);
+          handles[i] = new_slot;
+        }
+
+      memory_chunks.clear();
+      memory_chunks.push_back(std::vector<double>());
+      memory_chunks.back().swap(sorted_chunk);
+
+      free_slots.clear();
+      capacity = memory_chunks.back().size() / slot_size;
+      next_unused_slot = &memory_chunks.back()[0] + handles.size() * slot_size;
+      end_of_chunk = &memory_chunks.back()[0] + capacity * slot_size;
     }
 
+
+
     unsigned int
     PropertyPool::n_properties_per_slot() const
     {
       return n_properties;
     }
+
+
+
+    unsigned int
+    PropertyPool::n_integrator_data_per_slot() const
+    {
+      return n_integrator_data;
+    }
+
+
+
+    bool
+    PropertyPool::is_single_precision(const unsigned int property_index) const
+    {
+      AssertIndexRange (property_index, n_properties);
+      return single_precision[property_index];
+    }
+
+
+
+    bool
+    PropertyPool::has_single_precision_properties() const
+    {
+      return n_float_properties > 0;
+    }
+
+
+
+    std::size_t
+    PropertyPool::n_allocated_slots() const
+    {
+      return n_allocated;
+    }
   }
 }
@@ -25,8 +25,10 @@
 #include <aspect/geometry_model/box.h>
 
 #include <deal.II/base/quadrature_lib.h>
+#include <deal.II/base/work_stream.h>
 #include <deal.II/fe/fe_values.h>
 #include <deal.II/grid/grid_tools.h>
+#include <deal.II/grid/filtered_iterator.h>
 #include <boost/serialization/map.hpp>
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
@@ -37,6 +39,9 @@ namespace aspect
   {
     template <int dim>
     World<dim>::World()
+      :
+      particle_load_imbalance(std::numeric_limits<double>::quiet_NaN()),
+      external_particle_time(0.0)
     {}
 
     template <int dim>
@@ -47,6 +52,11 @@ namespace aspect
     void
     World<dim>::initialize()
     {
+      // Only start measuring the time step length once the first time step
+      // is finished, the time before includes the setup of the model
+      time_step_timer.reset();
+      particle_timer.reset();
+
       if (particle_load_balancing & ParticleLoadBalancing::repartition)
         this->get_triangulation().signals.cell_weight.connect(std_cxx11::bind(&aspect::Particle::World<dim>::cell_weight,
                                                                               std_cxx11::ref(*this),
@@ -59,7 +69,9 @@ namespace aspect
       particle_handler.reset(new ParticleHandler<dim>(this->get_triangulation(),
                                                       this->get_mapping(),
                                                       this->get_mpi_communicator(),
-                                                      property_manager->get_n_property_components()));
+                                                      property_manager->get_n_property_components(),
+                                                      integrator->get_n_data_components(),
+                                                      property_manager->get_single_precision_components()));
 
       const std_cxx11::function<std::size_t ()> size_callback_function
         = std_cxx11::bind(&aspect::Particle::Integrator::Interface<dim>::get_data_size,
@@ -83,9 +95,74 @@ namespace aspect
                                                                  store_callback_function,
                                                                  load_callback_function);
 
+      if (update_ghost_particles && exchange_interpolated_ghost_properties_only)
+        particle_handler->set_ghost_property_indices(get_ghost_property_indices());
+
       connect_to_signals(this->get_signals());
     }
 
+
+
+    template <int dim>
+    std::vector<unsigned int>
+    World<dim>::get_ghost_property_indices() const
+    {
+      ComponentMask property_mask = property_manager->get_interpolated_late_initialization_components();
+
+      // Add the particle property of every compositional field that
+      // is advected with the particle method
+      for (unsigned int c=0; c<this->n_compositional_fields(); ++c)
+        if (this->introspection().compositional_field_methods[c] == Parameters<dim>::AdvectionFieldMethod::particles)
+          property_mask.set(get_property_index_of_compositional_field(c),true);
+
+      std::vector<unsigned int> property_indices;
+      for (unsigned int i=0; i<property_mask.size(); ++i)
+        if (property_mask[i])
+          property_indices.push_back(i);
+
+      return property_indices;
+    }
+
+
+
+    template <int dim>
+    unsigned int
+    World<dim>::get_property_index_of_compositional_field (const unsigned int compositional_field) const
+    {
+      Assert (this->introspection().compositional_field_methods[compositional_field]
+              == Parameters<dim>::AdvectionFieldMethod::particles,
+              ExcMessage("The compositional field " + Utilities::int_to_string(compositional_field)
+                         + " is not advected with the particle method."));
+
+      const Property::ParticlePropertyInformation &property_information = property_manager->get_data_info();
+
+      unsigned int property_index;
+      if (this->get_parameters().mapped_particle_properties.size() != 0)
+        {
+          const std::map<unsigned int, std::pair<std::string,unsigned int> >::const_iterator
+          mapped_property = this->get_parameters().mapped_particle_properties.find(compositional_field);
+
+          AssertThrow(mapped_property != this->get_parameters().mapped_particle_properties.end(),
+                      ExcMessage("The parameter `Mapped particle properties' does not contain a particle "
+                                 "property for compositional field " + Utilities::int_to_string(compositional_field)
+                                 + ", which is advected with the particle method."));
+
+          property_index = property_information.get_position_by_field_name(mapped_property->second.first)
+                           + mapped_property->second.second;
+        }
+      else
+        property_index = std::count(this->introspection().compositional_field_methods.begin(),
+                                    this->introspection().compositional_field_methods.begin() + compositional_field,
+                                    Parameters<dim>::AdvectionFieldMethod::particles);
+
+      AssertThrow(property_index < property_information.n_components(),
+                  ExcMessage("Can not determine the particle property that is interpolated to "
+                             "compositional field " + Utilities::int_to_string(compositional_field) + ", because there are "
+                             "more fields that are marked as particle advected than particle properties."));
+
+      return property_index;
+    }
+
     template <int dim>
     const Property::Manager<dim> &
     World<dim>::get_property_manager() const
@@ -232,6 +309,19 @@ namespace aspect
 
           boost::mt19937 random_number_generator;
 
+          // If the properties of new particles are interpolated from the
+          // surrounding particles, every new particle has to be visible to
+          // the initialization of the particles that are generated after
+          // it. The interpolators only see particles that are sorted into
+          // their cells, so in this case the particle storage has to be
+          // compressed after every insertion. Otherwise it is enough to
+          // compress it once after the loop.
+          const ComponentMask interpolated_components = property_manager->get_interpolated_late_initialization_components();
+          bool interpolate_new_properties = false;
+          for (unsigned int i=0; i<interpolated_components.size(); ++i)
+            if (interpolated_components[i])
+              interpolate_new_properties = true;
+
           // Loop over all cells and generate or remove the particles cell-wise
           typename DoFHandler<dim>::active_cell_iterator
           cell = this->get_dof_handler().begin_active(),
@@ -261,6 +351,9 @@ namespace aspect
                                                                                         new_particle.first.first,
                                                                                         new_particle.first.second));
                         particle->set_properties(particle_properties);
+
+                        if (interpolate_new_properties)
+                          particle_handler->compress_particle_storage();
                       }
                   }
 
@@ -296,6 +389,7 @@ namespace aspect
                   }
               }
 
+          particle_handler->compress_particle_storage();
           particle_handler->update_n_global_particles();
         }
     }
@@ -312,7 +406,7 @@ namespace aspect
           || status == parallel::distributed::Triangulation<dim>::CELL_REFINE)
         {
           const unsigned int n_particles_in_cell = particle_handler->n_particles_in_cell(cell);
-          return n_particles_in_cell * particle_weight;
+          return static_cast<unsigned int> (n_particles_in_cell * particle_weight + 0.5);
         }
       else if (status == parallel::distributed::Triangulation<dim>::CELL_COARSEN)
         {
@@ -321,7 +415,7 @@ namespace aspect
           for (unsigned int child_index = 0; child_index < GeometryInfo<dim>::max_children_per_cell; ++child_index)
             n_particles_in_cell += particle_handler->n_particles_in_cell(cell->child(child_index));
 
-          return n_particles_in_cell * particle_weight;
+          return static_cast<unsigned int> (n_particles_in_cell * particle_weight + 0.5);
         }
 
       Assert (false, ExcInternalError());
@@ -402,26 +496,40 @@ namespace aspect
     template <int dim>
     void
     World<dim>::local_update_particles(const typename DoFHandler<dim>::active_cell_iterator &cell,
-                                       const typename ParticleHandler<dim>::particle_iterator &begin_particle,
-                                       const typename ParticleHandler<dim>::particle_iterator &end_particle)
+                                       internal::ParticleCellScratchData<dim> &scratch,
+                                       internal::ParticleCellCopyData &)
     {
-      const unsigned int particles_in_cell = std::distance(begin_particle,end_particle);
+      // Only the const version of particles_in_cell() is thread-safe
+      const ParticleHandler<dim> &const_particle_handler = *particle_handler;
+      const typename ParticleHandler<dim>::particle_iterator_range
+      particles_in_cell = const_particle_handler.particles_in_cell(cell);
+
+      const typename ParticleHandler<dim>::particle_iterator begin_particle = particles_in_cell.begin();
+      const typename ParticleHandler<dim>::particle_iterator end_particle = particles_in_cell.end();
+
+      // Only update particles, if there are any in this cell
+      if (begin_particle == end_particle)
+        return;
+
+      const unsigned int n_particles_in_cell = std::distance(begin_particle,end_particle);
       const unsigned int solution_components = this->introspection().n_components;
 
-      Vector<double>              value (solution_components);
-      std::vector<Tensor<1,dim> > gradient (solution_components,Tensor<1,dim>());
+      // The scratch vectors are reused between cells. Entries that already
+      // exist have the correct size, and all of them are overwritten below.
+      scratch.values.resize(n_particles_in_cell,Vector<double>(solution_components));
+      scratch.gradients.resize(n_particles_in_cell,std::vector<Tensor<1,dim> >(solution_components));
+      scratch.positions.resize(n_particles_in_cell);
 
-      std::vector<Vector<double> >              values(particles_in_cell,value);
-      std::vector<std::vector<Tensor<1,dim> > > gradients(particles_in_cell,gradient);
-      std::vector<Point<dim> >                  positions(particles_in_cell);
+      std::vector<Vector<double> > &values = scratch.values;
+      std::vector<std::vector<Tensor<1,dim> > > &gradients = scratch.gradients;
 
       typename ParticleHandler<dim>::particle_iterator it = begin_particle;
       for (unsigned int i = 0; it!=end_particle; ++it,++i)
         {
-          positions[i] = it->get_reference_location();
+          scratch.positions[i] = it->get_reference_location();
         }
 
-      const Quadrature<dim> quadrature_formula(positions);
+      const Quadrature<dim> quadrature_formula(scratch.positions);
       const UpdateFlags update_flags = property_manager->get_needed_update_flags();
       FEValues<dim> fe_value (this->get_mapping(),
                               this->get_fe(),
@@ -448,13 +556,27 @@ namespace aspect
     template <int dim>
     void
     World<dim>::local_advect_particles(const typename DoFHandler<dim>::active_cell_iterator &cell,
-                                       const typename ParticleHandler<dim>::particle_iterator &begin_particle,
-                                       const typename ParticleHandler<dim>::particle_iterator &end_particle)
+                                       internal::ParticleCellScratchData<dim> &scratch,
+                                       internal::ParticleCellCopyData &)
     {
-      const unsigned int particles_in_cell = std::distance(begin_particle,end_particle);
+      // Only the const version of particles_in_cell() is thread-safe
+      const ParticleHandler<dim> &const_particle_handler = *particle_handler;
+      const typename ParticleHandler<dim>::particle_iterator_range
+      particles_in_cell = const_particle_handler.particles_in_cell(cell);
 
-      std::vector<Tensor<1,dim> >  velocity(particles_in_cell);
-      std::vector<Tensor<1,dim> >  old_velocity(particles_in_cell);
+      const typename ParticleHandler<dim>::particle_iterator begin_particle = particles_in_cell.begin();
+      const typename ParticleHandler<dim>::particle_iterator end_particle = particles_in_cell.end();
+
+      // Only advect particles, if there are any in this cell
+      if (begin_particle == end_particle)
+        return;
+
+      const unsigned int n_particles_in_cell = std::distance(begin_particle,end_particle);
+
+      std::vector<Tensor<1,dim> > &velocity = scratch.velocities;
+      std::vector<Tensor<1,dim> > &old_velocity = scratch.old_velocities;
+      velocity.assign(n_particles_in_cell,Tensor<1,dim>());
+      old_velocity.assign(n_particles_in_cell,Tensor<1,dim>());
 
       // Below we manually evaluate the solution at all support points of the
       // current cell, and then use the shape functions to interpolate the
@@ -464,7 +586,8 @@ namespace aspect
       // for other cells, it is much faster to do the work manually. Also this
       // function is quite performance critical.
 
-      std::vector<types::global_dof_index> cell_dof_indices (this->get_fe().dofs_per_cell);
+      std::vector<types::global_dof_index> &cell_dof_indices = scratch.cell_dof_indices;
+      cell_dof_indices.resize(this->get_fe().dofs_per_cell);
       cell->get_dof_indices (cell_dof_indices);
 
       const FiniteElement<dim> &velocity_fe = this->get_fe().base_element(this->introspection()
@@ -480,10 +603,36 @@ namespace aspect
 
       // In regions without melt, the fluid velocity equals the solid velocity, so we can use it for all particles.
       std::vector<bool> use_fluid_velocity((compute_fluid_velocity ?
-                                            particles_in_cell
+                                            n_particles_in_cell
                                             :
                                             0), compute_fluid_velocity);
 
+      // Integrators that need the velocity field of the whole cell only
+      // get the velocities at the support points, which are the same
+      // for all particles in the cell. Where the particles carry melt,
+      // the fluid velocity is used.
+      if (integrator->need_cell_velocity_field())
+        {
+          Integrator::CellVelocityField<dim> &velocity_field = scratch.cell_velocity_field;
+          velocity_field.fe = &this->get_fe();
+          velocity_field.first_velocity_component = (compute_fluid_velocity
+                                                     ?
+                                                     fluid_component_index
+                                                     :
+                                                     this->introspection().component_indices.velocities[0]);
+          velocity_field.velocity_fe = &velocity_fe;
+          velocity_field.mapping = &this->get_mapping();
+          velocity_field.solution = &this->get_solution();
+          velocity_field.old_solution = &this->get_old_solution();
+          velocity_field.reinit(cell);
+
+          integrator->local_integrate_cell(begin_particle,
+                                           end_particle,
+                                           velocity_field,
+                                           this->get_timestep());
+          return;
+        }
+
       for (unsigned int j=0; j<velocity_fe.dofs_per_cell; ++j)
         {
           Tensor<1,dim> velocity_at_support_point;
@@ -538,6 +687,11 @@ namespace aspect
                                        this->get_timestep());
     }
 
+    template <int dim>
+    void
+    World<dim>::copy_local_particle_data(const internal::ParticleCellCopyData &)
+    {}
+
     template <int dim>
     void
     World<dim>::setup_initial_state ()
@@ -576,14 +730,16 @@ namespace aspect
         particle->set_property_pool(particle_handler->get_property_pool());
 
 
-      // TODO: Change this loop over all cells to use the WorkStream interface
       if (property_manager->get_n_property_components() > 0)
         {
           TimerOutput::Scope timer_section(this->get_computing_timer(), "Particles: Initialize properties");
 
           particle_handler->get_property_pool().reserve(2 * particle_handler->n_locally_owned_particles());
 
-          // Loop over all cells and initialize the particles cell-wise
+          // Loop over all cells and initialize the particles cell-wise.
+          // This loop is not run in parallel, because the property plugins
+          // evaluate the initial conditions, whose plugins are not required
+          // to be thread-safe.
           typename DoFHandler<dim>::active_cell_iterator
           cell = this->get_dof_handler().begin_active(),
           endc = this->get_dof_handler().end();
@@ -599,6 +755,7 @@ namespace aspect
                   local_initialize_particles(particles_in_cell.begin(),
                                              particles_in_cell.end());
               }
+
           if (update_ghost_particles &&
               dealii::Utilities::MPI::n_mpi_processes(this->get_mpi_communicator()) > 1)
             {
@@ -612,29 +769,30 @@ namespace aspect
     void
     World<dim>::update_particles()
     {
-      // TODO: Change this loop over all cells to use the WorkStream interface
-
       if (property_manager->get_n_property_components() > 0)
         {
           TimerOutput::Scope timer_section(this->get_computing_timer(), "Particles: Update properties");
 
           // Loop over all cells and update the particles cell-wise
-          typename DoFHandler<dim>::active_cell_iterator
-          cell = this->get_dof_handler().begin_active(),
-          endc = this->get_dof_handler().end();
-
-          for (; cell!=endc; ++cell)
-            if (cell->is_locally_owned())
-              {
-                typename ParticleHandler<dim>::particle_iterator_range
-                particles_in_cell = particle_handler->particles_in_cell(cell);
-
-                // Only update particles, if there are any in this cell
-                if (particles_in_cell.begin() != particles_in_cell.end())
-                  local_update_particles(cell,
-                                         particles_in_cell.begin(),
-                                         particles_in_cell.end());
-              }
+          typedef FilteredIterator<typename DoFHandler<dim>::active_cell_iterator> CellFilter;
+
+          particle_handler->compress_particle_storage();
+
+          WorkStream::
+          run (CellFilter (IteratorFilters::LocallyOwnedCell(),
+                           this->get_dof_handler().begin_active()),
+               CellFilter (IteratorFilters::LocallyOwnedCell(),
+                           this->get_dof_handler().end()),
+               std_cxx11::bind (&World<dim>::local_update_particles,
+                                this,
+                                std_cxx11::_1,
+                                std_cxx11::_2,
+                                std_cxx11::_3),
+               std_cxx11::bind (&World<dim>::copy_local_particle_data,
+                                this,
+                                std_cxx11::_1),
+               internal::ParticleCellScratchData<dim>(),
+               internal::ParticleCellCopyData());
         }
     }
 
@@ -643,26 +801,31 @@ namespace aspect
     World<dim>::advect_particles()
     {
       {
-        // TODO: Change this loop over all cells to use the WorkStream interface
         TimerOutput::Scope timer_section(this->get_computing_timer(), "Particles: Advect");
 
-        // Loop over all cells and advect the particles cell-wise
-        typename DoFHandler<dim>::active_cell_iterator
-        cell = this->get_dof_handler().begin_active(),
-        endc = this->get_dof_handler().end();
-
-        for (; cell!=endc; ++cell)
-          if (cell->is_locally_owned())
-            {
-              const typename ParticleHandler<dim>::particle_iterator_range
-              particles_in_cell = particle_handler->particles_in_cell(cell);
-
-              // Only advect particles, if there are any in this cell
-              if (particles_in_cell.begin() != particles_in_cell.end())
-                local_advect_particles(cell,
-                                       particles_in_cell.begin(),
-                                       particles_in_cell.end());
-            }
+        // Loop over all cells and advect the particles cell-wise. Particles
+        // only change their position here, they are not moved between
+        // cells until the sorting below, therefore the cells can be
+        // processed in parallel.
+        typedef FilteredIterator<typename DoFHandler<dim>::active_cell_iterator> CellFilter;
+
+        particle_handler->compress_particle_storage();
+
+        WorkStream::
+        run (CellFilter (IteratorFilters::LocallyOwnedCell(),
+                         this->get_dof_handler().begin_active()),
+             CellFilter (IteratorFilters::LocallyOwnedCell(),
+                         this->get_dof_handler().end()),
+             std_cxx11::bind (&World<dim>::local_advect_particles,
+                              this,
+                              std_cxx11::_1,
+                              std_cxx11::_2,
+                              std_cxx11::_3),
+             std_cxx11::bind (&World<dim>::copy_local_particle_data,
+                              this,
+                              std_cxx11::_1),
+             internal::ParticleCellScratchData<dim>(),
+             internal::ParticleCellCopyData());
 
         // If particles fell out of the mesh, put them back in if they have crossed
         // a periodic boundary. If they have left the mesh otherwise, they will be
@@ -675,6 +838,9 @@ namespace aspect
         TimerOutput::Scope timer_section(this->get_computing_timer(), "Particles: Sort");
         // Find the cells that the particles moved to
         particle_handler->sort_particles_into_subdomains_and_cells();
+
+        if (sort_property_memory)
+          particle_handler->sort_property_memory();
       }
     }
 
@@ -682,6 +848,15 @@ namespace aspect
     void
     World<dim>::advance_timestep()
     {
+      if (adaptive_particle_weight)
+        particle_timer.start();
+
+      // A deforming mesh changes the cell geometry without changing the
+      // triangulation, therefore the particle handler has to be told
+      // to update its cached cell geometry.
+      if (this->get_parameters().free_surface_enabled)
+        particle_handler->notify_mesh_deformation();
+
       do
         {
           advect_particles();
@@ -706,6 +881,84 @@ namespace aspect
           TimerOutput::Scope timer_section(this->get_computing_timer(), "Particles: Exchange ghosts");
           particle_handler->exchange_ghost_particles();
         }
+
+      if (adaptive_particle_weight)
+        {
+          particle_timer.stop();
+          update_adaptive_particle_weight();
+        }
+    }
+
+    template <int dim>
+    void
+    World<dim>::update_adaptive_particle_weight()
+    {
+      const MPI_Comm mpi_communicator = this->get_mpi_communicator();
+
+      const double particle_time = particle_timer.wall_time() + external_particle_time;
+      const Utilities::MPI::MinMaxAvg particle_times = Utilities::MPI::min_max_avg(particle_time,mpi_communicator);
+
+      particle_load_imbalance = (particle_times.avg > 0.0)
+                                ?
+                                particle_times.max / particle_times.avg
+                                :
+                                1.0;
+
+      // The time step timer was reset in initialize() and is only
+      // running after the first time step
+      const double time_step_time = time_step_timer.wall_time();
+      if (time_step_time > 0.0)
+        {
+          const double field_time = std::max(time_step_time - particle_time, 0.0);
+          const double global_field_time = Utilities::MPI::sum(field_time,mpi_communicator);
+
+          const types::particle_index n_particles = particle_handler->n_global_particles();
+          const types::global_dof_index n_cells = this->get_triangulation().n_global_active_cells();
+
+          if (global_field_time > 0.0 && n_particles > 0)
+            {
+              // A cell has a weight of 1000, therefore a particle gets
+              // 1000 times the ratio of the cost per particle to the
+              // cost of the field-based computations per cell. Average with
+              // the previous weight to damp the fluctuations of individual
+              // time steps.
+              const double measured_particle_weight = 1000.0
+                                                      * (particle_times.sum / n_particles)
+                                                      / (global_field_time / n_cells);
+
+              particle_weight = 0.5 * (particle_weight + measured_particle_weight);
+            }
+        }
+
+      time_step_timer.reset();
+      time_step_timer.start();
+      particle_timer.reset();
+      external_particle_time = 0.0;
+    }
+
+
+
+    template <int dim>
+    void
+    World<dim>::add_external_particle_time(const double time) const
+    {
+      external_particle_time += time;
+    }
+
+    template <int dim>
+    void
+    World<dim>::write_load_balancing_statistics(TableHandler &statistics) const
+    {
+      if (!adaptive_particle_weight)
+        return;
+
+      statistics.add_value("Particle weight", particle_weight);
+
+      if (!std::isnan(particle_load_imbalance))
+        {
+          statistics.add_value("Particle load imbalance", particle_load_imbalance);
+          statistics.set_precision("Particle load imbalance", 3);
+        }
     }
 
     template <int dim>
@@ -782,6 +1035,21 @@ namespace aspect
                              "particle weight is recommended. Before adding the weights "
                              "of particles, each cell already carries a weight of 1000 to "
                              "account for the cost of field-based computations.");
+          prm.declare_entry ("Adaptive particle weight", "false",
+                             Patterns::Bool (),
+                             "Whether to calibrate the `Particle weight' during the model "
+                             "run. If this is set to true, the wall time every process "
+                             "spends on advecting, sorting, updating and interpolating "
+                             "particles and the wall time of the whole time step are "
+                             "measured in every time step. The particle weight is then set "
+                             "such that its ratio to the cell weight of 1000 equals the "
+                             "ratio of the measured cost "
+                             "per particle to the measured cost of all other computations "
+                             "per cell, averaged with the previous weight. The value of "
+                             "`Particle weight' is used until the first measurement is "
+                             "available. The current weight and the ratio of the maximum "
+                             "to the average particle wall time of all processes are "
+                             "written to the statistics file.");
           prm.declare_entry ("Update ghost particles", "false",
                              Patterns::Bool (),
                              "Some particle interpolation algorithms require knowledge "
@@ -789,6 +1057,29 @@ namespace aspect
                              "particles in ghost cells need to be exchanged between the "
                              "processes neighboring this cell. This parameter determines "
                              "whether this transport is happening.");
+          prm.declare_entry ("Ghost particle properties", "all",
+                             Patterns::Selection ("all|interpolated"),
+                             "Which particle properties are sent for ghost particles if "
+                             "`Update ghost particles' is set to true. `all' sends complete "
+                             "particles, including all properties and the data of the "
+                             "particle integrator. `interpolated' only sends the id, the "
+                             "location, and the properties that are interpolated to "
+                             "compositional fields advected with the particle method, or "
+                             "that are used to initialize new particles by interpolation. "
+                             "This reduces the amount of data that is communicated for "
+                             "models with many particle properties, but all other properties "
+                             "of ghost particles are undefined, which can be a problem for "
+                             "user-written plugins that access them.");
+          prm.declare_entry ("Sort particle property memory", "false",
+                             Patterns::Bool (),
+                             "Particles that are created, destroyed or moved between cells "
+                             "and processes scatter their properties in memory over time. "
+                             "If this parameter is set to true, the properties of all "
+                             "particles are moved into one contiguous block of memory in "
+                             "the order of the cells after the particles have been sorted "
+                             "into their new cells. This costs one copy of all particle "
+                             "properties per advection step, but makes all subsequent loops "
+                             "over particles access their properties sequentially.");
         }
         prm.leave_subsection ();
       }
@@ -811,21 +1102,6 @@ namespace aspect
     void
     World<dim>::parse_parameters (ParameterHandler &prm)
     {
-      // First do some error checking. The current algorithm does not find
-      // the cells around particles, if the particles moved more than one
-      // cell in one timestep and we are running in parallel, because they
-      // skip the layer of ghost cells around our local domain. Assert this
-      // is not possible.
-      const double CFL_number = prm.get_double ("CFL number");
-      const unsigned int n_processes = Utilities::MPI::n_mpi_processes(this->get_mpi_communicator());
-
-      AssertThrow((n_processes == 1) || (CFL_number <= 1.0),
-                  ExcMessage("The current particle algorithm does not work in "
-                             "parallel if the CFL number is larger than 1.0, because "
-                             "in this case particles can move more than one cell "
-                             "diameter in one time step and therefore skip the layer "
-                             "of ghost cells around the local subdomain."));
-
       prm.enter_subsection("Postprocess");
       {
         prm.enter_subsection("Particles");
@@ -838,8 +1114,11 @@ namespace aspect
                                  "that is smaller than or equal to the 'Maximum particles per cell' parameter."));
 
           particle_weight = prm.get_integer("Particle weight");
+          adaptive_particle_weight = prm.get_bool("Adaptive particle weight");
 
           update_ghost_particles = prm.get_bool("Update ghost particles");
+          exchange_interpolated_ghost_properties_only = (prm.get("Ghost particle properties") == "interpolated");
+          sort_property_memory = prm.get_bool("Sort particle property memory");
 
           const std::vector<std::string> strategies = Utilities::split_string_list(prm.get ("Load balancing strategy"));
           AssertThrow(Utilities::has_unique_entries(strategies),
@@ -43,8 +43,8 @@ namespace aspect
       const Postprocess::Particles<dim> &particle_postprocessor =
         this->get_postprocess_manager().template get_matching_postprocessor<Postprocess::Particles<dim> >();
 
-      const Particle::ParticleHandler<dim> &particle_handler =
-        particle_postprocessor.get_particle_world().get_particle_handler();
+      const std::vector<unsigned int> &n_particles_per_cell =
+        particle_postprocessor.get_particle_world().get_particle_handler().get_n_particles_per_cell();
 
       typename DoFHandler<dim>::active_cell_iterator
       cell = this->get_dof_handler().begin_active(),
@@ -58,7 +58,7 @@ namespace aspect
       for (; cell!=endc; ++cell)
         if (cell->is_locally_owned())
           {
-            const unsigned int particles_in_cell = particle_handler.n_particles_in_cell(cell);
+            const unsigned int particles_in_cell = n_particles_per_cell[cell->active_cell_index()];
             local_min_particles = std::min(local_min_particles,particles_in_cell);
             local_max_particles = std::max(local_max_particles,particles_in_cell);
           }
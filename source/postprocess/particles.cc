@@ -80,6 +80,7 @@ namespace aspect
         patches.resize(particle_handler.n_locally_owned_particles());
 
         typename Particle::ParticleHandler<dim>::particle_iterator particle = particle_handler.begin();
+        std::vector<double> properties;
 
         for (unsigned int i=0; particle != particle_handler.end(); ++particle, ++i)
           {
@@ -92,7 +93,7 @@ namespace aspect
 
             if (particle->has_properties())
               {
-                const ArrayView<const double> properties = particle->get_properties();
+                particle->get_properties(properties);
                 for (unsigned int property_index = 0; property_index < properties.size(); ++property_index)
                   patches[i].data(property_index+1,0) = properties[property_index];
               }
@@ -130,11 +131,11 @@ namespace aspect
       output_interval (0),
       // initialize this to a nonsensical value; set it to the actual time
       // the first time around we get to check it
-      last_output_time (std::numeric_limits<double>::quiet_NaN())
+      last_output_time (std::numeric_limits<double>::quiet_NaN()),
+      write_in_background_thread(false)
 #if DEAL_II_VERSION_GTE(9,0,0)
       ,output_file_number (numbers::invalid_unsigned_int),
-      group_files(0),
-      write_in_background_thread(false)
+      group_files(0)
 #endif
     {}
 
@@ -176,7 +177,6 @@ namespace aspect
       return world;
     }
 
-#if DEAL_II_VERSION_GTE(9,0,0)
     template <int dim>
     void Particles<dim>::writer (const std::string filename,
                                  const std::string temporary_output_location,
@@ -220,7 +220,7 @@ namespace aspect
             close(tmp_file_desc);
         }
 
-      std::ofstream out(tmp_filename.c_str());
+      std::ofstream out(tmp_filename.c_str(), std::ios::binary);
 
       AssertThrow (out, ExcMessage(std::string("Trying to write to file <") +
                                    filename +
@@ -246,6 +246,7 @@ namespace aspect
       delete file_contents;
     }
 
+#if DEAL_II_VERSION_GTE(9,0,0)
     template <int dim>
     void
     Particles<dim>::write_master_files (const internal::ParticleOutput<dim> &data_out,
@@ -327,6 +328,7 @@ namespace aspect
         world.advance_timestep();
 
       statistics.add_value("Number of advected particles",world.n_global_particles());
+      world.write_load_balancing_statistics(statistics);
 
       // If it's not time to generate an output file or we do not write output
       // return early with the number of particles that were advected
@@ -611,6 +613,21 @@ namespace aspect
                              "'Use years in output instead of seconds' parameter is set; "
                              "seconds otherwise.");
 
+          prm.declare_entry ("Write in background thread", "false",
+                             Patterns::Bool(),
+                             "File operations can potentially take a long time, blocking the "
+                             "progress of the rest of the model run. Setting this variable to "
+                             "`true' moves this process into a background thread, while the "
+                             "rest of the model continues.");
+
+          prm.declare_entry ("Temporary output location", "",
+                             Patterns::Anything(),
+                             "On large clusters it can be advantageous to first write the "
+                             "output to a temporary file on a local file system and later "
+                             "move this file to a network file system. If this variable is "
+                             "set to a non-empty string it will be interpreted as a "
+                             "temporary storage location.");
+
 #if DEAL_II_VERSION_GTE(9,0,0)
           // now also see about the file format we're supposed to write in
           // Note: "ascii" is a legacy format used by ASPECT before particle output
@@ -630,21 +647,6 @@ namespace aspect
                              "A value of 1 will generate one big file containing the whole "
                              "solution, while a larger value will create that many files "
                              "(at most as many as there are MPI ranks).");
-
-          prm.declare_entry ("Write in background thread", "false",
-                             Patterns::Bool(),
-                             "File operations can potentially take a long time, blocking the "
-                             "progress of the rest of the model run. Setting this variable to "
-                             "`true' moves this process into a background thread, while the "
-                             "rest of the model continues.");
-
-          prm.declare_entry ("Temporary output location", "",
-                             Patterns::Anything(),
-                             "On large clusters it can be advantageous to first write the "
-                             "output to a temporary file on a local file system and later "
-                             "move this file to a network file system. If this variable is "
-                             "set to a non-empty string it will be interpreted as a "
-                             "temporary storage location.");
 #endif
         }
         prm.leave_subsection ();
@@ -671,6 +673,21 @@ namespace aspect
                       ExcMessage("Postprocessing nonlinear iterations in models with "
                                  "particles is currently not supported."));
 
+          write_in_background_thread = prm.get_bool("Write in background thread");
+          temporary_output_location = prm.get("Temporary output location");
+
+          if (temporary_output_location != "")
+            {
+              // Check if a command-processor is available by calling system() with a
+              // null pointer. System is guaranteed to return non-zero if it finds
+              // a terminal and zero if there is none (like on the compute nodes of
+              // some cluster architectures, e.g. IBM BlueGene/Q)
+              AssertThrow(system((char *)0) != 0,
+                          ExcMessage("Usage of a temporary storage location is only supported if "
+                                     "there is a terminal available to move the files to their final location "
+                                     "after writing. The system() command did not succeed in finding such a terminal."));
+            }
+
 #if DEAL_II_VERSION_GTE(9,0,0)
           output_formats   = Utilities::split_string_list(prm.get ("Data output format"));
           AssertThrow(Utilities::has_unique_entries(output_formats),
@@ -703,20 +720,6 @@ namespace aspect
             *output_format = "gnuplot";
 
           group_files     = prm.get_integer("Number of grouped files");
-          write_in_background_thread = prm.get_bool("Write in background thread");
-          temporary_output_location = prm.get("Temporary output location");
-
-          if (temporary_output_location != "")
-            {
-              // Check if a command-processor is available by calling system() with a
-              // null pointer. System is guaranteed to return non-zero if it finds
-              // a terminal and zero if there is none (like on the compute nodes of
-              // some cluster architectures, e.g. IBM BlueGene/Q)
-              AssertThrow(system((char *)0) != 0,
-                          ExcMessage("Usage of a temporary storage location is only supported if "
-                                     "there is a terminal available to move the files to their final location "
-                                     "after writing. The system() command did not succeed in finding such a terminal."));
-            }
 #endif
         }
         prm.leave_subsection ();
@@ -39,8 +39,8 @@ namespace aspect
         const Postprocess::Particles<dim> &particle_postprocessor =
           this->get_postprocess_manager().template get_matching_postprocessor<Postprocess::Particles<dim> >();
 
-        const Particle::ParticleHandler<dim> &particle_handler =
-          particle_postprocessor.get_particle_world().get_particle_handler();
+        const std::vector<unsigned int> &n_particles_per_cell =
+          particle_postprocessor.get_particle_world().get_particle_handler().get_n_particles_per_cell();
 
         std::pair<std::string, Vector<float> *>
         return_value ("particles_per_cell",
@@ -51,11 +51,11 @@ namespace aspect
         cell = this->get_dof_handler().begin_active(),
         endc = this->get_dof_handler().end();
 
-        unsigned int cell_index = 0;
-        for (; cell!=endc; ++cell,++cell_index)
+        for (; cell!=endc; ++cell)
           if (cell->is_locally_owned())
             {
-              (*return_value.second)(cell_index) = static_cast<float> (particle_handler.n_particles_in_cell(cell));
+              const unsigned int cell_index = cell->active_cell_index();
+              (*return_value.second)(cell_index) = static_cast<float> (n_particles_per_cell[cell_index]);
             }
 
         return return_value;
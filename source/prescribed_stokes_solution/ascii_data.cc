@@ -64,9 +64,9 @@ namespace aspect
     {
       prm.enter_subsection("Prescribed Stokes solution");
       {
-        Utilities::AsciiDataBase<dim>::declare_parameters(prm,
-                                                          "$ASPECT_SOURCE_DIR/data/prescribed-stokes-solution/",
-                                                          "box_2d.txt");
+        Utilities::AsciiDataInitial<dim>::declare_parameters(prm,
+                                                             "$ASPECT_SOURCE_DIR/data/prescribed-stokes-solution/",
+                                                             "box_2d.txt");
       }
       prm.leave_subsection();
     }
@@ -78,7 +78,7 @@ namespace aspect
     {
       prm.enter_subsection("Prescribed Stokes solution");
       {
-        Utilities::AsciiDataBase<dim>::parse_parameters(prm);
+        Utilities::AsciiDataInitial<dim>::parse_parameters(prm);
       }
       prm.leave_subsection();
     }
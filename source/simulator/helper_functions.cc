@@ -38,9 +38,12 @@
 #include <deal.II/base/conditional_ostream.h>
 #include <deal.II/base/quadrature_lib.h>
 #include <deal.II/base/signaling_nan.h>
+#include <deal.II/base/work_stream.h>
+#include <deal.II/base/std_cxx11/shared_ptr.h>
 #include <deal.II/lac/constraint_matrix.h>
 #include <deal.II/lac/block_sparsity_pattern.h>
 #include <deal.II/grid/grid_tools.h>
+#include <deal.II/grid/filtered_iterator.h>
 
 #include <deal.II/dofs/dof_renumbering.h>
 #include <deal.II/dofs/dof_accessor.h>
@@ -1492,189 +1495,764 @@ namespace aspect
 
 
 
-  template <int dim>
-  void Simulator<dim>::compute_reactions ()
+  namespace internal
   {
-    // if the time step has a length of zero, there are no reactions
-    if (time_step == 0)
-      return;
+    namespace Reactions
+    {
+      /**
+       * The material model inputs and outputs for a subset of the support
+       * points of one cell, for which the reaction rates are computed
+       * together.
+       */
+      template <int dim>
+      struct PointBatch
+      {
+        PointBatch (const unsigned int n_points,
+                    const unsigned int n_compositional_fields)
+          :
+          in (n_points, n_compositional_fields),
+          out (n_points, n_compositional_fields),
+          heating_model_outputs (n_points, n_compositional_fields)
+        {}
+
+        MaterialModel::MaterialModelInputs<dim>  in;
+        MaterialModel::MaterialModelOutputs<dim> out;
+        HeatingModel::HeatingModelOutputs        heating_model_outputs;
+      };
+
+      /**
+       * Scratch data for the computation of the reactions on one cell.
+       */
+      template <int dim>
+      struct ScratchData
+      {
+        ScratchData (const Mapping<dim>       &mapping,
+                     const FiniteElement<dim> &finite_element,
+                     const Quadrature<dim>    &quadrature_C,
+                     const Quadrature<dim>    &quadrature_T,
+                     const unsigned int        n_compositional_fields)
+          :
+          fe_values_C (mapping,
+                       finite_element,
+                       quadrature_C,
+                       update_quadrature_points | update_values | update_gradients),
+          fe_values_T (mapping,
+                       finite_element,
+                       quadrature_T,
+                       update_quadrature_points | update_values | update_gradients),
+          in_C (quadrature_C.size(), n_compositional_fields),
+          in_T (quadrature_T.size(), n_compositional_fields),
+          local_dof_indices (finite_element.dofs_per_cell)
+        {}
+
+        ScratchData (const ScratchData &scratch)
+          :
+          fe_values_C (scratch.fe_values_C.get_mapping(),
+                       scratch.fe_values_C.get_fe(),
+                       scratch.fe_values_C.get_quadrature(),
+                       scratch.fe_values_C.get_update_flags()),
+          fe_values_T (scratch.fe_values_T.get_mapping(),
+                       scratch.fe_values_T.get_fe(),
+                       scratch.fe_values_T.get_quadrature(),
+                       scratch.fe_values_T.get_update_flags()),
+          in_C (scratch.in_C),
+          in_T (scratch.in_T),
+          local_dof_indices (scratch.local_dof_indices)
+        {}
+
+        FEValues<dim> fe_values_C;
+        FEValues<dim> fe_values_T;
+
+        /**
+         * The material model inputs at all support points of the
+         * composition and temperature element of the current cell.
+         */
+        MaterialModel::MaterialModelInputs<dim> in_C;
+        MaterialModel::MaterialModelInputs<dim> in_T;
+
+        std::vector<types::global_dof_index> local_dof_indices;
+
+        /**
+         * The support points of the current cell at which the reactions are
+         * computed.
+         */
+        std::vector<unsigned int> batch_points;
+
+        /**
+         * The temperature and the compositions (in this order) at the points
+         * of batch_points after the reactions, and their accumulated
+         * changes, both stored consecutively for every point.
+         */
+        std::vector<double> values;
+        std::vector<double> changes;
+
+        /**
+         * Temporary storage of the adaptive integrator: the stages of the
+         * Runge-Kutta method, the new values, the time reached and the
+         * current step size of every point, and the points that have not
+         * yet reached the end of the time step.
+         */
+        std::vector<double>       stage_values;
+        std::vector<double>       k1, k2, k3, k4;
+        std::vector<double>       new_values;
+        std::vector<double>       time;
+        std::vector<double>       step_size;
+        std::vector<unsigned int> active_points;
+
+        /**
+         * The batches used so far, indexed by their number of points. They
+         * are created on first use, so that the additional material model
+         * outputs do not have to be recreated for every evaluation.
+         */
+        std::vector<std_cxx11::shared_ptr<PointBatch<dim> > > batches;
+      };
+
+      /**
+       * The new values and the accumulated reactions of the degrees of
+       * freedom that were computed on one cell, and the number of substeps
+       * of the adaptive integrator.
+       */
+      struct CopyData
+      {
+        std::vector<types::global_dof_index> dof_indices;
+        std::vector<double>                  values;
+        std::vector<double>                  reactions;
+
+        unsigned int n_accepted_steps;
+        unsigned int n_rejected_steps;
+        unsigned int max_steps_per_point;
+      };
+
+      /**
+       * A class that solves the reaction equations of the operator
+       * splitting scheme at the support points of the temperature and
+       * compositional fields. The reactions at a support point only depend
+       * on the solution at this point, so every support point is assigned
+       * to exactly one locally owned cell by select_support_points(), and
+       * the reactions are then computed cell-wise through the WorkStream
+       * framework. On every cell the selected support points are evaluated
+       * together in one material model call per reaction step. If the
+       * temperature and the compositional fields use the same support
+       * points, both are updated with the same material model call.
+       *
+       * The reactions are either integrated with a fixed number of forward
+       * Euler steps, or with the embedded Runge-Kutta method of Bogacki and
+       * Shampine, which chooses the step size of every support point
+       * separately such that the estimated error of every step stays below
+       * the given tolerances.
+       */
+      template <int dim>
+      class ReactionSolver
+      {
+        public:
+          ReactionSolver (const MaterialModel::Interface<dim> &material_model,
+                          const HeatingModel::Manager<dim>    &heating_model_manager,
+                          const Introspection<dim>            &introspection,
+                          const FiniteElement<dim>            &finite_element,
+                          const LinearAlgebra::BlockVector    &solution,
+                          const unsigned int                   n_reaction_steps,
+                          const double                         reaction_time_step_size,
+                          const bool                           adaptive,
+                          const double                         relative_tolerance,
+                          const double                         absolute_tolerance,
+                          LinearAlgebra::BlockVector          &distributed_vector,
+                          LinearAlgebra::BlockVector          &distributed_reaction_vector)
+            :
+            n_accepted_steps (0),
+            n_rejected_steps (0),
+            max_steps_per_point (0),
+            material_model (material_model),
+            heating_model_manager (heating_model_manager),
+            introspection (introspection),
+            finite_element (finite_element),
+            solution (solution),
+            n_reaction_steps (n_reaction_steps),
+            reaction_time_step_size (reaction_time_step_size),
+            adaptive (adaptive),
+            relative_tolerance (relative_tolerance),
+            absolute_tolerance (absolute_tolerance),
+            distributed_vector (distributed_vector),
+            distributed_reaction_vector (distributed_reaction_vector),
+            n_points_C (introspection.n_compositional_fields > 0
+                        ?
+                        finite_element.base_element(introspection.base_elements.compositional_fields).dofs_per_cell
+                        :
+                        0),
+            n_points_T (finite_element.base_element(introspection.base_elements.temperature).dofs_per_cell),
+            n_values (1 + introspection.n_compositional_fields),
+            shared_support_points (introspection.n_compositional_fields > 0
+                                   &&
+                                   finite_element.base_element(introspection.base_elements.compositional_fields).get_unit_support_points()
+                                   ==
+                                   finite_element.base_element(introspection.base_elements.temperature).get_unit_support_points())
+          {}
+
+          /**
+           * Assign every locally owned temperature and composition degree
+           * of freedom to the first locally owned cell it belongs to.
+           */
+          void
+          select_support_points (const DoFHandler<dim> &dof_handler)
+          {
+            const IndexSet &locally_owned_dofs = dof_handler.locally_owned_dofs();
+            std::vector<bool> dof_is_selected (locally_owned_dofs.n_elements(), false);
 
-    // we need some temporary vectors to store our updates to composition and temperature in
-    // while we do the time stepping, before we copy them over to the solution vector in the end
-    LinearAlgebra::BlockVector distributed_vector (introspection.index_sets.system_partitioning,
-                                                   mpi_communicator);
+            selected_points.assign(dof_handler.get_triangulation().n_active_cells() * (n_points_C + n_points_T),
+                                   false);
 
-    LinearAlgebra::BlockVector distributed_reaction_vector (introspection.index_sets.system_partitioning,
-                                                            mpi_communicator);
+            std::vector<types::global_dof_index> local_dof_indices (finite_element.dofs_per_cell);
 
-    // we use a different (potentially smaller) time step than in the advection scheme,
-    // and we want all of our reaction time steps (within one advection step) to have the same size
-    const unsigned int number_of_reaction_steps = std::max(static_cast<unsigned int>(time_step / parameters.reaction_time_step),
-                                                           std::max(parameters.reaction_steps_per_advection_step,1U));
+            // all compositional fields share the same base element and the
+            // same support points, so it is enough to look at the first one.
+            // Without compositional fields n_points_C is zero and only
+            // temperature support points are selected.
+            const unsigned int component_C = (introspection.n_compositional_fields > 0
+                                              ?
+                                              introspection.component_indices.compositional_fields[0]
+                                              :
+                                              numbers::invalid_unsigned_int);
+            const unsigned int component_T = introspection.component_indices.temperature;
 
-    const double reaction_time_step_size = time_step / static_cast<double>(number_of_reaction_steps);
+            typename DoFHandler<dim>::active_cell_iterator cell = dof_handler.begin_active(),
+                                                           endc = dof_handler.end();
+            for (; cell!=endc; ++cell)
+              if (cell->is_locally_owned())
+                {
+                  cell->get_dof_indices (local_dof_indices);
+                  const unsigned int offset = cell->active_cell_index() * (n_points_C + n_points_T);
 
-    Assert (reaction_time_step_size > 0,
-            ExcMessage("Reaction time step must be greater than 0."));
+                  for (unsigned int j=0; j<n_points_C + n_points_T; ++j)
+                    {
+                      const types::global_dof_index dof_index
+                        = (j < n_points_C
+                           ?
+                           local_dof_indices[finite_element.component_to_system_index(component_C, j)]
+                           :
+                           local_dof_indices[finite_element.component_to_system_index(component_T, j - n_points_C)]);
+
+                      // skip entries that are not locally owned:
+                      if (!locally_owned_dofs.is_element(dof_index))
+                        continue;
+
+                      const types::global_dof_index local_index = locally_owned_dofs.index_within_set(dof_index);
+                      if (!dof_is_selected[local_index])
+                        {
+                          dof_is_selected[local_index] = true;
+                          selected_points[offset + j] = true;
+                        }
+                    }
+                }
+          }
 
-    pcout << "   Solving composition reactions in "
-          << number_of_reaction_steps
-          << " substep(s)."
-          << std::endl;
+          void
+          local_compute_reactions (const typename DoFHandler<dim>::active_cell_iterator &cell,
+                                   ScratchData<dim> &scratch,
+                                   CopyData &data) const
+          {
+            data.dof_indices.clear();
+            data.values.clear();
+            data.reactions.clear();
+            data.n_accepted_steps = 0;
+            data.n_rejected_steps = 0;
+            data.max_steps_per_point = 0;
+
+            const unsigned int offset = cell->active_cell_index() * (n_points_C + n_points_T);
+            const std::vector<bool>::const_iterator selected_C = selected_points.begin() + offset;
+            const std::vector<bool>::const_iterator selected_T = selected_C + n_points_C;
+
+            cell->get_dof_indices (scratch.local_dof_indices);
+
+            // composition support points, which are also the temperature
+            // support points if both are the same
+            scratch.batch_points.clear();
+            for (unsigned int j=0; j<n_points_C; ++j)
+              if (selected_C[j] || (shared_support_points && selected_T[j]))
+                scratch.batch_points.push_back(j);
+
+            if (scratch.batch_points.size() > 0)
+              {
+                scratch.fe_values_C.reinit (cell);
+                scratch.in_C.reinit(scratch.fe_values_C, cell, introspection, solution);
 
-    // make one fevalues for the composition, and one for the temperature (they might use different finite elements)
-    const Quadrature<dim> quadrature_C(dof_handler.get_fe().base_element(introspection.base_elements.compositional_fields).get_unit_support_points());
+                compute_reactions(scratch.in_C, scratch, data);
 
-    FEValues<dim> fe_values_C (*mapping,
-                               dof_handler.get_fe(),
-                               quadrature_C,
-                               update_quadrature_points | update_values | update_gradients);
+                for (unsigned int i=0; i<scratch.batch_points.size(); ++i)
+                  {
+                    const unsigned int j = scratch.batch_points[i];
+
+                    if (selected_C[j])
+                      for (unsigned int c=0; c<introspection.n_compositional_fields; ++c)
+                        add_value (scratch.local_dof_indices[finite_element.component_to_system_index(introspection.component_indices.compositional_fields[c],
+                                                             /*dof index within component=*/ j)],
+                                   scratch.values[i*n_values+1+c],
+                                   scratch.changes[i*n_values+1+c],
+                                   data);
+
+                    if (shared_support_points && selected_T[j])
+                      add_value (scratch.local_dof_indices[finite_element.component_to_system_index(introspection.component_indices.temperature,
+                                                           /*dof index within component=*/ j)],
+                                 scratch.values[i*n_values],
+                                 scratch.changes[i*n_values],
+                                 data);
+                  }
+              }
 
-    std::vector<types::global_dof_index> local_dof_indices (dof_handler.get_fe().dofs_per_cell);
-    MaterialModel::MaterialModelInputs<dim> in_C(quadrature_C.size(), introspection.n_compositional_fields);
-    MaterialModel::MaterialModelOutputs<dim> out_C(quadrature_C.size(), introspection.n_compositional_fields);
-    HeatingModel::HeatingModelOutputs heating_model_outputs_C(quadrature_C.size(), introspection.n_compositional_fields);
+            if (shared_support_points)
+              return;
 
-    // temperature element
-    const Quadrature<dim> quadrature_T(dof_handler.get_fe().base_element(introspection.base_elements.temperature).get_unit_support_points());
+            // temperature support points
+            scratch.batch_points.clear();
+            for (unsigned int j=0; j<n_points_T; ++j)
+              if (selected_T[j])
+                scratch.batch_points.push_back(j);
 
-    FEValues<dim> fe_values_T (*mapping,
-                               dof_handler.get_fe(),
-                               quadrature_T,
-                               update_quadrature_points | update_values | update_gradients);
-
-    MaterialModel::MaterialModelInputs<dim> in_T(quadrature_T.size(), introspection.n_compositional_fields);
-    MaterialModel::MaterialModelOutputs<dim> out_T(quadrature_T.size(), introspection.n_compositional_fields);
-    HeatingModel::HeatingModelOutputs heating_model_outputs_T(quadrature_T.size(), introspection.n_compositional_fields);
-
-    // add reaction rate outputs
-    material_model->create_additional_named_outputs(out_C);
-    material_model->create_additional_named_outputs(out_T);
-
-    MaterialModel::ReactionRateOutputs<dim> *reaction_rate_outputs_C
-      = out_C.template get_additional_output<MaterialModel::ReactionRateOutputs<dim> >();
-
-    MaterialModel::ReactionRateOutputs<dim> *reaction_rate_outputs_T
-      = out_T.template get_additional_output<MaterialModel::ReactionRateOutputs<dim> >();
-
-    AssertThrow(reaction_rate_outputs_C != NULL && reaction_rate_outputs_T != NULL,
-                ExcMessage("You are trying to use the operator splitting solver scheme, "
-                           "but the material model you use does not support operator splitting "
-                           "(it does not create ReactionRateOutputs, which are required for this "
-                           "solver scheme)."));
-
-    // some heating models require the additional outputs
-    heating_model_manager.create_additional_material_model_outputs(out_C);
-    heating_model_manager.create_additional_material_model_outputs(out_T);
-
-    // Make a loop first over all cells, than over all reaction time steps, and then over
-    // all degrees of freedom in each element to compute the reactions. This is possible
-    // because the reactions only depend on the temperature and composition values at a given
-    // degree of freedom (and are independent of the solution in other points).
-
-    // Note that the values for some degrees of freedom are set more than once in the loop
-    // below where we assign the new values to distributed_vector (if they are located on the
-    // interface between cells), as we loop over all cells, and then over all degrees of freedom
-    // on each cell. Although this means we do some additional work, the results are still
-    // correct, as we never read from distributed_vector inside the loop over all cells.
-    // We initialize the material model inputs objects in_T and in_C using the solution vector
-    // on every cell, compute the update, and then on every cell put the result into the
-    // distributed_vector vector. Only after the loop over all cells do we copy distributed_vector
-    // back onto the solution vector.
-    // So even though we touch some DoF twice, we always start from the same value, compute the
-    // same value, and then overwrite the same value in distributed_vector.
-    // TODO: make this more effective
-    typename DoFHandler<dim>::active_cell_iterator cell = dof_handler.begin_active(),
-                                                   endc = dof_handler.end();
-    for (; cell!=endc; ++cell)
-      if (cell->is_locally_owned())
-        {
-          fe_values_C.reinit (cell);
-          cell->get_dof_indices (local_dof_indices);
-          in_C.reinit(fe_values_C, cell, introspection, solution);
-
-          fe_values_T.reinit (cell);
-          in_T.reinit(fe_values_T, cell, introspection, solution);
-
-          std::vector<std::vector<double> > accumulated_reactions_C (quadrature_C.size(),std::vector<double> (introspection.n_compositional_fields));
-          std::vector<double> accumulated_reactions_T (quadrature_T.size());
-
-          // Make the reaction time steps: We have to update the values of compositional fields and the temperature.
-          // Because temperature and composition might use different finite elements, we loop through their elements
-          // separately, and update the temperature and the compositions for both.
-          // We can reuse the same material model inputs and outputs structure for each reaction time step.
-          // We store the computed updates to temperature and composition in a separate (accumulated_reactions) vector,
-          // so that we can later copy it over to the solution vector.
-          for (unsigned int i=0; i<number_of_reaction_steps; ++i)
-            {
-              // Loop over composition element
-              material_model->evaluate(in_C, out_C);
+            if (scratch.batch_points.size() > 0)
+              {
+                scratch.fe_values_T.reinit (cell);
+                scratch.in_T.reinit(scratch.fe_values_T, cell, introspection, solution);
+
+                compute_reactions(scratch.in_T, scratch, data);
 
-              heating_model_manager.evaluate(in_C, out_C, heating_model_outputs_C);
+                for (unsigned int i=0; i<scratch.batch_points.size(); ++i)
+                  add_value (scratch.local_dof_indices[finite_element.component_to_system_index(introspection.component_indices.temperature,
+                                                       /*dof index within component=*/ scratch.batch_points[i])],
+                             scratch.values[i*n_values],
+                             scratch.changes[i*n_values],
+                             data);
+              }
+          }
+
+          void
+          copy_local_to_global (const CopyData &data)
+          {
+            for (unsigned int i=0; i<data.dof_indices.size(); ++i)
+              {
+                distributed_vector(data.dof_indices[i]) = data.values[i];
+                distributed_reaction_vector(data.dof_indices[i]) = data.reactions[i];
+              }
 
-              for (unsigned int j=0; j<dof_handler.get_fe().base_element(introspection.base_elements.compositional_fields).dofs_per_cell; ++j)
+            n_accepted_steps += data.n_accepted_steps;
+            n_rejected_steps += data.n_rejected_steps;
+            max_steps_per_point = std::max(max_steps_per_point, data.max_steps_per_point);
+          }
+
+          /**
+           * The number of accepted and rejected steps of the adaptive
+           * integrator summed over all locally computed support points, and
+           * the largest number of accepted steps of a single support point.
+           */
+          types::global_dof_index n_accepted_steps;
+          types::global_dof_index n_rejected_steps;
+          unsigned int            max_steps_per_point;
+
+        private:
+          /**
+           * Integrate the reactions at the support points
+           * scratch.batch_points, starting from the values in @p cell_inputs,
+           * and store the new values and the accumulated changes in
+           * scratch.values and scratch.changes.
+           */
+          void
+          compute_reactions (const MaterialModel::MaterialModelInputs<dim> &cell_inputs,
+                             ScratchData<dim> &scratch,
+                             CopyData &data) const
+          {
+            const unsigned int n_points = scratch.batch_points.size();
+
+            scratch.values.resize(n_points * n_values);
+            scratch.changes.assign(n_points * n_values, 0.0);
+
+            for (unsigned int i=0; i<n_points; ++i)
+              {
+                const unsigned int q = scratch.batch_points[i];
+                scratch.values[i*n_values] = cell_inputs.temperature[q];
+                for (unsigned int c=0; c<introspection.n_compositional_fields; ++c)
+                  scratch.values[i*n_values+1+c] = cell_inputs.composition[q][c];
+              }
+
+            scratch.active_points.resize(n_points);
+            for (unsigned int i=0; i<n_points; ++i)
+              scratch.active_points[i] = i;
+
+            if (adaptive)
+              integrate_adaptively(cell_inputs, scratch, data);
+            else
+              for (unsigned int step=0; step<n_reaction_steps; ++step)
                 {
-                  for (unsigned int c=0; c<introspection.n_compositional_fields; ++c)
+                  // simple forward euler
+                  compute_rates(cell_inputs, scratch.values, scratch, scratch.k1);
+
+                  for (unsigned int i=0; i<n_points*n_values; ++i)
                     {
-                      // simple forward euler
-                      in_C.composition[j][c] = in_C.composition[j][c]
-                                               + reaction_time_step_size * reaction_rate_outputs_C->reaction_rates[j][c];
-                      accumulated_reactions_C[j][c] += reaction_time_step_size * reaction_rate_outputs_C->reaction_rates[j][c];
+                      const double change = reaction_time_step_size * scratch.k1[i];
+                      scratch.values[i] += change;
+                      scratch.changes[i] += change;
                     }
-                  in_C.temperature[j] = in_C.temperature[j]
-                                        + reaction_time_step_size * heating_model_outputs_C.rates_of_temperature_change[j];
                 }
+          }
 
-              // loop over temperature element
-              material_model->evaluate(in_T, out_T);
+          /**
+           * Integrate the reactions of every point with the Bogacki-Shampine
+           * method, which uses its last stage as the first stage of the next
+           * step. The step size of every point is chosen separately, and
+           * every material model evaluation only contains the points that
+           * have not yet reached the end of the time step.
+           */
+          void
+          integrate_adaptively (const MaterialModel::MaterialModelInputs<dim> &cell_inputs,
+                                ScratchData<dim> &scratch,
+                                CopyData &data) const
+          {
+            const unsigned int n_points = scratch.batch_points.size();
+            const double time_step = n_reaction_steps * reaction_time_step_size;
 
-              heating_model_manager.evaluate(in_T, out_T, heating_model_outputs_T);
+            // Start every point with the step size of the fixed step scheme
+            scratch.time.assign(n_points, 0.0);
+            scratch.step_size.assign(n_points, reaction_time_step_size);
+            std::vector<unsigned int> n_steps (n_points, 0);
 
-              for (unsigned int j=0; j<dof_handler.get_fe().base_element(introspection.base_elements.temperature).dofs_per_cell; ++j)
-                {
-                  // simple forward euler
-                  in_T.temperature[j] = in_T.temperature[j]
-                                        + reaction_time_step_size * heating_model_outputs_T.rates_of_temperature_change[j];
-                  accumulated_reactions_T[j] += reaction_time_step_size * heating_model_outputs_T.rates_of_temperature_change[j];
+            scratch.new_values = scratch.values;
+            scratch.stage_values.resize(n_points * n_values);
+            scratch.k2.resize(n_points * n_values);
+            scratch.k3.resize(n_points * n_values);
+            scratch.k4.resize(n_points * n_values);
 
-                  for (unsigned int c=0; c<introspection.n_compositional_fields; ++c)
-                    in_T.composition[j][c] = in_T.composition[j][c]
-                                             + reaction_time_step_size * reaction_rate_outputs_T->reaction_rates[j][c];
-                }
-            }
+            compute_rates(cell_inputs, scratch.values, scratch, scratch.k1);
 
-          // copy reaction rates and new values for the compositional fields
-          for (unsigned int j=0; j<dof_handler.get_fe().base_element(introspection.base_elements.compositional_fields).dofs_per_cell; ++j)
-            for (unsigned int c=0; c<introspection.n_compositional_fields; ++c)
+            while (scratch.active_points.size() > 0)
               {
-                const unsigned int composition_idx
-                  = dof_handler.get_fe().component_to_system_index(introspection.component_indices.compositional_fields[c],
-                                                                   /*dof index within component=*/ j);
+                for (unsigned int p=0; p<scratch.active_points.size(); ++p)
+                  {
+                    const unsigned int i = scratch.active_points[p];
+                    const double h = step_length(scratch.step_size[i], time_step - scratch.time[i]);
+                    for (unsigned int v=i*n_values; v<(i+1)*n_values; ++v)
+                      scratch.stage_values[v] = scratch.values[v] + 0.5 * h * scratch.k1[v];
+                  }
+                compute_rates(cell_inputs, scratch.stage_values, scratch, scratch.k2);
 
-                // skip entries that are not locally owned:
-                if (dof_handler.locally_owned_dofs().is_element(local_dof_indices[composition_idx]))
+                for (unsigned int p=0; p<scratch.active_points.size(); ++p)
                   {
-                    distributed_vector(local_dof_indices[composition_idx]) = in_C.composition[j][c];
-                    distributed_reaction_vector(local_dof_indices[composition_idx]) = accumulated_reactions_C[j][c];
+                    const unsigned int i = scratch.active_points[p];
+                    const double h = step_length(scratch.step_size[i], time_step - scratch.time[i]);
+                    for (unsigned int v=i*n_values; v<(i+1)*n_values; ++v)
+                      scratch.stage_values[v] = scratch.values[v] + 0.75 * h * scratch.k2[v];
                   }
-              }
+                compute_rates(cell_inputs, scratch.stage_values, scratch, scratch.k3);
 
-          // copy reaction rates and new values for the temperature field
-          for (unsigned int j=0; j<dof_handler.get_fe().base_element(introspection.base_elements.temperature).dofs_per_cell; ++j)
-            for (unsigned int c=0; c<introspection.n_compositional_fields; ++c)
-              {
-                const unsigned int temperature_idx
-                  = dof_handler.get_fe().component_to_system_index(introspection.component_indices.temperature,
-                                                                   /*dof index within component=*/ j);
+                for (unsigned int p=0; p<scratch.active_points.size(); ++p)
+                  {
+                    const unsigned int i = scratch.active_points[p];
+                    const double h = step_length(scratch.step_size[i], time_step - scratch.time[i]);
+                    for (unsigned int v=i*n_values; v<(i+1)*n_values; ++v)
+                      scratch.new_values[v] = scratch.values[v]
+                                              + h * (2./9. * scratch.k1[v] + 1./3. * scratch.k2[v] + 4./9. * scratch.k3[v]);
+                  }
+                compute_rates(cell_inputs, scratch.new_values, scratch, scratch.k4);
 
-                // skip entries that are not locally owned:
-                if (dof_handler.locally_owned_dofs().is_element(local_dof_indices[temperature_idx]))
+                // Compare the third order solution with the embedded second
+                // order solution, and accept or reject the step of every point
+                unsigned int n_still_active = 0;
+                for (unsigned int p=0; p<scratch.active_points.size(); ++p)
                   {
-                    distributed_vector(local_dof_indices[temperature_idx]) = in_T.temperature[j];
-                    distributed_reaction_vector(local_dof_indices[temperature_idx]) = accumulated_reactions_T[j];
+                    const unsigned int i = scratch.active_points[p];
+                    const double h = step_length(scratch.step_size[i], time_step - scratch.time[i]);
+                    const bool last_step = (h == time_step - scratch.time[i]);
+
+                    double error = 0.0;
+                    for (unsigned int v=i*n_values; v<(i+1)*n_values; ++v)
+                      {
+                        const double local_error = h * (-5./72. * scratch.k1[v] + 1./12. * scratch.k2[v]
+                                                        + 1./9. * scratch.k3[v] - 1./8. * scratch.k4[v]);
+                        const double scale = absolute_tolerance
+                                             + relative_tolerance * std::max(std::abs(scratch.values[v]),
+                                                                             std::abs(scratch.new_values[v]));
+                        error = std::max(error, std::abs(local_error) / scale);
+                      }
+
+                    if (error <= 1.0)
+                      {
+                        for (unsigned int v=i*n_values; v<(i+1)*n_values; ++v)
+                          {
+                            scratch.changes[v] += scratch.new_values[v] - scratch.values[v];
+                            scratch.values[v] = scratch.new_values[v];
+                            scratch.k1[v] = scratch.k4[v];
+                          }
+                        scratch.time[i] = (last_step ? time_step : scratch.time[i] + h);
+                        ++n_steps[i];
+                        ++data.n_accepted_steps;
+                      }
+                    else
+                      ++data.n_rejected_steps;
+
+                    // Choose the next step size from the error estimate of
+                    // this one, with the usual safety factor and limits
+                    const double factor = (error > 0.0
+                                           ?
+                                           0.9 * std::pow(error, -1./3.)
+                                           :
+                                           5.0);
+                    scratch.step_size[i] = h * std::max(0.2, std::min(5.0, factor));
+
+                    // Only the step size proposed after a rejected step
+                    // can become small, because step_length() never
+                    // leaves a small remainder at the end of the time step
+                    AssertThrow (error <= 1.0 || scratch.step_size[i] > 1e-12 * time_step,
+                                 ExcMessage("The adaptive reaction solver could not reach the requested "
+                                            "tolerance. The reaction rates are likely too stiff for an "
+                                            "explicit method, consider increasing the reaction solver "
+                                            "tolerances."));
+
+                    if (scratch.time[i] < time_step)
+                      scratch.active_points[n_still_active++] = i;
+                    else
+                      data.max_steps_per_point = std::max(data.max_steps_per_point, n_steps[i]);
                   }
+                scratch.active_points.resize(n_still_active);
               }
-        }
+          }
+
+          /**
+           * Compute the rate of change of the temperature and the
+           * compositions at the points scratch.active_points, if the
+           * temperature and the compositions at these points are given by
+           * @p values. Both @p values and @p rates store the values of all
+           * points of scratch.batch_points, the entries of the other points
+           * are not touched.
+           */
+          void
+          compute_rates (const MaterialModel::MaterialModelInputs<dim> &cell_inputs,
+                         const std::vector<double> &values,
+                         ScratchData<dim> &scratch,
+                         std::vector<double> &rates) const
+          {
+            const unsigned int n_points = scratch.active_points.size();
+            const unsigned int n_fields = introspection.n_compositional_fields;
+
+            if (scratch.batches.size() <= n_points)
+              scratch.batches.resize(n_points + 1);
+
+            if (!scratch.batches[n_points])
+              {
+                scratch.batches[n_points].reset(new PointBatch<dim>(n_points, n_fields));
+
+                // add reaction rate outputs, some heating models require
+                // additional outputs as well
+                material_model.create_additional_named_outputs(scratch.batches[n_points]->out);
+                heating_model_manager.create_additional_material_model_outputs(scratch.batches[n_points]->out);
+              }
+
+            PointBatch<dim> &batch = *scratch.batches[n_points];
+
+            for (unsigned int p=0; p<n_points; ++p)
+              {
+                const unsigned int i = scratch.active_points[p];
+                const unsigned int q = scratch.batch_points[i];
+                batch.in.position[p] = cell_inputs.position[q];
+                batch.in.temperature[p] = values[i*n_values];
+                batch.in.pressure[p] = cell_inputs.pressure[q];
+                batch.in.pressure_gradient[p] = cell_inputs.pressure_gradient[q];
+                batch.in.velocity[p] = cell_inputs.velocity[q];
+                for (unsigned int c=0; c<n_fields; ++c)
+                  batch.in.composition[p][c] = values[i*n_values+1+c];
+                batch.in.strain_rate[p] = cell_inputs.strain_rate[q];
+              }
+            batch.in.current_cell = cell_inputs.current_cell;
+
+            material_model.evaluate(batch.in, batch.out);
+            heating_model_manager.evaluate(batch.in, batch.out, batch.heating_model_outputs);
+
+            const MaterialModel::ReactionRateOutputs<dim> *reaction_rate_outputs
+              = batch.out.template get_additional_output<MaterialModel::ReactionRateOutputs<dim> >();
+
+            rates.resize(scratch.batch_points.size() * n_values);
+            for (unsigned int p=0; p<n_points; ++p)
+              {
+                const unsigned int i = scratch.active_points[p];
+                rates[i*n_values] = batch.heating_model_outputs.rates_of_temperature_change[p];
+                for (unsigned int c=0; c<n_fields; ++c)
+                  rates[i*n_values+1+c] = reaction_rate_outputs->reaction_rates[p][c];
+              }
+          }
+
+          /**
+           * Return the length of the next step of a point, given the step
+           * size proposed by the error control and the time remaining until
+           * the end of the reaction time step. If only a small remainder
+           * would be left after the proposed step, the step is stretched to
+           * the end of the time step instead of leaving a tiny last step
+           * caused by rounding.
+           */
+          static
+          double
+          step_length (const double proposed_step_size,
+                       const double remaining_time)
+          {
+            return (remaining_time - proposed_step_size < 0.01 * proposed_step_size
+                    ?
+                    remaining_time
+                    :
+                    proposed_step_size);
+          }
+
+          static
+          void
+          add_value (const types::global_dof_index dof_index,
+                     const double value,
+                     const double reaction,
+                     CopyData &data)
+          {
+            data.dof_indices.push_back(dof_index);
+            data.values.push_back(value);
+            data.reactions.push_back(reaction);
+          }
+
+          const MaterialModel::Interface<dim> &material_model;
+          const HeatingModel::Manager<dim>    &heating_model_manager;
+          const Introspection<dim>            &introspection;
+          const FiniteElement<dim>            &finite_element;
+          const LinearAlgebra::BlockVector    &solution;
+          const unsigned int                   n_reaction_steps;
+          const double                         reaction_time_step_size;
+          const bool                           adaptive;
+          const double                         relative_tolerance;
+          const double                         absolute_tolerance;
+          LinearAlgebra::BlockVector          &distributed_vector;
+          LinearAlgebra::BlockVector          &distributed_reaction_vector;
+
+          /**
+           * The number of support points of the composition (zero if there
+           * are no compositional fields) and the temperature element, the
+           * number of values (temperature and compositions) per support
+           * point, and whether the support points of both elements coincide.
+           */
+          const unsigned int n_points_C;
+          const unsigned int n_points_T;
+          const unsigned int n_values;
+          const bool         shared_support_points;
+
+          /**
+           * For every active cell, whether the reactions are computed at its
+           * composition support points, followed by the same information for
+           * its temperature support points.
+           */
+          std::vector<bool> selected_points;
+      };
+    }
+  }
+
+
+
+  template <int dim>
+  void Simulator<dim>::compute_reactions ()
+  {
+    // if the time step has a length of zero, there are no reactions
+    if (time_step == 0)
+      return;
+
+    // we need some temporary vectors to store our updates to composition and temperature in
+    // while we do the time stepping, before we copy them over to the solution vector in the end
+    LinearAlgebra::BlockVector distributed_vector (introspection.index_sets.system_partitioning,
+                                                   mpi_communicator);
+
+    LinearAlgebra::BlockVector distributed_reaction_vector (introspection.index_sets.system_partitioning,
+                                                            mpi_communicator);
+
+    // we use a different (potentially smaller) time step than in the advection scheme,
+    // and we want all of our reaction time steps (within one advection step) to have the same size.
+    // If the reactions are integrated adaptively, this is the initial step size of every support point
+    const unsigned int number_of_reaction_steps = std::max(static_cast<unsigned int>(time_step / parameters.reaction_time_step),
+                                                           std::max(parameters.reaction_steps_per_advection_step,1U));
+
+    const double reaction_time_step_size = time_step / static_cast<double>(number_of_reaction_steps);
+
+    Assert (reaction_time_step_size > 0,
+            ExcMessage("Reaction time step must be greater than 0."));
+
+    const bool adaptive_reaction_steps
+      = (parameters.reaction_solver_type == Parameters<dim>::ReactionSolverType::adaptive_runge_kutta);
+
+    if (!adaptive_reaction_steps)
+      pcout << "   Solving composition reactions in "
+            << number_of_reaction_steps
+            << " substep(s)."
+            << std::endl;
+
+    // make sure that the material model provides reaction rates
+    {
+      MaterialModel::MaterialModelOutputs<dim> out(1, introspection.n_compositional_fields);
+      material_model->create_additional_named_outputs(out);
+
+      AssertThrow(out.template get_additional_output<MaterialModel::ReactionRateOutputs<dim> >() != NULL,
+                  ExcMessage("You are trying to use the operator splitting solver scheme, "
+                             "but the material model you use does not support operator splitting "
+                             "(it does not create ReactionRateOutputs, which are required for this "
+                             "solver scheme)."));
+    }
+
+    // The reactions only depend on the temperature and composition values at a given
+    // degree of freedom (and are independent of the solution in other points). We
+    // therefore first assign every locally owned degree of freedom to one cell, and then
+    // loop over all cells in parallel and compute the reactions at the support points
+    // that were assigned to them. The results are written into distributed_vector and
+    // distributed_reaction_vector, and are only copied back onto the solution vector
+    // after the loop over all cells, so that all reactions start from the same solution.
+    internal::Reactions::ReactionSolver<dim>
+    reaction_solver (*material_model,
+                     heating_model_manager,
+                     introspection,
+                     dof_handler.get_fe(),
+                     solution,
+                     number_of_reaction_steps,
+                     reaction_time_step_size,
+                     adaptive_reaction_steps,
+                     parameters.reaction_solver_relative_tolerance,
+                     parameters.reaction_solver_absolute_tolerance,
+                     distributed_vector,
+                     distributed_reaction_vector);
+
+    reaction_solver.select_support_points(dof_handler);
+
+    // make one fevalues for the composition, and one for the temperature (they might use different finite elements)
+    const Quadrature<dim> quadrature_C(dof_handler.get_fe().base_element(introspection.base_elements.compositional_fields).get_unit_support_points());
+    const Quadrature<dim> quadrature_T(dof_handler.get_fe().base_element(introspection.base_elements.temperature).get_unit_support_points());
+
+    typedef FilteredIterator<typename DoFHandler<dim>::active_cell_iterator> CellFilter;
+
+    WorkStream::
+    run (CellFilter (IteratorFilters::LocallyOwnedCell(),
+                     dof_handler.begin_active()),
+         CellFilter (IteratorFilters::LocallyOwnedCell(),
+                     dof_handler.end()),
+         std_cxx11::bind (&internal::Reactions::ReactionSolver<dim>::local_compute_reactions,
+                          &reaction_solver,
+                          std_cxx11::_1,
+                          std_cxx11::_2,
+                          std_cxx11::_3),
+         std_cxx11::bind (&internal::Reactions::ReactionSolver<dim>::copy_local_to_global,
+                          &reaction_solver,
+                          std_cxx11::_1),
+         internal::Reactions::ScratchData<dim> (*mapping,
+                                                dof_handler.get_fe(),
+                                                quadrature_C,
+                                                quadrature_T,
+                                                introspection.n_compositional_fields),
+         internal::Reactions::CopyData());
+
+    if (adaptive_reaction_steps)
+      {
+        const types::global_dof_index n_accepted_steps
+          = Utilities::MPI::sum (reaction_solver.n_accepted_steps, mpi_communicator);
+        const types::global_dof_index n_rejected_steps
+          = Utilities::MPI::sum (reaction_solver.n_rejected_steps, mpi_communicator);
+        const unsigned int max_steps_per_point
+          = Utilities::MPI::max (reaction_solver.max_steps_per_point, mpi_communicator);
+
+        pcout << "   Solving composition reactions with adaptive substeps: "
+              << n_accepted_steps << " accepted and "
+              << n_rejected_steps << " rejected substep(s), at most "
+              << max_steps_per_point << " substep(s) per support point."
+              << std::endl;
+      }
 
     // put the final values into the solution vector
     for (unsigned int c=0; c<introspection.n_compositional_fields; ++c)
@@ -27,17 +27,149 @@
 
 #include <deal.II/base/quadrature_lib.h>
 #include <deal.II/base/function.h>
+#include <deal.II/base/work_stream.h>
 
 #include <deal.II/lac/full_matrix.h>
 #include <deal.II/lac/constraint_matrix.h>
 #include <deal.II/grid/tria_iterator.h>
 #include <deal.II/dofs/dof_accessor.h>
 #include <deal.II/fe/fe_values.h>
+#include <deal.II/grid/filtered_iterator.h>
 #include <deal.II/numerics/vector_tools.h>
 
 
 namespace aspect
 {
+  namespace internal
+  {
+    namespace ParticleInterpolation
+    {
+      /**
+       * Scratch data for the interpolation of particle properties onto the
+       * support points of one cell.
+       */
+      template <int dim>
+      struct ScratchData
+      {
+        ScratchData (const Mapping<dim>       &mapping,
+                     const FiniteElement<dim> &finite_element,
+                     const Quadrature<dim>    &support_points)
+          :
+          fe_values (mapping,
+                     finite_element,
+                     support_points,
+                     update_quadrature_points)
+        {}
+
+        ScratchData (const ScratchData &scratch)
+          :
+          fe_values (scratch.fe_values.get_mapping(),
+                     scratch.fe_values.get_fe(),
+                     scratch.fe_values.get_quadrature(),
+                     scratch.fe_values.get_update_flags())
+        {}
+
+        FEValues<dim> fe_values;
+      };
+
+      /**
+       * The interpolated property values of one cell, together with the
+       * indices of the degrees of freedom they belong to.
+       */
+      struct CopyData
+      {
+        std::vector<types::global_dof_index> local_dof_indices;
+        std::vector<double>                  values;
+      };
+
+      /**
+       * A class that interpolates particle properties onto the support
+       * points of the cells of one or several advection fields. All
+       * fields are interpolated with a single call to the particle
+       * interpolator per cell, so that the particles of every cell are
+       * only collected (and for least squares interpolators the system
+       * matrix is only built) once. The interpolation is done cell-wise
+       * through the WorkStream framework, the results are written into the
+       * global vector sequentially.
+       */
+      template <int dim>
+      class PropertyInterpolator
+      {
+        public:
+          PropertyInterpolator (const Particle::ParticleHandler<dim>       &particle_handler,
+                                const Particle::Interpolator::Interface<dim> &interpolator,
+                                const ComponentMask                        &property_mask,
+                                const std::vector<unsigned int>            &particle_properties,
+                                const FiniteElement<dim>                   &finite_element,
+                                const unsigned int                          base_element,
+                                const std::vector<unsigned int>            &component_indices,
+                                LinearAlgebra::BlockVector                 &particle_solution)
+            :
+            particle_handler (particle_handler),
+            interpolator (interpolator),
+            property_mask (property_mask),
+            particle_properties (particle_properties),
+            finite_element (finite_element),
+            base_element (base_element),
+            component_indices (component_indices),
+            particle_solution (particle_solution)
+          {}
+
+          void
+          local_interpolate (const typename DoFHandler<dim>::active_cell_iterator &cell,
+                             ScratchData<dim> &scratch,
+                             CopyData &data) const
+          {
+            scratch.fe_values.reinit (cell);
+
+            const std::vector<std::vector<double> > interpolated_properties =
+              interpolator.properties_at_points(particle_handler,
+                                                scratch.fe_values.get_quadrature_points(),
+                                                property_mask,
+                                                cell);
+
+            // go through the dofs of all fields and store their values
+            // interpolated from the particle field at these points
+            const unsigned int dofs_per_cell = finite_element.base_element(base_element).dofs_per_cell;
+            const unsigned int n_fields = component_indices.size();
+            std::vector<types::global_dof_index> cell_dof_indices (finite_element.dofs_per_cell);
+            cell->get_dof_indices (cell_dof_indices);
+
+            data.local_dof_indices.resize(n_fields * dofs_per_cell);
+            data.values.resize(n_fields * dofs_per_cell);
+
+            for (unsigned int field=0; field<n_fields; ++field)
+              for (unsigned int i=0; i<dofs_per_cell; ++i)
+                {
+                  const unsigned int system_local_dof
+                    = finite_element.component_to_system_index(component_indices[field],
+                                                               /*dof index within component=*/i);
+
+                  data.local_dof_indices[field*dofs_per_cell+i] = cell_dof_indices[system_local_dof];
+                  data.values[field*dofs_per_cell+i] = interpolated_properties[i][particle_properties[field]];
+                }
+          }
+
+          void
+          copy_local_to_global (const CopyData &data)
+          {
+            for (unsigned int i=0; i<data.local_dof_indices.size(); ++i)
+              particle_solution(data.local_dof_indices[i]) = data.values[i];
+          }
+
+        private:
+          const Particle::ParticleHandler<dim>         &particle_handler;
+          const Particle::Interpolator::Interface<dim> &interpolator;
+          const ComponentMask                          &property_mask;
+          const std::vector<unsigned int>              &particle_properties;
+          const FiniteElement<dim>                     &finite_element;
+          const unsigned int                            base_element;
+          const std::vector<unsigned int>              &component_indices;
+          LinearAlgebra::BlockVector                   &particle_solution;
+      };
+    }
+  }
+
 
   template <int dim>
   void Simulator<dim>::set_initial_temperature_and_compositional_fields ()
@@ -191,9 +323,13 @@ namespace aspect
 
 
   template <int dim>
-  void Simulator<dim>::interpolate_particle_properties (const AdvectionField &advection_field)
+  void Simulator<dim>::interpolate_particle_properties (const std::vector<unsigned int> &compositional_fields)
   {
+    if (compositional_fields.size() == 0)
+      return;
+
     TimerOutput::Scope timer (computing_timer, "Particles: Interpolate");
+    Timer interpolation_timer;
 
     // below, we would want to call VectorTools::interpolate on the
     // entire FESystem. there currently is no way to restrict the
@@ -209,7 +345,7 @@ namespace aspect
     //
     // to work around this problem, the following code is essentially
     // a (simplified) copy of the code in VectorTools::interpolate
-    // that only works on the given component
+    // that only works on the given components
 
     // create a fully distributed vector since we
     // need to write into it and we can not
@@ -221,87 +357,93 @@ namespace aspect
     const Particle::Interpolator::Interface<dim> *particle_interpolator = &particle_postprocessor.get_particle_world().get_interpolator();
     const Particle::Property::Manager<dim> *particle_property_manager = &particle_postprocessor.get_particle_world().get_property_manager();
 
-    unsigned int particle_property;
+    // determine the particle property and the solution component of
+    // every field
+    std::vector<unsigned int> particle_properties (compositional_fields.size());
+    std::vector<unsigned int> component_indices (compositional_fields.size());
+    ComponentMask property_mask  (particle_property_manager->get_data_info().n_components(),false);
 
-    if (parameters.mapped_particle_properties.size() != 0)
+    for (unsigned int i=0; i<compositional_fields.size(); ++i)
       {
-        const std::pair<std::string,unsigned int> particle_property_and_component = parameters.mapped_particle_properties.find(advection_field.compositional_variable)->second;
+        const AdvectionField advection_field = AdvectionField::composition(compositional_fields[i]);
 
-        particle_property = particle_property_manager->get_data_info().get_position_by_field_name(particle_property_and_component.first)
-                            + particle_property_and_component.second;
-      }
-    else
-      {
-        particle_property = std::count(introspection.compositional_field_methods.begin(),
-                                       introspection.compositional_field_methods.begin() + advection_field.compositional_variable,
-                                       Parameters<dim>::AdvectionFieldMethod::particles);
-        AssertThrow(particle_property <= particle_property_manager->get_data_info().n_components(),
-                    ExcMessage("Can not automatically match particle properties to fields, because there are"
-                               "more fields that are marked as particle advected than particle properties"));
+        particle_properties[i] = particle_postprocessor.get_particle_world()
+                                 .get_property_index_of_compositional_field(advection_field.compositional_variable);
+
+        component_indices[i] = advection_field.component_index(introspection);
+        property_mask.set(particle_properties[i],true);
       }
 
     LinearAlgebra::BlockVector particle_solution;
 
     particle_solution.reinit(system_rhs, false);
 
-    const unsigned int base_element = advection_field.base_element(introspection);
+    // all compositional fields share the same base element, and are
+    // therefore interpolated at the same support points
+    const unsigned int base_element = introspection.base_elements.compositional_fields;
 
-    // get the temperature/composition support points
+    // get the composition support points
     const std::vector<Point<dim> > support_points
       = finite_element.base_element(base_element).get_unit_support_points();
     Assert (support_points.size() != 0,
             ExcInternalError());
 
-    // create an FEValues object with just the temperature/composition element
-    FEValues<dim> fe_values (*mapping, finite_element,
-                             support_points,
-                             update_quadrature_points);
-
-    std::vector<types::global_dof_index> local_dof_indices (finite_element.dofs_per_cell);
-
-    for (typename DoFHandler<dim>::active_cell_iterator cell = dof_handler.begin_active();
-         cell != dof_handler.end(); ++cell)
-      if (cell->is_locally_owned())
-        {
-          fe_values.reinit (cell);
-          const std::vector<Point<dim> > quadrature_points = fe_values.get_quadrature_points();
-
-          ComponentMask property_mask  (particle_property_manager->get_data_info().n_components(),false);
-          property_mask.set(particle_property,true);
-
-          const std::vector<std::vector<double> > particle_properties =
-            particle_interpolator->properties_at_points(particle_postprocessor.get_particle_world().get_particle_handler(),
-                                                        quadrature_points,
-                                                        property_mask,
-                                                        cell);
-
-          // go through the composition dofs and set their global values
-          // to the particle field interpolated at these points
-          cell->get_dof_indices (local_dof_indices);
-          for (unsigned int i=0; i<finite_element.base_element(base_element).dofs_per_cell; ++i)
-            {
-              const unsigned int system_local_dof
-                = finite_element.component_to_system_index(advection_field.component_index(introspection),
-                                                           /*dof index within component=*/i);
-
-              particle_solution(local_dof_indices[system_local_dof]) = particle_properties[i][particle_property];
-            }
-        }
+    // interpolate the particle properties cell-wise in parallel, and
+    // write them into the global vector sequentially
+    internal::ParticleInterpolation::PropertyInterpolator<dim>
+    property_interpolator (particle_postprocessor.get_particle_world().get_particle_handler(),
+                           *particle_interpolator,
+                           property_mask,
+                           particle_properties,
+                           finite_element,
+                           base_element,
+                           component_indices,
+                           particle_solution);
+
+    typedef FilteredIterator<typename DoFHandler<dim>::active_cell_iterator> CellFilter;
+
+    WorkStream::
+    run (CellFilter (IteratorFilters::LocallyOwnedCell(),
+                     dof_handler.begin_active()),
+         CellFilter (IteratorFilters::LocallyOwnedCell(),
+                     dof_handler.end()),
+         std_cxx11::bind (&internal::ParticleInterpolation::PropertyInterpolator<dim>::local_interpolate,
+                          &property_interpolator,
+                          std_cxx11::_1,
+                          std_cxx11::_2,
+                          std_cxx11::_3),
+         std_cxx11::bind (&internal::ParticleInterpolation::PropertyInterpolator<dim>::copy_local_to_global,
+                          &property_interpolator,
+                          std_cxx11::_1),
+         internal::ParticleInterpolation::ScratchData<dim> (*mapping,
+                                                            finite_element,
+                                                            Quadrature<dim>(support_points)),
+         internal::ParticleInterpolation::CopyData());
 
     particle_solution.compress(VectorOperation::insert);
 
+    std::vector<bool> is_interpolated_block (particle_solution.n_blocks(),false);
+    for (unsigned int i=0; i<compositional_fields.size(); ++i)
+      is_interpolated_block[introspection.block_indices.compositional_fields[compositional_fields[i]]] = true;
+
     // we should not have written at all into any of the blocks with
-    // the exception of the current composition block
+    // the exception of the interpolated composition blocks
     for (unsigned int b=0; b<particle_solution.n_blocks(); ++b)
-      if (b != advection_field.block_index(introspection))
+      if (!is_interpolated_block[b])
         Assert (particle_solution.block(b).l2_norm() == 0,
                 ExcInternalError());
 
-    // overwrite the relevant composition block only
-    const unsigned int blockidx = advection_field.block_index(introspection);
-    solution.block(blockidx) = particle_solution.block(blockidx);
-    old_solution.block(blockidx) = particle_solution.block(blockidx);
-    old_old_solution.block(blockidx) = particle_solution.block(blockidx);
+    // overwrite the relevant composition blocks only
+    for (unsigned int i=0; i<compositional_fields.size(); ++i)
+      {
+        const unsigned int blockidx = introspection.block_indices.compositional_fields[compositional_fields[i]];
+        solution.block(blockidx) = particle_solution.block(blockidx);
+        old_solution.block(blockidx) = particle_solution.block(blockidx);
+        old_old_solution.block(blockidx) = particle_solution.block(blockidx);
+      }
+
+    // the interpolation is part of the particle work of this time step
+    particle_postprocessor.get_particle_world().add_external_particle_time(interpolation_timer.wall_time());
   }
 
 
@@ -462,7 +604,7 @@ namespace aspect
 #define INSTANTIATE(dim) \
   template void Simulator<dim>::set_initial_temperature_and_compositional_fields(); \
   template void Simulator<dim>::compute_initial_pressure_field(); \
-  template void Simulator<dim>::interpolate_particle_properties(const AdvectionField &);
+  template void Simulator<dim>::interpolate_particle_properties(const std::vector<unsigned int> &);
 
 
   ASPECT_INSTANTIATE(INSTANTIATE)
@@ -431,6 +431,39 @@ namespace aspect
                            "this criterion and the ``Reaction time step'', whichever yields the "
                            "smaller time step. "
                            "Units: none.");
+
+        prm.declare_entry ("Reaction solver type", "forward Euler",
+                           Patterns::Selection ("forward Euler|adaptive Runge-Kutta"),
+                           "The method used to integrate the reactions of the compositional fields "
+                           "and the temperature field in case operator splitting is used. "
+                           "``forward Euler'' uses the fixed number of reaction time steps "
+                           "determined by the ``Reaction time step'' and the ``Reaction time steps "
+                           "per advection step'' for every support point. ``adaptive Runge-Kutta'' "
+                           "uses the embedded third order Runge-Kutta method of Bogacki and Shampine, "
+                           "and chooses the step size for every support point separately, such "
+                           "that the estimated error of every step stays below the ``Reaction solver "
+                           "relative tolerance'' and the ``Reaction solver absolute tolerance''. The "
+                           "reaction time step computed from the other two parameters is then only "
+                           "used as the initial step size. This allows support points with slow "
+                           "reactions to take few large steps, while support points with fast "
+                           "reactions take as many small steps as necessary.");
+
+        prm.declare_entry ("Reaction solver relative tolerance", "1e-6",
+                           Patterns::Double (0),
+                           "The tolerance for the estimated error of every reaction step relative to "
+                           "the values of the temperature and the compositional fields, if the "
+                           "``Reaction solver type'' is ``adaptive Runge-Kutta''. "
+                           "Units: none.");
+
+        prm.declare_entry ("Reaction solver absolute tolerance", "1e-8",
+                           Patterns::Double (0),
+                           "The absolute tolerance for the estimated error of every reaction step, "
+                           "if the ``Reaction solver type'' is ``adaptive Runge-Kutta''. This "
+                           "tolerance is added to the relative tolerance, and determines the accuracy "
+                           "for fields whose values are close to zero. It therefore has to be "
+                           "strictly positive. "
+                           "Units: Kelvin for the temperature, the units of the compositional fields "
+                           "otherwise.");
       }
       prm.leave_subsection ();
     }
@@ -1042,6 +1075,20 @@ namespace aspect
         if (convert_to_years == true)
           reaction_time_step *= year_in_seconds;
         reaction_steps_per_advection_step = prm.get_integer ("Reaction time steps per advection step");
+
+        if (prm.get ("Reaction solver type") == "forward Euler")
+          reaction_solver_type = ReactionSolverType::forward_euler;
+        else if (prm.get ("Reaction solver type") == "adaptive Runge-Kutta")
+          reaction_solver_type = ReactionSolverType::adaptive_runge_kutta;
+        else
+          AssertThrow (false, ExcNotImplemented());
+
+        reaction_solver_relative_tolerance = prm.get_double ("Reaction solver relative tolerance");
+        reaction_solver_absolute_tolerance = prm.get_double ("Reaction solver absolute tolerance");
+        AssertThrow (reaction_solver_absolute_tolerance > 0,
+                     ExcMessage("The reaction solver absolute tolerance must be greater than 0, "
+                                "otherwise the error of fields with values of zero can never "
+                                "be controlled."));
       }
       prm.leave_subsection ();
     }
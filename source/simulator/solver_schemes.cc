@@ -170,6 +170,17 @@ namespace aspect
         Assert(initial_residual->size() == introspection.n_compositional_fields, ExcInternalError());
       }
 
+    // Interpolate all fields that are advected with particles in a single
+    // pass over the cells. They do not depend on the other fields, so do
+    // this first to make their new values available when solving for the
+    // remaining fields.
+    std::vector<unsigned int> particle_fields;
+    for (unsigned int c=0; c < introspection.n_compositional_fields; ++c)
+      if (AdvectionField::composition(c).advection_method(introspection) == Parameters<dim>::AdvectionFieldMethod::particles)
+        particle_fields.push_back(c);
+
+    interpolate_particle_properties(particle_fields);
+
     for (unsigned int c=0; c < introspection.n_compositional_fields; ++c)
       {
         const AdvectionField adv_field (AdvectionField::composition(c));
@@ -193,7 +204,7 @@ namespace aspect
             }
 
             case Parameters<dim>::AdvectionFieldMethod::particles:
-              interpolate_particle_properties(adv_field);
+              // already interpolated above
               break;
 
             case Parameters<dim>::AdvectionFieldMethod::static_field:
@@ -20,6 +20,7 @@
 #include <aspect/global.h>
 #include <aspect/utilities.h>
 #include <aspect/simulator_access.h>
+#include <aspect/simulator_signals.h>
 
 #include <deal.II/base/std_cxx11/array.h>
 #include <deal.II/base/point.h>
@@ -30,6 +31,10 @@
 #include <deal.II/base/function_lib.h>
 #include <deal.II/base/exceptions.h>
 #include <deal.II/base/signaling_nan.h>
+#include <deal.II/base/thread_management.h>
+#include <deal.II/base/multithread_info.h>
+#include <deal.II/grid/tria_iterator.h>
+#include <deal.II/grid/tria_accessor.h>
 
 #include <aspect/geometry_model/box.h>
 #include <aspect/geometry_model/spherical_shell.h>
@@ -37,13 +42,21 @@
 
 #include <fstream>
 #include <string>
+#include <map>
+#include <limits>
+#include <algorithm>
 #include <locale>
 #include <dirent.h>
 #include <sys/stat.h>
 #include <errno.h>
+#include <cstdlib>
+#include <cctype>
+#include <locale.h>
+#ifdef __APPLE__
+#include <xlocale.h>
+#endif
 
 #include <boost/math/special_functions/spherical_harmonic.hpp>
-#include <boost/lexical_cast.hpp>
 
 namespace aspect
 {
@@ -597,67 +610,344 @@ namespace aspect
 
 
 
+    namespace
+    {
+      /**
+       * The size of the pieces in which read_and_distribute_file_content()
+       * broadcasts a file. This needs to be small enough to be
+       * representable as the 'int' count argument of MPI_Bcast, and large
+       * enough that the latency of individual broadcasts does not matter.
+       */
+      const std::size_t file_content_chunk_size = 1ULL << 26;
+
+      /**
+       * A file size that signals that process 0 could not open or read
+       * the requested file.
+       */
+      const unsigned long long invalid_file_size = std::numeric_limits<unsigned long long>::max();
+    }
+
+
+
+    /**
+     * The content of a file that is read in the background by
+     * FilePrefetcher::prefetch().
+     */
+    struct FilePrefetcher::PrefetchedFile
+    {
+      std::string filename;
+      std::string content;
+      bool success;
+      Threads::Thread<void> thread;
+    };
+
+
+
+    void
+    FilePrefetcher::read_file_in_background (PrefetchedFile *file)
+    {
+      file->success = false;
+
+      std::ifstream filestream(file->filename.c_str(), std::ios::in | std::ios::binary);
+      if (!filestream)
+        return;
+
+      filestream.seekg(0, std::ios::end);
+      const std::streamoff end_position = filestream.tellg();
+      filestream.seekg(0, std::ios::beg);
+
+      if (!filestream || end_position < 0)
+        return;
+
+      file->content.resize(end_position);
+      if (end_position > 0)
+        filestream.read(&file->content[0], end_position);
+
+      if (filestream.gcount() != end_position)
+        {
+          std::string().swap(file->content);
+          return;
+        }
+
+      file->success = true;
+    }
+
+
+
+    FilePrefetcher::FilePrefetcher ()
+    {}
+
+
+
+    FilePrefetcher::~FilePrefetcher ()
+    {
+      clear();
+    }
+
+
+
+    void
+    FilePrefetcher::prefetch (const std::vector<std::string> &filenames,
+                              const MPI_Comm &comm)
+    {
+      if (Utilities::MPI::this_mpi_process(comm) != 0)
+        return;
+
+      // discard all files that are no longer needed
+      for (std::map<std::string, std_cxx11::shared_ptr<PrefetchedFile> >::iterator
+           file = files.begin(); file != files.end();)
+        if (std::find(filenames.begin(), filenames.end(), file->first) == filenames.end())
+          {
+            file->second->thread.join();
+            files.erase(file++);
+          }
+        else
+          ++file;
+
+      for (unsigned int i = 0; i < filenames.size(); ++i)
+        {
+          if (files.find(filenames[i]) != files.end()
+              || !fexists(filenames[i]))
+            continue;
+
+          std_cxx11::shared_ptr<PrefetchedFile> file (new PrefetchedFile());
+          file->filename = filenames[i];
+          file->success = false;
+          // A task would not necessarily start before it is joined, see
+          // read_and_distribute_file_content().
+          file->thread = Threads::new_thread (&read_file_in_background, file.get());
+
+          files.insert(std::make_pair(filenames[i], file));
+        }
+    }
+
+
+
+    bool
+    FilePrefetcher::take_content (const std::string &filename,
+                                  std::string &content)
+    {
+      const std::map<std::string, std_cxx11::shared_ptr<PrefetchedFile> >::iterator
+      prefetched_file = files.find(filename);
+
+      if (prefetched_file == files.end())
+        return false;
+
+      const std_cxx11::shared_ptr<PrefetchedFile> file = prefetched_file->second;
+      files.erase(prefetched_file);
+
+      file->thread.join();
+
+      if (file->success == false)
+        return false;
+
+      content.swap(file->content);
+      return true;
+    }
+
+
+
+    void
+    FilePrefetcher::clear ()
+    {
+      for (std::map<std::string, std_cxx11::shared_ptr<PrefetchedFile> >::iterator
+           file = files.begin(); file != files.end(); ++file)
+        file->second->thread.join();
+
+      files.clear();
+    }
+
+
+
+    namespace
+    {
+      /**
+       * Read @p size bytes from the current position of @p filestream into
+       * @p buffer, and set @p success to false if this was not possible.
+       * read_and_distribute_file_content() runs this function on a separate
+       * thread, so that reading the next piece of a file overlaps with
+       * broadcasting the previous one.
+       */
+      void
+      read_file_chunk (std::ifstream *filestream,
+                       char *buffer,
+                       const std::size_t size,
+                       bool *success)
+      {
+        filestream->read(buffer, size);
+        if (filestream->gcount() != static_cast<std::streamsize>(size))
+          *success = false;
+      }
+    }
+
+
+
     std::string
     read_and_distribute_file_content(const std::string &filename,
-                                     const MPI_Comm &comm)
+                                     const MPI_Comm &comm,
+                                     FilePrefetcher *prefetcher)
     {
       std::string data_string;
+      const bool is_root = (Utilities::MPI::this_mpi_process(comm) == 0);
 
-      if (Utilities::MPI::this_mpi_process(comm) == 0)
-        {
-          // set file size to an invalid size (signalling an error if we can not read it)
-          unsigned int filesize = numbers::invalid_unsigned_int;
+      // set file size to an invalid size (signalling an error if we can not read it)
+      unsigned long long filesize = invalid_file_size;
 
-          std::ifstream filestream(filename.c_str());
+      // whether process 0 already has the content of the file, because it
+      // was read in the background
+      bool content_is_prefetched = false;
 
-          if (!filestream)
+      std::ifstream filestream;
+
+      if (is_root)
+        {
+          // If reading in the background failed, just try again below
+          // to generate the usual error messages.
+          if (prefetcher != NULL
+              && prefetcher->take_content(filename, data_string))
             {
-              // broadcast failure state, then throw
-              MPI_Bcast(&filesize,1,MPI_UNSIGNED,0,comm);
-              AssertThrow (false,
-                           ExcMessage (std::string("Could not open file <") + filename + ">."));
-              return data_string; // never reached
+              filesize = data_string.size();
+              content_is_prefetched = true;
             }
 
-          // Read data from disk
-          std::stringstream datastream;
-          filestream >> datastream.rdbuf();
-
-          if (!filestream.eof())
+          if (!content_is_prefetched)
             {
-              // broadcast failure state, then throw
-              MPI_Bcast(&filesize,1,MPI_UNSIGNED,0,comm);
-              AssertThrow (false,
-                           ExcMessage (std::string("Reading of file ") + filename + " finished " +
-                                       "before the end of file was reached. Is the file corrupted or"
-                                       "too large for the input buffer?"));
-              return data_string; // never reached
+              filestream.open(filename.c_str(), std::ios::in | std::ios::binary);
+
+              if (filestream)
+                {
+                  // determine the size of the file without reading it, so that we
+                  // can allocate the output exactly once. The content itself is
+                  // read piece by piece below, while the previous piece is
+                  // broadcast.
+                  filestream.seekg(0, std::ios::end);
+                  const std::streamoff end_position = filestream.tellg();
+                  filestream.seekg(0, std::ios::beg);
+
+                  if (filestream && end_position >= 0)
+                    {
+                      data_string.resize(end_position);
+                      filesize = static_cast<unsigned long long>(end_position);
+                    }
+                }
             }
+        }
 
-          data_string = datastream.str();
-          filesize = data_string.size();
+      // Distribute the file size (or failure state) across processes
+      MPI_Bcast(&filesize,1,MPI_UNSIGNED_LONG_LONG,0,comm);
 
-          // Distribute data_size and data across processes
-          MPI_Bcast(&filesize,1,MPI_UNSIGNED,0,comm);
-          MPI_Bcast(&data_string[0],filesize,MPI_CHAR,0,comm);
+      if (filesize == invalid_file_size)
+        {
+          AssertThrow (!is_root,
+                       ExcMessage (std::string("Could not open or read file <") + filename + ">."));
+          throw QuietException();
         }
-      else
+
+      if (!is_root)
+        data_string.resize(filesize);
+
+      // Broadcast the content in pieces. This keeps the count argument of
+      // every MPI_Bcast call within the range of 'int' even for files larger
+      // than 2 GB. All processes know the total size, so no additional
+      // communication is necessary between the pieces. Unless the file was
+      // prefetched, process 0 reads the next piece on a separate thread
+      // while the current piece is broadcast, so that reading the file and
+      // distributing it overlap. We use a thread instead of a task, because
+      // ASPECT by default only uses one task thread per process, and a task
+      // might therefore not run before it is joined.
+      const bool read_pieces = (is_root && !content_is_prefetched);
+      bool read_success = true;
+      Threads::Thread<void> reader;
+
+      if (read_pieces && filesize > 0)
+        reader = Threads::new_thread (&read_file_chunk,
+                                      &filestream,
+                                      &data_string[0],
+                                      static_cast<std::size_t>(std::min<unsigned long long>(file_content_chunk_size,
+                                                               filesize)),
+                                      &read_success);
+
+      for (unsigned long long offset = 0; offset < filesize; offset += file_content_chunk_size)
         {
-          // Prepare for receiving data
-          unsigned int filesize;
-          MPI_Bcast(&filesize,1,MPI_UNSIGNED,0,comm);
-          if (filesize == numbers::invalid_unsigned_int)
-            throw QuietException();
+          const std::size_t chunk_size = std::min<unsigned long long>(file_content_chunk_size,
+                                                                      filesize - offset);
 
-          data_string.resize(filesize);
+          if (read_pieces)
+            {
+              reader.join();
+
+              const unsigned long long next_offset = offset + chunk_size;
+              if (next_offset < filesize && read_success)
+                reader = Threads::new_thread (&read_file_chunk,
+                                              &filestream,
+                                              &data_string[next_offset],
+                                              static_cast<std::size_t>(std::min<unsigned long long>(file_content_chunk_size,
+                                                                       filesize - next_offset)),
+                                              &read_success);
+            }
 
-          // Receive and store data
-          MPI_Bcast(&data_string[0],filesize,MPI_CHAR,0,comm);
+          MPI_Bcast(&data_string[offset],chunk_size,MPI_CHAR,0,comm);
+        }
+
+      // A read error can only be detected after the file size was sent,
+      // so tell all processes whether the content they received is valid.
+      int content_is_valid = (read_success ? 1 : 0);
+      MPI_Bcast(&content_is_valid,1,MPI_INT,0,comm);
+
+      if (content_is_valid == 0)
+        {
+          AssertThrow (!is_root,
+                       ExcMessage (std::string("Could not open or read file <") + filename + ">."));
+          throw QuietException();
         }
 
       return data_string;
     }
 
+    std::vector<int>
+    predict_next_data_file_numbers (const double next_time_since_start,
+                                    const double data_file_time_step,
+                                    const int first_data_file_number,
+                                    const int current_file_number,
+                                    const bool decreasing_file_order)
+    {
+      std::vector<int> file_numbers;
+
+      if (next_time_since_start < 0.0)
+        return file_numbers;
+
+      const int next_time_steps_since_start = static_cast<int> (next_time_since_start / data_file_time_step);
+
+      if (next_time_steps_since_start <= std::abs(current_file_number - first_data_file_number))
+        return file_numbers;
+
+      // The second of the two files that is currently loaded
+      const int loaded_file_number =
+        (decreasing_file_order) ?
+        current_file_number - 1
+        :
+        current_file_number + 1;
+
+      const int next_current_file_number =
+        (decreasing_file_order) ?
+        first_data_file_number - next_time_steps_since_start
+        :
+        first_data_file_number + next_time_steps_since_start;
+
+      const int next_file_number =
+        (decreasing_file_order) ?
+        next_current_file_number - 1
+        :
+        next_current_file_number + 1;
+
+      if (next_current_file_number != loaded_file_number)
+        file_numbers.push_back(next_current_file_number);
+
+      file_numbers.push_back(next_file_number);
+
+      return file_numbers;
+    }
+
     int
     mkdirp(std::string pathname,const mode_t mode)
     {
@@ -1169,6 +1459,229 @@ namespace aspect
       return (set_of_strings.size() == strings.size());
     }
 
+    namespace
+    {
+      /**
+       * Return a handle to the "C" locale, which is used to interpret
+       * numbers in data files independently of the locale (in particular
+       * the decimal separator) the user has set for the program. The
+       * locale is created the first time this function is called, which
+       * has to happen on the main thread.
+       */
+      locale_t
+      get_c_numeric_locale ()
+      {
+        static const locale_t c_locale = newlocale(LC_NUMERIC_MASK, "C", static_cast<locale_t>(0));
+        AssertThrow (c_locale != static_cast<locale_t>(0),
+                     ExcMessage ("Could not create the C locale to read data files."));
+        return c_locale;
+      }
+
+
+
+      /**
+       * Return whether @p word can be completely interpreted as a floating
+       * point number.
+       */
+      bool
+      is_floating_point_number (const std::string &word)
+      {
+        if (word.size() == 0 || std::isspace(static_cast<unsigned char>(word[0])))
+          return false;
+
+        const char *begin = word.c_str();
+        char *end;
+        strtod_l(begin, &end, get_c_numeric_locale());
+
+        return (end != begin && *end == '\0');
+      }
+
+
+
+      /**
+       * Parse all whitespace separated floating point numbers in the
+       * character range [@p begin, @p end) and append them to @p values.
+       * The range has to end in a whitespace character, or at the end of
+       * a null-terminated string, so that no number is split at @p end.
+       * Numbers are interpreted in the locale @p c_locale, which should be
+       * the one returned by get_c_numeric_locale().
+       * Returns false if a word in the range could not be interpreted as a
+       * floating point number, and true otherwise.
+       */
+      bool
+      parse_floating_point_numbers (const char *begin,
+                                    const char *end,
+                                    const locale_t c_locale,
+                                    std::vector<double> *values)
+      {
+        // A rough guess for the number of values in the range, to
+        // avoid most of the reallocations of the vector
+        values->reserve(values->size() + (end - begin) / 8);
+
+        const char *position = begin;
+        while (true)
+          {
+            while (position != end && std::isspace(static_cast<unsigned char>(*position)))
+              ++position;
+
+            if (position == end)
+              return true;
+
+            char *number_end;
+            const double value = strtod_l(position, &number_end, c_locale);
+
+            if (number_end == position || number_end > end
+                || (number_end != end && !std::isspace(static_cast<unsigned char>(*number_end))))
+              return false;
+
+            values->push_back(value);
+            position = number_end;
+          }
+      }
+
+
+
+      /**
+       * Return the value with the global index @p index in a list of values
+       * that is split into the vectors @p chunk_values, where the vector
+       * @p chunk_offsets contains the global index of the first value of
+       * each chunk, followed by the total number of values.
+       */
+      double
+      value_at_index (const std::vector<std::vector<double> > &chunk_values,
+                      const std::vector<std::size_t> &chunk_offsets,
+                      const std::size_t index)
+      {
+        Assert (index < chunk_offsets.back(), ExcIndexRange(index, 0, chunk_offsets.back()));
+
+        const std::size_t chunk = std::upper_bound(chunk_offsets.begin(),
+                                                   chunk_offsets.end(),
+                                                   index) - chunk_offsets.begin() - 1;
+        return chunk_values[chunk][index - chunk_offsets[chunk]];
+      }
+
+
+
+      /**
+       * Determine the range of points of a data file whose coordinates in
+       * each direction are given by @p file_coordinate_values that is
+       * stored to interpolate the data within @p region. These are all
+       * points within the region, plus the points next to it that are
+       * necessary to interpolate at the boundary of the region, plus one
+       * additional layer of points as a safety margin. The range is returned
+       * as the first point and the number of points in each direction.
+       */
+      template <int dim>
+      void
+      compute_stored_point_range (const std_cxx11::array<std::vector<double>,dim> &file_coordinate_values,
+                                  const std_cxx11::array<std::pair<double,double>,dim> &region,
+                                  TableIndices<dim> &first_point,
+                                  TableIndices<dim> &n_points)
+      {
+        for (unsigned int i = 0; i < dim; i++)
+          {
+            const std::vector<double> &coordinates = file_coordinate_values[i];
+            const unsigned int n_file_points = coordinates.size();
+
+            // the first point that is larger than the lower end of the region
+            const unsigned int first_point_above =
+              std::upper_bound(coordinates.begin(), coordinates.end(), region[i].first)
+              - coordinates.begin();
+
+            // the first point that is not smaller than the upper end of the region
+            const unsigned int first_point_not_below =
+              std::lower_bound(coordinates.begin(), coordinates.end(), region[i].second)
+              - coordinates.begin();
+
+            unsigned int begin = (first_point_above >= 2) ? first_point_above - 2 : 0;
+            unsigned int end = std::min(first_point_not_below + 1, n_file_points - 1);
+
+            // we need at least two points in every direction to interpolate
+            if (end <= begin && n_file_points > 1)
+              {
+                if (begin + 1 < n_file_points)
+                  end = begin + 1;
+                else
+                  begin = end - 1;
+              }
+
+            first_point[i] = begin;
+            n_points[i] = end - begin + 1;
+          }
+      }
+
+
+
+      /**
+       * Return the data of all points of a data file in the range given by
+       * @p first_point and @p n_points, multiplied by @p scale_factor.
+       * The values of the file are given by @p chunk_values and
+       * @p chunk_offsets as for value_at_index(), and the file contains
+       * @p table_points points in each direction, each with @p components
+       * data values. The returned vector contains the data of every point
+       * next to each other, and the points in the order of the file, i.e.
+       * with the first coordinate running fastest.
+       */
+      template <int dim>
+      std::vector<double>
+      extract_stored_values (const std::vector<std::vector<double> > &chunk_values,
+                             const std::vector<std::size_t> &chunk_offsets,
+                             const TableIndices<dim> &table_points,
+                             const unsigned int components,
+                             const TableIndices<dim> &first_point,
+                             const TableIndices<dim> &n_points,
+                             const double scale_factor)
+      {
+        std::size_t n_stored_points = 1;
+        for (unsigned int i = 0; i < dim; i++)
+          n_stored_points *= n_points[i];
+
+        std::vector<double> values;
+        values.reserve(n_stored_points * components);
+
+        for (std::size_t point = 0; point < n_stored_points; ++point)
+          {
+            // the index of this point in the file
+            std::size_t file_index = 0;
+            std::size_t file_stride = 1;
+            std::size_t remaining_index = point;
+            for (unsigned int i = 0; i < dim; i++)
+              {
+                file_index += (first_point[i] + remaining_index % n_points[i]) * file_stride;
+                remaining_index /= n_points[i];
+                file_stride *= table_points[i];
+              }
+
+            for (unsigned int c = 0; c < components; ++c)
+              values.push_back(scale_factor * value_at_index(chunk_values,
+                                                             chunk_offsets,
+                                                             file_index * (components+dim) + dim + c));
+          }
+
+        return values;
+      }
+
+
+
+      /**
+       * Send the string @p content from process 0 of @p comm to all other
+       * processes.
+       */
+      void
+      broadcast_string (std::string &content,
+                        const MPI_Comm &comm)
+      {
+        unsigned long long size = content.size();
+        MPI_Bcast(&size,1,MPI_UNSIGNED_LONG_LONG,0,comm);
+
+        content.resize(size);
+        if (size > 0)
+          MPI_Bcast(&content[0],size,MPI_CHAR,0,comm);
+      }
+    }
+
+
+
     template <int dim>
     AsciiDataLookup<dim>::AsciiDataLookup(const unsigned int components,
                                           const double scale_factor)
@@ -1234,8 +1747,26 @@ namespace aspect
     AsciiDataLookup<dim>::load_file(const std::string &filename,
                                     const MPI_Comm &comm)
     {
-      // Read data from disk and distribute among processes
-      std::stringstream in(read_and_distribute_file_content(filename, comm));
+      std_cxx11::array<std::pair<double,double>,dim> unbounded_region;
+      for (unsigned int i = 0; i < dim; i++)
+        unbounded_region[i] = std::make_pair(-std::numeric_limits<double>::max(),
+                                             std::numeric_limits<double>::max());
+
+      load_file(filename, comm, unbounded_region);
+    }
+
+
+
+    template <int dim>
+    void
+    AsciiDataLookup<dim>::parse_file_content(const std::string &content,
+                                             const std::string &filename,
+                                             std::vector<std::vector<double> > &chunk_values,
+                                             std::vector<std::size_t> &chunk_offsets,
+                                             std_cxx11::array<std::vector<double>,dim> &file_coordinate_values,
+                                             bool &equidistant_grid)
+    {
+      std::istringstream in(content);
 
       // Read header lines and table size
       while (in.peek() == '#')
@@ -1273,10 +1804,10 @@ namespace aspect
                                  "(e.g. a missing space character)."));
         }
 
-      // Read column lines if present
-      unsigned int field_index = 0;
+      // Read column lines if present. Remember where the first data
+      // entry starts, because the data itself is parsed separately below.
       unsigned int name_column_index = 0;
-      double temp_data;
+      std::size_t data_begin = content.size();
 
       while (true)
         {
@@ -1286,17 +1817,17 @@ namespace aspect
                                   "interpreted as floating point numbers. If you do want to read a data file with more "
                                   "than 100 columns, please remove this assertion."));
 
+          const std::streampos word_begin = in.tellg();
           std::string column_name_or_data;
           in >> column_name_or_data;
-          try
+          if (is_floating_point_number(column_name_or_data))
             {
-              // If the data field contains a name this will throw an exception
-              temp_data = boost::lexical_cast<double>(column_name_or_data);
-
-              // If there was no exception we have left the line containing names
-              // and have read the first data field. Save number of components, and
+              // If the word is a number we have left the line containing names
+              // and have found the first data field. Save number of components, and
               // make sure there is no contradiction if the components were already given to
               // the constructor of this class.
+              data_begin = static_cast<std::size_t>(word_begin);
+
               if (components == numbers::invalid_unsigned_int)
                 components = name_column_index - dim;
               else if (name_column_index != 0)
@@ -1309,8 +1840,12 @@ namespace aspect
 
               break;
             }
-          catch (const boost::bad_lexical_cast &e)
+          else
             {
+              AssertThrow (in,
+                           ExcMessage("The data file " + filename + " does not contain any data "
+                                      "after its header."));
+
               // The first dim columns are coordinates and contain no data
               if (name_column_index >= dim)
                 {
@@ -1330,37 +1865,54 @@ namespace aspect
             }
         }
 
-      /**
-       * Create table for the data. This peculiar reinit is necessary, because
-       * there is no constructor for Table, which takes TableIndices as
-       * argument.
-       */
-      data.resize(components);
-      maximum_component_value.resize(components,-std::numeric_limits<double>::max());
-      Table<dim,double> data_table;
-      data_table.TableBase<dim,double>::reinit(table_points);
-      std::vector<Table<dim,double> > data_tables(components+dim,data_table);
-
-
-      // Read data lines
-      do
+      // Parse the data lines. For large files this is the most expensive
+      // part of this function, therefore we split the data into chunks
+      // that start and end at line breaks, and parse each chunk in a
+      // separate task.
+      const std::size_t data_size = content.size() - data_begin;
+      const std::size_t min_chunk_size = 1 << 20;
+      const std::size_t n_chunks = std::max<std::size_t>(1,
+                                                         std::min<std::size_t>(MultithreadInfo::n_threads(),
+                                                             data_size / min_chunk_size));
+
+      std::vector<std::size_t> chunk_begins(n_chunks+1, content.size());
+      chunk_begins[0] = data_begin;
+      for (unsigned int c = 1; c < n_chunks; ++c)
         {
-          const unsigned int column_num = field_index%(components+dim);
-
-          if (column_num >= dim)
-            {
-              temp_data *= scale_factor;
-              maximum_component_value[column_num-dim] = std::max(maximum_component_value[column_num-dim], temp_data);
-            }
-
-          data_tables[column_num](compute_table_indices(field_index)) = temp_data;
-
-          ++field_index;
+          const std::size_t line_break = content.find('\n', std::max(chunk_begins[c-1],
+                                                                      data_begin + c * (data_size / n_chunks)));
+          chunk_begins[c] = (line_break == std::string::npos) ? content.size() : line_break + 1;
         }
-      while (in >> temp_data);
 
+      chunk_values.clear();
+      chunk_values.resize(n_chunks);
+      std::vector<Threads::Task<bool> > parse_tasks;
+      for (unsigned int c = 0; c < n_chunks; ++c)
+        parse_tasks.push_back(Threads::new_task (&parse_floating_point_numbers,
+                                                 content.c_str() + chunk_begins[c],
+                                                 content.c_str() + chunk_begins[c+1],
+                                                 get_c_numeric_locale(),
+                                                 &chunk_values[c]));
+
+      bool parsing_successful = true;
+      for (unsigned int c = 0; c < n_chunks; ++c)
+        parsing_successful &= parse_tasks[c].return_value();
+
+      AssertThrow(parsing_successful,
+                  ExcMessage ("The data file " + filename + " contains an entry that can not be "
+                              "interpreted as a floating point number after its header. "
+                              "File corrupted?"));
+
+      // The position of each chunk in the list of all values of the file
+      chunk_offsets.assign(n_chunks+1, 0);
+      for (unsigned int c = 0; c < n_chunks; ++c)
+        chunk_offsets[c+1] = chunk_offsets[c] + chunk_values[c].size();
+
+      std::size_t n_points = 1;
+      for (unsigned int i = 0; i < dim; i++)
+        n_points *= table_points[i];
 
-      AssertThrow(field_index == (components + dim) * data_table.n_elements(),
+      AssertThrow(chunk_offsets[n_chunks] == (components + dim) * n_points,
                   ExcMessage (std::string("Number of read in points does not match number of expected points. File corrupted?")));
 
       // In case the data is specified on a grid that is equidistant
@@ -1374,34 +1926,27 @@ namespace aspect
       // We also check the requirement that the coordinates are
       // strictly ascending.
 
-      // The number of intervals in each direction
-      std_cxx11::array<unsigned int,dim> table_intervals;
-
-      // Whether or not the grid is equidistant
-      bool equidistant_grid = true;
+      equidistant_grid = true;
 
+      std::size_t point_stride = 1;
       for (unsigned int i = 0; i < dim; i++)
         {
-          table_intervals[i] = table_points[i] - 1;
-
-          TableIndices<dim> idx;
-          double temp_coord = data_tables[i](idx);
-          double new_temp_coord = 0;
-
-          // The minimum coordinates
-          grid_extent[i].first = temp_coord;
-
-          // The first coordinate value
-          coordinate_values[i].push_back(temp_coord);
+          file_coordinate_values[i].resize(table_points[i]);
 
           // The grid spacing
           double grid_spacing = numbers::signaling_nan<double>();
 
-          // Loop over the rest of the coordinate points
-          for (unsigned int n = 1; n < table_points[i]; n++)
+          for (unsigned int n = 0; n < table_points[i]; n++)
             {
-              idx[i] = n;
-              new_temp_coord = data_tables[i](idx);
+              file_coordinate_values[i][n] = value_at_index(chunk_values,
+                                                            chunk_offsets,
+                                                            n * point_stride * (components+dim) + i);
+
+              if (n == 0)
+                continue;
+
+              const double temp_coord = file_coordinate_values[i][n-1];
+              const double new_temp_coord = file_coordinate_values[i][n];
               AssertThrow(new_temp_coord > temp_coord,
                           ExcMessage ("Coordinates in dimension "
                                       + int_to_string(i)
@@ -1418,17 +1963,292 @@ namespace aspect
                   if (std::abs(current_grid_spacing - grid_spacing) > 0.005*(current_grid_spacing+grid_spacing))
                     equidistant_grid = false;
                 }
+            }
+
+          point_stride *= table_points[i];
+        }
+
+      // The maximum component value is computed from all points in the
+      // file, so that it does not depend on the part of the file that is
+      // stored.
+      maximum_component_value.resize(components,-std::numeric_limits<double>::max());
+      std::size_t field_index = 0;
+      for (unsigned int c = 0; c < n_chunks; ++c)
+        for (std::vector<double>::const_iterator value = chunk_values[c].begin();
+             value != chunk_values[c].end(); ++value, ++field_index)
+          {
+            const unsigned int column_num = field_index%(components+dim);
+            if (column_num >= dim)
+              maximum_component_value[column_num-dim] = std::max(maximum_component_value[column_num-dim],
+                                                                 *value * scale_factor);
+          }
+    }
+
 
-              // Set the coordinate value
-              coordinate_values[i].push_back(new_temp_coord);
 
-              temp_coord = new_temp_coord;
+    template <int dim>
+    void
+    AsciiDataLookup<dim>::load_file(const std::string &filename,
+                                    const MPI_Comm &comm,
+                                    const std_cxx11::array<std::pair<double,double>,dim> &region,
+                                    FilePrefetcher *prefetcher)
+    {
+      const bool is_root = (Utilities::MPI::this_mpi_process(comm) == 0);
+      const unsigned int n_processes = Utilities::MPI::n_mpi_processes(comm);
+
+      // If any process only stores a part of the file, process 0 reads and
+      // parses the file alone, and sends every other process only the part
+      // it needs. This way, only process 0 ever holds the whole file.
+      // Otherwise the whole file is distributed to, and parsed on, all
+      // processes, which avoids sending the data twice.
+      unsigned int region_is_bounded = 0;
+      for (unsigned int i = 0; i < dim; i++)
+        if (region[i].first > -std::numeric_limits<double>::max()
+            || region[i].second < std::numeric_limits<double>::max())
+          region_is_bounded = 1;
+
+      const bool send_parts_from_root = (n_processes > 1
+                                         && Utilities::MPI::max(region_is_bounded, comm) == 1);
+
+      // The values of the file, and the coordinates of all of its points
+      // in each direction. These are only filled on processes that parse
+      // the file.
+      std::vector<std::vector<double> > chunk_values;
+      std::vector<std::size_t> chunk_offsets;
+      std_cxx11::array<std::vector<double>,dim> file_coordinate_values;
+      bool equidistant_grid = true;
+
+      // The range of points that is stored on this process, and their data
+      TableIndices<dim> first_point;
+      TableIndices<dim> local_table_points;
+      std::vector<double> stored_values;
+
+      if (send_parts_from_root == false)
+        {
+          // Read data from disk and distribute among processes
+          const std::string content = read_and_distribute_file_content(filename, comm, prefetcher);
+          parse_file_content(content, filename, chunk_values, chunk_offsets,
+                             file_coordinate_values, equidistant_grid);
+
+          compute_stored_point_range(file_coordinate_values, region,
+                                     first_point, local_table_points);
+          stored_values = extract_stored_values(chunk_values, chunk_offsets, table_points,
+                                                components, first_point, local_table_points,
+                                                scale_factor);
+
+          for (unsigned int i = 0; i < dim; i++)
+            {
+              coordinate_values[i].assign(file_coordinate_values[i].begin() + first_point[i],
+                                          file_coordinate_values[i].begin() + first_point[i] + local_table_points[i]);
+              file_grid_extent[i] = std::make_pair(file_coordinate_values[i].front(),
+                                                   file_coordinate_values[i].back());
+            }
+        }
+      else
+        {
+          // Collect the regions of all processes on process 0
+          std::vector<double> local_region(2*dim);
+          for (unsigned int i = 0; i < dim; i++)
+            {
+              local_region[2*i] = region[i].first;
+              local_region[2*i+1] = region[i].second;
             }
 
-          // The maximum coordinate
-          grid_extent[i].second = temp_coord;
+          std::vector<double> all_regions(is_root ? 2*dim*n_processes : 1);
+          MPI_Gather(&local_region[0], 2*dim, MPI_DOUBLE,
+                     &all_regions[0], 2*dim, MPI_DOUBLE,
+                     0, comm);
+
+          // Process 0 reads and parses the file. If this fails, it has to
+          // tell the other processes before it throws the exception, so that
+          // they do not wait for their data.
+          unsigned int parsing_failed = 0;
+          if (is_root)
+            {
+              try
+                {
+                  const std::string content = read_and_distribute_file_content(filename,
+                                                                               MPI_COMM_SELF,
+                                                                               prefetcher);
+                  parse_file_content(content, filename, chunk_values, chunk_offsets,
+                                     file_coordinate_values, equidistant_grid);
+                }
+              catch (...)
+                {
+                  parsing_failed = 1;
+                  MPI_Bcast(&parsing_failed,1,MPI_UNSIGNED,0,comm);
+                  throw;
+                }
+            }
+
+          MPI_Bcast(&parsing_failed,1,MPI_UNSIGNED,0,comm);
+          if (parsing_failed == 1)
+            throw QuietException();
+
+          // Distribute the information about the whole file that every
+          // process needs: the number of points and components, whether the
+          // grid is equidistant, the extent of the grid, the maximum
+          // component values, and the column names.
+          std::vector<unsigned int> file_information(dim+2);
+          if (is_root)
+            {
+              for (unsigned int i = 0; i < dim; i++)
+                file_information[i] = table_points[i];
+              file_information[dim] = components;
+              file_information[dim+1] = (equidistant_grid ? 1 : 0);
+            }
+          MPI_Bcast(&file_information[0],dim+2,MPI_UNSIGNED,0,comm);
+
+          for (unsigned int i = 0; i < dim; i++)
+            table_points[i] = file_information[i];
+          components = file_information[dim];
+          equidistant_grid = (file_information[dim+1] == 1);
+
+          std::vector<double> file_values(2*dim+components);
+          if (is_root)
+            {
+              for (unsigned int i = 0; i < dim; i++)
+                {
+                  file_values[2*i] = file_coordinate_values[i].front();
+                  file_values[2*i+1] = file_coordinate_values[i].back();
+                }
+              for (unsigned int c = 0; c < components; c++)
+                file_values[2*dim+c] = maximum_component_value[c];
+            }
+          MPI_Bcast(&file_values[0],2*dim+components,MPI_DOUBLE,0,comm);
+
+          for (unsigned int i = 0; i < dim; i++)
+            file_grid_extent[i] = std::make_pair(file_values[2*i], file_values[2*i+1]);
+          maximum_component_value.assign(file_values.begin() + 2*dim, file_values.end());
+
+          // The column names do not contain whitespace, because they are
+          // read word by word
+          std::string column_names;
+          for (unsigned int c = 0; c < data_component_names.size(); ++c)
+            column_names += data_component_names[c] + " ";
+          broadcast_string(column_names, comm);
+
+          data_component_names.clear();
+          std::istringstream column_name_stream(column_names);
+          std::string column_name;
+          while (column_name_stream >> column_name)
+            data_component_names.push_back(column_name);
+
+          // Now send every process the number of points it stores in each
+          // direction, their coordinates, and their data
+          const int tag = 2729;
+          if (is_root)
+            {
+              for (unsigned int process = 0; process < n_processes; ++process)
+                {
+                  std_cxx11::array<std::pair<double,double>,dim> process_region;
+                  for (unsigned int i = 0; i < dim; i++)
+                    process_region[i] = std::make_pair(all_regions[2*dim*process + 2*i],
+                                                       all_regions[2*dim*process + 2*i + 1]);
+
+                  TableIndices<dim> process_first_point;
+                  TableIndices<dim> process_table_points;
+                  compute_stored_point_range(file_coordinate_values, process_region,
+                                             process_first_point, process_table_points);
+
+                  std::vector<double> values = extract_stored_values(chunk_values, chunk_offsets, table_points,
+                                                                     components, process_first_point,
+                                                                     process_table_points, scale_factor);
+
+                  if (process == 0)
+                    {
+                      first_point = process_first_point;
+                      local_table_points = process_table_points;
+                      stored_values.swap(values);
+
+                      for (unsigned int i = 0; i < dim; i++)
+                        coordinate_values[i].assign(file_coordinate_values[i].begin() + first_point[i],
+                                                    file_coordinate_values[i].begin() + first_point[i] + local_table_points[i]);
+                      continue;
+                    }
+
+                  std::vector<double> message;
+                  for (unsigned int i = 0; i < dim; i++)
+                    message.push_back(process_table_points[i]);
+                  for (unsigned int i = 0; i < dim; i++)
+                    message.insert(message.end(),
+                                   file_coordinate_values[i].begin() + process_first_point[i],
+                                   file_coordinate_values[i].begin() + process_first_point[i] + process_table_points[i]);
+                  message.insert(message.end(), values.begin(), values.end());
+
+                  unsigned long long message_size = message.size();
+                  MPI_Send(&message_size,1,MPI_UNSIGNED_LONG_LONG,process,tag,comm);
+                  MPI_Send(&message[0],static_cast<int>(message_size),MPI_DOUBLE,process,tag,comm);
+                }
+            }
+          else
+            {
+              unsigned long long message_size = 0;
+              MPI_Recv(&message_size,1,MPI_UNSIGNED_LONG_LONG,0,tag,comm,MPI_STATUS_IGNORE);
+              std::vector<double> message(message_size);
+              MPI_Recv(&message[0],static_cast<int>(message_size),MPI_DOUBLE,0,tag,comm,MPI_STATUS_IGNORE);
+
+              std::size_t position = 0;
+              for (unsigned int i = 0; i < dim; i++)
+                local_table_points[i] = static_cast<unsigned int>(message[position++]);
+              for (unsigned int i = 0; i < dim; i++)
+                {
+                  coordinate_values[i].assign(message.begin() + position,
+                                              message.begin() + position + local_table_points[i]);
+                  position += local_table_points[i];
+                }
+              stored_values.assign(message.begin() + position, message.end());
+            }
+        }
+
+      // free the memory of the values of the whole file as soon as possible
+      std::vector<std::vector<double> >().swap(chunk_values);
+
+      for (unsigned int i = 0; i < dim; i++)
+        grid_extent[i] = std::make_pair(coordinate_values[i].front(),
+                                        coordinate_values[i].back());
+
+      /**
+       * Create table for the data. This peculiar reinit is necessary, because
+       * there is no constructor for Table, which takes TableIndices as
+       * argument.
+       */
+      data.resize(components);
+      Table<dim,double> data_table;
+      data_table.TableBase<dim,double>::reinit(local_table_points);
+      std::vector<Table<dim,double> > data_tables(components,data_table);
+
+      // Now sort the stored data into the tables. The points are stored
+      // in the order of the file, i.e. with the first coordinate
+      // running fastest.
+      std::size_t n_stored_points = 1;
+      for (unsigned int i = 0; i < dim; i++)
+        n_stored_points *= local_table_points[i];
+
+      Assert (stored_values.size() == n_stored_points * components,
+              ExcInternalError());
+
+      for (std::size_t point = 0; point < n_stored_points; ++point)
+        {
+          TableIndices<dim> idx;
+          std::size_t remaining_index = point;
+          for (unsigned int i = 0; i < dim; i++)
+            {
+              idx[i] = remaining_index % local_table_points[i];
+              remaining_index /= local_table_points[i];
+            }
+
+          for (unsigned int c = 0; c < components; ++c)
+            data_tables[c](idx) = stored_values[point * components + c];
         }
 
+      std::vector<double>().swap(stored_values);
+
+      // The number of intervals in each direction
+      std_cxx11::array<unsigned int,dim> table_intervals;
+      for (unsigned int i = 0; i < dim; i++)
+        table_intervals[i] = local_table_points[i] - 1;
+
       // For each data component, set up a GridData,
       // its type depending on the read-in grid.
       for (unsigned int i = 0; i < components; i++)
@@ -1439,15 +2259,32 @@ namespace aspect
           if (equidistant_grid)
             data[i] = new Functions::InterpolatedUniformGridData<dim> (grid_extent,
                                                                        table_intervals,
-                                                                       data_tables[dim+i]);
+                                                                       data_tables[i]);
           else
             {
-              if (Utilities::MPI::this_mpi_process(comm) == 0)
+              if (Utilities::MPI::this_mpi_process(comm) == 0 && i == 0)
                 std::cout << "   Ascii data file coordinates are not equidistant. " << std::endl << std::endl;
               data[i] = new Functions::InterpolatedTensorProductGridData<dim> (coordinate_values,
-                                                                               data_tables[dim+i]);
+                                                                               data_tables[i]);
             }
         }
+
+      loaded_filename = filename;
+    }
+
+
+
+    template <int dim>
+    void
+    AsciiDataLookup<dim>::reload_file(const MPI_Comm &comm,
+                                      const std_cxx11::array<std::pair<double,double>,dim> &region)
+    {
+      if (loaded_filename.size() > 0)
+        {
+          // copy the name, because load_file() modifies the member variable
+          const std::string filename = loaded_filename;
+          load_file(filename, comm, region);
+        }
     }
 
 
@@ -1456,6 +2293,25 @@ namespace aspect
     AsciiDataLookup<dim>::get_data(const Point<dim> &position,
                                    const unsigned int component) const
     {
+      AssertThrow(component < data.size() && data[component] != NULL,
+                  ExcMessage("The data of an ascii data file was requested before "
+                             "the file was loaded."));
+
+      // If only a part of the file is stored, requesting data outside of
+      // it would silently return the data at the nearest stored point,
+      // which is not the data of the file at this position. Outside of
+      // the whole file, we keep returning the data at the nearest point.
+      for (unsigned int i = 0; i < dim; i++)
+        AssertThrow(!((position[i] < grid_extent[i].first && grid_extent[i].first > file_grid_extent[i].first)
+                      ||
+                      (position[i] > grid_extent[i].second && grid_extent[i].second < file_grid_extent[i].second)),
+                    ExcMessage("The data of the ascii data file <" + loaded_filename + "> was "
+                               "requested at a position outside of the part of the file that "
+                               "is stored on this process. This happens if the data is only "
+                               "stored for the local subdomain, but a plugin evaluates it "
+                               "outside of the cells of this process. Please set the "
+                               "parameter 'Restrict data to local subdomain' to false."));
+
       return data[component]->value(position);
     }
 
@@ -1538,6 +2394,141 @@ namespace aspect
       prm.leave_subsection();
     }
 
+    namespace
+    {
+      /**
+       * Compute the region that is covered by the locally owned and ghost
+       * cells of the current process, in the coordinates in which ascii
+       * data files are provided for the current geometry model (i.e.
+       * Cartesian coordinates for box models and spherical coordinates
+       * for spherical shells and chunks). The region is slightly enlarged
+       * to account for curved cell boundaries and mesh deformation.
+       * If the process does not have any cells, the returned region is
+       * empty, i.e. its minimum is larger than its maximum.
+       */
+      template <int dim>
+      std_cxx11::array<std::pair<double,double>,dim>
+      compute_local_data_region (const SimulatorAccess<dim> &simulator_access)
+      {
+        const bool spherical_coordinates =
+          (dynamic_cast<const GeometryModel::SphericalShell<dim>*> (&simulator_access.get_geometry_model()) != 0
+           || dynamic_cast<const GeometryModel::Chunk<dim>*> (&simulator_access.get_geometry_model()) != 0);
+
+        std_cxx11::array<std::pair<double,double>,dim> region;
+        for (unsigned int d = 0; d < dim; ++d)
+          region[d] = std::make_pair(std::numeric_limits<double>::max(),
+                                     -std::numeric_limits<double>::max());
+
+        const parallel::distributed::Triangulation<dim> &triangulation = simulator_access.get_triangulation();
+
+        // The mesh is not yet created when plugins are initialized
+        if (triangulation.n_levels() == 0)
+          return region;
+
+        for (typename Triangulation<dim>::active_cell_iterator
+             cell = triangulation.begin_active();
+             cell != triangulation.end(); ++cell)
+          if (!cell->is_artificial())
+            {
+              std_cxx11::array<std::pair<double,double>,dim> cell_region;
+              for (unsigned int d = 0; d < dim; ++d)
+                cell_region[d] = std::make_pair(std::numeric_limits<double>::max(),
+                                                -std::numeric_limits<double>::max());
+
+              bool cell_touches_axis = false;
+
+              for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell; ++v)
+                {
+                  const Point<dim> vertex = cell->vertex(v);
+                  std_cxx11::array<double,dim> coordinates;
+
+                  if (spherical_coordinates)
+                    {
+                      coordinates = Utilities::Coordinates::cartesian_to_spherical_coordinates(vertex);
+
+                      if (dim == 3 && vertex[0] * vertex[0] + vertex[1] * vertex[1] <= 1e-20 * vertex.norm_square())
+                        cell_touches_axis = true;
+                    }
+                  else
+                    for (unsigned int d = 0; d < dim; ++d)
+                      coordinates[d] = vertex[d];
+
+                  for (unsigned int d = 0; d < dim; ++d)
+                    {
+                      cell_region[d].first = std::min(cell_region[d].first, coordinates[d]);
+                      cell_region[d].second = std::max(cell_region[d].second, coordinates[d]);
+                    }
+                }
+
+              // Cells that touch the polar axis, or that cross the periodic
+              // boundary of the azimuth angle, can contain points with any
+              // azimuth angle.
+              if (spherical_coordinates
+                  && (cell_touches_axis || cell_region[1].second - cell_region[1].first > numbers::PI))
+                cell_region[1] = std::make_pair(0.0, 2.0 * numbers::PI);
+
+              for (unsigned int d = 0; d < dim; ++d)
+                {
+                  const double margin = 0.1 * (cell_region[d].second - cell_region[d].first);
+                  region[d].first = std::min(region[d].first, cell_region[d].first - margin);
+                  region[d].second = std::max(region[d].second, cell_region[d].second + margin);
+                }
+            }
+
+        return region;
+      }
+
+
+
+      /**
+       * Enlarge @p region, given in the same coordinates as in
+       * compute_local_data_region(), such that it contains the line from
+       * the representative point of the geometry model at the surface to
+       * the one at the maximal depth. Reference profiles like the adiabatic
+       * conditions are computed along this line on all processes, before
+       * the mesh is created and possibly outside of the cells of the
+       * current process.
+       */
+      template <int dim>
+      void
+      add_reference_profile_to_region (const SimulatorAccess<dim> &simulator_access,
+                                       std_cxx11::array<std::pair<double,double>,dim> &region)
+      {
+        const GeometryModel::Interface<dim> &geometry_model = simulator_access.get_geometry_model();
+        const bool spherical_coordinates =
+          (dynamic_cast<const GeometryModel::SphericalShell<dim>*> (&geometry_model) != 0
+           || dynamic_cast<const GeometryModel::Chunk<dim>*> (&geometry_model) != 0);
+
+        const Point<dim> end_points[2] = {geometry_model.representative_point(0.0),
+                                          geometry_model.representative_point(geometry_model.maximal_depth())
+                                         };
+
+        for (unsigned int p = 0; p < 2; ++p)
+          {
+            std_cxx11::array<double,dim> coordinates;
+            if (spherical_coordinates)
+              coordinates = Utilities::Coordinates::cartesian_to_spherical_coordinates(end_points[p]);
+            else
+              for (unsigned int d = 0; d < dim; ++d)
+                coordinates[d] = end_points[p][d];
+
+            for (unsigned int d = 0; d < dim; ++d)
+              {
+                region[d].first = std::min(region[d].first, coordinates[d]);
+                region[d].second = std::max(region[d].second, coordinates[d]);
+              }
+
+            // The azimuth angle is not defined on the polar axis
+            if (spherical_coordinates && dim == 3
+                && end_points[p][0] * end_points[p][0] + end_points[p][1] * end_points[p][1]
+                <= 1e-20 * end_points[p].norm_square())
+              region[1] = std::make_pair(0.0, 2.0 * numbers::PI);
+          }
+      }
+    }
+
+
+
     template <int dim>
     AsciiDataBoundary<dim>::AsciiDataBoundary ()
       :
@@ -1549,7 +2540,8 @@ namespace aspect
       time_weight(0.0),
       time_dependent(true),
       lookups(),
-      old_lookups()
+      old_lookups(),
+      restrict_to_local_subdomain(false)
     {}
 
     template <int dim>
@@ -1563,6 +2555,12 @@ namespace aspect
                    ExcMessage ("This ascii data plugin can only be used when using "
                                "a spherical shell, chunk or box geometry."));
 
+      // The mesh does not exist yet, therefore the files are only loaded
+      // for an empty region here, and loaded again every time the mesh is set
+      // up or changed.
+      if (restrict_to_local_subdomain)
+        this->get_signals().edit_parameters_pre_setup_dofs.connect(std_cxx11::bind(&AsciiDataBoundary<dim>::reload_data_for_local_subdomain,
+                                                                                   std_cxx11::ref(*this)));
 
       for (typename std::set<types::boundary_id>::const_iterator
            boundary_id = boundary_ids.begin();
@@ -1593,7 +2591,7 @@ namespace aspect
                             << filename << "." << std::endl << std::endl;
 
           if (Utilities::fexists(filename))
-            lookups.find(*boundary_id)->second->load_file(filename,this->get_mpi_communicator());
+            lookups.find(*boundary_id)->second->load_file(filename,this->get_mpi_communicator(),get_local_data_region(*boundary_id));
           else
             AssertThrow(false,
                         ExcMessage (std::string("Ascii data file <")
@@ -1618,7 +2616,7 @@ namespace aspect
               if (Utilities::fexists(filename))
                 {
                   lookups.find(*boundary_id)->second.swap(old_lookups.find(*boundary_id)->second);
-                  lookups.find(*boundary_id)->second->load_file(filename,this->get_mpi_communicator());
+                  lookups.find(*boundary_id)->second->load_file(filename,this->get_mpi_communicator(),get_local_data_region(*boundary_id));
                 }
               else
                 end_time_dependence ();
@@ -1807,6 +2805,32 @@ namespace aspect
                   ExcMessage (
                     "Error in set_current_time. Time_weight has to be in [0,1]"));
         }
+
+      if (time_dependent)
+        prefetch_data_files();
+    }
+
+
+    template <int dim>
+    void
+    AsciiDataBoundary<dim>::prefetch_data_files ()
+    {
+      const std::vector<int> file_numbers =
+        predict_next_data_file_numbers (this->get_time() + this->get_timestep() - first_data_file_model_time,
+                                        data_file_time_step,
+                                        first_data_file_number,
+                                        current_file_number,
+                                        decreasing_file_order);
+
+      std::vector<std::string> filenames;
+      for (typename std::map<types::boundary_id,
+           std_cxx11::shared_ptr<Utilities::AsciiDataLookup<dim-1> > >::const_iterator
+           boundary_id = lookups.begin();
+           boundary_id != lookups.end(); ++boundary_id)
+        for (unsigned int i = 0; i < file_numbers.size(); ++i)
+          filenames.push_back(create_filename (file_numbers[i], boundary_id->first));
+
+      file_prefetcher.prefetch(filenames, this->get_mpi_communicator());
     }
 
     template <int dim>
@@ -1825,7 +2849,8 @@ namespace aspect
           if (Utilities::fexists(filename))
             {
               lookups.find(boundary_id)->second.swap(old_lookups.find(boundary_id)->second);
-              lookups.find(boundary_id)->second->load_file(filename,this->get_mpi_communicator());
+              lookups.find(boundary_id)->second->load_file(filename,this->get_mpi_communicator(),get_local_data_region(boundary_id),
+                                                           &file_prefetcher);
             }
 
           // If loading current_time_step failed, end time dependent part with old_file_number.
@@ -1846,7 +2871,8 @@ namespace aspect
       if (Utilities::fexists(filename))
         {
           lookups.find(boundary_id)->second.swap(old_lookups.find(boundary_id)->second);
-          lookups.find(boundary_id)->second->load_file(filename,this->get_mpi_communicator());
+          lookups.find(boundary_id)->second->load_file(filename,this->get_mpi_communicator(),get_local_data_region(boundary_id),
+                                                       &file_prefetcher);
         }
 
       // If next file does not exist, end time dependent part with current_time_step.
@@ -1868,6 +2894,48 @@ namespace aspect
                         << std::endl << std::endl;
     }
 
+    template <int dim>
+    std_cxx11::array<std::pair<double,double>,dim-1>
+    AsciiDataBoundary<dim>::get_local_data_region (const types::boundary_id boundary_id) const
+    {
+      std_cxx11::array<std::pair<double,double>,dim-1> boundary_region;
+
+      if (restrict_to_local_subdomain)
+        {
+          const std_cxx11::array<std::pair<double,double>,dim> region =
+            compute_local_data_region(*this);
+
+          const std_cxx11::array<unsigned int,dim-1> boundary_dimensions =
+            get_boundary_dimensions(boundary_id);
+
+          for (unsigned int i = 0; i < dim-1; i++)
+            boundary_region[i] = region[boundary_dimensions[i]];
+        }
+      else
+        for (unsigned int i = 0; i < dim-1; i++)
+          boundary_region[i] = std::make_pair(-std::numeric_limits<double>::max(),
+                                              std::numeric_limits<double>::max());
+
+      return boundary_region;
+    }
+
+    template <int dim>
+    void
+    AsciiDataBoundary<dim>::reload_data_for_local_subdomain ()
+    {
+      for (typename std::map<types::boundary_id,
+           std_cxx11::shared_ptr<Utilities::AsciiDataLookup<dim-1> > >::iterator
+           boundary_id = lookups.begin();
+           boundary_id != lookups.end(); ++boundary_id)
+        {
+          const std_cxx11::array<std::pair<double,double>,dim-1> region =
+            get_local_data_region(boundary_id->first);
+
+          boundary_id->second->reload_file(this->get_mpi_communicator(), region);
+          old_lookups.find(boundary_id->first)->second->reload_file(this->get_mpi_communicator(), region);
+        }
+    }
+
     template <int dim>
     double
     AsciiDataBoundary<dim>::
@@ -1954,6 +3022,14 @@ namespace aspect
                            "'True' the plugin will first load the file with the number "
                            "'First velocity file number' and decrease the file number during "
                            "the model run.");
+        prm.declare_entry ("Restrict data to local subdomain", "false",
+                           Patterns::Bool (),
+                           "If set to true, every process only stores the part of the data "
+                           "files that is needed to evaluate the data on its own and its ghost "
+                           "cells, instead of the whole file. This reduces the memory "
+                           "requirements for large data files in parallel computations. "
+                           "The stored part of the data is updated whenever the mesh "
+                           "changes.");
       }
       prm.leave_subsection();
     }
@@ -1971,6 +3047,7 @@ namespace aspect
         first_data_file_model_time      = prm.get_double ("First data file model time");
         first_data_file_number          = prm.get_double ("First data file number");
         decreasing_file_order           = prm.get_bool   ("Decreasing file order");
+        restrict_to_local_subdomain     = prm.get_bool   ("Restrict data to local subdomain");
 
         if (this->convert_output_to_years() == true)
           {
@@ -1983,6 +3060,8 @@ namespace aspect
 
     template <int dim>
     AsciiDataInitial<dim>::AsciiDataInitial ()
+      :
+      restrict_to_local_subdomain(false)
     {}
 
 
@@ -2002,18 +3081,55 @@ namespace aspect
       const std::string filename = Utilities::AsciiDataBase<dim>::data_directory
                                    + Utilities::AsciiDataBase<dim>::data_file_name;
 
+      AssertThrow(Utilities::fexists(filename),
+                  ExcMessage (std::string("Ascii data file <")
+                              +
+                              filename
+                              +
+                              "> not found!"));
+
+      if (restrict_to_local_subdomain)
+        {
+          this->get_pcout() << std::endl << "   Loading Ascii data initial file "
+                            << filename << " for the local subdomains." << std::endl << std::endl;
+
+          // The mesh does not exist yet, therefore we can only load the
+          // part of the data along the reference profile, which some plugins
+          // (e.g. the adiabatic conditions) evaluate before the mesh is
+          // created. Load the file again every time the mesh is set up or
+          // changed.
+          load_data_for_local_subdomain();
+          this->get_signals().edit_parameters_pre_setup_dofs.connect(std_cxx11::bind(&AsciiDataInitial<dim>::load_data_for_local_subdomain,
+                                                                                     std_cxx11::ref(*this)));
+          return;
+        }
+
       this->get_pcout() << std::endl << "   Loading Ascii data initial file "
                         << filename << "." << std::endl << std::endl;
 
-      if (Utilities::fexists(filename))
-        lookup->load_file(filename,this->get_mpi_communicator());
-      else
-        AssertThrow(false,
-                    ExcMessage (std::string("Ascii data file <")
-                                +
-                                filename
-                                +
-                                "> not found!"));
+      lookup->load_file(filename,this->get_mpi_communicator());
+    }
+
+
+    template <int dim>
+    void
+    AsciiDataInitial<dim>::load_data_for_local_subdomain ()
+    {
+      // Initial conditions are not only evaluated during the first time
+      // step, but also later by plugins that use them as boundary
+      // conditions, for the properties of new particles, or for
+      // reference profiles. Therefore the data has to follow the
+      // changing mesh for the whole model run.
+      const std::string filename = Utilities::AsciiDataBase<dim>::data_directory
+                                   + Utilities::AsciiDataBase<dim>::data_file_name;
+
+      std_cxx11::array<std::pair<double,double>,dim> region =
+        compute_local_data_region(*this);
+      add_reference_profile_to_region(*this, region);
+
+      lookup->load_file(filename,
+                        this->get_mpi_communicator(),
+                        region);
     }
 
     template <int dim>
@@ -2037,6 +3153,52 @@ namespace aspect
     }
 
 
+    template <int dim>
+    void
+    AsciiDataInitial<dim>::declare_parameters (ParameterHandler  &prm,
+                                               const std::string &default_directory,
+                                               const std::string &default_filename)
+    {
+      Utilities::AsciiDataBase<dim>::declare_parameters(prm,
+                                                        default_directory,
+                                                        default_filename);
+
+      prm.enter_subsection ("Ascii data model");
+      {
+        prm.declare_entry ("Restrict data to local subdomain", "false",
+                           Patterns::Bool (),
+                           "If set to true, every process only stores the part of the data "
+                           "file that is needed to evaluate the data on its own and its ghost "
+                           "cells, instead of the whole file. This reduces the memory "
+                           "requirements for large data files in parallel computations. "
+                           "The stored part of the data is updated whenever the mesh "
+                           "changes, and additionally contains the data along the "
+                           "reference profile from the representative point at the "
+                           "surface to the one at the bottom of the model, which is used "
+                           "e.g. by the adiabatic conditions. Plugins that evaluate the "
+                           "data anywhere else outside of the cells of a process (e.g. the "
+                           "`initial lithostatic pressure' boundary traction model) can "
+                           "not be used with this option, and the model stops with an "
+                           "error message if they try.");
+      }
+      prm.leave_subsection();
+    }
+
+
+    template <int dim>
+    void
+    AsciiDataInitial<dim>::parse_parameters (ParameterHandler &prm)
+    {
+      Utilities::AsciiDataBase<dim>::parse_parameters(prm);
+
+      prm.enter_subsection("Ascii data model");
+      {
+        restrict_to_local_subdomain = prm.get_bool ("Restrict data to local subdomain");
+      }
+      prm.leave_subsection();
+    }
+
+
     template <int dim>
     AsciiDataProfile<dim>::AsciiDataProfile ()
     {}
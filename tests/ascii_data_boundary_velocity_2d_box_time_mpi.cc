@@ -0,0 +1,83 @@
+#include <aspect/postprocess/interface.h>
+#include <aspect/boundary_velocity/interface.h>
+#include <aspect/geometry_model/interface.h>
+#include <aspect/simulator_access.h>
+#include <aspect/global.h>
+
+#include <deal.II/base/utilities.h>
+
+
+namespace aspect
+{
+  using namespace dealii;
+
+  /**
+   * A postprocessor that evaluates the prescribed velocity at one point of
+   * the left and one point of the top boundary of the box. The boundary data
+   * is evaluated on every process, and all processes have to agree on it.
+   */
+  template <int dim>
+  class BoundaryVelocityPostprocessor : public Postprocess::Interface<dim>, public ::aspect::SimulatorAccess<dim>
+  {
+    public:
+      /**
+       * Evaluate the boundary velocity and check that it is the same on all
+       * processes.
+       */
+      virtual
+      std::pair<std::string,std::string>
+      execute (TableHandler &statistics);
+  };
+
+  template <int dim>
+  std::pair<std::string,std::string>
+  BoundaryVelocityPostprocessor<dim>::execute (TableHandler &)
+  {
+    const types::boundary_id left_boundary = this->get_geometry_model().translate_symbolic_boundary_name_to_id("left");
+    const types::boundary_id top_boundary = this->get_geometry_model().translate_symbolic_boundary_name_to_id("top");
+
+    // the midpoint between the first two data points of the left boundary,
+    // and the second data point of the top boundary
+    Point<dim> left_point;
+    left_point[dim-1] = 165000;
+
+    Point<dim> top_point;
+    top_point[0] = 1650000;
+    top_point[dim-1] = 660000;
+
+    const double velocity_scaling_factor = this->convert_output_to_years() ? year_in_seconds : 1.0;
+
+    const Tensor<1,dim> left_velocity = this->get_boundary_velocity_manager().boundary_velocity(left_boundary, left_point)
+                                        * velocity_scaling_factor;
+    const Tensor<1,dim> top_velocity = this->get_boundary_velocity_manager().boundary_velocity(top_boundary, top_point)
+                                       * velocity_scaling_factor;
+
+    for (unsigned int d=0; d<dim; ++d)
+      {
+        AssertThrow (Utilities::MPI::max (left_velocity[d], this->get_mpi_communicator())
+                     ==
+                     Utilities::MPI::min (left_velocity[d], this->get_mpi_communicator()),
+                     ExcMessage ("The left boundary velocity differs between processes."));
+        AssertThrow (Utilities::MPI::max (top_velocity[d], this->get_mpi_communicator())
+                     ==
+                     Utilities::MPI::min (top_velocity[d], this->get_mpi_communicator()),
+                     ExcMessage ("The top boundary velocity differs between processes."));
+      }
+
+    std::ostringstream os;
+    os << left_velocity << ", " << top_velocity;
+
+    return std::make_pair ("Left/top boundary velocity (m/year):", os.str());
+  }
+}
+
+
+
+// explicit instantiations
+namespace aspect
+{
+  ASPECT_REGISTER_POSTPROCESSOR(BoundaryVelocityPostprocessor,
+                                "BoundaryVelocityPostprocessor",
+                                "A postprocessor that evaluates the boundary velocity "
+                                "at one point of the left and the top boundary.")
+}
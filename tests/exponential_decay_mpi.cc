@@ -0,0 +1,2 @@
+#include "../benchmarks/operator_splitting/exponential_decay/exponential_decay.cc"
+
@@ -0,0 +1,149 @@
+#include <aspect/postprocess/interface.h>
+#include <aspect/postprocess/particles.h>
+#include <aspect/particle/world.h>
+#include <aspect/simulator_access.h>
+#include <aspect/utilities.h>
+#include <aspect/global.h>
+
+#include <deal.II/base/quadrature.h>
+#include <deal.II/fe/fe_values.h>
+
+#include <fstream>
+
+
+namespace aspect
+{
+  using namespace dealii;
+
+  /**
+   * A postprocessor that checks in the first time step that the
+   * compositional fields 'advection_particle' and 'initial_x' are the cell
+   * averages of the particle properties 'function' and 'initial position
+   * [0]' they are mapped to. The particles have not moved yet in the first
+   * time step, and both properties do not change, so the particles are
+   * still the ones the fields were interpolated from. The check throws an
+   * exception if a field differs from the average, and writes the checked
+   * fields into the file <tt>particle_field_checks</tt> in the output
+   * directory.
+   */
+  template <int dim>
+  class ParticleFieldCheck : public Postprocess::Interface<dim>, public ::aspect::SimulatorAccess<dim>
+  {
+    public:
+      /**
+       * Compare the fields with the particle properties.
+       */
+      virtual
+      std::pair<std::string,std::string>
+      execute (TableHandler &statistics);
+
+      /**
+       * The particles have to exist before they can be checked.
+       */
+      virtual
+      std::list<std::string>
+      required_other_postprocessors () const;
+  };
+
+
+  template <int dim>
+  std::pair<std::string,std::string>
+  ParticleFieldCheck<dim>::execute (TableHandler &)
+  {
+    if (this->get_timestep_number() != 0)
+      return std::make_pair ("Particle field checks:", "skipped");
+
+    const Particle::World<dim> &world =
+      this->get_postprocess_manager().template get_matching_postprocessor<Postprocess::Particles<dim> >()
+      .get_particle_world();
+    const Particle::ParticleHandler<dim> &particle_handler = world.get_particle_handler();
+    const Particle::Property::ParticlePropertyInformation &property_information
+      = world.get_property_manager().get_data_info();
+
+    std::vector<std::string> field_names;
+    std::vector<std::string> property_names;
+    std::vector<unsigned int> property_indices;
+
+    field_names.push_back ("advection_particle");
+    property_names.push_back ("function");
+    property_indices.push_back (property_information.get_position_by_field_name ("function"));
+
+    field_names.push_back ("initial_x");
+    property_names.push_back ("initial position [0]");
+    property_indices.push_back (property_information.get_position_by_field_name ("initial position"));
+
+    const Quadrature<dim> quadrature (this->get_fe().base_element(this->introspection().base_elements.compositional_fields)
+                                      .get_unit_support_points());
+    FEValues<dim> fe_values (this->get_mapping(),
+                             this->get_fe(),
+                             quadrature,
+                             update_values);
+    std::vector<double> field_values (quadrature.size());
+
+    typename DoFHandler<dim>::active_cell_iterator
+    cell = this->get_dof_handler().begin_active(),
+    endc = this->get_dof_handler().end();
+    for (; cell!=endc; ++cell)
+      if (cell->is_locally_owned())
+        {
+          const typename Particle::ParticleHandler<dim>::particle_iterator_range particles_in_cell
+            = particle_handler.particles_in_cell(cell);
+
+          AssertThrow (particles_in_cell.begin() != particles_in_cell.end(),
+                       ExcMessage ("This check requires particles in every cell."));
+
+          fe_values.reinit (cell);
+
+          for (unsigned int f=0; f<field_names.size(); ++f)
+            {
+              double average = 0.0;
+              unsigned int n_particles = 0;
+              for (typename Particle::ParticleHandler<dim>::particle_iterator particle = particles_in_cell.begin();
+                   particle != particles_in_cell.end(); ++particle, ++n_particles)
+                average += particle->get_property(property_indices[f]);
+              average /= n_particles;
+
+              const unsigned int field_index = this->introspection().compositional_index_for_name(field_names[f]);
+              fe_values[this->introspection().extractors.compositional_fields[field_index]]
+              .get_function_values (this->get_solution(), field_values);
+
+              for (unsigned int q=0; q<quadrature.size(); ++q)
+                AssertThrow (std::abs(field_values[q] - average) < 1e-10,
+                             ExcMessage ("The compositional field " + field_names[f]
+                                         + " is not the cell average of the particle property "
+                                         + property_names[f] + "."));
+            }
+        }
+
+    if (Utilities::MPI::this_mpi_process(this->get_mpi_communicator()) == 0)
+      {
+        std::ofstream out ((this->get_output_directory() + "particle_field_checks").c_str());
+        for (unsigned int f=0; f<field_names.size(); ++f)
+          out << "The field " << field_names[f]
+              << " is the cell average of the particle property "
+              << property_names[f] << ".\n";
+      }
+
+    return std::make_pair ("Particle field checks:", "passed");
+  }
+
+
+  template <int dim>
+  std::list<std::string>
+  ParticleFieldCheck<dim>::required_other_postprocessors () const
+  {
+    return std::list<std::string> (1, "particles");
+  }
+}
+
+
+
+// explicit instantiations
+namespace aspect
+{
+  ASPECT_REGISTER_POSTPROCESSOR(ParticleFieldCheck,
+                                "particle field check",
+                                "A postprocessor that checks that the particle advected "
+                                "compositional fields are the cell averages of the "
+                                "particle properties they are mapped to.")
+}
@@ -0,0 +1 @@
+#include "particle_storage_adaptive_refinement.cc"
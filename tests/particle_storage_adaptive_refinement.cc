@@ -0,0 +1,267 @@
+#include <aspect/postprocess/interface.h>
+#include <aspect/postprocess/particles.h>
+#include <aspect/particle/world.h>
+#include <aspect/simulator_access.h>
+#include <aspect/utilities.h>
+#include <aspect/global.h>
+
+#include <deal.II/base/utilities.h>
+#include <deal.II/base/geometry_info.h>
+#include <deal.II/fe/mapping.h>
+
+#include <algorithm>
+#include <fstream>
+
+
+namespace aspect
+{
+  using namespace dealii;
+
+  /**
+   * A postprocessor that checks the consistency of the particle storage in
+   * every time step, and throws an exception if any of the checks fails:
+   * every locally owned particle has to lie inside the cell it is stored in,
+   * the number of particles per cell kept by the particle handler has to
+   * agree with the particles that are stored in the cell, and the number
+   * of particles has to stay constant, unless the load balancing adds or
+   * removes particles. In the latter case the number of particles per cell
+   * has to stay within the limits of the load balancing instead.
+   *
+   * Since the particle positions and per-cell numbers depend on the flow
+   * field and the parallel partitioning, only the list of checks that
+   * were performed is written into the file <tt>particle_checks</tt> in
+   * the output directory, to be compared with a reference file.
+   *
+   * Other tests include this file to use the same checks.
+   */
+  template <int dim>
+  class ParticleStorageCheck : public Postprocess::Interface<dim>, public ::aspect::SimulatorAccess<dim>
+  {
+    public:
+      ParticleStorageCheck ();
+
+      /**
+       * Check the particle storage and write the list of checks.
+       */
+      virtual
+      std::pair<std::string,std::string>
+      execute (TableHandler &statistics);
+
+      /**
+       * The particles have to be advected before they can be checked.
+       */
+      virtual
+      std::list<std::string>
+      required_other_postprocessors () const;
+
+      static
+      void
+      declare_parameters (ParameterHandler &prm);
+
+      virtual
+      void
+      parse_parameters (ParameterHandler &prm);
+
+    private:
+      /**
+       * Whether to check that the number of particles does not change.
+       */
+      bool check_number_of_particles;
+
+      /**
+       * The limits of the number of particles per cell that are checked
+       * if the load balancing removes or adds particles.
+       */
+      bool check_max_particles_per_cell;
+      bool check_min_particles_per_cell;
+      unsigned int max_particles_per_cell;
+      unsigned int min_particles_per_cell;
+
+      /**
+       * The number of particles the first time the checks were performed.
+       */
+      Particle::types::particle_index initial_n_particles;
+      bool first_execution;
+  };
+
+
+  template <int dim>
+  ParticleStorageCheck<dim>::ParticleStorageCheck ()
+    :
+    initial_n_particles (0),
+    first_execution (true)
+  {}
+
+
+  template <int dim>
+  std::pair<std::string,std::string>
+  ParticleStorageCheck<dim>::execute (TableHandler &)
+  {
+    const Particle::ParticleHandler<dim> &particle_handler =
+      this->get_postprocess_manager().template get_matching_postprocessor<Postprocess::Particles<dim> >()
+      .get_particle_world().get_particle_handler();
+
+    const std::vector<unsigned int> &n_particles_per_cell = particle_handler.get_n_particles_per_cell();
+
+    AssertThrow (n_particles_per_cell.size() == this->get_triangulation().n_active_cells(),
+                 ExcMessage ("The number of particles per cell is not stored for every active cell."));
+
+    Particle::types::particle_index n_local_particles = 0;
+
+    typename parallel::distributed::Triangulation<dim>::active_cell_iterator
+    cell = this->get_triangulation().begin_active(),
+    endc = this->get_triangulation().end();
+    for (; cell!=endc; ++cell)
+      if (cell->is_locally_owned())
+        {
+          const typename Particle::ParticleHandler<dim>::particle_iterator_range particles_in_cell
+            = particle_handler.particles_in_cell(cell);
+
+          unsigned int n_particles_in_cell = 0;
+          for (typename Particle::ParticleHandler<dim>::particle_iterator particle = particles_in_cell.begin();
+               particle != particles_in_cell.end(); ++particle, ++n_particles_in_cell)
+            {
+              AssertThrow (particle->get_surrounding_cell(this->get_triangulation()) == cell,
+                           ExcMessage ("A particle is stored in the wrong cell."));
+
+              const Point<dim> reference_location
+                = this->get_mapping().transform_real_to_unit_cell(cell, particle->get_location());
+              AssertThrow (GeometryInfo<dim>::is_inside_unit_cell(reference_location, 1e-10),
+                           ExcMessage ("A particle is not located inside the cell it is stored in."));
+            }
+
+          AssertThrow (n_particles_in_cell == particle_handler.n_particles_in_cell(cell)
+                       &&
+                       n_particles_in_cell == n_particles_per_cell[cell->active_cell_index()],
+                       ExcMessage ("The number of particles of a cell does not agree "
+                                   "with the particles stored in the cell."));
+
+          if (check_max_particles_per_cell)
+            AssertThrow (n_particles_in_cell <= max_particles_per_cell,
+                         ExcMessage ("A cell contains more particles than allowed."));
+          if (check_min_particles_per_cell)
+            AssertThrow (n_particles_in_cell >= min_particles_per_cell,
+                         ExcMessage ("A cell contains fewer particles than required."));
+
+          n_local_particles += n_particles_in_cell;
+        }
+      else if (cell->is_artificial())
+        AssertThrow (n_particles_per_cell[cell->active_cell_index()] == 0,
+                     ExcMessage ("An artificial cell contains particles."));
+
+    AssertThrow (n_local_particles == particle_handler.n_locally_owned_particles(),
+                 ExcMessage ("The number of locally owned particles does not agree "
+                             "with the particles stored in the locally owned cells."));
+
+    const Particle::types::particle_index n_particles =
+      Utilities::MPI::sum (n_local_particles, this->get_mpi_communicator());
+
+    AssertThrow (n_particles == particle_handler.n_global_particles(),
+                 ExcMessage ("The global number of particles does not agree "
+                             "with the particles stored on all processes."));
+
+    if (first_execution)
+      {
+        initial_n_particles = n_particles;
+        first_execution = false;
+      }
+    else if (check_number_of_particles)
+      AssertThrow (n_particles == initial_n_particles,
+                   ExcMessage ("The number of particles changed from "
+                               + Utilities::int_to_string(initial_n_particles) + " to "
+                               + Utilities::int_to_string(n_particles) + "."));
+
+    if (Utilities::MPI::this_mpi_process(this->get_mpi_communicator()) == 0)
+      {
+        std::ofstream out ((this->get_output_directory() + "particle_checks").c_str());
+        out << "The following particle checks passed in all time steps:\n"
+            << "Particles are located in the cells they are stored in.\n"
+            << "Particle numbers per cell agree with the stored particles.\n";
+        if (check_number_of_particles)
+          out << "The number of particles does not change.\n";
+        if (check_min_particles_per_cell)
+          out << "Every cell contains at least " << min_particles_per_cell << " particles.\n";
+        if (check_max_particles_per_cell)
+          out << "Every cell contains at most " << max_particles_per_cell << " particles.\n";
+      }
+
+    return std::make_pair ("Particle storage checks:", "passed");
+  }
+
+
+  template <int dim>
+  std::list<std::string>
+  ParticleStorageCheck<dim>::required_other_postprocessors () const
+  {
+    return std::list<std::string> (1, "particles");
+  }
+
+
+  template <int dim>
+  void
+  ParticleStorageCheck<dim>::declare_parameters (ParameterHandler &prm)
+  {
+    prm.enter_subsection("Postprocess");
+    {
+      prm.enter_subsection("Particle storage check");
+      {
+        prm.declare_entry ("Check number of particles", "true",
+                           Patterns::Bool (),
+                           "Whether to check that the number of particles does not "
+                           "change. This check is skipped if the load balancing adds "
+                           "or removes particles, and should be disabled if particles "
+                           "can leave the domain.");
+      }
+      prm.leave_subsection();
+    }
+    prm.leave_subsection();
+  }
+
+
+  template <int dim>
+  void
+  ParticleStorageCheck<dim>::parse_parameters (ParameterHandler &prm)
+  {
+    prm.enter_subsection("Postprocess");
+    {
+      prm.enter_subsection("Particle storage check");
+      {
+        check_number_of_particles = prm.get_bool ("Check number of particles");
+      }
+      prm.leave_subsection();
+
+      // the limits of the particle load balancing are declared by the
+      // particle world
+      prm.enter_subsection("Particles");
+      {
+        const std::vector<std::string> strategies = Utilities::split_string_list(prm.get ("Load balancing strategy"));
+
+        const bool remove_particles = (std::find(strategies.begin(), strategies.end(), "remove particles") != strategies.end())
+                                      || (std::find(strategies.begin(), strategies.end(), "remove and add particles") != strategies.end());
+        const bool add_particles = (std::find(strategies.begin(), strategies.end(), "add particles") != strategies.end())
+                                   || (std::find(strategies.begin(), strategies.end(), "remove and add particles") != strategies.end());
+
+        check_max_particles_per_cell = remove_particles;
+        check_min_particles_per_cell = add_particles;
+        max_particles_per_cell = prm.get_integer ("Maximum particles per cell");
+        min_particles_per_cell = prm.get_integer ("Minimum particles per cell");
+
+        if (remove_particles || add_particles)
+          check_number_of_particles = false;
+      }
+      prm.leave_subsection();
+    }
+    prm.leave_subsection();
+  }
+}
+
+
+
+// explicit instantiations
+namespace aspect
+{
+  ASPECT_REGISTER_POSTPROCESSOR(ParticleStorageCheck,
+                                "particle storage check",
+                                "A postprocessor that checks the consistency of the "
+                                "particle storage in every time step.")
+}